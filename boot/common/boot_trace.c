@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/boot.h>
+#include <tilck/common/arch/generic_x86/x86_utils.h>
+
+#include "common_int.h"
+
+/*
+ * The bootloader's stages, timestamped with the TSC. It does not stop nor
+ * get reset when the kernel takes over, so the kernel can just append its own
+ * timestamps to these ones. The trace is copied in the extra boot info struct
+ * right before jumping to the kernel.
+ */
+static struct tilck_boot_trace bl_trace;
+
+void
+boot_trace_stamp(const char *name)
+{
+   struct tilck_boot_trace_entry *e;
+
+   if (bl_trace.count == TILCK_BOOT_TRACE_MAX)
+      return;
+
+   e = &bl_trace.entries[bl_trace.count++];
+   e->tsc = RDTSC();
+   strncpy(e->name, name, sizeof(e->name) - 1);
+}
+
+void
+boot_trace_copy(struct tilck_boot_trace *dst)
+{
+   memcpy(dst, &bl_trace, sizeof(bl_trace));
+}
@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck_gen_headers/config_boot.h>
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/fat32_base.h>
+
+#include "common_int.h"
+
+bool
+check_fat_header(struct fat_hdr *hdr)
+{
+   /*
+    * Minimum sanity checks for determining if we correctly read a real FAT
+    * header or some corrupted data.
+    */
+
+   if (hdr->BPB_BytsPerSec != SECTOR_SIZE)
+      return false;
+
+   switch (fat_get_type(hdr)) {
+
+      case fat12_type:
+         /* We never use FAT12: something must be wrong */
+         return false;
+
+      case fat16_type:
+
+         {
+            struct fat16_header2 *h2 = (void *)(hdr + 1);
+
+            if (h2->BS_FilSysType[0] != 'F' ||
+                h2->BS_FilSysType[1] != 'A' ||
+                h2->BS_FilSysType[2] != 'T')
+            {
+               /*
+               * The FAT specification does not require BS_FilSysType to be set,
+               * but the Tilck tools and most of the FAT tools in general do set
+               * this field to a reasonable value like FAT16 or FAT32. If it
+               * does not start with "FAT", something is wrong.
+               */
+               return false;
+            }
+         }
+         break;
+
+      case fat32_type:
+
+         {
+            struct fat32_header2 *h2 = (void *)(hdr + 1);
+
+            if (h2->BS_FilSysType[0] != 'F' ||
+                h2->BS_FilSysType[1] != 'A' ||
+                h2->BS_FilSysType[2] != 'T')
+            {
+               /* Same as for fat16_type */
+               return false;
+            }
+         }
+
+         break;
+
+      default:
+
+         /* We couldn't determine the FAT type */
+         return false;
+   }
+
+   return true;
+}
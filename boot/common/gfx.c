@@ -37,8 +37,10 @@ append_ok_mode(video_mode_t mode, struct generic_video_mode_info *gi)
 void
 init_common_bootloader_code(const struct bootloader_intf *i)
 {
-   if (!intf)
+   if (!intf) {
       intf = i;
+      boot_trace_stamp("bootloader");
+   }
 }
 
 static bool
@@ -595,6 +595,7 @@ common_bootloader_logic(void)
    if (!load_kernel_file())
       return false;
 
+   boot_trace_stamp("kernel_file");
    printk("\n");
 
    if (kmod_serial && !video_modes_cnt) {
@@ -626,8 +627,12 @@ retry:
    in_retry = true;
 
    if (interactive) {
+
       if (!run_interactive_logic())
          return false;
+
+      /* Time spent waiting for the user: not part of the boot cost */
+      boot_trace_stamp("menu");
    }
 
    clear_screen();
@@ -640,6 +645,8 @@ retry:
       return false;
    }
 
+   boot_trace_stamp("initrd");
+
    if (selected_mode != INVALID_VIDEO_MODE) {
 
       if (!intf->set_curr_video_mode(selected_mode)) {
@@ -677,5 +684,6 @@ retry:
       }
    }
 
+   boot_trace_stamp("video_mode");
    return true;
 }
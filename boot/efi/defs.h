@@ -40,6 +40,7 @@ extern const struct bootloader_intf efi_boot_intf;
 EFI_STATUS LoadKernelFile(CHAR16 *filePath, EFI_PHYSICAL_ADDRESS *paddr);
 EFI_STATUS MultibootSaveMemoryMap(UINTN *mapkey);
 EFI_STATUS SetupMultibootInfo(void);
+void MbiSetBootTrace(void);
 
 EFI_STATUS
 ReserveMemAreaForKernelImage(void);
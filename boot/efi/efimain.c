@@ -98,7 +98,10 @@ efi_main(EFI_HANDLE image, EFI_SYSTEM_TABLE *__ST)
 
    /* --- Point of no return: from here on, we MUST NOT fail --- */
 
+   boot_trace_stamp("exit_boot_services");
    kernel_entry = load_kernel_image();
+   boot_trace_stamp("kernel_image");
+   MbiSetBootTrace();
    JumpToKernel(kernel_entry);
 
 end:
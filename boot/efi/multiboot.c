@@ -348,8 +348,9 @@ MbiSetExtraBootInfo(void)
     * We set struct tilck_extra_boot_info to the `apm_table` field
     * instead of RSDP as mentioned earlier.
     *
-    * Struct tilck_extra_boot_info stores RSDP and
-    * RT (UEFI Runtime Services pointer).
+    * Struct tilck_extra_boot_info stores RSDP,
+    * RT (UEFI Runtime Services pointer) and the bootloader's boot trace,
+    * filled later by MbiSetBootTrace().
     */
 
    gMbi->apm_table = (u32)paddr;
@@ -358,6 +359,18 @@ end:
    return status;
 }
 
+/*
+ * Copy the bootloader's boot trace in the extra boot info page. Called right
+ * before jumping to the kernel, after ExitBootServices(): the page is still
+ * there, identity-mapped.
+ */
+void
+MbiSetBootTrace(void)
+{
+   struct tilck_extra_boot_info *info = TO_PTR(gMbi->apm_table);
+   boot_trace_copy(&info->trace);
+}
+
 static void
 MbiSetKernelCmdline(void)
 {
@@ -6,6 +6,8 @@
 #include <tilck/common/page_size.h>
 #include <tilck/common/assert.h>
 #include <tilck/common/fat32_base.h>
+#include <tilck/common/lz4.h>
+#include <tilck/common/string_util.h>
 #include <tilck/common/utils.h>
 
 #include "defs.h"
@@ -22,6 +24,9 @@ struct load_ramdisk_ctx {
    UINT32 rounded_tot_used_bytes;   /* Rounded up at PAGE_SIZE */
 
    void *fat_hdr;
+
+   bool compressed;                 /* see <tilck/common/lz4.h> */
+   struct lz4_rd_header lz4_hdr;
 };
 
 static EFI_STATUS
@@ -43,6 +48,18 @@ LoadRamdisk_GetTotFatSize(struct load_ramdisk_ctx *ctx)
    status = ReadAlignedBlock(ctx->blockio, initrd_off, PAGE_SIZE, fat_hdr);
    HANDLE_EFI_ERROR("ReadAlignedBlock");
 
+   if (((struct lz4_rd_header *)fat_hdr)->magic == LZ4_RD_MAGIC) {
+
+      ctx->compressed = true;
+      ctx->lz4_hdr = *(struct lz4_rd_header *)fat_hdr;
+      ctx->tot_used_bytes = ctx->lz4_hdr.raw_size;
+      ctx->rounded_tot_used_bytes = round_up_at(ctx->tot_used_bytes, PAGE_SIZE);
+
+      status = BS->FreePages(paddr, 1);
+      HANDLE_EFI_ERROR("FreePages");
+      goto end;
+   }
+
    fat_sec_sz = fat_get_sector_size(fat_hdr);
    ctx->total_fat_size = (fat_get_first_data_sector(fat_hdr) + 1) * fat_sec_sz;
    ctx->rounded_tot_fat_sz = round_up_at(ctx->total_fat_size, PAGE_SIZE);
@@ -92,6 +109,78 @@ end:
    return status;
 }
 
+/*
+ * Read and decompress a compressed initrd directly into ctx->fat_hdr, one
+ * chunk at a time. The chunks are read right after a window big enough for
+ * the largest block: the partial block at the end of each chunk is moved back
+ * just before the next one. See load_lz4_ramdisk() in the legacy bootloader.
+ */
+static EFI_STATUS
+LoadRamdisk_ReadCompressed(struct load_ramdisk_ctx *ctx)
+{
+   const UINTN initrd_off = INITRD_SECTOR * SECTOR_SIZE;
+   const UINT32 ChunkSize = 256 * KB;
+   const UINT32 window = round_up_at(LZ4_RD_MAX_BLK_DISK_SZ, PAGE_SIZE);
+   const UINTN pages = (window + ChunkSize) / PAGE_SIZE;
+   const UINT32 blockSize = ctx->blockio->Media->BlockSize;
+   struct lz4_rd_ctx lz = {
+      .out = ctx->fat_hdr,
+      .out_size = ctx->lz4_hdr.raw_size,
+   };
+   EFI_PHYSICAL_ADDRESS paddr = 0;
+   EFI_STATUS status;
+   UINT32 tot, have = 0, skip = sizeof(struct lz4_rd_header);
+   u8 *stage;
+
+   CHECK(ctx->lz4_hdr.block_size == LZ4_RD_BLOCK_SIZE);
+
+   tot = round_up_at(sizeof(struct lz4_rd_header) + ctx->lz4_hdr.data_size,
+                     blockSize);
+
+   status = BS->AllocatePages(AllocateAnyPages, EfiLoaderData, pages, &paddr);
+   HANDLE_EFI_ERROR("AllocatePages");
+   stage = (u8 *)TO_PTR(paddr) + window;
+
+   for (UINT32 off = 0; off < tot; off += ChunkSize) {
+
+      const UINT32 n = MIN(ChunkSize, tot - off);
+      u8 *buf;
+      int rc;
+
+      if (off > 0)
+         ShowProgress(ST->ConOut, LOADING_INITRD_STR_U, off, tot);
+
+      status = ReadAlignedBlock(ctx->blockio, initrd_off + off, n, stage);
+      HANDLE_EFI_ERROR("ReadAlignedBlock");
+
+      /* The partial block left (`have` bytes) is right before `stage` */
+      buf = stage - have + skip;
+      rc = lz4_rd_feed(&lz, buf, have + n - skip);
+
+      if (rc < 0) {
+         status = EFI_VOLUME_CORRUPTED;
+         HANDLE_EFI_ERROR("lz4_rd_feed");
+      }
+
+      have = have + n - skip - (UINT32)rc;
+      memmove(stage - have, buf + rc, have);
+      skip = 0;
+   }
+
+   if (lz.out_pos != lz.out_size || !check_fat_header(ctx->fat_hdr)) {
+      status = EFI_VOLUME_CORRUPTED;
+      HANDLE_EFI_ERROR("Decompressed initrd");
+   }
+
+   ShowProgress(ST->ConOut, LOADING_INITRD_STR_U, tot, tot);
+
+end:
+   if (paddr)
+      BS->FreePages(paddr, pages);
+
+   return status;
+}
+
 static EFI_STATUS
 LoadRamdisk_CompactClusters(struct load_ramdisk_ctx *ctx)
 {
@@ -249,19 +338,29 @@ LoadRamdisk(EFI_HANDLE image,
    status = LoadRamdisk_GetTotFatSize(&ctx);
    HANDLE_EFI_ERROR("LoadRamdisk_GetTotFatSize");
 
-   status = LoadRamdisk_GetTotUsedBytes(&ctx);
-   HANDLE_EFI_ERROR("LoadRamdisk_GetTotUsedBytes");
+   if (!ctx.compressed) {
+      status = LoadRamdisk_GetTotUsedBytes(&ctx);
+      HANDLE_EFI_ERROR("LoadRamdisk_GetTotUsedBytes");
+   }
 
    status = LoadRamdisk_AllocMem(&ctx);
    HANDLE_EFI_ERROR("LoadRamdisk_AllocMem");
 
-   status = ReadDiskWithProgress(ST->ConOut,
-                                 LOADING_INITRD_STR_U,
-                                 ctx.blockio,
-                                 initrd_off,
-                                 ctx.rounded_tot_used_bytes,
-                                 ctx.fat_hdr);
-   HANDLE_EFI_ERROR("ReadDiskWithProgress");
+   if (ctx.compressed) {
+
+      status = LoadRamdisk_ReadCompressed(&ctx);
+      HANDLE_EFI_ERROR("LoadRamdisk_ReadCompressed");
+
+   } else {
+
+      status = ReadDiskWithProgress(ST->ConOut,
+                                    LOADING_INITRD_STR_U,
+                                    ctx.blockio,
+                                    initrd_off,
+                                    ctx.rounded_tot_used_bytes,
+                                    ctx.fat_hdr);
+      HANDLE_EFI_ERROR("ReadDiskWithProgress");
+   }
 
    /* Now we're done with the BlockIoProtocol, close it. */
    BS->CloseProtocol(bioDeviceHandle, &BlockIoProtocol, image, NULL);
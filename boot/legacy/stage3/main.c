@@ -134,12 +134,14 @@ void bootloader_main(void)
    if (!success)
       goto boot_aborted;
 
+   boot_trace_stamp("bootpart");
    success = common_bootloader_logic();
 
    if (!success)
       goto boot_aborted;
 
    entry = load_kernel_image();
+   boot_trace_stamp("kernel_image");
    mbi = setup_multiboot_info(initrd_paddr, initrd_size);
 
    /* Jump to the kernel */
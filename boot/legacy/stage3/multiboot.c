@@ -4,6 +4,8 @@
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/string_util.h>
 #include <tilck/common/printk.h>
+#include <tilck/common/utils.h>
+#include <tilck/common/boot.h>
 
 #include "common.h"
 #include "mm.h"
@@ -13,6 +15,8 @@ static multiboot_info_t *mbi;
 static multiboot_module_t *mod;
 static multiboot_memory_map_t *mmmap;
 static char *cmdline_buf;
+static struct tilck_extra_boot_info *extra_boot_info;
+static char *bootloader_name;
 
 char *
 legacy_boot_get_cmdline_buf(u32 *buf_sz)
@@ -44,6 +48,13 @@ alloc_mbi(void)
 
    mmmap = (void *)(cmdline_buf + CMDLINE_BUF_SZ);
    bzero(mmmap, g_meminfo.count * sizeof(multiboot_memory_map_t));
+
+   extra_boot_info = (void *)pow2_round_up_at((ulong)(mmmap + g_meminfo.count),
+                                              8);
+   bzero(extra_boot_info, sizeof(*extra_boot_info));
+
+   bootloader_name = (char *)(extra_boot_info + 1);
+   strcpy(bootloader_name, "TILCK_LEGACY");
 }
 
 multiboot_info_t *
@@ -126,5 +137,16 @@ setup_multiboot_info(ulong ramdisk_paddr, ulong ramdisk_size)
       };
    }
 
+   /*
+    * As the EFI bootloader does, pass the extra boot info through the
+    * `apm_table` field, without setting MULTIBOOT_INFO_APM_TABLE. Here,
+    * there's no RSDP nor UEFI RT: the kernel looks for the RSDP by itself.
+    */
+   mbi->flags |= MULTIBOOT_INFO_BOOT_LOADER_NAME;
+   mbi->boot_loader_name = (u32)bootloader_name;
+   mbi->apm_table = (u32)extra_boot_info;
+
+   boot_trace_stamp("multiboot");
+   boot_trace_copy(&extra_boot_info->trace);
    return mbi;
 }
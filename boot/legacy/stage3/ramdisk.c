@@ -4,7 +4,10 @@
 
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/fat32_base.h>
+#include <tilck/common/lz4.h>
 #include <tilck/common/printk.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/utils.h>
 #include <tilck/common/color_defs.h>
 
 #include <multiboot.h>
@@ -96,66 +99,109 @@ overlap_with_kernel_file(ulong pa, ulong sz)
    return IN_RANGE(pa, kbegin, kend) || IN_RANGE(pa + sz, kbegin, kend);
 }
 
+/*
+ * Load a compressed initrd (see <tilck/common/lz4.h>) whose header has
+ * already been read at `h`. The compressed data is read in chunks of
+ * `chunk_sectors` right after a window big enough for the largest block: the
+ * partial block left at the end of each chunk is moved back, just before the
+ * next chunk, and the complete blocks are decompressed directly into the
+ * ramdisk's final location, while reading. That way, only a few hundred KB
+ * of memory are used for the compressed data, whatever the initrd's size.
+ */
 static bool
-check_fat_header(struct fat_hdr *hdr)
+load_lz4_ramdisk(const char *load_str,
+                 struct lz4_rd_header *hdr,
+                 u32 first_sec,
+                 ulong min_paddr,
+                 ulong *ref_rd_paddr,
+                 u32 *ref_rd_size,
+                 bool alloc_extra_page)
 {
-   /*
-    * Minimum sanity checks for determining if we correctly read a real FAT
-    * header or some corrupted data.
-    */
-
-   if (hdr->BPB_BytsPerSec != SECTOR_SIZE)
-      return false;
-
-   switch (fat_get_type(hdr)) {
-
-      case fat12_type:
-         /* We never use FAT12: something must be wrong */
-         return false;
-
-      case fat16_type:
-
-         {
-            struct fat16_header2 *h2 = (void *)(hdr + 1);
-
-            if (h2->BS_FilSysType[0] != 'F' ||
-                h2->BS_FilSysType[1] != 'A' ||
-                h2->BS_FilSysType[2] != 'T')
-            {
-               /*
-               * The FAT specification does not require BS_FilSysType to be set,
-               * but the Tilck tools and most of the FAT tools in general do set
-               * this field to a reasonable value like FAT16 or FAT32. If it
-               * does not start with "FAT", something is wrong.
-               */
-               return false;
-            }
-         }
-         break;
-
-      case fat32_type:
-
-         {
-            struct fat32_header2 *h2 = (void *)(hdr + 1);
-
-            if (h2->BS_FilSysType[0] != 'F' ||
-                h2->BS_FilSysType[1] != 'A' ||
-                h2->BS_FilSysType[2] != 'T')
-            {
-               /* Same as for fat16_type */
-               return false;
-            }
-         }
-
-         break;
-
-      default:
-
-         /* We couldn't determine the FAT type */
-         return false;
+   const u32 chunk_sectors = 256;
+   const u32 chunk_sz = chunk_sectors * SECTOR_SIZE;
+   const u32 window = (u32)round_up_at(LZ4_RD_MAX_BLK_DISK_SZ, SECTOR_SIZE);
+   struct lz4_rd_header h = *hdr;     /* `hdr` is in a free memory area */
+   struct lz4_rd_ctx ctx;
+   u32 tot_sectors;        /* sectors to read, header included */
+   u32 out_size;           /* mem for the decompressed ramdisk */
+   u32 sec, have, skip;
+   ulong stage;
+   ulong free_mem;
+
+   if (h.block_size != LZ4_RD_BLOCK_SIZE)
+      goto corrupted;
+
+   tot_sectors = DIV_ROUND_UP(sizeof(h) + h.data_size, SECTOR_SIZE);
+   out_size = (u32)round_up_at(h.raw_size, SECTOR_SIZE);
+
+   if (alloc_extra_page)
+      out_size += PAGE_SIZE;
+
+   free_mem = get_usable_mem(&g_meminfo,
+                             min_paddr,
+                             out_size + window + chunk_sz);
+
+   if (!free_mem ||
+       overlap_with_kernel_file(free_mem, out_size + window + chunk_sz))
+   {
+      goto oom;
+   }
+
+   ctx = (struct lz4_rd_ctx) {
+      .out = (u8 *)free_mem,
+      .out_size = h.raw_size,
+   };
+
+   stage = free_mem + out_size + window;
+   skip = sizeof(h);
+   have = 0;
+
+   for (sec = 0; sec < tot_sectors; sec += chunk_sectors) {
+
+      const u32 n = MIN(chunk_sectors, tot_sectors - sec);
+      u8 *buf;
+      int rc;
+
+      if (sec > 0)
+         dump_progress(load_str, sec, tot_sectors);
+
+      read_sectors(stage, first_sec + sec, n);
+
+      /* The partial block left (`have` bytes) is right before `stage` */
+      buf = (u8 *)stage - have + skip;
+      rc = lz4_rd_feed(&ctx, buf, have + n * SECTOR_SIZE - skip);
+
+      if (rc < 0)
+         goto corrupted;
+
+      have = have + n * SECTOR_SIZE - skip - (u32)rc;
+      memmove((u8 *)stage - have, buf + rc, have);
+      skip = 0;
    }
 
+   if (ctx.out_pos != h.raw_size || !check_fat_header((void *)free_mem))
+      goto corrupted;
+
+   dump_progress(load_str, tot_sectors, tot_sectors);
+   bt_movecur(bt_get_curr_row(), 0);
+   printk("%s", load_str);
+   write_ok_msg();
+
+   *ref_rd_paddr = free_mem;
+   *ref_rd_size = h.raw_size;
    return true;
+
+oom:
+   printk("No free memory for loading the ramdisk\n");
+   goto end;
+
+corrupted:
+   printk("\nCompressed initrd corrupted\n");
+   goto end;
+
+end:
+   write_fail_msg();
+   return false;
 }
 
 bool
@@ -182,6 +228,16 @@ load_fat_ramdisk(const char *load_str,
    // Read FAT's header
    read_sectors(free_mem, first_sec, 1 /* read just 1 sector */);
 
+   if (((struct lz4_rd_header *)free_mem)->magic == LZ4_RD_MAGIC) {
+      return load_lz4_ramdisk(load_str,
+                              (void *)free_mem,
+                              first_sec,
+                              min_paddr,
+                              ref_rd_paddr,
+                              ref_rd_size,
+                              alloc_extra_page);
+   }
+
    // Do some sanity checks against data corruption
    if (!check_fat_header((void *)free_mem))
       goto corrupted;
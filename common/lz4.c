@@ -0,0 +1,279 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/lz4.h>
+
+/*
+ * A minimal implementation of the LZ4 block format. A block is a sequence of:
+ *
+ *    token | [literal length bytes] | literals | offset | [match length bytes]
+ *
+ * The high nibble of the token is the number of literals and the low one the
+ * length of the match minus LZ4_MIN_MATCH. A nibble equal to 15 is followed
+ * by bytes to add to the length, until one of them is not 255. The offset is
+ * a 16-bit little-endian distance back in the output. The last sequence has
+ * only literals.
+ */
+
+#define LZ4_MIN_MATCH              4
+#define LZ4_MAX_OFFSET             65535
+#define LZ4_LAST_LITERALS          5     /* the last 5 bytes are literals */
+#define LZ4_MF_LIMIT               12    /* no match starts in the last 12 */
+#define LZ4_HASH_BITS              14
+
+static int
+lz4_read_len(const u8 **ip_ref, const u8 *iend, u32 *len)
+{
+   const u8 *ip = *ip_ref;
+   u32 b;
+
+   do {
+
+      if (ip == iend || *len > (1u << 30))
+         return -1;
+
+      b = *ip++;
+      *len += b;
+
+   } while (b == 255);
+
+   *ip_ref = ip;
+   return 0;
+}
+
+int lz4_decompress(void *dst, u32 dst_size, const void *src, u32 src_size)
+{
+   const u8 *ip = src;
+   const u8 *const iend = ip + src_size;
+   u8 *op = dst;
+   u8 *const oend = op + dst_size;
+
+   while (ip < iend) {
+
+      const u32 token = *ip++;
+      const u8 *match;
+      u32 len, off;
+
+      /* Literals */
+      len = token >> 4;
+
+      if (len == 15 && lz4_read_len(&ip, iend, &len))
+         return -1;
+
+      if (len > (u32)(iend - ip) || len > (u32)(oend - op))
+         return -1;
+
+      memcpy(op, ip, len);
+      op += len;
+      ip += len;
+
+      if (ip == iend)
+         break;         /* the last sequence has no match */
+
+      /* Match */
+      if (iend - ip < 2)
+         return -1;
+
+      off = (u32)ip[0] | ((u32)ip[1] << 8);
+      ip += 2;
+
+      if (!off || off > (u32)(op - (u8 *)dst))
+         return -1;
+
+      len = token & 15;
+
+      if (len == 15 && lz4_read_len(&ip, iend, &len))
+         return -1;
+
+      len += LZ4_MIN_MATCH;
+
+      if (len > (u32)(oend - op))
+         return -1;
+
+      match = op - off;
+
+      if (off >= len) {
+         memcpy(op, match, len);
+         op += len;
+      } else {
+         /* Overlapping match: it repeats the last `off` bytes */
+         for (u32 i = 0; i < len; i++)
+            *op++ = *match++;
+      }
+   }
+
+   return (int)(op - (u8 *)dst);
+}
+
+int lz4_rd_feed(struct lz4_rd_ctx *ctx, const void *buf, u32 len)
+{
+   const u8 *p = buf;
+   u32 left = len;
+
+   while (left >= 4 && ctx->out_pos < ctx->out_size) {
+
+      const u32 word = (u32)p[0] | (u32)p[1] << 8 |
+                       (u32)p[2] << 16 | (u32)p[3] << 24;
+      const u32 blk_sz = word & ~LZ4_RD_BLK_STORED;
+      const u32 out_max = MIN(ctx->out_size - ctx->out_pos,
+                              (u32)LZ4_RD_BLOCK_SIZE);
+      u8 *const out = ctx->out + ctx->out_pos;
+      int rc;
+
+      if (blk_sz > LZ4_RD_BLOCK_SIZE)
+         return -1;
+
+      if (left - 4 < blk_sz)
+         break;                  /* incomplete block: need more data */
+
+      if (word & LZ4_RD_BLK_STORED) {
+
+         if (blk_sz != out_max)
+            return -1;
+
+         memcpy(out, p + 4, blk_sz);
+         rc = (int)blk_sz;
+
+      } else {
+
+         rc = lz4_decompress(out, out_max, p + 4, blk_sz);
+
+         if (rc != (int)out_max)
+            return -1;
+      }
+
+      ctx->out_pos += (u32)rc;
+      p += 4 + blk_sz;
+      left -= 4 + blk_sz;
+   }
+
+   return (int)(len - left);
+}
+
+#if defined(USERMODE_APP)                  ||                               \
+    defined(UNIT_TEST_ENVIRONMENT)         ||                               \
+    defined(__TILCK_KERNEL__)
+
+static inline u32 lz4_read32(const u8 *p)
+{
+   u32 v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline u32 lz4_hash(u32 v, u32 bits)
+{
+   return (v * 2654435761u) >> (32 - bits);
+}
+
+static u8 *lz4_put_len(u8 *op, u32 len)
+{
+   for (; len >= 255; len -= 255)
+      *op++ = 255;
+
+   *op++ = (u8)len;
+   return op;
+}
+
+/*
+ * Emit a sequence with `lit_len` literals from `lit` and, if `match_len` is
+ * not zero, a match. Returns the new output pointer, or NULL if there's not
+ * enough room before `oend`.
+ */
+static u8 *
+lz4_emit(u8 *op, u8 *oend, const u8 *lit, u32 lit_len, u32 off, u32 match_len)
+{
+   const u32 ml = match_len ? match_len - LZ4_MIN_MATCH : 0;
+   const u32 worst = 1 + lit_len / 255 + 1 + lit_len + 2 + ml / 255 + 1;
+   u8 *token = op++;
+
+   if (worst > (u32)(oend - op + 1))
+      return NULL;
+
+   *token = (u8)(MIN(lit_len, 15u) << 4);
+
+   if (lit_len >= 15)
+      op = lz4_put_len(op, lit_len - 15);
+
+   memcpy(op, lit, lit_len);
+   op += lit_len;
+
+   if (!match_len)
+      return op;
+
+   *op++ = (u8)(off & 0xff);
+   *op++ = (u8)(off >> 8);
+   *token |= (u8)MIN(ml, 15u);
+
+   if (ml >= 15)
+      op = lz4_put_len(op, ml - 15);
+
+   return op;
+}
+
+int lz4_compress_ht(void *dst, u32 dst_size, const void *src, u32 src_size,
+                    u32 *table, u32 ht_bits)
+{
+   const u8 *const s = src;
+   u8 *op = dst;
+   u8 *const oend = op + dst_size;
+   u32 ip = 0, anchor = 0;
+
+   memset(table, 0, sizeof(table[0]) << ht_bits);
+
+   if (src_size > LZ4_MF_LIMIT) {
+
+      const u32 match_limit = src_size - LZ4_MF_LIMIT;
+      const u32 end_limit = src_size - LZ4_LAST_LITERALS;
+
+      while (ip < match_limit) {
+
+         const u32 seq = lz4_read32(s + ip);
+         const u32 h = lz4_hash(seq, ht_bits);
+         const u32 cand = table[h];
+         u32 len;
+
+         table[h] = ip;
+
+         if (cand >= ip ||
+             ip - cand > LZ4_MAX_OFFSET ||
+             lz4_read32(s + cand) != seq)
+         {
+            ip++;
+            continue;
+         }
+
+         for (len = LZ4_MIN_MATCH;
+              ip + len < end_limit && s[cand + len] == s[ip + len];
+              len++) { }
+
+         op = lz4_emit(op, oend, s + anchor, ip - anchor, ip - cand, len);
+
+         if (!op)
+            return -1;
+
+         ip += len;
+         anchor = ip;
+      }
+   }
+
+   op = lz4_emit(op, oend, s + anchor, src_size - anchor, 0, 0);
+
+   if (!op)
+      return -1;
+
+   return (int)(op - (u8 *)dst);
+}
+
+#endif
+
+#if defined(USERMODE_APP) || defined(UNIT_TEST_ENVIRONMENT)
+
+int lz4_compress(void *dst, u32 dst_size, const void *src, u32 src_size)
+{
+   static u32 table[1 << LZ4_HASH_BITS];
+   return lz4_compress_ht(dst, dst_size, src, src_size, table, LZ4_HASH_BITS);
+}
+
+#endif
@@ -24,6 +24,7 @@
 
 /* opt-in debug features */
 #cmakedefine01 KRN_HANG_DETECTION
+#cmakedefine01 KRN_IRQSOFF_TRACER
 
 /*
  * --------------------------------------------------------------------------
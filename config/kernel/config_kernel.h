@@ -50,3 +50,7 @@
 #define WTH_MAX_PRIO_QUEUE_SIZE                    32
 #define WTH_KB_QUEUE_SIZE                          32
 #define WTH_SERIAL_QUEUE_SIZE                      32
+#define WTH_MAX_QUEUE_SIZE                       1024
+#define WTH_OVF_POOL_SIZE                         256
+
+#define PROF_BUF_SAMPLES                         2048
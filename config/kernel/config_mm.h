@@ -18,6 +18,10 @@
 
 #define KRN_USER_STACK_PAGES       @KRN_USER_STACK_PAGES@
 
+/* --------- Boolean config variables --------- */
+
+#cmakedefine01 KRN_RAMFS_COMPRESSION
+
 
 /*
  * --------------------------------------------------------------------------
@@ -45,5 +49,18 @@
 #define USER_MMAP_MIN_SZ            (16 * MB)
 #define USER_MMAP_MAX_SZ          (1024 * MB)
 
+/* Changing the protection of more pages than that flushes the whole TLB */
+#define USER_PAGES_PROT_INVLPG_MAX              32
+
+/* Compressed ramfs tier (KRN_RAMFS_COMPRESSION) */
+#define RAMFS_Z_SCAN_INTERVAL_SECS               5
+#define RAMFS_Z_CHUNK_SIZE               (64 * KB)
+#define RAMFS_Z_MAX_BLOB_SIZE    (PAGE_SIZE * 3 / 4)   /* larger: not worth */
+
+/* Same-page merging scanner (-ksm), see kernel/mm/ksm.c */
+#define KSM_SCAN_INTERVAL_MS                   100
+#define KSM_PAGES_PER_BATCH                     64
+#define KSM_TABLE_SIZE                        4096   /* power of 2 */
+
 #define USERMODE_STACK_MAX \
    ((USERMODE_VADDR_END - 1) & ALIGNED_MASK(USERMODE_STACK_ALIGN))
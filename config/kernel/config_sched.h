@@ -11,6 +11,7 @@
 #define KRN_TIMER_HZ                   @KRN_TIMER_HZ@
 #define KRN_SCHED_LATENCY_TICKS        @KRN_SCHED_LATENCY_TICKS@
 #define KRN_MIN_GRANULARITY_TICKS      @KRN_MIN_GRANULARITY_TICKS@
+#define KRN_RT_BANDWIDTH_PCT           @KRN_RT_BANDWIDTH_PCT@
 
 /* --------- Boolean config variables --------- */
 #cmakedefine01 KRN_RESCHED_ENABLE_PREEMPT
@@ -61,3 +61,10 @@ size_t get_loaded_kernel_mem_sz(void);
 void write_bootloader_hello_msg(void);
 void write_ok_msg(void);
 void write_fail_msg(void);
+
+struct fat_hdr;
+bool check_fat_header(struct fat_hdr *hdr);
+
+struct tilck_boot_trace;
+void boot_trace_stamp(const char *name);
+void boot_trace_copy(struct tilck_boot_trace *dst);
@@ -229,14 +229,23 @@ static ALWAYS_INLINE void set_eflags(ulong f)
  */
 #ifndef UNIT_TEST_ENVIRONMENT
 
+#ifdef __TILCK_KERNEL__
+   #include <tilck/kernel/irqsoff.h>
+#else
+   #define IRQSOFF_TRACE_IRQS_OFF()          do { } while (0)
+   #define IRQSOFF_TRACE_IRQS_ON()           do { } while (0)
+#endif
+
 static ALWAYS_INLINE void enable_interrupts_forced(void)
 {
+   IRQSOFF_TRACE_IRQS_ON();
    asmVolatile("sti");
 }
 
 static ALWAYS_INLINE void disable_interrupts_forced(void)
 {
    asmVolatile("cli");
+   IRQSOFF_TRACE_IRQS_OFF();
 }
 
 static ALWAYS_INLINE bool are_interrupts_enabled(void)
@@ -324,6 +333,14 @@ static ALWAYS_INLINE void write_cr3(ulong val)
                : /* no clobber */);
 }
 
+/*
+ * Invalidates all the non-global TLB entries, i.e. all the user pages.
+ */
+static ALWAYS_INLINE void invalidate_user_tlb_hw(void)
+{
+   write_cr3(read_cr3());
+}
+
 static ALWAYS_INLINE ulong read_cr4(void)
 {
    ulong res;
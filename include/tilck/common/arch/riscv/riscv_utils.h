@@ -108,6 +108,13 @@
  */
 #ifndef UNIT_TEST_ENVIRONMENT
 
+#ifdef __TILCK_KERNEL__
+   #include <tilck/kernel/irqsoff.h>
+#else
+   #define IRQSOFF_TRACE_IRQS_OFF()          do { } while (0)
+   #define IRQSOFF_TRACE_IRQS_ON()           do { } while (0)
+#endif
+
 static ALWAYS_INLINE bool are_interrupts_enabled(void)
 {
    return !!(csr_read(CSR_SSTATUS) & SR_SIE);
@@ -119,12 +126,14 @@ static ALWAYS_INLINE void disable_interrupts(ulong *var)
 
    if (*var & SR_SIE) {
       csr_clear(CSR_SSTATUS, SR_SIE);
+      IRQSOFF_TRACE_IRQS_OFF();
    }
 }
 
 static ALWAYS_INLINE void enable_interrupts(ulong *var)
 {
    if (*var & SR_SIE) {
+      IRQSOFF_TRACE_IRQS_ON();
       csr_set(CSR_SSTATUS, SR_SIE);
    }
 }
@@ -132,10 +141,12 @@ static ALWAYS_INLINE void enable_interrupts(ulong *var)
 static ALWAYS_INLINE void disable_interrupts_forced(void)
 {
    csr_clear(CSR_SSTATUS, SR_SIE);
+   IRQSOFF_TRACE_IRQS_OFF();
 }
 
 static ALWAYS_INLINE void enable_interrupts_forced(void)
 {
+   IRQSOFF_TRACE_IRQS_ON();
    csr_set(CSR_SSTATUS, SR_SIE);
 }
 
@@ -175,6 +186,14 @@ static ALWAYS_INLINE void invalidate_page_hw(ulong vaddr)
    asmVolatile("sfence.vma %0" : : "r" (vaddr) : "memory");
 }
 
+/*
+ * Invalidates all the TLB entries, including the ones of the user pages.
+ */
+static ALWAYS_INLINE void invalidate_user_tlb_hw(void)
+{
+   asmVolatile("sfence.vma" : : : "memory");
+}
+
 static ALWAYS_INLINE void flush_icache_all(void)
 {
    asmVolatile("fence.i" : : : "memory");
@@ -12,18 +12,44 @@
 
 #ifdef CLANGD
    #define uint32_t unsigned int
+   #define uint64_t unsigned long long
 #endif
 
 
 #define TILCK_BOOT_EFI_RUNTIME_RO (MULTIBOOT_MEMORY_RESERVED + 1)
 #define TILCK_BOOT_EFI_RUNTIME_RW (MULTIBOOT_MEMORY_RESERVED + 2)
 
+#define TILCK_BOOT_TRACE_MAX             16
+#define TILCK_BOOT_TRACE_NAME_LEN        20
+
+/*
+ * Timestamps (TSC values) of the bootloader's stages, passed to the kernel
+ * which merges them with its own (see kernel/boot_trace.c). The layout is the
+ * same for 32-bit and 64-bit bootloaders, as a 64-bit EFI bootloader can load
+ * a 32-bit kernel.
+ */
+struct tilck_boot_trace_entry
+{
+  uint64_t tsc;
+  char name[TILCK_BOOT_TRACE_NAME_LEN];
+  uint32_t reserved;
+};
+
+struct tilck_boot_trace
+{
+  uint32_t count;
+  uint32_t reserved;
+  struct tilck_boot_trace_entry entries[TILCK_BOOT_TRACE_MAX];
+};
+
 struct tilck_extra_boot_info
 {
   uint32_t RSDP;
   uint32_t RT;
+  struct tilck_boot_trace trace;
 };
 
 #ifdef CLANGD
    #undef uint32_t
+   #undef uint64_t
 #endif
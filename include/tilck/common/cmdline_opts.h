@@ -20,6 +20,8 @@ DEFINE_KOPT(selftest          ,     , wordstr, NULL)
 DEFINE_KOPT(sched_alive_thread, sat , bool,    KERNEL_SAT)
 DEFINE_KOPT(sercon            ,     , bool,    KERNEL_SERCON || !MOD_console)
 DEFINE_KOPT(noacpi            ,     , bool,    false)
+DEFINE_KOPT(acpi_lazy         , al  , bool,    false)
+DEFINE_KOPT(no_defer_mods     , ndm , bool,    false)
 DEFINE_KOPT(fb_no_opt         ,     , bool,    false)
 DEFINE_KOPT(fb_no_wc          ,     , bool,    false)
 DEFINE_KOPT(no_fpu_memcpy     ,     , bool,    false)
@@ -30,3 +32,8 @@ DEFINE_KOPT(panic_mmap        , pm  , bool,    false)
 DEFINE_KOPT(big_scroll_buf    , bb  , bool,    TERM_BIG_SCROLL_BUF)
 DEFINE_KOPT(ps2_log           , plg , bool,    PS2_VERBOSE_DEBUG_LOG)
 DEFINE_KOPT(ps2_selftest      , pse , bool,    PS2_DO_SELFTEST)
+DEFINE_KOPT(trace_buf_kb      , tbk , long,    128)
+DEFINE_KOPT(ramfs_zidle       , rzi , long,    30)
+DEFINE_KOPT(ksm               ,     , bool,    false)
+DEFINE_KOPT(big_pages         , bp  , bool,    false)
+DEFINE_KOPT(task_pool         , tp  , long,    8)
@@ -91,6 +91,8 @@ struct dp_trace_stats {
    s32  printk_lvl;          /* trace_printk verbosity threshold */
    s32  sys_traced_count;    /* number of syscalls in the filter */
    s32  tasks_traced_count;  /* number of tasks with .traced=true */
+   u32  lost_events;         /* events dropped because the ring was full */
+   u32  ring_capacity;       /* trace ring size, in events */
 };
 
 /*
@@ -139,6 +141,20 @@ struct dp_task_info {
    u8   reserved[3];
 
    char name[DP_TASK_NAME_MAX];
+
+   /* Scheduling-latency summary, see struct dp_sched_stats */
+   u32  nvcsw;
+   u32  nivcsw;
+   u32  wakeups;
+   u32  reserved2;
+   u64  wakeup_lat_tot;      /* RDTSC cycles */
+   u64  wakeup_lat_max;      /* RDTSC cycles */
+
+   /* Memory usage of the address space, see struct mm_usage */
+   u32  rss_pages;
+   u32  shared_pages;
+   u32  pt_pages;
+   u32  reserved3;
 };
 
 /*
@@ -183,7 +199,37 @@ struct dp_kmalloc_chunk {
    u32  reserved;
 };
 
-/* IRQs panel snapshot. */
+/*
+ * IRQs panel snapshot. The per-IRQ handler stats mirror `struct
+ * irq_line_stats` from <tilck/kernel/irq_stats.h>, the bottom halves ones
+ * `struct wth_exec_stats` from <tilck/kernel/worker_thread.h>. All the
+ * durations are in RDTSC cycles.
+ */
+#define DP_IRQ_LINES                32
+#define DP_IRQ_HIST_BUCKETS         32
+#define DP_IRQ_BH_MAX               16
+
+#define DP_IRQ_FL_RESET              (1u << 0)   /* reset after snapshot */
+
+struct dp_irq_line_stats {
+
+   u64  count;
+   u64  tot_cycles;
+   u64  max_cycles;
+   u32  spurious;
+   u32  unhandled;
+   u32  hist[DP_IRQ_HIST_BUCKETS];   /* [2^i, 2^(i+1)) cycles */
+};
+
+struct dp_irq_bh_stats {
+
+   char name[DP_TASK_NAME_MAX];      /* worker thread, "" for generic ones */
+   s32  priority;
+   u32  run;                         /* jobs run */
+   u64  exec_tot;
+   u64  exec_max;
+};
+
 struct dp_irq_stats {
 
    u32  slow_timer_count;            /* slow_timer_irq_handler_count */
@@ -191,6 +237,13 @@ struct dp_irq_stats {
    u64  ticks_at_snapshot;           /* get_ticks() at sample time */
    u32  unhandled_count[DP_IRQ_VECTORS];
    u32  unmasked_mask_lo16;          /* bitmask of legacy IRQ 0..15 */
+
+   u32  tsc_khz;                     /* 0 if not known yet */
+   u64  tsc_at_snapshot;
+   u32  max_nesting;                 /* max IRQ handlers running at once */
+   u32  bh_count;
+   struct dp_irq_line_stats lines[DP_IRQ_LINES];
+   struct dp_irq_bh_stats bh[DP_IRQ_BH_MAX];
 };
 
 /*
@@ -261,6 +314,94 @@ struct dp_runtime_info {
    u32  clk_multi_second_resync_count;
 };
 
+/*
+ * IRQsOff panel snapshot. Mirrors `struct irqsoff_stats` from
+ * <tilck/kernel/irqsoff.h>, one per kind (irqs-off, preempt-off), with the
+ * call sites of the longest sections already resolved to "symbol+0xoff"
+ * strings by the kernel. All durations are in RDTSC cycles.
+ */
+#define DP_IRQSOFF_HIST_BUCKETS     32
+#define DP_IRQSOFF_TOP_N             8
+#define DP_IRQSOFF_SYM_MAX          40
+
+#define DP_IRQSOFF_FL_RESET          (1u << 0)   /* reset after snapshot */
+
+struct dp_irqsoff_site {
+
+   u64  cycles;
+   char begin[DP_IRQSOFF_SYM_MAX];
+   char end[DP_IRQSOFF_SYM_MAX];
+};
+
+struct dp_irqsoff_kind_stats {
+
+   u64  count;
+   u64  tot_cycles;
+   u64  max_cycles;
+   u32  hist[DP_IRQSOFF_HIST_BUCKETS];   /* [2^i, 2^(i+1)) cycles */
+   struct dp_irqsoff_site top[DP_IRQSOFF_TOP_N];
+};
+
+struct dp_irqsoff_stats {
+
+   struct dp_irqsoff_kind_stats irqs;
+   struct dp_irqsoff_kind_stats preempt;
+};
+
+/*
+ * Sched panel snapshot. Mirrors `struct sched_lat_stats` from
+ * <tilck/kernel/sched.h>: wakeup-to-run latencies in RDTSC cycles, as a
+ * log2 histogram, and the runqueue depth seen at each wakeup.
+ */
+#define DP_SCHED_LAT_HIST_BUCKETS   32
+#define DP_SCHED_RQ_HIST_BUCKETS     8
+
+#define DP_SCHED_FL_RESET            (1u << 0)   /* reset after snapshot */
+
+struct dp_sched_stats {
+
+   u32  wakeups;
+   u32  nvcsw;
+   u32  nivcsw;
+   u32  reserved;
+   u64  lat_tot;
+   u64  lat_max;
+
+   /* [2^i, 2^(i+1)) cycles, the last one unbounded */
+   u32  lat_hist[DP_SCHED_LAT_HIST_BUCKETS];
+
+   /* [0]: empty runqueue, [i]: [2^(i-1), 2^i) runnable tasks ahead */
+   u32  rq_hist[DP_SCHED_RQ_HIST_BUCKETS];
+};
+
+/*
+ * Boot panel snapshot. Mirrors the entries returned by boot_trace_get()
+ * (<tilck/kernel/boot_trace.h>): one TSC timestamp at the end of each stage.
+ */
+#define DP_BOOT_TRACE_MAX           112
+#define DP_BOOT_TRACE_NAME_MAX       32
+
+enum dp_boot_trace_src {
+   DP_BOOT_TRACE_BOOTLOADER,
+   DP_BOOT_TRACE_KERNEL,
+   DP_BOOT_TRACE_MODULE,
+};
+
+struct dp_boot_trace_entry {
+
+   u64  tsc;
+   u32  src;                           /* enum dp_boot_trace_src */
+   char name[DP_BOOT_TRACE_NAME_MAX];
+   u32  reserved;
+};
+
+struct dp_boot_trace {
+
+   u32  count;
+   u32  tsc_khz;                       /* 0 if not known yet */
+   struct dp_boot_trace_entry entries[DP_BOOT_TRACE_MAX];
+};
+
 /* ----------------- sub-command argument conventions -----------------
  *
  * sys_tilck_cmd(int cmd_n, ulong a1, ulong a2, ulong a3, ulong a4)
@@ -283,6 +424,7 @@ struct dp_runtime_info {
  *
  * GET_IRQ_STATS:
  *   a1 = struct dp_irq_stats __user *out
+ *   a2 = ulong flags (DP_IRQ_FL_*)
  *   returns: 0, or -errno
  *
  * GET_MEM_MAP:
@@ -304,6 +446,17 @@ struct dp_runtime_info {
  *   a1 = struct dp_runtime_info __user *out
  *   returns: 0, or -errno
  *
+ * GET_IRQSOFF_STATS:
+ *   a1 = struct dp_irqsoff_stats __user *out
+ *   a2 = ulong flags (DP_IRQSOFF_FL_*)
+ *   returns: 0, or -EOPNOTSUPP if KRN_IRQSOFF_TRACER is off, or -errno
+ *
+ * GET_SCHED_STATS:
+ *   a1 = ulong tid (0 for the global stats)
+ *   a2 = struct dp_sched_stats __user *out
+ *   a3 = ulong flags (DP_SCHED_FL_*, the reset applies to all the tasks)
+ *   returns: 0, or -ESRCH if there are no stats for `tid`, or -errno
+ *
  * TRACE_SET_FILTER:
  *   a1 = const char __user *expr   (NUL-terminated, ≤ DP_TRACE_FILTER_MAX)
  *   returns: 0, or -errno
@@ -318,6 +471,22 @@ struct dp_runtime_info {
  *   a2 = ulong enabled (0 or 1)
  *   returns: 0, or -ESRCH if no such task, -EPERM for kthreads/self
  *
+ * GET_BOOT_TRACE:
+ *   a1 = struct dp_boot_trace __user *out
+ *   returns: 0, or -errno
+ *
+ * TRACE_DRAIN:
+ *   a1 = struct dp_trace_event __user *buf
+ *   a2 = ulong max_count
+ *   a3 = ulong wait (wait up to 100ms if the ring is empty)
+ *   returns: number of events copied and consumed, or -errno
+ *
+ * TRACE_CONSUME:
+ *   a1 = ulong count (events read in place, starting at the ring's tail)
+ *   a2 = ulong wait (wait up to 100ms if the ring is then empty)
+ *   returns: number of events now available, or -EINVAL if `count` is
+ *   more than that, or -errno
+ *
  * TRACE_RENDER_EVENT:
  *   a1 = const struct dp_trace_event __user *event
  *   a2 = char __user *out
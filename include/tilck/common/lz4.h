@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * LZ4 block format (de)compression and the compressed initrd container.
+ *
+ * A compressed initrd is the ready-to-use FAT ramdisk image (the `fatpart`
+ * file, after fathack truncated it and page-aligned its first data sector),
+ * split in blocks of `block_size` bytes, each one compressed independently.
+ * On disk, it's a struct lz4_rd_header followed by the blocks, each one
+ * prefixed by a 32-bit little-endian word containing its compressed size.
+ * Blocks that don't compress are stored as-is, with LZ4_RD_BLK_STORED set
+ * in their size word.
+ *
+ * Because the blocks are independent, the bootloaders can decompress them
+ * while the rest of the initrd is still being read from the disk, keeping
+ * in memory only a window of compressed data. The decompressed image is
+ * exactly the original one, so nothing changes for the kernel.
+ */
+
+#pragma once
+#include <tilck/common/basic_defs.h>
+
+#define LZ4_RD_MAGIC            0x3144524cu   /* 'L' 'R' 'D' '1' (LE) */
+#define LZ4_RD_BLOCK_SIZE       (64 * KB)
+#define LZ4_RD_BLK_STORED       (1u << 31)
+
+/* Max bytes of a block on disk, size word included */
+#define LZ4_RD_MAX_BLK_DISK_SZ  (4 + LZ4_RD_BLOCK_SIZE)
+
+struct lz4_rd_header {
+
+   u32 magic;
+   u32 raw_size;              /* size of the decompressed image */
+   u32 data_size;             /* bytes after this header (all the blocks) */
+   u32 block_size;            /* decompressed size of each block but last */
+};
+
+struct lz4_rd_ctx {
+
+   u8 *out;                   /* destination of the decompressed image */
+   u32 out_size;              /* == raw_size */
+   u32 out_pos;               /* bytes decompressed so far */
+};
+
+/*
+ * Decompress one LZ4 block into `dst`. Returns the number of bytes written or
+ * -1 if the input is malformed or its data does not fit in `dst_size` bytes.
+ */
+int lz4_decompress(void *dst, u32 dst_size, const void *src, u32 src_size);
+
+/*
+ * Decompress all the complete blocks at the beginning of `buf`, appending
+ * their data to ctx->out. Returns the number of bytes consumed (the caller
+ * has to feed the remaining ones again, followed by more data), or -1 if the
+ * data is corrupted. Once the whole image has been decompressed, any further
+ * data (e.g. the sector padding) is ignored.
+ */
+int lz4_rd_feed(struct lz4_rd_ctx *ctx, const void *buf, u32 len);
+
+#if defined(USERMODE_APP)                  ||                               \
+    defined(UNIT_TEST_ENVIRONMENT)         ||                               \
+    defined(__TILCK_KERNEL__)
+
+/* Worst-case compressed size of `n` bytes */
+static inline u32 lz4_compress_bound(u32 n)
+{
+   return n + n / 255 + 16;
+}
+
+/*
+ * Like lz4_compress(), but using the caller-provided hash table `ht`, made
+ * of (1 << ht_bits) entries. Smaller tables trade some compression ratio for
+ * less memory and can be used for small inputs, like single pages. The
+ * kernel uses it to compress the cold ramfs blocks (KRN_RAMFS_COMPRESSION).
+ */
+int lz4_compress_ht(void *dst, u32 dst_size, const void *src, u32 src_size,
+                    u32 *ht, u32 ht_bits);
+
+#endif
+
+#if defined(USERMODE_APP) || defined(UNIT_TEST_ENVIRONMENT)
+
+/*
+ * Compress `src_size` bytes into one LZ4 block. Returns the compressed size
+ * or -1 if it does not fit in `dst_size` bytes. Not re-entrant, as it uses a
+ * static hash table: only the build tools and the unit tests use it.
+ */
+int lz4_compress(void *dst, u32 dst_size, const void *src, u32 src_size);
+
+#endif
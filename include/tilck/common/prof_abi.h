@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Shared ABI between the kernel's sampling profiler (kernel/prof.c) and its
+ * userspace front-end (`tracer --prof`). The sub-commands are dispatched
+ * through sys_tilck_cmd(): see TILCK_CMD_PROF_* in <tilck/common/syscalls.h>.
+ *
+ *   PROF_CTL:
+ *     a1 = enum prof_ctl_op
+ *     a2 = ulong period, in timer ticks (START only, 0 means 1)
+ *     a3 = ulong flags (PROF_FL_*, START only)
+ *     a4 = struct prof_info __user *info (NULL allowed), filled after the op
+ *     returns: 0, or -EBUSY (START while running), -ENOMEM, -errno
+ *
+ *   PROF_GET_SAMPLES:
+ *     a1 = struct prof_sample __user *buf
+ *     a2 = ulong first (index of the first sample to copy)
+ *     a3 = ulong max_count
+ *     returns: number of samples copied, or -errno
+ *
+ *   PROF_GET_SYM:
+ *     a1 = ulong addr (kernel address, as returned in the samples)
+ *     a2 = char __user *buf
+ *     a3 = ulong buf_size
+ *     returns: length of the symbol name, -ENOENT if unknown, or -errno
+ */
+
+#pragma once
+#include <tilck/common/basic_defs.h>
+
+#define PROF_MAX_CALLCHAIN           8
+
+#define PROF_FL_CALLCHAIN     (1u << 0)     /* walk the kernel stack */
+
+enum prof_ctl_op {
+   PROF_CTL_INFO  = 0,
+   PROF_CTL_START = 1,        /* discard the old samples and start */
+   PROF_CTL_STOP  = 2,        /* stop, keeping the samples */
+   PROF_CTL_FREE  = 3,        /* stop and free the sample buffer */
+};
+
+struct prof_info {
+
+   u8   running;
+   u8   reserved[3];
+   u32  flags;                /* PROF_FL_* */
+   u32  period;               /* in timer ticks */
+   u32  timer_hz;
+   u32  count;                /* samples in the buffer */
+   u32  capacity;
+   u32  lost;                 /* samples dropped: buffer full */
+   u32  reserved2;
+};
+
+/*
+ * Kernel addresses are returned already resolved to the start of their
+ * function (0 if unknown), while user ones are returned as they are.
+ * The callchain, innermost caller first, is available only for kernel
+ * samples taken with PROF_FL_CALLCHAIN.
+ */
+struct prof_sample {
+
+   u64  ip;
+   s32  tid;
+   u8   user;                 /* 0/1 */
+   u8   depth;                /* valid entries in callchain[] */
+   u16  reserved;
+   u64  callchain[PROF_MAX_CALLCHAIN];
+};
@@ -83,8 +83,45 @@ enum tilck_cmd {
     */
    TILCK_CMD_DP_GET_RUNTIME_INFO       = 35,
 
+   /*
+    * Snapshot of the irqs-off / preempt-off latency tracer (histograms +
+    * longest sections). Fed by debugpanel/dp_data.c; returns -EOPNOTSUPP
+    * when the kernel is built without KRN_IRQSOFF_TRACER.
+    */
+   TILCK_CMD_DP_GET_IRQSOFF_STATS      = 36,
+
+   /*
+    * Wakeup-to-run latency / runqueue depth histograms, global or for a
+    * single task (kernel/sched_stats.c). Fed by debugpanel/dp_data.c.
+    */
+   TILCK_CMD_DP_GET_SCHED_STATS        = 37,
+
+   /*
+    * Bulk consumers of the trace ring (see <tilck/common/tracing/ring.h>):
+    * DRAIN copies a batch of events out and consumes them, CONSUME
+    * releases the events already read in place through the read-only
+    * mapping of /syst/tracing/ring.
+    */
+   TILCK_CMD_DP_TRACE_DRAIN            = 38,
+   TILCK_CMD_DP_TRACE_CONSUME          = 39,
+
+   /*
+    * Boot-time profile: the timestamps of the bootloader stages, kernel
+    * init stages and module inits (kernel/boot_trace.c). Fed by
+    * debugpanel/dp_data.c.
+    */
+   TILCK_CMD_DP_GET_BOOT_TRACE         = 40,
+
+   /*
+    * Sampling CPU profiler (kernel/prof.c): always built in, since it
+    * costs nothing until started. See <tilck/common/prof_abi.h>.
+    */
+   TILCK_CMD_PROF_CTL                  = 41,
+   TILCK_CMD_PROF_GET_SAMPLES          = 42,
+   TILCK_CMD_PROF_GET_SYM              = 43,
+
    /* Number of elements in the enum */
-   TILCK_CMD_COUNT               = 36,
+   TILCK_CMD_COUNT               = 44,
 };
 
 #if defined(__x86_64__)
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Layout of the trace event ring exposed at /syst/tracing/ring.
+ *
+ * The kernel's tracing module keeps all the trace events in a single
+ * per-boot ring: a header, followed (at `data_off`) by `capacity` slots
+ * of `elem_size` bytes each, every slot holding one struct trace_event
+ * (struct dp_trace_event in userspace). The file can be mmap()-ed
+ * read-only: consumers read the events in place between `tail` and `head`
+ * and then release them with TILCK_CMD_DP_TRACE_CONSUME, or copy them out
+ * in bulk with TILCK_CMD_DP_TRACE_DRAIN, without mapping the ring at all.
+ *
+ * `head` and `tail` are free-running 32-bit counters (events produced and
+ * consumed since boot); `capacity` is a power of two, so the slot of the
+ * event number `n` is simply `n & (capacity - 1)`. When the ring is full,
+ * new events are dropped and counted in `lost`.
+ *
+ * Both kernel and userspace include this header. No #ifdefs.
+ */
+
+#pragma once
+
+#include <tilck/common/basic_defs.h>
+
+#define TR_RING_MAGIC      0x42525254u   /* 'T' 'R' 'R' 'B' (LE on disk) */
+#define TR_RING_VERSION    1u
+
+struct tr_ring_header {
+
+   u32 magic;
+   u32 version;
+   u32 elem_size;             /* sizeof(struct trace_event) */
+   u32 capacity;              /* number of slots, a power of two */
+   u32 data_off;              /* offset of the first slot from the header */
+   u32 reserved;
+
+   /* Written only by the kernel */
+   volatile u32 head;         /* events produced */
+   volatile u32 tail;         /* events consumed */
+   volatile u32 lost;         /* events dropped because the ring was full */
+};
+
+static inline u32
+tr_ring_count(const struct tr_ring_header *h)
+{
+   return h->head - h->tail;
+}
+
+static inline const void *
+tr_ring_slot(const struct tr_ring_header *h, u32 n)
+{
+   return (const char *)h + h->data_off
+          + (size_t)(n & (h->capacity - 1)) * h->elem_size;
+}
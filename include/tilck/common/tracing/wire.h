@@ -1,7 +1,8 @@
 /* SPDX-License-Identifier: BSD-2-Clause */
 
 /*
- * Wire format for /syst/tracing/metadata.
+ * Wire format for /syst/tracing/metadata, and for the trace recordings
+ * that embed it (see struct tr_file_header below).
  *
  * The kernel's tracing module pre-builds this blob at module-init time
  * from its in-memory metadata + slot allocation tables and exposes it
@@ -173,3 +174,50 @@ static const u16 tr_fmt_sizes[2][4] = {
    { 64, 64, 32, 16 },
    { 128, 32, 16,  0 },
 };
+
+/*
+ * Recording file format, written by `tracer --record` and read back by
+ * `tracer --replay`. The file layout is:
+ *
+ *   tr_file_header
+ *   the /syst/tracing/metadata blob, as-is     (meta_size bytes)
+ *   tr_file_sys_name[names_count]
+ *   tr_file_chunk + struct trace_event[count]  (repeated until EOF)
+ *
+ * The events are stored raw, so a recording can be replayed only by a
+ * tracer built for an arch with the same struct trace_event layout:
+ * `event_size` catches the mismatch. Each chunk also carries the number
+ * of events the kernel dropped (ring full) since the previous chunk.
+ */
+
+#define TR_FILE_MAGIC      0x46435254u   /* 'T' 'R' 'C' 'F' (LE on disk) */
+#define TR_FILE_VERSION    1u
+#define TR_CHUNK_MAGIC     0x4b484354u   /* 'T' 'C' 'H' 'K' (LE on disk) */
+#define TR_FILE_NAME_MAX   28
+
+struct tr_file_header {
+
+   u32  magic;           /* TR_FILE_MAGIC */
+   u16  version;         /* TR_FILE_VERSION */
+   u16  event_size;      /* sizeof(struct trace_event) */
+   u32  meta_size;       /* size of the metadata blob that follows */
+   u32  names_count;     /* number of tr_file_sys_name records */
+};
+
+struct tr_file_sys_name {
+
+   u32  sys_n;
+   char name[TR_FILE_NAME_MAX];  /* NUL-terminated, without "sys_" */
+};
+
+struct tr_file_chunk {
+
+   u32  magic;           /* TR_CHUNK_MAGIC */
+   u32  count;           /* events following this chunk header */
+   u32  lost;            /* events dropped since the previous chunk */
+   u32  reserved;
+};
+
+STATIC_ASSERT(sizeof(struct tr_file_header)     == 16);
+STATIC_ASSERT(sizeof(struct tr_file_sys_name)   == 32);
+STATIC_ASSERT(sizeof(struct tr_file_chunk)      == 16);
@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/common/basic_defs.h>
+
+/*
+ * Boot-time profiler: a TSC timestamp at the end of each bootloader stage,
+ * kernel init stage and module init. The entries are never discarded, so the
+ * whole trace can be read at any time through /syst/boot/trace and the debug
+ * panel. The time spent in a stage is the difference between its timestamp
+ * and the previous one.
+ */
+
+#define BOOT_TRACE_MAX_ENTRIES                 96
+
+enum boot_trace_src {
+   BOOT_TRACE_BOOTLOADER,
+   BOOT_TRACE_KERNEL,
+   BOOT_TRACE_MODULE,
+};
+
+struct boot_trace_entry {
+
+   u64 tsc;
+   const char *name;
+   enum boot_trace_src src;
+};
+
+struct tilck_boot_trace;
+
+void boot_trace(const char *name);
+void boot_trace_module(const char *name);
+void boot_trace_import(const struct tilck_boot_trace *bl_trace);
+
+/*
+ * Take the reference point for boot_trace_tsc_khz(). Must be called once the
+ * system time is running.
+ */
+void boot_trace_timer_ready(void);
+
+/*
+ * Estimate of the TSC's frequency, measured against the system time since
+ * boot_trace_timer_ready(). Returns 0 when the interval is still too short.
+ */
+u32 boot_trace_tsc_khz(void);
+
+/*
+ * Copy up to `max` entries (the bootloader ones first) in `buf`. Returns the
+ * number of entries copied.
+ */
+u32 boot_trace_get(struct boot_trace_entry *buf, u32 max);
+
+void register_boot_trace_sysfs(void);
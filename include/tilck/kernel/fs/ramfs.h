@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/kernel/fs/vfs_base.h>
+
+struct mnt_fs *ramfs_create(void);
+
+/*
+ * Stats of the compressed tier for the cold ramfs blocks, in
+ * /syst/ramfs/compression. A no-op unless KRN_RAMFS_COMPRESSION is enabled.
+ */
+void register_ramfs_sysfs(void);
@@ -165,8 +165,8 @@ struct file_ops {
    func_fsync sync;                    /* if NULL -> -EROFS or 0 */
    func_fsync datasync;                /* if NULL -> -EROFS or 0 */
 
-   func_readv readv;                   /* if NULL, emulated in non-atomic way */
-   func_writev writev;                 /* if NULL, emulated in non-atomic way */
+   func_readv readv;                   /* if NULL, emulated (see below) */
+   func_writev writev;                 /* if NULL, emulated (see below) */
 
    func_handle_fault handle_fault;     /* if NULL -> false     */
 
@@ -225,6 +225,53 @@ ssize_t vfs_writev(fs_handle h, const struct iovec *iov, int iovcnt);
 ssize_t vfs_pread(fs_handle h, void *buf, size_t buf_size, offt off);
 ssize_t vfs_pwrite(fs_handle h, void *buf, size_t buf_size, offt off);
 
+/*
+ * readv() and writev() on top of a read or write func working on kernel
+ * buffers. The iovecs are gathered through the task's io_copybuf in chunks of
+ * up to IO_COPYBUF_SIZE bytes: `func` gets called once per chunk, instead of
+ * once per iovec. Used by vfs_readv() and vfs_writev() for the file systems
+ * without native scatter-gather ops and by the ones that just want to call
+ * them under their own lock, for atomicity.
+ */
+ssize_t
+vfs_readv_copybuf(fs_handle h,
+                  const struct iovec *iov,
+                  int iovcnt,
+                  func_read func,
+                  offt *pos);
+
+ssize_t
+vfs_writev_copybuf(fs_handle h,
+                   const struct iovec *iov,
+                   int iovcnt,
+                   func_write func,
+                   offt *pos);
+
+static inline size_t iov_total_len(const struct iovec *iov, int iovcnt)
+{
+   size_t tot = 0;
+
+   for (int i = 0; i < iovcnt; i++)
+      tot += iov[i].iov_len;
+
+   return tot;
+}
+
+static inline bool iov_len_overflow(const struct iovec *iov, int iovcnt)
+{
+   ssize_t tot_len = 0;
+
+   for (int i = 0; i < iovcnt; i++) {
+
+      tot_len += iov[i].iov_len;
+
+      if (tot_len < 0)
+         return true; /* overflow detected */
+   }
+
+   return false;
+}
+
 int vfs_exlock_noblock(struct mnt_fs *fs, vfs_inode_ptr_t i);
 int vfs_exunlock(struct mnt_fs *fs, vfs_inode_ptr_t i);
 
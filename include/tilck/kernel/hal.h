@@ -273,6 +273,9 @@ void set_kernel_stack(ulong stack);
 void enable_cpu_features(void);
 void fpu_context_begin(void);
 void fpu_context_end(void);
+bool fpu_context_try_begin(void);
+void memcpy_large(void *dest, const void *src, size_t n);
+void bzero_page(void *page);
 void save_current_fpu_regs(bool in_kernel);
 void restore_fpu_regs(void *task, bool in_kernel);
 void restore_current_fpu_regs(bool in_kernel);
@@ -9,6 +9,12 @@
 
 void set_fault_handler(int fault, void *ptr);
 
+/*
+ * Registers of the context interrupted by the current IRQ, or NULL outside
+ * of IRQ handlers. Used by the sampling profiler.
+ */
+regs_t *get_irq_regs(void);
+
 static ALWAYS_INLINE bool in_irq(void)
 {
    extern atomic_int_t __in_irq_count;
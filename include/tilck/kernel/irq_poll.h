@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/common/basic_defs.h>
+#include <tilck/kernel/list.h>
+
+/*
+ * IRQ polling (NAPI-like) for drivers' bottom halves, built on worker threads.
+ *
+ * On the first IRQ, the driver calls irq_poll_schedule(), which disables the
+ * device's IRQ and enqueues the poll job. The job calls the driver's poll
+ * function with a budget: as long as the budget gets used entirely, there's
+ * probably more work to do and the job re-enqueues itself, leaving the IRQ
+ * disabled. Once a poll call does less work than its budget, the device's IRQ
+ * is enabled again. Under load, that bounds the IRQ rate and processes the
+ * data in batches; when idle, it costs one extra IRQ enable/disable per burst.
+ */
+
+struct worker_thread;
+struct irq_poll;
+
+/*
+ * Process up to `budget` units of work (packets, bytes, ...) and return how
+ * many have been processed. Called in the worker thread, preemption enabled.
+ */
+typedef int (*irq_poll_func)(struct irq_poll *ip, int budget);
+
+/*
+ * Enable or disable the IRQ at device level (e.g. its interrupt mask register),
+ * not at the interrupt controller level: the IRQ line might be shared. Called
+ * with interrupts disabled.
+ */
+typedef void (*irq_poll_set_irq_func)(struct irq_poll *ip, bool enabled);
+
+struct irq_poll {
+
+   struct list_node node;           /* all_irq_polls list, for the stats */
+   const char *name;
+   struct worker_thread *wth;
+   irq_poll_func poll;
+   irq_poll_set_irq_func set_irq;
+   void *ctx;                       /* driver's private data */
+   int budget;
+   volatile bool scheduled;         /* IRQ disabled, poll job enqueued */
+
+   /* stats */
+   u32 irqs;                        /* calls to irq_poll_schedule() */
+   u32 polls;                       /* calls to `poll` */
+   u32 budget_exhausted;            /* polls that used all their budget */
+   u32 enqueue_failures;            /* poll jobs that couldn't be enqueued */
+   u64 work;                        /* sum of the values returned by `poll` */
+};
+
+void
+irq_poll_init(struct irq_poll *ip,
+              const char *name,
+              struct worker_thread *wth,
+              irq_poll_func poll,
+              irq_poll_set_irq_func set_irq,
+              void *ctx,
+              int budget);
+
+/*
+ * Called by the driver's IRQ handler when there's work to do. Returns false
+ * only when the poll job couldn't be enqueued: in that case, the device's IRQ
+ * is left enabled, so that the next IRQ will try again.
+ */
+bool
+irq_poll_schedule(struct irq_poll *ip);
+
+/* Per-poller stats in /syst/irq_poll/stats */
+void
+register_irq_poll_sysfs(void);
@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/common/basic_defs.h>
+
+/*
+ * Per-IRQ handler accounting: number of IRQs, spurious ones and time spent
+ * in the handlers (RDTSC cycles), as a log2 histogram. The time spent in
+ * nested IRQs is charged only to them, not to the handler they interrupted.
+ *
+ * The arch IRQ dispatch code calls irq_stats_enter() before running the
+ * handlers and irq_stats_exit() after them, both with interrupts disabled.
+ */
+
+#define IRQ_STATS_MAX_IRQS                         32
+#define IRQ_STATS_HIST_BUCKETS                     32
+#define IRQ_STATS_MAX_NESTING                      16
+
+struct irq_line_stats {
+   u64 count;
+   u64 tot_cycles;
+   u64 max_cycles;
+   u32 spurious;
+
+   /* hist[i]: handlers lasting [2^i, 2^(i+1)) cycles, last one unbounded */
+   u32 hist[IRQ_STATS_HIST_BUCKETS];
+};
+
+void irq_stats_enter(void);
+void irq_stats_exit(int irq);
+void irq_stats_spurious(int irq);
+
+/* `irq` must be < IRQ_STATS_MAX_IRQS */
+void irq_stats_get(int irq, struct irq_line_stats *out);
+
+/* Max number of IRQ handlers seen running at the same time */
+u32 irq_stats_max_nesting(void);
+
+void irq_stats_reset(void);
+u32 irq_stats_hist_bucket(u64 cycles);
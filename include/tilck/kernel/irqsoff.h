@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck_gen_headers/config_debug.h>
+#include <tilck/common/basic_defs.h>
+
+/*
+ * Worst-case interrupts-off / preemption-off latency tracer.
+ *
+ * When KRN_IRQSOFF_TRACER is enabled, the IRQ-state primitives in the arch
+ * headers and the preemption counter helpers in sched.h call the hooks below
+ * on every off->on and on->off transition. Each closed section is measured
+ * in RDTSC cycles and accounted in a log2 histogram plus a small table with
+ * the longest sections, keyed by their (begin, end) call sites.
+ *
+ * The stats functions are always compiled in, so that the accounting logic
+ * can be unit-tested and the consumers (tracing, debugpanel) don't need
+ * #ifdefs: with the tracer off, the stats simply stay at zero.
+ */
+
+#define IRQSOFF_HIST_BUCKETS                       32
+#define IRQSOFF_TOP_N                               8
+
+enum irqsoff_kind {
+   IRQSOFF_IRQS      = 0,     /* interrupts disabled */
+   IRQSOFF_PREEMPT   = 1,     /* preemption disabled */
+   IRQSOFF_KINDS_COUNT,
+};
+
+struct irqsoff_site {
+   u64 cycles;
+   ulong begin_ip;
+   ulong end_ip;
+};
+
+struct irqsoff_stats {
+   u64 count;                 /* number of closed sections */
+   u64 tot_cycles;
+   u64 max_cycles;
+
+   /* hist[i]: sections lasting [2^i, 2^(i+1)) cycles, last one unbounded */
+   u32 hist[IRQSOFF_HIST_BUCKETS];
+
+   /* Longest sections, sorted by `cycles` desc; at most one per site pair */
+   struct irqsoff_site top[IRQSOFF_TOP_N];
+};
+
+void irqsoff_get_stats(enum irqsoff_kind k, struct irqsoff_stats *out);
+void irqsoff_reset_stats(enum irqsoff_kind k);
+u32 irqsoff_hist_bucket(u64 cycles);
+
+/* Format a call site as "symbol+0xoff" (or just its address, as fallback) */
+void irqsoff_ip_to_str(ulong ip, char *buf, size_t size);
+
+/*
+ * Low-level hooks. Always called with interrupts disabled, except for the
+ * preemption ones, which take care of that on their own.
+ *
+ * irqsoff_trace_entry() is called by the interrupt entry points, where the
+ * CPU already disabled the interrupts. It returns true if it opened a new
+ * section, meaning that the interrupted context had the interrupts enabled:
+ * in that case, the matching irqsoff_trace_exit() closes the section, right
+ * before the `iret` re-enables them.
+ */
+void irqsoff_trace_irqs_off(void);
+void irqsoff_trace_irqs_on(void);
+bool irqsoff_trace_entry(void);
+void irqsoff_trace_exit(bool opened);
+void irqsoff_trace_preempt_off(void);
+void irqsoff_trace_preempt_on(void);
+void __irqsoff_trace_preempt_on(ulong ip);
+
+/*
+ * The hooks are active only in the real kernel. The tracer's own translation
+ * unit defines __IRQSOFF_TRACER_IMPL__ in order to use the plain primitives,
+ * without recursing into itself.
+ */
+#if KRN_IRQSOFF_TRACER                          &&             \
+    !defined(UNIT_TEST_ENVIRONMENT)             &&             \
+    !defined(__IRQSOFF_TRACER_IMPL__)
+
+   #define IRQSOFF_TRACE_IRQS_OFF()          irqsoff_trace_irqs_off()
+   #define IRQSOFF_TRACE_IRQS_ON()           irqsoff_trace_irqs_on()
+   #define IRQSOFF_TRACE_ENTRY()             irqsoff_trace_entry()
+   #define IRQSOFF_TRACE_EXIT(opened)        irqsoff_trace_exit(opened)
+   #define IRQSOFF_TRACE_PREEMPT_OFF()       irqsoff_trace_preempt_off()
+   #define IRQSOFF_TRACE_PREEMPT_ON()        irqsoff_trace_preempt_on()
+   #define IRQSOFF_TRACE_PREEMPT_ON_IP(ip)   __irqsoff_trace_preempt_on(ip)
+
+#else
+
+   #define IRQSOFF_TRACE_IRQS_OFF()          do { } while (0)
+   #define IRQSOFF_TRACE_IRQS_ON()           do { } while (0)
+   #define IRQSOFF_TRACE_ENTRY()             false
+   #define IRQSOFF_TRACE_EXIT(opened)        do { (void)(opened); } while (0)
+   #define IRQSOFF_TRACE_PREEMPT_OFF()       do { } while (0)
+   #define IRQSOFF_TRACE_PREEMPT_ON()        do { } while (0)
+   #define IRQSOFF_TRACE_PREEMPT_ON_IP(ip)   do { } while (0)
+
+#endif
@@ -82,6 +82,15 @@ per_heap_kmalloc(struct kmalloc_heap *h, size_t *size, u32 flags);
 void
 per_heap_kfree(struct kmalloc_heap *h, void *ptr, size_t *size, u32 flags);
 
+/*
+ * Allocate exactly the chunk [ptr, ptr + size) in the heap, if it's all free.
+ * The flags supported are KMALLOC_FL_NO_ACTUAL_ALLOC and the sub-block min
+ * size: with that, the chunk can be freed with KFREE_FL_MULTI_STEP and
+ * KFREE_FL_ALLOW_SPLIT also in parts or together with adjacent chunks.
+ */
+bool
+per_heap_kmalloc_at(struct kmalloc_heap *h, void *ptr, size_t size, u32 flags);
+
 struct kmalloc_acc {
 
    u32 elem_size;
@@ -129,6 +138,14 @@ aligned_kmalloc(size_t size, u32 align);
 void
 aligned_kfree2(void *ptr, size_t size);
 
+/*
+ * Allocate `size` bytes (a power of 2) physically contiguous and aligned at
+ * `size`, like a big page. The chunk is split in pages, which have to be
+ * freed one by one with kfree2(ptr, PAGE_SIZE). Slow: it scans the heaps.
+ */
+void *
+kmalloc_big_aligned_pages(size_t size);
+
 void *
 vmalloc(size_t size);
 
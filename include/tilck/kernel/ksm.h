@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/common/basic_defs.h>
+
+/*
+ * Same-page merging of the private user pages, enabled by the -ksm boot
+ * option. See kernel/mm/ksm.c.
+ */
+void init_ksm(void);
+
+/* Scanner stats and memory saved, in /syst/ksm/stats */
+void register_ksm_sysfs(void);
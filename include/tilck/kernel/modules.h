@@ -10,9 +10,29 @@ struct module {
    const char *name;
    int priority;
    void (*init)(void);
+
+   /*
+    * NULL-terminated list of the modules that must be initialized before this
+    * one (see MODULE_DEPS). Dependencies not built-in are ignored.
+    */
+   const char *const *deps;
+
+   u32 flags;                 /* MOD_FL_* */
 };
 
+/*
+ * The module is not needed to start userspace: initialize it in a kthread,
+ * after starting the init process, unless a non-deferred module depends on
+ * it or the -no_defer_mods kopt is set. Such modules must not register devfs
+ * drivers nor create device files: devfs doesn't expect changes while it's in
+ * use and userspace expects the device files to exist when init starts.
+ */
+#define MOD_FL_DEFERRED                        (1u << 0)
+
+#define MODULE_DEPS(...)      ((const char *const []) { __VA_ARGS__, NULL })
+
 void init_modules(void);
+void init_deferred_modules(void);
 void register_module(struct module *m);
 
 #define REGISTER_MODULE(m)                                            \
@@ -138,7 +138,7 @@ map_zero_pages(pdir_t *pdir,
 void init_paging(void);
 bool is_mapped(pdir_t *pdir, void *vaddr);
 bool is_rw_mapped(pdir_t *pdir, void *vaddrp);
-void unmap_page(pdir_t *pdir, void *vaddr, bool do_free);
+int unmap_page(pdir_t *pdir, void *vaddr, bool do_free);
 int unmap_page_permissive(pdir_t *pdir, void *vaddrp, bool do_free);
 void unmap_pages(pdir_t *pdir, void *vaddr, size_t count, bool do_free);
 size_t unmap_pages_permissive(pdir_t *pd, void *va, size_t count, bool do_free);
@@ -148,10 +148,69 @@ pdir_t *pdir_clone(pdir_t *pdir);
 pdir_t *pdir_deep_clone(pdir_t *pdir);
 void pdir_destroy(pdir_t *pdir);
 void invalidate_page(ulong vaddr);
-void set_page_rw(pdir_t *pdir, void *vaddr, bool rw);
+int set_page_rw(pdir_t *pdir, void *vaddr, bool rw);
 void retain_pageframes_mapped_at(pdir_t *pdir, void *vaddr, size_t len);
 void release_pageframes_mapped_at(pdir_t *pdir, void *vaddr, size_t len);
 
+/*
+ * Page merging support (see kernel/mm/ksm.c).
+ *
+ * get_private_user_page() returns true if `vaddr` is mapped in `pdir` as a
+ * private (non-shared) user page backed by a ref-counted pageframe, storing
+ * its physical address in `*paddr`.
+ *
+ * share_page_cow() turns that mapping into a read-only COW mapping of the
+ * pageframe at `paddr`, which gets one more reference, while the previous
+ * pageframe loses one and it's freed if that was the last. Returns true in
+ * that case. With `paddr` equal to the current pageframe, the mapping just
+ * becomes COW.
+ */
+bool get_private_user_page(pdir_t *pdir, void *vaddr, ulong *paddr);
+bool share_page_cow(pdir_t *pdir, void *vaddr, ulong paddr);
+
+/*
+ * Exchange the page table entries of two present user pages, moving their
+ * pageframes (and flags) without touching their ref-counts. Used by mremap().
+ * Fails with -ENOMEM only when a big page cannot be split.
+ */
+int swap_user_pages(pdir_t *pdir, void *va1, void *va2);
+
+/*
+ * Set the protection of the present user pages among the `count` ones at
+ * `vaddr`, with a single TLB flush for big ranges. `pg_flags` can contain only
+ * PAGING_FL_US (the pages are accessible) and PAGING_FL_RW.
+ *
+ * Private pages made writable become CoW when their pageframe is shared,
+ * while shared (file) pages become writable right away: they're never CoW.
+ * Fails with -ENOMEM, before changing anything, when a big page in the range
+ * cannot be split.
+ */
+int
+set_user_pages_prot(pdir_t *pdir, void *vaddr, size_t count, u32 pg_flags);
+
+/*
+ * False if any present page in [vaddr, vaddr + len) is not accessible from
+ * user space (PROT_NONE). The non-present pages are fine: a copy will fault.
+ */
+bool is_user_range_accessible(pdir_t *pdir, const void *vaddr, size_t len);
+
+/*
+ * Split all the big pages overlapping [vaddr, vaddr + len), so that changing
+ * or unmapping the single pages in that range cannot fail anymore. Fails with
+ * -ENOMEM when a page table cannot be allocated: the big pages already split
+ * stay so, but that doesn't change the mappings. No-op on archs without user
+ * big pages.
+ */
+int split_user_big_pages(pdir_t *pdir, void *vaddr, size_t len);
+
+/*
+ * Replace with big pages the page tables covering 4 MB-aligned chunks in
+ * [vaddr, vaddr + len) that map physically contiguous and aligned pageframes,
+ * all with the same flags. The big pages are split back on demand (partial
+ * unmap, COW, mprotect etc.). No-op on archs without user big pages.
+ */
+void collapse_user_big_pages(pdir_t *pdir, void *vaddr, size_t len);
+
 static ALWAYS_INLINE pdir_t *get_kernel_pdir(void)
 {
    extern pdir_t *__kernel_pdir;
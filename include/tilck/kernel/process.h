@@ -57,6 +57,8 @@ struct process {
 
    struct vfs_path cwd;                   /* CWD as a struct vfs_path */
    char *debug_cmdline;                   /* debug field used by debugpanel */
+   struct k_rlimit64 *rlimits;            /* NULL means all the defaults */
+   struct aio_ctx *aio_ctxs;              /* io_setup() contexts */
 
    struct locked_file *elf;
    fs_handle handles[KRN_MAX_HANDLES];       /* small fixed-size array */
@@ -155,6 +157,10 @@ void arch_specific_new_proc_setup(struct process *pi, struct process *parent);
 void arch_specific_free_proc(struct process *pi);
 void wake_up_tasks_waiting_on(struct task *ti, enum wakeup_reason r);
 void init_process_lists(struct process *pi);
+u64 get_process_rlimit(struct process *pi, int resource);
+bool dup_process_rlimits(struct process *pi, struct process *parent);
+void free_process_rlimits(struct process *pi);
+void destroy_process_aio_ctxs(struct process *pi);
 
 void process_set_cwd2_nolock(struct vfs_path *tp);
 void process_set_cwd2_nolock_raw(struct process *pi, struct vfs_path *tp);
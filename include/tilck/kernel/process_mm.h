@@ -36,12 +36,25 @@ struct user_mapping {
 
 };
 
+/* Memory usage of an address space, in pages */
+struct mm_usage {
+
+   long rss_pages;         /* present user pages, except the zero page      */
+   long shared_pages;      /* rss pages mapped as shared (files, fb)        */
+   long pt_pages;          /* page tables of the user address space         */
+};
+
 struct mappings_info {
 
    struct kmalloc_heap *mmap_heap;
    size_t mmap_heap_size;
    struct list mappings;
    struct user_mapping *brk_region;   /* the USER_MAPPING_HEAP entry (brk) */
+
+   pdir_t *pdir;                      /* the address space described here */
+   struct list_node node;             /* node in the list of all the mi */
+   struct mm_usage usage;
+   bool prot_none;                    /* some pages might be PROT_NONE */
 };
 
 struct user_mapping *
@@ -60,12 +73,43 @@ void full_remove_user_mapping(struct process *pi, struct user_mapping *um);
 void remove_all_mappings_of_handle(struct process *pi, fs_handle h);
 void remove_all_user_mappings(struct process *pi);
 struct user_mapping *process_get_user_mapping(void *vaddr);
+
+/*
+ * True if [vaddr, vaddr + size) is entirely inside a single writable
+ * anonymous mmap() of the current process and can be backed by a big page.
+ */
+bool is_anon_big_page_allowed(void *vaddr, size_t size);
 void remove_all_file_mappings(struct process *pi);
 struct mappings_info *
 duplicate_mappings_info(struct process *new_pi, struct mappings_info *mi);
-struct mappings_info *alloc_mappings_info(void);
+struct mappings_info *alloc_mappings_info(pdir_t *pdir);
 void free_mappings_info(struct mappings_info *mi);
 
+/*
+ * Accounting of the pages in the user address space of `pdir`, called by the
+ * arch paging code on map, unmap and COW. Mapping the zero page doesn't count.
+ */
+void mm_acct_user_pages(pdir_t *pdir, ulong paddr, bool shared, long n);
+void mm_acct_page_tables(pdir_t *pdir, long n);
+
+/* Virtual size of all the mappings and of the data (writable, private) ones */
+size_t mm_get_vm_size(struct mappings_info *mi);
+size_t mm_get_data_size(struct mappings_info *mi);
+
+/*
+ * PROT_NONE pages stay mapped, just without the user bit: the kernel could
+ * still read and write them. Therefore, in address spaces having any, the
+ * user copies check the page tables first.
+ */
+static inline bool
+mm_user_range_accessible(struct mappings_info *mi, const void *va, size_t n)
+{
+   if (LIKELY(!mi || !mi->prot_none))
+      return true;
+
+   return is_user_range_accessible(mi->pdir, va, n);
+}
+
 
 /* Internal functions */
 bool user_valloc_and_map(ulong user_vaddr, size_t page_count);
@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/common/basic_defs.h>
+
+/*
+ * Sampling CPU profiler, driven by the timer IRQ. See kernel/prof.c and the
+ * ABI in <tilck/common/prof_abi.h>.
+ */
+
+/* Called by the timer IRQ handler on every tick */
+void prof_tick(void);
+
+int tilck_sys_prof_ctl(ulong op, ulong period, ulong flags, ulong user_info);
+int tilck_sys_prof_get_samples(ulong user_buf, ulong first, ulong max, ulong _4);
+int tilck_sys_prof_get_sym(ulong addr, ulong user_buf, ulong buf_sz, ulong _4);
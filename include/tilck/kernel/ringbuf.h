@@ -41,6 +41,16 @@ bool ringbuf_unwrite_elem(struct ringbuf *rb, void *elem_ptr /* out */);
 size_t ringbuf_write_bytes(struct ringbuf *rb, u8 *buf, size_t len);
 size_t ringbuf_read_bytes(struct ringbuf *rb, u8 *buf, size_t len);
 
+/*
+ * Zero-copy access for byte ring buffers: get the contiguous chunk of bytes
+ * that can be read (or written) at the current position, use it in place and
+ * then consume (or commit) up to its length.
+ */
+size_t ringbuf_get_read_chunk(struct ringbuf *rb, u8 **ptr);
+size_t ringbuf_get_write_chunk(struct ringbuf *rb, u8 **ptr);
+void ringbuf_consume_bytes(struct ringbuf *rb, size_t len);
+void ringbuf_commit_bytes(struct ringbuf *rb, size_t len);
+
 
 inline bool ringbuf_write_elem1(struct ringbuf *rb, u8 val)
 {
@@ -61,6 +61,14 @@ void rwlock_wp_shunlock(struct rwlock_wp *rw);
 void rwlock_wp_exlock(struct rwlock_wp *rw);
 void rwlock_wp_exunlock(struct rwlock_wp *rw);
 
+/*
+ * Take the exclusive lock only if nobody holds or waits for it (or if the
+ * current task already holds it, in the recursive case). Returns true on
+ * success. It never waits for readers or writers, just on the internal
+ * mutex, which is held only briefly.
+ */
+bool rwlock_wp_try_exlock(struct rwlock_wp *rw);
+
 #if DEBUG_CHECKS
 
    static inline bool rwlock_wp_is_shlocked(struct rwlock_wp *rw)
@@ -94,6 +94,15 @@ safe_ringbuf_init(struct safe_ringbuf *rb, u16 max_elems, u16 e_size, void *b);
 void
 safe_ringbuf_destory(struct safe_ringbuf *rb);
 
+/*
+ * Number of elements in the buffer and pointer to the i-th one, starting from
+ * the oldest. Peeking is safe only when no write can be in progress (e.g.
+ * interrupts disabled and no write interrupted), otherwise the element might
+ * belong to a slot claimed by a writer but not filled yet.
+ */
+u16 safe_ringbuf_get_count(struct safe_ringbuf *rb);
+void *safe_ringbuf_peek_elem(struct safe_ringbuf *rb, u16 i);
+
 /* Generic read/write funcs */
 
 bool
@@ -11,6 +11,7 @@
 #include <tilck/kernel/timer.h>
 #include <tilck/kernel/worker_thread.h>
 #include <tilck/kernel/signal.h>
+#include <tilck/kernel/irqsoff.h>
 
 #include <tilck_gen_headers/config_sched.h>
 
@@ -88,6 +89,75 @@ struct sched_ticks {
    atomic_u64_t deadline;
 };
 
+enum sched_class {
+   SCHED_CLASS_NONRT    = 0,        /* default: EEVDF or worker thread */
+   SCHED_CLASS_RT       = 1,        /* CBS/EDF, see kernel/sched_rt.c */
+};
+
+/*
+ * Per-task CBS reservation (C, T) for SCHED_CLASS_RT tasks. All the
+ * times are in timer ticks: the ktimer AVL, used for replenishment,
+ * has tick granularity. sched_setattr() converts from/to the ns of
+ * the Linux ABI.
+ *
+ * Allocated on admission and freed on release (kernel/sched_rt.c),
+ * instead of being embedded in struct task: non-RT tasks don't need
+ * it and struct task_and_process has to fit in 1 KB on i386.
+ */
+struct sched_rt {
+
+   u32 runtime;            /* C: declared budget per period */
+   u32 period;             /* T: period, also the relative deadline */
+   u32 budget;             /* Q: budget left in the current period */
+   u32 util_x1k;           /* C/T * 1000, for admission accounting */
+   u64 deadline;           /* absolute tick of the current deadline */
+
+   /*
+    * Budget exhausted: the task is kept out of the RT ready set until
+    * the next replenishment, even when RUNNABLE.
+    */
+   bool throttled;
+
+   u32 throttle_count;     /* periods that ended with a throttle */
+   u32 deadline_misses;    /* periods that ended with the job pending */
+
+   /* Period timer (KTIMER_MODE_IRQ), armed while the task is admitted */
+   struct ktimer repl_timer;
+};
+
+#define SCHED_LAT_HIST_BUCKETS                     32
+#define SCHED_RQ_HIST_BUCKETS                       8
+
+/*
+ * Wakeup-to-run latency and context-switch counters, kept per task and
+ * globally (kernel/sched_stats.c). A wakeup is a SLEEPING/STOPPED ->
+ * RUNNABLE transition; its latency is the time, in RDTSC cycles, until
+ * the task is RUNNING again.
+ *
+ * Heap-allocated with the other per-task buffers instead of being
+ * embedded in struct task, for the same 1 KB reason as struct sched_rt.
+ */
+struct sched_lat_stats {
+
+   bool wakeup_pending;    /* woken up, not yet selected */
+   u64 wakeup_tsc;         /* RDTSC at the last wakeup */
+
+   u32 wakeups;            /* accounted wakeup-to-run latencies */
+   u32 nvcsw;              /* switches away while blocked (voluntary) */
+   u32 nivcsw;             /* switches away while RUNNABLE (preempted) */
+   u64 tot_cycles;
+   u64 max_cycles;
+
+   /* lat_hist[i]: latencies in [2^i, 2^(i+1)) cycles, last one unbounded */
+   u32 lat_hist[SCHED_LAT_HIST_BUCKETS];
+
+   /*
+    * rq_hist[0]: woken up with an empty runqueue; rq_hist[i], i > 0: with
+    * [2^(i-1), 2^i) runnable tasks ahead. The last bucket is unbounded.
+    */
+   u32 rq_hist[SCHED_RQ_HIST_BUCKETS];
+};
+
 STATIC_ASSERT(sizeof(enum sig_state) == 1);
 
 struct task {
@@ -158,6 +228,14 @@ struct task {
    s32 wstatus;                       /* waitpid's wstatus  */
    struct sched_ticks ticks;          /* scheduler counters */
 
+   /*
+    * Scheduling class. RT tasks reuse `runnable_tree_node` to sit in
+    * the RT ready set (kernel/sched_rt.c) instead of the EEVDF tree.
+    */
+   enum sched_class sclass;
+   struct sched_rt *rt;               /* NULL unless sclass == RT */
+   struct sched_lat_stats *lat;       /* NULL for kernel_process */
+
    void *kernel_stack;
    void *args_copybuf;
 
@@ -261,6 +339,20 @@ void fork_vruntime_handoff(struct task *ti);
 void sched_start_quantum(struct task *ti);
 bool save_regs_and_schedule(bool skip_disable_preempt);
 
+void sched_rt_init_task(struct task *ti);
+int sched_rt_admit(struct task *ti, u32 runtime, u32 period);
+void sched_rt_release(struct task *ti);
+
+u32 sched_lat_hist_bucket(u64 cycles);
+u32 sched_rq_hist_bucket(u32 depth);
+void sched_stats_on_state_change(struct task *ti,
+                                 enum task_state old_state,
+                                 enum task_state new_state,
+                                 u32 rq_depth);
+void sched_stats_on_switch(struct task *curr, struct task *next);
+bool sched_stats_get(int tid, struct sched_lat_stats *out);
+void sched_stats_reset(void);
+
 static ALWAYS_INLINE void sched_set_need_resched(void)
 {
    extern atomic_int_t __need_resched; /* see docs/atomics.md */
@@ -282,13 +374,17 @@ static ALWAYS_INLINE bool need_reschedule(void)
 static ALWAYS_INLINE void disable_preemption(void)
 {
    extern atomic_int_t __disable_preempt; /* see docs/atomics.md */
-   atomic_fetch_add(&__disable_preempt, 1);
+
+   if (!atomic_fetch_add(&__disable_preempt, 1))
+      IRQSOFF_TRACE_PREEMPT_OFF();
 }
 
 static ALWAYS_INLINE void enable_preemption_nosched(void)
 {
    extern atomic_int_t __disable_preempt; /* see docs/atomics.md */
-   atomic_fetch_sub(&__disable_preempt, 1);
+
+   if (atomic_fetch_sub(&__disable_preempt, 1) == 1)
+      IRQSOFF_TRACE_PREEMPT_ON();
 }
 
 void enable_preemption(void);
@@ -300,6 +396,7 @@ void enable_preemption(void);
 static ALWAYS_INLINE void force_enable_preemption(void)
 {
    extern atomic_int_t __disable_preempt; /* see docs/atomics.md */
+   IRQSOFF_TRACE_PREEMPT_ON();
    atomic_store(&__disable_preempt, 0);
 }
 
@@ -338,6 +435,11 @@ static ALWAYS_INLINE bool is_worker_thread(struct task *ti)
    return ti->worker_thread != NULL;
 }
 
+static ALWAYS_INLINE bool is_rt_task(struct task *ti)
+{
+   return ti->sclass == SCHED_CLASS_RT;
+}
+
 /*
  * Default yield function
  *
@@ -113,6 +113,25 @@ struct k_rusage {
    STATIC_ASSERT(sizeof(struct k_rusage) == 136);
 #endif
 
+/*
+ * Linux's struct rlimit, used by getrlimit() and setrlimit(), with pointer-size
+ * fields, and struct rlimit64, used by prlimit64().
+ */
+struct k_rlimit {
+
+   ulong rlim_cur;
+   ulong rlim_max;
+};
+
+struct k_rlimit64 {
+
+   u64 rlim_cur;
+   u64 rlim_max;
+};
+
+#define K_RLIM_INFINITY          ((ulong)-1)
+#define K_RLIM64_INFINITY          ((u64)-1)
+
 /*
  * Classic (old) timespec. Suffers from the Y2038 bug on ALL systems.
  */
@@ -131,6 +150,86 @@ struct k_timespec64 {
    long tv_nsec;
 };
 
+/*
+ * Linux's struct sched_attr (SCHED_ATTR_SIZE_VER0 layout), used by
+ * sched_setattr() and sched_getattr(). Times are in nanoseconds.
+ */
+struct k_sched_attr {
+
+   u32 size;
+   u32 sched_policy;
+   u64 sched_flags;
+   s32 sched_nice;
+   u32 sched_priority;
+   u64 sched_runtime;
+   u64 sched_deadline;
+   u64 sched_period;
+};
+
+STATIC_ASSERT(sizeof(struct k_sched_attr) == 48);
+
+/*
+ * Linux's AIO structs (see <linux/aio_abi.h>), used by io_setup(),
+ * io_submit(), io_getevents() and io_cancel(). Their layout is the same on
+ * 32-bit and 64-bit systems: pointers are always stored in 64-bit fields.
+ */
+#define K_IOCB_CMD_PREAD            0
+#define K_IOCB_CMD_PWRITE           1
+#define K_IOCB_CMD_FSYNC            2
+#define K_IOCB_CMD_FDSYNC           3
+#define K_IOCB_CMD_POLL             5
+#define K_IOCB_CMD_NOOP             6
+#define K_IOCB_CMD_PREADV           7
+#define K_IOCB_CMD_PWRITEV          8
+
+struct k_iocb {
+
+   u64 aio_data;
+   u32 aio_key;
+   u32 aio_rw_flags;
+   u16 aio_lio_opcode;
+   s16 aio_reqprio;
+   u32 aio_fildes;
+   u64 aio_buf;
+   u64 aio_nbytes;
+   s64 aio_offset;
+   u64 aio_reserved2;
+   u32 aio_flags;
+   u32 aio_resfd;
+};
+
+struct k_io_event {
+
+   u64 data;                     /* the iocb's aio_data */
+   u64 obj;                      /* user address of the iocb */
+   s64 res;
+   s64 res2;
+};
+
+/*
+ * Header of the ring of completion events mapped in the process by
+ * io_setup(): the events follow it. The kernel moves `tail`, while the
+ * process can consume the events by itself, advancing `head`.
+ */
+#define K_AIO_RING_MAGIC            0xa10a10a1
+#define K_AIO_RING_COMPAT_FEATURES  1
+
+struct k_aio_ring {
+
+   u32 id;
+   u32 nr;
+   u32 head;
+   u32 tail;
+   u32 magic;
+   u32 compat_features;
+   u32 incompat_features;
+   u32 header_length;
+};
+
+STATIC_ASSERT(sizeof(struct k_iocb) == 64);
+STATIC_ASSERT(sizeof(struct k_io_event) == 32);
+STATIC_ASSERT(sizeof(struct k_aio_ring) == 32);
+
 
 
 #if defined(__i386__)
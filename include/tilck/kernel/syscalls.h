@@ -135,7 +135,8 @@ CREATE_STUB_SYSCALL_IMPL(sys_setregid16)
 CREATE_STUB_SYSCALL_IMPL(sys_sigsuspend)
 CREATE_STUB_SYSCALL_IMPL(sys_sigpending)
 CREATE_STUB_SYSCALL_IMPL(sys_sethostname)
-CREATE_STUB_SYSCALL_IMPL(sys_setrlimit)
+int sys_setrlimit(int resource, const struct k_rlimit *user_rlim);
+
 CREATE_STUB_SYSCALL_IMPL(sys_old_getrlimit)
 
 int sys_getrusage(int who, struct k_rusage *user_buf);
@@ -206,7 +207,6 @@ int sys_newuname(struct utsname *buf);
 CREATE_STUB_SYSCALL_IMPL(sys_modify_ldt)
 CREATE_STUB_SYSCALL_IMPL(sys_adjtimex_time32)
 CREATE_STUB_SYSCALL_IMPL(sys_adjtimex)
-CREATE_STUB_SYSCALL_IMPL(sys_mprotect)
 
 int sys_sigprocmask(ulong a1, ulong a2, ulong a3); // deprecated interface
 
@@ -260,7 +260,6 @@ int sys_nanosleep_time32(const struct k_timespec32 *req,
 long sys_nanosleep(const struct k_timespec64 *u_req,
                    struct k_timespec64 *u_rem);
 
-CREATE_STUB_SYSCALL_IMPL(sys_mremap)
 CREATE_STUB_SYSCALL_IMPL(sys_setresuid16)
 CREATE_STUB_SYSCALL_IMPL(sys_getresuid16)
 CREATE_STUB_SYSCALL_IMPL(sys_vm86)
@@ -305,7 +304,7 @@ CREATE_STUB_SYSCALL_IMPL(sys_sendfile)
 
 int sys_vfork(void *u_regs);
 
-CREATE_STUB_SYSCALL_IMPL(sys_getrlimit)
+int sys_getrlimit(int resource, struct k_rlimit *user_rlim);
 
 long sys_mmap_pgoff(void *addr, size_t length, int prot,
                     int flags, int fd, size_t pgoffset);
@@ -313,6 +312,11 @@ long sys_mmap_pgoff(void *addr, size_t length, int prot,
 long sys_mmap(void *addr, size_t len, int prot,
               int flags, int fd, size_t offset);
 
+long sys_mremap(void *old_addr, size_t old_len,
+                size_t len, int flags, void *addr);
+
+int sys_mprotect(void *addr, size_t len, int prot);
+
 int sys_ia32_truncate64(const char *u_path, s64 length);
 int sys_ia32_ftruncate64(int fd, s64 length);
 int sys_stat64(const char *u_path, struct k_stat64 *u_statbuf);
@@ -344,8 +348,8 @@ int sys_setgid(ulong gid);
 CREATE_STUB_SYSCALL_IMPL(sys_setfsuid)
 CREATE_STUB_SYSCALL_IMPL(sys_setfsgid)
 CREATE_STUB_SYSCALL_IMPL(sys_pivot_root)
-CREATE_STUB_SYSCALL_IMPL(sys_mincore)
 
+int sys_mincore(void *addr, size_t len, u8 *vec);
 int sys_madvise(void *addr, size_t len, int advice);
 int sys_getdents64(int fd, struct linux_dirent64 *dirp, u32 buf_size);
 int sys_fcntl64(int fd, int cmd, int arg);
@@ -375,12 +379,23 @@ CREATE_STUB_SYSCALL_IMPL(sys_sched_getaffinity)
 int sys_set_thread_area(void *u_info);
 
 CREATE_STUB_SYSCALL_IMPL(sys_get_thread_area)
-CREATE_STUB_SYSCALL_IMPL(sys_io_setup)
-CREATE_STUB_SYSCALL_IMPL(sys_io_destroy)
-CREATE_STUB_SYSCALL_IMPL(sys_io_getevents_time32)
-CREATE_STUB_SYSCALL_IMPL(sys_io_getevents)
-CREATE_STUB_SYSCALL_IMPL(sys_io_submit)
-CREATE_STUB_SYSCALL_IMPL(sys_io_cancel)
+int sys_io_setup(u32 nr_events, ulong *u_ctxp);
+int sys_io_destroy(ulong ctx_id);
+
+long sys_io_getevents_time32(ulong ctx_id,
+                             long min_nr,
+                             long nr,
+                             struct k_io_event *u_events,
+                             const struct k_timespec32 *u_timeout);
+
+long sys_io_getevents(ulong ctx_id,
+                      long min_nr,
+                      long nr,
+                      struct k_io_event *u_events,
+                      const struct k_timespec64 *u_timeout);
+
+int sys_io_submit(ulong ctx_id, long nr, struct k_iocb **u_iocbpp);
+int sys_io_cancel(ulong ctx_id, struct k_iocb *u_iocb, struct k_io_event *res);
 CREATE_STUB_SYSCALL_IMPL(sys_ia32_fadvise64)
 
 NORETURN int sys_exit_group(int status);
@@ -513,7 +528,10 @@ CREATE_STUB_SYSCALL_IMPL(sys_recvmmsg_time32)
 
 CREATE_STUB_SYSCALL_IMPL(sys_fanotify_init)
 CREATE_STUB_SYSCALL_IMPL(sys_fanotify_mark)
-CREATE_STUB_SYSCALL_IMPL(sys_prlimit64)
+int sys_prlimit64(int pid,
+                  int resource,
+                  const struct k_rlimit64 *user_new_rlim,
+                  struct k_rlimit64 *user_old_rlim);
 CREATE_STUB_SYSCALL_IMPL(sys_name_to_handle_at)
 CREATE_STUB_SYSCALL_IMPL(sys_open_by_handle_at)
 CREATE_STUB_SYSCALL_IMPL(sys_clock_adjtime32)
@@ -526,8 +544,9 @@ CREATE_STUB_SYSCALL_IMPL(sys_process_vm_readv)
 CREATE_STUB_SYSCALL_IMPL(sys_process_vm_writev)
 CREATE_STUB_SYSCALL_IMPL(sys_kcmp)
 CREATE_STUB_SYSCALL_IMPL(sys_finit_module)
-CREATE_STUB_SYSCALL_IMPL(sys_sched_setattr)
-CREATE_STUB_SYSCALL_IMPL(sys_sched_getattr)
+
+int sys_sched_setattr(int pid, struct k_sched_attr *u_attr, u32 flags);
+int sys_sched_getattr(int pid, struct k_sched_attr *u_attr, u32 size, u32 fl);
 
 long sys_renameat2(int olddfd, const char *oldname,
                    int newdfd, const char *newname, u32 flags);
@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/kernel/irq_stats.h>
+
+STATIC void irq_stats_push(u64 now);
+STATIC void irq_stats_pop(int irq, u64 now);
@@ -0,0 +1,7 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/kernel/irqsoff.h>
+
+STATIC void
+irqsoff_account(enum irqsoff_kind k, const struct irqsoff_site *site);
@@ -21,6 +21,10 @@ STATIC bool sched_is_eligible(struct task *ti);
     */
    extern atomic_u64_t min_vruntime;
    extern atomic_u64_t sum_vruntime_in_tree;
+
+   /* sched_rt.c admission-control state */
+   extern atomic_int_t rt_admitted_count;
+   extern u32 rt_sum_util_x1k;
 #endif
 
 /*
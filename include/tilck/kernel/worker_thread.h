@@ -8,6 +8,15 @@
 
 struct worker_thread;
 
+/* Time spent running jobs (bottom halves), per worker thread */
+struct wth_exec_stats {
+   const char *name;          /* NULL for the generic workers */
+   int priority;
+   u32 run;                   /* jobs run */
+   u64 exec_tot;              /* cycles */
+   u64 exec_max;              /* cycles */
+};
+
 void
 init_worker_threads();
 
@@ -26,6 +35,14 @@ wth_get_name(struct worker_thread *wth);
 struct task *
 wth_get_runnable_thread(void);
 
+/* Returns the number of workers whose stats have been copied in `buf` */
+int
+wth_get_exec_stats(struct wth_exec_stats *buf, int max);
+
+/* Reset the run, latency and exec stats of all the workers */
+void
+wth_reset_run_stats(void);
+
 struct worker_thread *
 wth_create_thread(const char *name, int priority, u16 queue_size);
 
@@ -35,6 +52,23 @@ wth_find_worker(int lowest_prio);
 NODISCARD bool
 wth_enqueue_on(struct worker_thread *wth, void (*func)(void *), void *arg);
 
+/*
+ * Like wth_enqueue_on(), but if an identical job (same func and arg) is
+ * already pending (not started yet), don't add another one: it will do the
+ * work for both. Useful for bottom halves processing everything available,
+ * like RX queues.
+ */
+NODISCARD bool
+wth_enqueue_once_on(struct worker_thread *wth, void (*func)(void *), void *arg);
+
+/*
+ * Enqueue a job on `wth` from a job running in `wth` itself. That's allowed
+ * only for jobs splitting their work, which don't retry on failure: waiting
+ * for space in the queue of the current worker would never end.
+ */
+NODISCARD bool
+wth_requeue_self(struct worker_thread *wth, void (*func)(void *), void *arg);
+
 NODISCARD bool
 wth_enqueue_anywhere(int lowest_prio, void (*func)(void *), void *arg);
 
@@ -48,3 +82,7 @@ wth_wait_for_completion(struct worker_thread *wth);
  */
 void
 wth_wakeup_top(void);
+
+/* Per-worker queue depth, latency and drop counters in /syst/wth */
+void
+register_wth_sysfs(void);
@@ -27,11 +27,20 @@ get_acpi_init_status(void)
 void acpi_mod_init_tables(void);
 void acpi_set_root_pointer(ulong);
 
+/*
+ * With -acpi_lazy, only the static tables are initialized at boot and the
+ * namespace is loaded and evaluated on first use: this function does that,
+ * if still needed. `trigger` is just for the reports. It's a no-op when
+ * preemption is disabled or in panic.
+ */
+void acpi_ensure_ns_loaded(const char *trigger);
+
 #else
 
 #define get_acpi_init_status()            ais_not_started
 #define acpi_mod_init_tables()
 #define acpi_set_root_pointer(...)
+#define acpi_ensure_ns_loaded(...)
 
 #endif
 
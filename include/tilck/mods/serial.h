@@ -10,6 +10,9 @@ bool serial_read_ready(u16 port);
 void serial_wait_for_read(u16 port);
 char serial_read(u16 port);
 
+/* Enable or disable the "data received" interrupt of the UART */
+void serial_set_rx_intr(u16 port, bool enabled);
+
 bool serial_write_ready(u16 port);
 void serial_wait_for_write(u16 port);
 void serial_write(u16 port, char c);
@@ -169,6 +169,30 @@ read_trace_event(struct trace_event *e, u32 timeout_ticks);
 bool
 read_trace_event_noblock(struct trace_event *e);
 
+/*
+ * Bulk consumers of the trace ring (see <tilck/common/tracing/ring.h>).
+ * tracing_drain_events() copies up to `max` events to the user buffer and
+ * consumes them; tracing_consume_events() releases `n` events already read
+ * in place through the read-only mapping of /syst/tracing/ring. Both
+ * return a negative errno on failure. tracing_wait_for_events() waits up
+ * to `timeout_ticks` for the ring to become non-empty, returning false on
+ * timeout.
+ */
+int
+tracing_drain_events(void *user_buf, u32 max);
+
+int
+tracing_consume_events(u32 n);
+
+bool
+tracing_wait_for_events(u32 timeout_ticks);
+
+u32
+tracing_get_lost_events_count(void);
+
+u32
+tracing_get_ring_capacity(void);
+
 /*
  * Push a fully-formed event into the ring buffer. Used only by the
  * test-mode TILCK_CMD_DP_TRACE_INJECT_EVENT handler — bypasses the
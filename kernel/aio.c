@@ -0,0 +1,1028 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Asynchronous I/O: Linux's io_setup(), io_submit(), io_getevents(),
+ * io_cancel() and io_destroy().
+ *
+ * io_setup() maps in the process a ring of completion events, with the same
+ * layout as on Linux (struct k_aio_ring), and returns its user address as the
+ * context id. io_submit() queues a whole batch of iocbs with a single syscall:
+ * each request keeps a private dup of its file handle and runs as a job on a
+ * dedicated worker thread, which posts the result directly in the ring. The
+ * process can reap the completions with io_getevents() or just by reading the
+ * ring itself and advancing `head`, without entering the kernel at all.
+ *
+ * The worker thread accesses the memory of the process by switching for a
+ * moment to its page directory, with the preemption disabled, one chunk at a
+ * time through a bounce buffer. In order to keep that page directory alive,
+ * io_destroy(), execve() and exit wait for all the requests of the process.
+ *
+ * The requests on handles that might block (the ones with a readiness kcond,
+ * like pipes) never sleep in the worker: they run in non-blocking mode and,
+ * when they cannot make any progress, they get parked. Each request watches
+ * the readiness kcond of its handle with a `mwobj_elem` of the shared
+ * `aio_waiter`, exactly like poll() does: when the kcond is signalled, the
+ * `aio_poll` kthread wakes up and hands the request back to the worker, which
+ * runs it again. Reads complete as soon as some data has been read, while
+ * writes complete only when all the data has been written (or in case of
+ * error).
+ */
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/utils.h>
+
+#include <tilck/kernel/process.h>
+#include <tilck/kernel/process_mm.h>
+#include <tilck/kernel/syscalls.h>
+#include <tilck/kernel/user.h>
+#include <tilck/kernel/errno.h>
+#include <tilck/kernel/sched.h>
+#include <tilck/kernel/sync.h>
+#include <tilck/kernel/timer.h>
+#include <tilck/kernel/paging_hw.h>
+#include <tilck/kernel/worker_thread.h>
+#include <tilck/kernel/fs/vfs.h>
+
+#include <sys/mman.h>      // system header
+
+#define AIO_MAX_EVENTS                4096     /* per context */
+#define AIO_WTH_QUEUE_SIZE              32
+#define AIO_REAP_BATCH                   8
+#define AIO_MAX_IOVCNT     (ARGS_COPYBUF_SIZE / sizeof(struct iovec))
+
+struct aio_ctx {
+
+   struct aio_ctx *next;            /* next context of the same process */
+   struct process *pi;
+   ulong ring_va;                   /* user address of the ring: the ctx id */
+   size_t ring_size;
+   u32 nr;                          /* number of slots in the ring */
+   u32 tail;                        /* only the kernel moves the tail */
+   u32 inflight;                    /* submitted and not completed yet */
+   bool dead;                       /* being destroyed */
+   struct kcond cond;               /* signalled on every completion */
+};
+
+struct aio_req {
+
+   struct list_node node;           /* node in aio_parked/ready_list */
+   struct aio_ctx *ctx;
+   fs_handle h;                     /* private dup of the iocb's fd */
+   u64 data;                        /* iocb's aio_data */
+   u64 obj;                         /* user address of the iocb */
+   u16 opcode;
+   bool can_park;                   /* blocking fd made non-blocking */
+   bool parked;                     /* in aio_parked_list */
+   bool signaled;                   /* `ready_cond` fired while running */
+   struct kcond *ready_cond;        /* readiness kcond of the handle */
+   struct mwobj_elem wait_elem;     /* our elem of `aio_waiter` */
+   offt off;
+   size_t done;                     /* bytes transferred so far */
+   struct iovec *iov;
+   int iovcnt;
+   struct iovec iov_inline;         /* the buffer of non-vectored ops */
+};
+
+static struct worker_thread *aio_wth;
+static struct task *aio_poll_task;
+static struct list aio_parked_list = STATIC_LIST_INIT(aio_parked_list);
+static struct list aio_ready_list = STATIC_LIST_INIT(aio_ready_list);
+static char *aio_bounce_buf;        /* used only by aio_wth */
+
+/*
+ * The waiter of all the parked requests: it has no elems of its own, as each
+ * request embeds its one, but the kconds signalled end in its signaled_list.
+ */
+static struct multi_obj_waiter aio_waiter = {
+   .count = 0,
+   .signaled_list = STATIC_LIST_INIT(aio_waiter.signaled_list),
+};
+
+static void aio_run_req(void *arg);
+
+static struct k_io_event *aio_ring_event(struct aio_ctx *ctx, u32 idx)
+{
+   return (struct k_io_event *)(ctx->ring_va + sizeof(struct k_aio_ring)) + idx;
+}
+
+/*
+ * Copy from/to the user memory of the context's process, from any task.
+ * When called by the worker thread, that requires switching to the page
+ * directory of the process: the scheduler won't restore the right one for
+ * us, so the whole thing runs with the preemption disabled.
+ */
+static int
+aio_user_copy(struct aio_ctx *ctx, void *dst, const void *src, size_t n,
+              bool to_user)
+{
+   pdir_t *old_pdir;
+   int rc;
+
+   /* copy_*_user() check the PROT_NONE pages of the worker, not ours */
+   if (!mm_user_range_accessible(ctx->pi->mi, to_user ? dst : src, n))
+      return -EFAULT;
+
+   disable_preemption();
+   {
+      old_pdir = get_curr_pdir();
+
+      if (old_pdir != ctx->pi->pdir)
+         set_curr_pdir(ctx->pi->pdir);
+
+      if (to_user)
+         rc = copy_to_user(dst, src, n);
+      else
+         rc = copy_from_user(dst, src, n);
+
+      if (old_pdir != ctx->pi->pdir)
+         set_curr_pdir(old_pdir);
+   }
+   enable_preemption();
+   return rc;
+}
+
+static void aio_post_event(struct aio_ctx *ctx, struct k_io_event *ev)
+{
+   struct k_aio_ring *ring = TO_PTR(ctx->ring_va);
+   struct k_io_event *slot = aio_ring_event(ctx, ctx->tail);
+   const u32 next = (ctx->tail + 1) % ctx->nr;
+
+   ASSERT(!is_preemption_enabled());
+
+   /*
+    * io_submit() never lets more requests in flight than the free slots in
+    * the ring, so it cannot be full here. If the user un-mapped the ring,
+    * the event is just lost.
+    */
+   if (aio_user_copy(ctx, slot, ev, sizeof(*ev), true))
+      return;
+
+   if (aio_user_copy(ctx, &ring->tail, &next, sizeof(next), true))
+      return;
+
+   ctx->tail = next;
+}
+
+static void aio_free_req(struct aio_req *req)
+{
+   disable_preemption();
+   {
+      mobj_waiter_reset(&req->wait_elem);
+   }
+   enable_preemption();
+
+   if (req->h)
+      vfs_close(req->h);
+
+   if (req->iov != &req->iov_inline)
+      kfree_array_obj(req->iov, struct iovec, req->iovcnt);
+
+   kfree_obj(req, struct aio_req);
+}
+
+static void aio_complete(struct aio_req *req, long res)
+{
+   struct aio_ctx *ctx = req->ctx;
+   struct k_io_event ev = {
+      .data = req->data,
+      .obj = req->obj,
+      .res = res,
+      .res2 = 0,
+   };
+
+   disable_preemption();
+   {
+      if (!ctx->dead)
+         aio_post_event(ctx, &ev);
+
+      /* After this, a dead `ctx` might be freed at any moment */
+      ctx->inflight--;
+      kcond_signal_all(&ctx->cond);
+   }
+   enable_preemption();
+   aio_free_req(req);
+}
+
+/*
+ * Read or write the iovecs of `req`, starting after the first `req->done`
+ * bytes. Returns the final result of the request or -EAGAIN if the request
+ * has to be parked and retried later.
+ */
+static long aio_rw(struct aio_req *req, bool wr)
+{
+   size_t skip = req->done;
+   long rc = 0;
+   int i;
+
+   for (i = 0; i < req->iovcnt; i++) {
+
+      char *ubuf = req->iov[i].iov_base;
+      size_t len = req->iov[i].iov_len;
+
+      if (skip >= len) {
+         skip -= len;
+         continue;
+      }
+
+      ubuf += skip;
+      len -= skip;
+      skip = 0;
+
+      while (len > 0) {
+
+         const size_t n = MIN(len, (size_t)IO_COPYBUF_SIZE);
+         const offt off = req->off + (offt)req->done;
+
+         if (wr) {
+
+            rc = aio_user_copy(req->ctx, aio_bounce_buf, ubuf, n, false);
+
+            if (rc)
+               goto out;
+
+            rc = vfs_pwrite(req->h, aio_bounce_buf, n, off);
+
+         } else {
+
+            rc = vfs_pread(req->h, aio_bounce_buf, n, off);
+
+            if (rc > 0) {
+
+               const int rc2 = aio_user_copy(req->ctx,
+                                             ubuf,
+                                             aio_bounce_buf,
+                                             (size_t)rc,
+                                             true);
+               if (rc2)
+                  rc = rc2;
+            }
+         }
+
+         if (rc <= 0)
+            goto out;
+
+         req->done += (size_t)rc;
+         ubuf += rc;
+         len -= (size_t)rc;
+
+         if ((size_t)rc < n) {
+
+            /* Short transfer: park a write until there's room again */
+            rc = wr && req->can_park ? -EAGAIN : 0;
+            goto out;
+         }
+      }
+   }
+
+out:
+   if (rc == -EAGAIN && req->can_park && (wr || !req->done))
+      return -EAGAIN;
+
+   if (rc < 0 && !req->done)
+      return rc;
+
+   return (long)req->done;
+}
+
+static long aio_do_req(struct aio_req *req)
+{
+   switch (req->opcode) {
+
+      case K_IOCB_CMD_PREAD:
+      case K_IOCB_CMD_PREADV:
+         return aio_rw(req, false);
+
+      case K_IOCB_CMD_PWRITE:
+      case K_IOCB_CMD_PWRITEV:
+         return aio_rw(req, true);
+
+      case K_IOCB_CMD_FSYNC:
+         return vfs_fsync(req->h);
+
+      case K_IOCB_CMD_FDSYNC:
+         return vfs_fdatasync(req->h);
+
+      default:
+         return 0; /* K_IOCB_CMD_NOOP */
+   }
+}
+
+/*
+ * Start watching the readiness kcond of `req`, before trying to run it: that
+ * way, the signals arriving while it's running are not lost.
+ */
+static void aio_watch_req(struct aio_req *req)
+{
+   struct mwobj_elem *e = &req->wait_elem;
+   struct kcond *c = req->ready_cond;
+
+   disable_preemption();
+   {
+      mobj_waiter_reset(e);
+      req->signaled = false;
+
+      /* Like mobj_waiter_set(), but for the aio_poll kthread */
+      e->waiter = &aio_waiter;
+      e->saved_ptr = c;
+      e->saved_wait_list = &c->wait_list;
+      e->ti = aio_poll_task;
+      e->type = WOBJ_KCOND;
+      wait_obj_set(&e->wobj, WOBJ_MWO_ELEM, c, NO_EXTRA, &c->wait_list);
+   }
+   enable_preemption();
+}
+
+/* Returns false if the handle became ready in the meanwhile: just retry */
+static bool aio_park_req(struct aio_req *req)
+{
+   bool parked = false;
+
+   disable_preemption();
+   {
+      if (!req->signaled) {
+         list_add_tail(&aio_parked_list, &req->node);
+         req->parked = parked = true;
+      }
+   }
+   enable_preemption();
+   return parked;
+}
+
+static void aio_run_req(void *arg)
+{
+   struct aio_req *req = arg;
+   long res;
+
+   if (req->ctx->dead) {
+      aio_complete(req, -ECANCELED);
+      return;
+   }
+
+   while (true) {
+
+      if (req->can_park)
+         aio_watch_req(req);
+
+      res = aio_do_req(req);
+
+      if (res != -EAGAIN || !req->can_park)
+         break;
+
+      if (aio_park_req(req))
+         return;
+   }
+
+   aio_complete(req, res);
+}
+
+static void aio_run_ready(void *unused)
+{
+   struct aio_req *req, *tmp;
+   struct list to_run;
+
+   list_init(&to_run);
+
+   disable_preemption();
+   {
+      list_for_each(req, tmp, &aio_ready_list, node) {
+         list_remove(&req->node);
+         list_add_tail(&to_run, &req->node);
+      }
+   }
+   enable_preemption();
+
+   list_for_each(req, tmp, &to_run, node) {
+      list_remove(&req->node);
+      aio_run_req(req);
+   }
+}
+
+/*
+ * Move the parked requests whose kcond has been signalled to the ready list.
+ * The ones still running are just flagged: aio_park_req() will retry them.
+ */
+static void aio_collect_signaled(void)
+{
+   struct mwobj_elem *e, *tmp;
+   struct aio_req *req;
+
+   ASSERT(!is_preemption_enabled());
+
+   list_for_each(e, tmp, &aio_waiter.signaled_list, signaled_node) {
+
+      req = CONTAINER_OF(e, struct aio_req, wait_elem);
+      list_remove(&e->signaled_node);
+      list_node_init(&e->signaled_node);
+
+      if (!req->parked) {
+         req->signaled = true;
+         continue;
+      }
+
+      req->parked = false;
+      list_remove(&req->node);
+      list_add_tail(&aio_ready_list, &req->node);
+   }
+}
+
+static void aio_poll(void *unused)
+{
+   struct task *curr = get_curr_task();
+   bool retry;
+
+   while (true) {
+
+      disable_preemption();
+      aio_collect_signaled();
+
+      retry = !list_is_empty(&aio_ready_list) &&
+              !wth_enqueue_once_on(aio_wth, &aio_run_ready, NULL);
+
+      /* The worker's queue is full: try again on the next tick */
+      if (retry)
+         task_set_wakeup_timer(curr, 1);
+
+      prepare_to_wait_on(WOBJ_MWO_WAITER, &aio_waiter, NO_EXTRA, NULL);
+      enter_sleep_wait_state();
+      /* enter_sleep_wait_state() leaves preemption enabled */
+
+      wait_obj_reset(&curr->wobj);
+
+      if (retry)
+         task_cancel_wakeup_timer(curr);
+   }
+}
+
+/* The bounce buffer is set last: once it's there, everything is ready */
+static int aio_init_once(void)
+{
+   char *buf;
+   int tid;
+
+   if (aio_bounce_buf)
+      return 0;
+
+   if (!(buf = kmalloc(IO_COPYBUF_SIZE)))
+      return -ENOMEM;
+
+   disable_preemption();
+   {
+      if (!aio_wth) {
+         aio_wth = wth_create_thread("aio",
+                                     WTH_PRIO_LOWEST,
+                                     AIO_WTH_QUEUE_SIZE);
+      }
+
+      if (aio_wth && !aio_poll_task) {
+         if ((tid = kthread_create(&aio_poll, 0, NULL)) > 0)
+            aio_poll_task = get_task(tid);
+      }
+
+      if (aio_poll_task && !aio_bounce_buf) {
+         aio_bounce_buf = buf;
+         buf = NULL;
+      }
+   }
+   enable_preemption();
+
+   if (buf)
+      kfree2(buf, IO_COPYBUF_SIZE);
+
+   return aio_bounce_buf ? 0 : -EAGAIN;
+}
+
+static struct aio_ctx *aio_lookup_ctx(ulong ctx_id)
+{
+   struct aio_ctx *ctx = get_curr_proc()->aio_ctxs;
+
+   while (ctx && ctx->ring_va != ctx_id)
+      ctx = ctx->next;
+
+   return ctx;
+}
+
+static void aio_unlink_ctx(struct process *pi, struct aio_ctx *ctx)
+{
+   struct aio_ctx **pp = &pi->aio_ctxs;
+
+   while (*pp != ctx)
+      pp = &(*pp)->next;
+
+   *pp = ctx->next;
+}
+
+/*
+ * Cancel the parked requests of `ctx` and wait for the ones queued or running
+ * in the worker thread. Then, nothing will touch the user memory anymore.
+ */
+static void aio_destroy_ctx(struct aio_ctx *ctx)
+{
+   struct aio_req *req, *tmp;
+   struct list cancelled;
+
+   list_init(&cancelled);
+
+   disable_preemption();
+   {
+      ctx->dead = true;
+
+      list_for_each(req, tmp, &aio_parked_list, node) {
+         if (req->ctx == ctx) {
+            req->parked = false;
+            list_remove(&req->node);
+            list_add_tail(&cancelled, &req->node);
+         }
+      }
+   }
+   enable_preemption();
+
+   list_for_each(req, tmp, &cancelled, node) {
+      list_remove(&req->node);
+      aio_complete(req, -ECANCELED);
+   }
+
+   /* The timeout covers a completion landing between the check and the wait */
+   while (ctx->inflight)
+      kcond_wait(&ctx->cond, NULL, KRN_TIMER_HZ / 10);
+
+   kcond_destroy(&ctx->cond);
+   kfree_obj(ctx, struct aio_ctx);
+}
+
+void destroy_process_aio_ctxs(struct process *pi)
+{
+   struct aio_ctx *ctx;
+
+   ASSERT(is_preemption_enabled());
+
+   /* The ring mappings go away together with the whole address space */
+   while ((ctx = pi->aio_ctxs)) {
+      pi->aio_ctxs = ctx->next;
+      aio_destroy_ctx(ctx);
+   }
+}
+
+int sys_io_setup(u32 nr_events, ulong *u_ctxp)
+{
+   struct process *pi = get_curr_proc();
+   struct k_aio_ring hdr;
+   struct aio_ctx *ctx;
+   size_t ring_size;
+   ulong ctx_id;
+   long va;
+   int rc;
+
+   if (copy_from_user(&ctx_id, u_ctxp, sizeof(ctx_id)))
+      return -EFAULT;
+
+   if (ctx_id || !nr_events)
+      return -EINVAL;
+
+   if (nr_events > AIO_MAX_EVENTS)
+      return -EAGAIN;
+
+   if ((rc = aio_init_once()))
+      return rc;
+
+   /* One slot always stays empty: use all the room left in the last page */
+   ring_size = pow2_round_up_at(
+      sizeof(struct k_aio_ring) + (nr_events + 1) * sizeof(struct k_io_event),
+      PAGE_SIZE
+   );
+
+   if (!(ctx = kzalloc_obj(struct aio_ctx)))
+      return -ENOMEM;
+
+   va = sys_mmap_pgoff(NULL,
+                       ring_size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE,
+                       -1,
+                       0);
+
+   if (va < 0) {
+      kfree_obj(ctx, struct aio_ctx);
+      return (int)va;
+   }
+
+   ctx->pi = pi;
+   ctx->ring_va = (ulong)va;
+   ctx->ring_size = ring_size;
+   ctx->nr = (u32)
+      ((ring_size - sizeof(struct k_aio_ring)) / sizeof(struct k_io_event));
+   kcond_init(&ctx->cond);
+
+   hdr = (struct k_aio_ring) {
+      .id = 0,
+      .nr = ctx->nr,
+      .head = 0,
+      .tail = 0,
+      .magic = K_AIO_RING_MAGIC,
+      .compat_features = K_AIO_RING_COMPAT_FEATURES,
+      .incompat_features = 0,
+      .header_length = sizeof(struct k_aio_ring),
+   };
+
+   if (copy_to_user(TO_PTR(va), &hdr, sizeof(hdr)) ||
+       copy_to_user(u_ctxp, &ctx->ring_va, sizeof(ctx->ring_va)))
+   {
+      sys_munmap(TO_PTR(va), ring_size);
+      kcond_destroy(&ctx->cond);
+      kfree_obj(ctx, struct aio_ctx);
+      return -EFAULT;
+   }
+
+   ctx->next = pi->aio_ctxs;
+   pi->aio_ctxs = ctx;
+   return 0;
+}
+
+int sys_io_destroy(ulong ctx_id)
+{
+   struct process *pi = get_curr_proc();
+   struct aio_ctx *ctx;
+   ulong ring_va;
+   size_t ring_size;
+
+   if (!(ctx = aio_lookup_ctx(ctx_id)))
+      return -EINVAL;
+
+   ring_va = ctx->ring_va;
+   ring_size = ctx->ring_size;
+
+   aio_unlink_ctx(pi, ctx);
+   aio_destroy_ctx(ctx);
+   sys_munmap(TO_PTR(ring_va), ring_size);
+   return 0;
+}
+
+static int aio_ring_used(struct aio_ctx *ctx, u32 *used)
+{
+   struct k_aio_ring *ring = TO_PTR(ctx->ring_va);
+   u32 head;
+
+   if (copy_from_user(&head, &ring->head, sizeof(head)))
+      return -EFAULT;
+
+   *used = (ctx->tail + ctx->nr - head % ctx->nr) % ctx->nr;
+   return 0;
+}
+
+static int
+aio_prepare_req(struct aio_req *req, struct k_iocb *cb, bool vec)
+{
+   if (vec) {
+
+      const size_t cnt = (size_t)cb->aio_nbytes;
+
+      if (!cnt || cnt > AIO_MAX_IOVCNT)
+         return -EINVAL;
+
+      if (!(req->iov = kalloc_array_obj(struct iovec, cnt)))
+         return -ENOMEM;
+
+      req->iovcnt = (int)cnt;
+
+      if (copy_from_user(req->iov,
+                         TO_PTR(cb->aio_buf),
+                         sizeof(struct iovec) * cnt))
+      {
+         return -EFAULT;
+      }
+
+      if (iov_len_overflow(req->iov, req->iovcnt))
+         return -EINVAL;
+
+   } else {
+
+      if (cb->aio_nbytes > (u64)INT32_MAX)
+         return -EINVAL;
+
+      req->iov_inline.iov_base = TO_PTR(cb->aio_buf);
+      req->iov_inline.iov_len = (size_t)cb->aio_nbytes;
+      req->iov = &req->iov_inline;
+      req->iovcnt = 1;
+   }
+
+   return 0;
+}
+
+static int aio_submit_one(struct aio_ctx *ctx, struct k_iocb *u_cb)
+{
+   struct fs_handle_base *hb;
+   struct aio_req *req;
+   struct k_iocb cb;
+   bool rw = true, wr = false, vec = false;
+   u32 used;
+   int rc;
+
+   if (copy_from_user(&cb, u_cb, sizeof(cb)))
+      return -EFAULT;
+
+   if (cb.aio_reserved2 || cb.aio_rw_flags || cb.aio_flags)
+      return -EINVAL; /* eventfd notification and RWF_* not supported */
+
+   switch (cb.aio_lio_opcode) {
+
+      case K_IOCB_CMD_PREAD:
+         break;
+
+      case K_IOCB_CMD_PWRITE:
+         wr = true;
+         break;
+
+      case K_IOCB_CMD_PREADV:
+         vec = true;
+         break;
+
+      case K_IOCB_CMD_PWRITEV:
+         wr = vec = true;
+         break;
+
+      case K_IOCB_CMD_FSYNC:
+      case K_IOCB_CMD_FDSYNC:
+      case K_IOCB_CMD_NOOP:
+         rw = false;
+         break;
+
+      default:
+         return -EINVAL;
+   }
+
+   if (rw && (cb.aio_offset < 0 || cb.aio_offset > OFFT_MAX))
+      return -EINVAL;
+
+   if (!(hb = get_fs_handle((int)cb.aio_fildes)))
+      return -EBADF;
+
+   if (hb->spec_flags & VFS_SPFL_NO_USER_COPY)
+      return -EINVAL; /* such handles need to run in the process itself */
+
+   if (rw && wr && !(hb->fl_flags & (O_WRONLY | O_RDWR)))
+      return -EBADF;
+
+   if (rw && !wr && (hb->fl_flags & O_WRONLY))
+      return -EBADF;
+
+   if ((rc = aio_ring_used(ctx, &used)))
+      return rc;
+
+   if (!(req = kzalloc_obj(struct aio_req)))
+      return -ENOMEM;
+
+   req->ctx = ctx;
+   req->data = cb.aio_data;
+   req->obj = (ulong)u_cb;
+   req->opcode = cb.aio_lio_opcode;
+   req->off = (offt)cb.aio_offset;
+   list_node_init(&req->node);
+   list_node_init(&req->wait_elem.signaled_node);
+
+   if (rw && (rc = aio_prepare_req(req, &cb, vec)))
+      goto err;
+
+   if ((rc = vfs_dup(hb, &req->h)))
+      goto err;
+
+   if (rw && !(hb->fl_flags & O_NONBLOCK)) {
+
+      struct kcond *c = wr ? vfs_get_wready_cond(hb) : vfs_get_rready_cond(hb);
+
+      if (c) {
+         /* Could block: the worker must never sleep, retry it instead */
+         ((struct fs_handle_base *)req->h)->fl_flags |= O_NONBLOCK;
+         req->ready_cond = c;
+         req->can_park = true;
+      }
+   }
+
+   rc = -EAGAIN;
+   disable_preemption();
+   {
+      if (ctx->inflight + used < ctx->nr - 1) {
+
+         ctx->inflight++;
+
+         if (wth_enqueue_on(aio_wth, &aio_run_req, req))
+            rc = 0;
+         else
+            ctx->inflight--;
+      }
+   }
+   enable_preemption();
+
+   if (!rc)
+      return 0;
+
+err:
+   aio_free_req(req);
+   return rc;
+}
+
+int sys_io_submit(ulong ctx_id, long nr, struct k_iocb **u_iocbpp)
+{
+   struct aio_ctx *ctx;
+   struct k_iocb *u_cb;
+   int rc = 0;
+   long i;
+
+   if (nr < 0)
+      return -EINVAL;
+
+   if (!(ctx = aio_lookup_ctx(ctx_id)))
+      return -EINVAL;
+
+   for (i = 0; i < nr; i++) {
+
+      if (copy_from_user(&u_cb, &u_iocbpp[i], sizeof(u_cb))) {
+         rc = -EFAULT;
+         break;
+      }
+
+      if ((rc = aio_submit_one(ctx, u_cb)))
+         break;
+   }
+
+   return i ? (int)i : rc;
+}
+
+int sys_io_cancel(ulong ctx_id, struct k_iocb *u_iocb, struct k_io_event *res)
+{
+   struct aio_req *req, *tmp, *found = NULL;
+   struct aio_ctx *ctx;
+
+   if (!(ctx = aio_lookup_ctx(ctx_id)))
+      return -EINVAL;
+
+   disable_preemption();
+   {
+      list_for_each(req, tmp, &aio_parked_list, node) {
+         if (req->ctx == ctx && req->obj == (ulong)u_iocb) {
+            req->parked = false;
+            list_remove(&req->node);
+            found = req;
+            break;
+         }
+      }
+   }
+   enable_preemption();
+
+   /* Only the parked requests can be cancelled */
+   if (!found)
+      return -EINVAL;
+
+   /* Like on Linux, the result is posted in the ring */
+   aio_complete(found, -ECANCELED);
+   return -EINPROGRESS;
+}
+
+/*
+ * Copy up to `max` events from the ring to `u_events`, consuming them.
+ * Returns the number of events copied or an error. In `tail_ref` it saves
+ * the value of the tail it saw.
+ */
+static long
+aio_reap(struct aio_ctx *ctx, struct k_io_event *u_events, long max,
+         u32 *tail_ref)
+{
+   struct k_aio_ring *ring = TO_PTR(ctx->ring_va);
+   struct k_io_event evs[AIO_REAP_BATCH];
+   const u32 tail = ctx->tail;
+   long got = 0;
+   u32 head, cnt;
+
+   *tail_ref = tail;
+
+   if (copy_from_user(&head, &ring->head, sizeof(head)))
+      return -EFAULT;
+
+   head %= ctx->nr;
+
+   while (got < max && head != tail) {
+
+      cnt = (head < tail ? tail : ctx->nr) - head;
+      cnt = MIN(cnt, (u32)AIO_REAP_BATCH);
+      cnt = MIN(cnt, (u32)(max - got));
+
+      if (copy_from_user(evs, aio_ring_event(ctx, head), sizeof(*evs) * cnt))
+         return got ? got : -EFAULT;
+
+      if (copy_to_user(u_events + got, evs, sizeof(*evs) * cnt))
+         return got ? got : -EFAULT;
+
+      got += cnt;
+      head = (head + cnt) % ctx->nr;
+
+      if (copy_to_user(&ring->head, &head, sizeof(head)))
+         return got;
+   }
+
+   return got;
+}
+
+static long
+aio_getevents(ulong ctx_id,
+              long min_nr,
+              long nr,
+              struct k_io_event *u_events,
+              const struct k_timespec64 *timeout)
+{
+   struct task *curr = get_curr_task();
+   struct aio_ctx *ctx;
+   u64 deadline = 0, now = 0;
+   long got = 0, rc;
+   u32 tail;
+
+   if (min_nr < 0 || nr < 0 || min_nr > nr)
+      return -EINVAL;
+
+   if (!(ctx = aio_lookup_ctx(ctx_id)))
+      return -EINVAL;
+
+   if (timeout)
+      deadline = get_ticks() + timespec_to_ticks(timeout);
+
+   while (true) {
+
+      if ((rc = aio_reap(ctx, u_events + got, nr - got, &tail)) < 0)
+         return got ? got : rc;
+
+      got += rc;
+
+      if (got >= min_nr || got == nr)
+         break;
+
+      /*
+       * Same as kcond_wait(), but checking in the preempt-disabled section
+       * that no completion arrived while we were reaping the events.
+       */
+      disable_preemption();
+
+      if (ctx->tail != tail) {
+         enable_preemption();
+         continue;
+      }
+
+      if (timeout && (now = get_ticks()) >= deadline) {
+         enable_preemption();
+         break;
+      }
+
+      prepare_to_wait_on(WOBJ_KCOND, &ctx->cond, NO_EXTRA,
+                         &ctx->cond.wait_list);
+
+      if (timeout)
+         task_set_wakeup_timer(curr, deadline - now);
+
+      enter_sleep_wait_state();
+      /* enter_sleep_wait_state() leaves preemption enabled */
+
+      wait_obj_reset(&curr->wobj);
+
+      if (timeout)
+         task_cancel_wakeup_timer(curr);
+
+      if (pending_signals())
+         return got ? got : -EINTR;
+   }
+
+   return got;
+}
+
+long sys_io_getevents(ulong ctx_id,
+                      long min_nr,
+                      long nr,
+                      struct k_io_event *u_events,
+                      const struct k_timespec64 *u_timeout)
+{
+   struct k_timespec64 ts;
+
+   if (u_timeout && copy_from_user(&ts, u_timeout, sizeof(ts)))
+      return -EFAULT;
+
+   return aio_getevents(ctx_id, min_nr, nr, u_events, u_timeout ? &ts : NULL);
+}
+
+long sys_io_getevents_time32(ulong ctx_id,
+                             long min_nr,
+                             long nr,
+                             struct k_io_event *u_events,
+                             const struct k_timespec32 *u_timeout)
+{
+   struct k_timespec32 ts32;
+   struct k_timespec64 ts;
+
+   if (u_timeout) {
+
+      if (copy_from_user(&ts32, u_timeout, sizeof(ts32)))
+         return -EFAULT;
+
+      ts = (struct k_timespec64) {
+         .tv_sec = ts32.tv_sec,
+         .tv_nsec = ts32.tv_nsec,
+      };
+   }
+
+   return aio_getevents(ctx_id, min_nr, nr, u_events, u_timeout ? &ts : NULL);
+}
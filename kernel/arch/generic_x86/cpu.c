@@ -373,3 +373,17 @@ void fpu_context_end(void)
    in_fpu_context = false;
    enable_preemption();
 }
+
+/*
+ * Opportunistic version of fpu_context_begin(), for callers having a non-FPU
+ * fallback (see memcpy_large()): instead of asserting, it fails when called
+ * from an IRQ handler or when an FPU context is already active.
+ */
+bool fpu_context_try_begin(void)
+{
+   if (in_irq() || in_fpu_context)
+      return false;
+
+   fpu_context_begin();
+   return true;
+}
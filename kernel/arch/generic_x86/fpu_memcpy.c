@@ -26,8 +26,22 @@
 
 #include <tilck/kernel/elf_utils.h>
 #include <tilck/kernel/cmdline.h>
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/paging.h>
 #include <tilck/kernel/arch/generic_x86/fpu_memcpy.h>
 
+/*
+ * Copies shorter than this are not worth an FPU context: saving and restoring
+ * the whole FPU state costs about as much as copying a page with REP MOVSD.
+ */
+#define FPU_MEMCPY_MIN_SIZE      PAGE_SIZE
+
+/*
+ * Alignment required by the SIMD kernels used by memcpy_large() and
+ * bzero_page(): 32 for AVX2, 16 for SSE2. Zero means they're not usable.
+ */
+static ulong fpu_large_align;
+
 void
 memcpy256_failsafe(void *dest, const void *src, u32 n)
 {
@@ -143,6 +157,57 @@ void fpu_memset256_avx2(void *dest, u32 val32, u32 n)
       fpu_cpy_single_256_nt_avx2(dest, val256);
 }
 
+/*
+ * Copy for large kernel-to-kernel buffers: ramfs blocks, pipe buffers, CoW
+ * and fork page copies. When dest and src are co-aligned for the widest SIMD
+ * kernel available, the bulk is copied by fpu_memcpy256() inside a single FPU
+ * context, while the unaligned head and the tail go through memcpy(). Small
+ * or not co-aligned copies, and the ones made in IRQ context or while an FPU
+ * context is already active, just use memcpy().
+ *
+ * NOTE: never use it on user pointers: faults are not handled.
+ */
+void memcpy_large(void *dest, const void *src, size_t n)
+{
+   const ulong align = fpu_large_align;
+   size_t head, bulk;
+
+   if (n < FPU_MEMCPY_MIN_SIZE || !align ||
+       (((ulong)dest ^ (ulong)src) & (align - 1)) ||
+       !fpu_context_try_begin())
+   {
+      memcpy(dest, src, n);
+      return;
+   }
+
+   head = (size_t)(-(ulong)dest & (align - 1));
+   bulk = (n - head) & ~(size_t)31;
+
+   memcpy(dest, src, head);
+   fpu_memcpy256(dest + head, src + head, (u32)(bulk >> 5));
+   fpu_context_end();
+
+   memcpy(dest + head + bulk, src + head + bulk, n - head - bulk);
+}
+
+/*
+ * Zero a page with non-temporal stores, bypassing the cache: zeroing freshly
+ * allocated user pages shouldn't evict the kernel's working set.
+ */
+void bzero_page(void *page)
+{
+   ASSERT(IS_PAGE_ALIGNED(page));
+
+   if (!fpu_large_align || !fpu_context_try_begin()) {
+      bzero(page, PAGE_SIZE);
+      return;
+   }
+
+   fpu_memset256(page, 0, PAGE_SIZE >> 5);
+   asmVolatile("sfence" : : : "memory");
+   fpu_context_end();
+}
+
 static void
 init_fpu_memcpy_internal_check(void *func, const char *fname, u32 size)
 {
@@ -260,4 +325,12 @@ void init_fpu_memcpy(void)
    if ((func = get_fpu_cpy_single_256_nt_read_func())) {
       simple_hot_patch(&__asm_fpu_cpy_single_256_nt_read, func, 128);
    }
+
+   if (!kopt_no_fpu_memcpy) {
+
+      if (x86_cpu_features.can_use_avx2)
+         fpu_large_align = 32;
+      else if (x86_cpu_features.can_use_sse2)
+         fpu_large_align = 16;
+   }
 }
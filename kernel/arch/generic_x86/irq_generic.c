@@ -7,6 +7,7 @@
 
 #include <tilck/kernel/hal.h>
 #include <tilck/kernel/irq.h>
+#include <tilck/kernel/irq_stats.h>
 #include <tilck/kernel/term.h>
 #include <tilck/kernel/sched.h>
 #include <tilck/kernel/worker_thread.h>
@@ -107,11 +108,13 @@ void arch_irq_handling(regs_t *r)
 
    if (pic_is_spur_irq(irq)) {
       spur_irq_count++;
+      irq_stats_spurious(irq);
       return;
    }
 
    push_nested_interrupt(r->int_num);
    handle_irq_set_mask_and_eoi(irq);
+   irq_stats_enter();
    enable_interrupts_forced();
    {
       list_for_each_ro(pos, &irq_handlers_lists[irq], node) {
@@ -126,6 +129,7 @@ void arch_irq_handling(regs_t *r)
          unhandled_irq_count[irq]++;
    }
    disable_interrupts_forced();
+   irq_stats_exit(irq);
    handle_irq_clear_mask(irq);
    pop_nested_interrupt();
 }
@@ -15,6 +15,10 @@ NORETURN void poweroff(void)
    printk("Halting the system...\n");
 
    if (MOD_acpi) {
+
+      /* With -acpi_lazy, the S5 object needed to power off is not loaded yet */
+      acpi_ensure_ns_loaded("poweroff");
+
       if (get_acpi_init_status() >= ais_subsystem_enabled) {
          acpi_poweroff();
       }
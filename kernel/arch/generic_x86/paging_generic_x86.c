@@ -136,7 +136,8 @@ map_framebuffer(pdir_t *pdir,
    const size_t page_count = pow2_round_up_at(size, PAGE_SIZE) / PAGE_SIZE;
    const u32 pg_flags = PAGING_FL_RW                     |
                         PAGING_FL_SHARED                 |
-                        (user_mmap ? PAGING_FL_US : 0);
+                        (user_mmap ? PAGING_FL_US : 0)   |
+                        (user_mmap ? PAGING_FL_BIG_PAGES_ALLOWED : 0);
 
    if (!vaddr) {
 
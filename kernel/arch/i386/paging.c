@@ -41,6 +41,275 @@ pdir_get_page_table(pdir_t *pdir, u32 i)
    return PA_TO_LIN_VA(pdir->entries[i].ptaddr << PAGE_SHIFT);
 }
 
+/* Per-process accounting (see mm_acct_user_pages()) of a user page */
+static ALWAYS_INLINE void
+acct_user_page(pdir_t *pdir, ulong vaddr, page_t p, long n)
+{
+   if (vaddr < BASE_VA) {
+      mm_acct_user_pages(pdir,
+                         (ulong)p.pageAddr << PAGE_SHIFT,
+                         !!(p.avail & PAGE_SHARED),
+                         n);
+   }
+}
+
+/*
+ * User big pages
+ * ----------------
+ *
+ * User mappings can use 4-MB pages, as long as every 4 KB pageframe in them
+ * keeps its own ref-count, exactly like when mapped by a page table. That
+ * way, a big page can be split at any time in a page table with the same
+ * pageframes and flags (also the COW and SHARED avail bits), for partial
+ * unmaps, COW faults, mprotect() etc.
+ */
+
+/* The raw page table entry for the `j`-th 4 KB page in the big page `e` */
+static u32 big_page_pte_raw(page_dir_entry_t e, u32 j)
+{
+   const ulong paddr = (ulong)e.big_4mb_page.paddr << BIG_PAGE_SHIFT;
+   u32 raw = e.raw & (PG_PRESENT_BIT |
+                      PG_RW_BIT      |
+                      PG_US_BIT      |
+                      PG_WT_BIT      |
+                      PG_CD_BIT      |
+                      PG_CUSTOM_BITS);
+
+   if (e.big_4mb_page.pat)
+      raw |= PG_PAGE_PAT_BIT;
+
+   return raw | (u32)(paddr + (j << PAGE_SHIFT));
+}
+
+static int split_big_user_page(pdir_t *pdir, ulong vaddr)
+{
+   const u32 pd_index = (vaddr >> BIG_PAGE_SHIFT);
+   page_dir_entry_t *e = &pdir->entries[pd_index];
+   page_table_t *pt;
+
+   ASSERT(e->present && e->psize);
+   ASSERT(pd_index < BASE_VADDR_PD_IDX);
+
+   if (!(pt = kalloc_obj(page_table_t)))
+      return -ENOMEM;
+
+   ASSERT(IS_PAGE_ALIGNED(pt));
+
+   for (u32 j = 0; j < 1024; j++)
+      pt->pages[j].raw = big_page_pte_raw(*e, j);
+
+   e->raw = PG_PRESENT_BIT | PG_RW_BIT | PG_US_BIT | LIN_VA_TO_PA(pt);
+   invalidate_page_hw(vaddr);
+   mm_acct_page_tables(pdir, 1);
+   return 0;
+}
+
+/* Split the big page containing `vaddr`, if any */
+static int ensure_small_user_page(pdir_t *pdir, ulong vaddr)
+{
+   const page_dir_entry_t e = pdir->entries[vaddr >> BIG_PAGE_SHIFT];
+
+   if (!e.present || !e.psize)
+      return 0;
+
+   return split_big_user_page(pdir, vaddr);
+}
+
+int split_user_big_pages(pdir_t *pdir, void *vaddrp, size_t len)
+{
+   const ulong vend = (ulong)vaddrp + len;
+   int rc;
+
+   ASSERT(vend <= BASE_VA);
+
+   for (ulong va = (ulong)vaddrp & ~(4 * MB - 1); va < vend; va += 4 * MB) {
+      if ((rc = ensure_small_user_page(pdir, va)))
+         return rc;
+   }
+
+   return 0;
+}
+
+static bool is_big_page_unmap(pdir_t *pdir, ulong vaddr, size_t page_count)
+{
+   const page_dir_entry_t e = pdir->entries[vaddr >> BIG_PAGE_SHIFT];
+
+   return e.present                       &&
+          e.psize                         &&
+          !(vaddr & (4 * MB - 1))         &&
+          page_count >= 1024              &&
+          vaddr < BASE_VA;
+}
+
+static void
+put_big_user_page_frames(page_dir_entry_t e, bool free_pageframe)
+{
+   const ulong paddr = (ulong)e.big_4mb_page.paddr << BIG_PAGE_SHIFT;
+
+   for (ulong pa = paddr; pa < paddr + 4 * MB; pa += PAGE_SIZE) {
+      if (!pf_ref_count_dec(pa) && free_pageframe)
+         kfree2(PA_TO_LIN_VA(pa), PAGE_SIZE);
+   }
+}
+
+static void unmap_big_user_page(pdir_t *pdir, ulong vaddr, bool free_pageframe)
+{
+   page_dir_entry_t *e = &pdir->entries[vaddr >> BIG_PAGE_SHIFT];
+   const page_dir_entry_t old = *e;
+
+   mm_acct_user_pages(pdir,
+                      (ulong)old.big_4mb_page.paddr << BIG_PAGE_SHIFT,
+                      !!(old.avail & PAGE_SHARED),
+                      -1024);
+   e->raw = 0;
+   invalidate_page_hw(vaddr);
+   put_big_user_page_frames(old, free_pageframe);
+}
+
+/*
+ * Write fault on the zero page: if the whole 4 MB around `vaddr` is still on
+ * the zero page and is allowed to be backed by a big page, allocate a zeroed
+ * big page for it, instead of a single 4 KB page.
+ */
+static bool try_cow_zero_big_page(pdir_t *pdir, ulong vaddr)
+{
+   const ulong zero_paddr = KERNEL_VA_TO_PA(zero_page);
+   const u32 pd_index = (vaddr >> BIG_PAGE_SHIFT);
+   page_table_t *const pt = pdir_get_page_table(pdir, pd_index);
+   ulong paddr;
+   void *va;
+
+   if (vaddr >= BASE_VA)
+      return false;
+
+   for (u32 j = 0; j < 1024; j++) {
+
+      const page_t p = pt->pages[j];
+
+      if (!p.present || !p.us || p.avail != PAGE_COW_ORIG_RW)
+         return false;
+
+      if (((ulong)p.pageAddr << PAGE_SHIFT) != zero_paddr)
+         return false;
+   }
+
+   if (!is_anon_big_page_allowed(TO_PTR(vaddr & ~(4 * MB - 1)), 4 * MB))
+      return false;
+
+   if (!(va = kmalloc_big_aligned_pages(4 * MB)))
+      return false;
+
+   bzero(va, 4 * MB);
+   paddr = LIN_VA_TO_PA(va);
+
+   for (u32 j = 0; j < 1024; j++) {
+      pf_ref_count_inc(paddr + (j << PAGE_SHIFT));
+      pf_ref_count_dec(zero_paddr);
+   }
+
+   pdir->entries[pd_index].raw =
+      PG_PRESENT_BIT | PG_RW_BIT | PG_US_BIT | PG_4MB_BIT | paddr;
+
+   kfree_obj(pt, page_table_t);
+   invalidate_user_tlb_hw();     /* Drop the TLB entries of the 4 KB pages */
+   mm_acct_user_pages(pdir, paddr, false, 1024);
+   mm_acct_page_tables(pdir, -1);
+   return true;
+}
+
+/*
+ * COW fault on a big page: if its pageframes are not shared anymore, just
+ * make it writable again. Otherwise, split it and let the caller copy only
+ * the 4 KB page.
+ */
+static enum cow_result handle_big_page_cow(pdir_t *pdir, ulong vaddr)
+{
+   page_dir_entry_t *e = &pdir->entries[vaddr >> BIG_PAGE_SHIFT];
+   const ulong paddr = (ulong)e->big_4mb_page.paddr << BIG_PAGE_SHIFT;
+   ulong pa;
+
+   if (!(e->avail & PAGE_COW_ORIG_RW))
+      return COW_NOT_A_COW;
+
+   for (pa = paddr; pa < paddr + 4 * MB; pa += PAGE_SIZE) {
+      if (pf_ref_count_get(pa) != 1)
+         break;
+   }
+
+   if (pa == paddr + 4 * MB) {
+      e->rw = true;
+      e->avail = 0;
+      invalidate_page_hw(vaddr);
+      return COW_RESOLVED;
+   }
+
+   if (split_big_user_page(pdir, vaddr))
+      return COW_NO_MEM;
+
+   return COW_NOT_A_COW; /* Not a COW on a big page (anymore) */
+}
+
+void collapse_user_big_pages(pdir_t *pdir, void *vaddrp, size_t len)
+{
+   const u32 mask = PG_PRESENT_BIT  |
+                    PG_RW_BIT       |
+                    PG_US_BIT       |
+                    PG_WT_BIT       |
+                    PG_CD_BIT       |
+                    PG_PAGE_PAT_BIT |
+                    PG_CUSTOM_BITS;
+
+   const ulong vend = (ulong)vaddrp + len;
+   page_dir_entry_t *e;
+   page_table_t *pt;
+   ulong paddr;
+   u32 j, raw;
+
+   ASSERT(!is_preemption_enabled());
+   ASSERT(vend <= BASE_VA);
+
+   for (ulong va = pow2_round_up_at((ulong)vaddrp, 4 * MB);
+        va + 4 * MB <= vend;
+        va += 4 * MB)
+   {
+      e = &pdir->entries[va >> BIG_PAGE_SHIFT];
+
+      if (!e->present || e->psize)
+         continue;
+
+      pt = pdir_get_page_table(pdir, va >> BIG_PAGE_SHIFT);
+      raw = pt->pages[0].raw;
+      paddr = raw & PAGE_MASK;
+
+      if (!(raw & PG_PRESENT_BIT) || (paddr & (4 * MB - 1)))
+         continue;
+
+      for (j = 1; j < 1024; j++) {
+
+         const page_t p = pt->pages[j];
+
+         if ((p.raw & mask) != (raw & mask))
+            break;
+
+         if (((ulong)p.pageAddr << PAGE_SHIFT) != paddr + (j << PAGE_SHIFT))
+            break;
+      }
+
+      if (j < 1024)
+         continue;
+
+      /* Each pageframe keeps the reference it had from the page table */
+      e->raw = (raw & (mask & ~PG_PAGE_PAT_BIT)) |
+               ((raw & PG_PAGE_PAT_BIT) ? PG_4MB_PAT_BIT : 0) |
+               PG_4MB_BIT |
+               paddr;
+
+      kfree_obj(pt, page_table_t);
+      invalidate_user_tlb_hw();
+      mm_acct_page_tables(pdir, -1);
+   }
+}
+
 enum cow_result handle_potential_cow(void *context)
 {
    regs_t *r = context;
@@ -55,7 +324,17 @@ enum cow_result handle_potential_cow(void *context)
    const u32 pt_index = (vaddr >> PAGE_SHIFT) & 1023;
    const u32 pd_index = (vaddr >> BIG_PAGE_SHIFT);
    const void *const page_vaddr = (void *)(vaddr & PAGE_MASK);
-   pt = pdir_get_page_table(get_curr_pdir(), pd_index);
+   pdir_t *const pdir = get_curr_pdir();
+
+   if (pdir->entries[pd_index].psize) {
+
+      const enum cow_result res = handle_big_page_cow(pdir, vaddr);
+
+      if (res != COW_NOT_A_COW || pdir->entries[pd_index].psize)
+         return res;
+   }
+
+   pt = pdir_get_page_table(pdir, pd_index);
 
    if (!(pt->pages[pt_index].avail & PAGE_COW_ORIG_RW))
       return COW_NOT_A_COW; /* Not a COW page */
@@ -63,6 +342,11 @@ enum cow_result handle_potential_cow(void *context)
    const u32 orig_page_paddr = (u32)
       pt->pages[pt_index].pageAddr << PAGE_SHIFT;
 
+   if (orig_page_paddr == KERNEL_VA_TO_PA(zero_page) && kopt_big_pages) {
+      if (try_cow_zero_big_page(pdir, vaddr))
+         return COW_RESOLVED;
+   }
+
    if (pf_ref_count_get(orig_page_paddr) == 1) {
 
       /* This page is not shared anymore. No need for copying it. */
@@ -71,7 +355,7 @@ enum cow_result handle_potential_cow(void *context)
       const ulong paddr = (ulong)
          pt->pages[pt_index].pageAddr << PAGE_SHIFT;
 
-      ASSERT(paddr != KERNEL_VA_TO_PA(&zero_page));
+      ASSERT(paddr != KERNEL_VA_TO_PA(zero_page));
 #endif
 
       pt->pages[pt_index].rw = true;
@@ -95,8 +379,11 @@ enum cow_result handle_potential_cow(void *context)
 
    ASSERT(IS_PAGE_ALIGNED(new_page_vaddr));
 
-   // Copy page's contents
-   memcpy32(new_page_vaddr, page_vaddr, PAGE_SIZE / 4);
+   // Copy page's contents (nothing to copy from the zero page)
+   if (orig_page_paddr == KERNEL_VA_TO_PA(zero_page))
+      bzero_page(new_page_vaddr);
+   else
+      memcpy_large(new_page_vaddr, page_vaddr, PAGE_SIZE);
 
    // Get the paddr of the new page
    const ulong paddr = LIN_VA_TO_PA(new_page_vaddr);
@@ -116,6 +403,10 @@ enum cow_result handle_potential_cow(void *context)
    pt->pages[pt_index].avail = 0;
 
    invalidate_page_hw(vaddr);
+
+   if (orig_page_paddr == KERNEL_VA_TO_PA(zero_page))
+      mm_acct_user_pages(pdir, paddr, false, 1);
+
    return COW_RESOLVED;
 }
 
@@ -163,10 +454,10 @@ void handle_page_fault_int(regs_t *r)
    if (um && um->h) {
 
       /*
-       * Call vfs_handle_fault() only if in first place the mapping allowed
-       * writing or if it didn't but the memory access type was a READ.
+       * Call vfs_handle_fault() only if the mapping allowed the type of the
+       * memory access in first place: not for mprotect()ed pages.
        */
-      if (!!(um->prot & PROT_WRITE) || !rw) {
+      if (um->prot & (rw ? PROT_WRITE : PROT_READ | PROT_EXEC)) {
 
          if (vfs_handle_fault(um, (void *)vaddr, p, rw))
             return;
@@ -240,17 +531,242 @@ bool is_rw_mapped(pdir_t *pdir, void *vaddrp)
    return page.present && page.rw;
 }
 
-void set_page_rw(pdir_t *pdir, void *vaddrp, bool rw)
+bool is_user_range_accessible(pdir_t *pdir, const void *vaddrp, size_t len)
+{
+   const ulong vend = (ulong)vaddrp + len;
+   page_table_t *pt;
+   page_t p;
+
+   for (ulong va = (ulong)vaddrp & PAGE_MASK; va < vend; va += PAGE_SIZE) {
+
+      const page_dir_entry_t e = pdir->entries[va >> BIG_PAGE_SHIFT];
+
+      if (!e.present)
+         continue;
+
+      if (e.psize) {
+
+         if (!e.us)
+            return false;
+
+         continue;
+      }
+
+      pt = PA_TO_LIN_VA(e.ptaddr << PAGE_SHIFT);
+      p = pt->pages[(va >> PAGE_SHIFT) & 1023];
+
+      if (p.present && !p.us)
+         return false;
+   }
+
+   return true;
+}
+
+int set_page_rw(pdir_t *pdir, void *vaddrp, bool rw)
 {
    page_table_t *pt;
    const ulong vaddr = (ulong) vaddrp;
    const u32 pt_index = (vaddr >> PAGE_SHIFT) & 1023;
    const u32 pd_index = (vaddr >> BIG_PAGE_SHIFT);
+   int rc;
+
+   if ((rc = ensure_small_user_page(pdir, vaddr)))
+      return rc;
 
    pt = PA_TO_LIN_VA(pdir->entries[pd_index].ptaddr << PAGE_SHIFT);
    ASSERT(LIN_VA_TO_PA(pt) != 0);
    pt->pages[pt_index].rw = rw;
    invalidate_page_hw(vaddr);
+   return 0;
+}
+
+static page_t *
+get_private_user_pte(pdir_t *pdir, ulong vaddr)
+{
+   page_table_t *pt;
+   page_t *p;
+   const u32 pt_index = (vaddr >> PAGE_SHIFT) & 1023;
+   const u32 pd_index = (vaddr >> BIG_PAGE_SHIFT);
+   const page_dir_entry_t e = pdir->entries[pd_index];
+
+   if (!e.present || e.psize)
+      return NULL;
+
+   pt = PA_TO_LIN_VA(e.ptaddr << PAGE_SHIFT);
+   p = &pt->pages[pt_index];
+
+   if (!p->present || !p->us || (p->avail & PAGE_SHARED))
+      return NULL;
+
+   if (!pf_ref_count_get((ulong)p->pageAddr << PAGE_SHIFT))
+      return NULL; /* Not a regular RAM pageframe */
+
+   return p;
+}
+
+bool get_private_user_page(pdir_t *pdir, void *vaddrp, ulong *paddr)
+{
+   const page_t *p = get_private_user_pte(pdir, (ulong)vaddrp);
+
+   if (!p)
+      return false;
+
+   *paddr = (ulong)p->pageAddr << PAGE_SHIFT;
+   return true;
+}
+
+bool share_page_cow(pdir_t *pdir, void *vaddrp, ulong paddr)
+{
+   const ulong vaddr = (ulong)vaddrp;
+   page_t *p = get_private_user_pte(pdir, vaddr);
+   ulong old_paddr;
+
+   ASSERT(p != NULL);
+   ASSERT(IS_PAGE_ALIGNED(paddr));
+   ASSERT(!is_preemption_enabled());
+
+   old_paddr = (ulong)p->pageAddr << PAGE_SHIFT;
+
+   if (p->rw)
+      p->avail |= PAGE_COW_ORIG_RW;
+
+   p->rw = false;
+
+   if (paddr == old_paddr) {
+      invalidate_page_hw(vaddr);
+      return false;
+   }
+
+   pf_ref_count_inc(paddr);
+   p->pageAddr = SHR_BITS(paddr, PAGE_SHIFT, u32);
+   invalidate_page_hw(vaddr);
+
+   if (paddr == KERNEL_VA_TO_PA(zero_page))
+      mm_acct_user_pages(pdir, old_paddr, false, -1);
+
+   if (pf_ref_count_dec(old_paddr))
+      return false;
+
+   ASSERT(old_paddr != KERNEL_VA_TO_PA(zero_page));
+   kfree2(PA_TO_LIN_VA(old_paddr), PAGE_SIZE);
+   return true;
+}
+
+static page_t *
+get_user_pte(pdir_t *pdir, ulong vaddr)
+{
+   page_table_t *pt;
+   const u32 pt_index = (vaddr >> PAGE_SHIFT) & 1023;
+   const u32 pd_index = (vaddr >> BIG_PAGE_SHIFT);
+   const page_dir_entry_t e = pdir->entries[pd_index];
+
+   ASSERT(e.present && !e.psize);
+   pt = PA_TO_LIN_VA(e.ptaddr << PAGE_SHIFT);
+
+   ASSERT(pt->pages[pt_index].present);
+   ASSERT(pt->pages[pt_index].us);
+   return &pt->pages[pt_index];
+}
+
+int swap_user_pages(pdir_t *pdir, void *va1, void *va2)
+{
+   page_t *p1, *p2;
+   page_t tmp;
+   int rc;
+
+   ASSERT(!is_preemption_enabled());
+
+   if ((rc = ensure_small_user_page(pdir, (ulong)va1)))
+      return rc;
+
+   if ((rc = ensure_small_user_page(pdir, (ulong)va2)))
+      return rc;
+
+   p1 = get_user_pte(pdir, (ulong)va1);
+   p2 = get_user_pte(pdir, (ulong)va2);
+   tmp = *p1;
+   *p1 = *p2;
+   *p2 = tmp;
+   invalidate_page_hw((ulong)va1);
+   invalidate_page_hw((ulong)va2);
+   return 0;
+}
+
+int
+set_user_pages_prot(pdir_t *pdir, void *vaddrp, size_t count, u32 pg_flags)
+{
+   const ulong zero_paddr = KERNEL_VA_TO_PA(zero_page);
+   const bool us = !!(pg_flags & PAGING_FL_US);
+   const bool rw = us && (pg_flags & PAGING_FL_RW);
+   const ulong vbegin = (ulong)vaddrp;
+   const ulong vend = vbegin + count * PAGE_SIZE;
+   page_table_t *pt;
+   ulong paddr;
+   page_t *p;
+   int rc;
+
+   ASSERT(!is_preemption_enabled());
+   ASSERT(IS_PAGE_ALIGNED(vbegin));
+   ASSERT(vend <= BASE_VA);
+
+   /*
+    * Split the big pages first, so that running out of memory leaves all the
+    * pages as they were. The pages already split don't need to be collapsed
+    * back: that's just slightly slower.
+    */
+   if ((rc = split_user_big_pages(pdir, vaddrp, vend - vbegin)))
+      return rc;
+
+   for (ulong vaddr = vbegin; vaddr < vend; vaddr += PAGE_SIZE) {
+
+      const page_dir_entry_t e = pdir->entries[vaddr >> BIG_PAGE_SHIFT];
+
+      if (!e.present)
+         continue;
+
+      pt = PA_TO_LIN_VA(e.ptaddr << PAGE_SHIFT);
+      p = &pt->pages[(vaddr >> PAGE_SHIFT) & 1023];
+
+      if (!p->present)
+         continue;
+
+      /* PROT_NONE pages are just not accessible from user space */
+      p->us = us;
+
+      if (!rw) {
+         p->rw = false;
+         p->avail &= ~PAGE_COW_ORIG_RW;
+         continue;
+      }
+
+      if (p->rw || (p->avail & PAGE_COW_ORIG_RW))
+         continue;
+
+      paddr = (ulong)p->pageAddr << PAGE_SHIFT;
+
+      if (p->avail & PAGE_SHARED) {
+
+         /* Never CoW, but a file hole on the zero page must stay read-only */
+         if (paddr != zero_paddr)
+            p->rw = true;
+
+         continue;
+      }
+
+      if (paddr == zero_paddr || pf_ref_count_get(paddr) > 1)
+         p->avail |= PAGE_COW_ORIG_RW;
+      else
+         p->rw = true;
+   }
+
+   if (count > USER_PAGES_PROT_INVLPG_MAX) {
+      invalidate_user_tlb_hw();
+   } else {
+      for (ulong vaddr = vbegin; vaddr < vend; vaddr += PAGE_SIZE)
+         invalidate_page_hw(vaddr);
+   }
+
+   return 0;
 }
 
 static inline int
@@ -260,6 +776,14 @@ __unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe, bool permissive)
    const ulong vaddr = (ulong) vaddrp;
    const u32 pt_index = (vaddr >> PAGE_SHIFT) & 1023;
    const u32 pd_index = (vaddr >> BIG_PAGE_SHIFT);
+   const page_dir_entry_t e = pdir->entries[pd_index];
+
+   if (e.present && e.psize) {
+
+      /* Unmapping a part of a big page: split it first */
+      if (split_big_user_page(pdir, vaddr))
+         return -ENOMEM;
+   }
 
    pt = PA_TO_LIN_VA(pdir->entries[pd_index].ptaddr << PAGE_SHIFT);
 
@@ -279,6 +803,7 @@ __unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe, bool permissive)
    const ulong paddr = (ulong)
       pt->pages[pt_index].pageAddr << PAGE_SHIFT;
 
+   acct_user_page(pdir, vaddr, pt->pages[pt_index], -1);
    pt->pages[pt_index].raw = 0;
    invalidate_page_hw(vaddr);
 
@@ -290,10 +815,10 @@ __unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe, bool permissive)
    return 0;
 }
 
-void
+int
 unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe)
 {
-   __unmap_page(pdir, vaddrp, free_pageframe, false);
+   return __unmap_page(pdir, vaddrp, free_pageframe, false);
 }
 
 int
@@ -309,7 +834,17 @@ unmap_pages(pdir_t *pdir,
             bool do_free)
 {
    for (size_t i = 0; i < page_count; i++) {
-      unmap_page(pdir, (char *)vaddr + (i << PAGE_SHIFT), do_free);
+
+      const ulong va = (ulong)vaddr + (i << PAGE_SHIFT);
+
+      if (is_big_page_unmap(pdir, va, page_count - i)) {
+         unmap_big_user_page(pdir, va, do_free);
+         i += 1023;
+         continue;
+      }
+
+      if (unmap_page(pdir, (void *)va, do_free))
+         panic("Out-of-memory: unable to split a big page. No OOM killer");
    }
 }
 
@@ -323,11 +858,17 @@ unmap_pages_permissive(pdir_t *pdir,
    size_t unmapped_pages = 0;
 
    for (size_t i = 0; i < page_count; i++) {
-      rc = unmap_page_permissive(
-         pdir,
-         (char *)vaddr + (i << PAGE_SHIFT),
-         do_free
-      );
+
+      const ulong va = (ulong)vaddr + (i << PAGE_SHIFT);
+
+      if (is_big_page_unmap(pdir, va, page_count - i)) {
+         unmap_big_user_page(pdir, va, do_free);
+         unmapped_pages += 1024;
+         i += 1023;
+         continue;
+      }
+
+      rc = unmap_page_permissive(pdir, (void *)va, do_free);
       unmapped_pages += (rc == 0);
    }
 
@@ -353,6 +894,11 @@ ulong get_mapping(pdir_t *pdir, void *vaddrp)
    ASSERT(e.present);
    ASSERT(e.ptaddr != 0);
 
+   if (e.psize) {
+      return ((ulong) e.big_4mb_page.paddr << BIG_PAGE_SHIFT) |
+             (vaddr & (4 * MB - 1));
+   }
+
    pt = PA_TO_LIN_VA(e.ptaddr << PAGE_SHIFT);
    p.raw = pt->pages[pt_index].raw;
    ASSERT(p.present);
@@ -415,6 +961,9 @@ map_page_int(pdir_t *pdir, void *vaddrp, ulong paddr, ulong hw_flags)
    ASSERT(!(vaddr & OFFSET_IN_PAGE_MASK)); // the vaddr must be page-aligned
    ASSERT(!(paddr & OFFSET_IN_PAGE_MASK)); // the paddr must be page-aligned
 
+   if (pdir->entries[pd_index].psize)
+      return -EADDRINUSE; /* Already mapped by a big page */
+
    pt = PA_TO_LIN_VA(pdir->entries[pd_index].ptaddr << PAGE_SHIFT);
    ASSERT(IS_PAGE_ALIGNED(pt));
 
@@ -434,6 +983,9 @@ map_page_int(pdir_t *pdir, void *vaddrp, ulong paddr, ulong hw_flags)
          (hw_flags & PG_US_BIT)  |
          (hw_flags & PG_CD_BIT)  |
          LIN_VA_TO_PA(pt);
+
+      if (vaddr < BASE_VA)
+         mm_acct_page_tables(pdir, 1);
    }
 
    if (pt->pages[pt_index].present)
@@ -442,6 +994,7 @@ map_page_int(pdir_t *pdir, void *vaddrp, ulong paddr, ulong hw_flags)
    pt->pages[pt_index].raw = PG_PRESENT_BIT | hw_flags | paddr;
    pf_ref_count_inc(paddr);
    invalidate_page_hw(vaddr);
+   acct_user_page(pdir, vaddr, pt->pages[pt_index], 1);
    return 0;
 }
 
@@ -483,7 +1036,24 @@ map_pages_int(pdir_t *pdir,
       big_page_flags &= ~PG_GLOBAL_BIT;
 
       for (; big_pages < (rem_pages >> 10); big_pages++) {
+
+         if (pdir->entries[(ulong)vaddr >> BIG_PAGE_SHIFT].raw)
+            break; /* There's already a page table there: use 4 KB pages */
+
          map_4mb_page_int(pdir, vaddr, paddr, big_page_flags);
+
+         /* User big pages hold a reference on each 4 KB pageframe */
+         if (hw_flags & PG_US_BIT) {
+
+            for (u32 j = 0; j < 1024; j++)
+               pf_ref_count_inc(paddr + (j << PAGE_SHIFT));
+
+            mm_acct_user_pages(pdir,
+                               paddr,
+                               !!(hw_flags & (PAGE_SHARED << PG_CUSTOM_B0_POS)),
+                               1024);
+         }
+
          vaddr += (4 * MB);
          paddr += (4 * MB);
       }
@@ -527,7 +1097,7 @@ map_page(pdir_t *pdir, void *vaddrp, ulong paddr, u32 pg_flags)
          return -ENOMEM;
 
       if (pg_flags & PAGING_FL_ZERO_PG)
-         bzero(va, PAGE_SIZE);
+         bzero_page(va);
 
       paddr = LIN_VA_TO_PA(va);
 
@@ -570,7 +1140,7 @@ map_zero_page(pdir_t *pdir, void *vaddrp, u32 pg_flags)
    return
       map_page_int(pdir,
                    vaddrp,
-                   KERNEL_VA_TO_PA(&zero_page),
+                   KERNEL_VA_TO_PA(zero_page),
                    (u32)(us << PG_US_BIT_POS)              |
                    (u32)(avail_bits << PG_CUSTOM_B0_POS)   |
                    (u32)((!us) << PG_GLOBAL_BIT_POS));
@@ -619,10 +1189,7 @@ pdir_t *pdir_clone(pdir_t *pdir)
 
    for (u32 i = 0; i < BASE_VADDR_PD_IDX; i++) {
 
-      /* User-space cannot use 4-MB pages */
-      ASSERT(!pdir->entries[i].psize);
-
-      if (!pdir->entries[i].present)
+      if (!pdir->entries[i].present || pdir->entries[i].psize)
          continue;
 
       page_table_t *const pt = kalloc_obj(page_table_t);
@@ -630,8 +1197,11 @@ pdir_t *pdir_clone(pdir_t *pdir)
       if (UNLIKELY(!pt)) {
 
          for (; i > 0; i--) {
-            if (pdir->entries[i - 1].present)
-               kfree_obj(pdir_get_page_table(pdir, i - 1), page_table_t);
+
+            const page_dir_entry_t e = new_pdir->entries[i - 1];
+
+            if (e.present && !e.psize)
+               kfree_obj(pdir_get_page_table(new_pdir, i - 1), page_table_t);
          }
 
          kfree_obj(new_pdir, pdir_t);
@@ -644,8 +1214,30 @@ pdir_t *pdir_clone(pdir_t *pdir)
 
    for (u32 i = 0; i < BASE_VADDR_PD_IDX; i++) {
 
-      if (!pdir->entries[i].present)
+      page_dir_entry_t *const e = &pdir->entries[i];
+
+      if (!e->present)
+         continue;
+
+      if (e->psize) {
+
+         const ulong paddr = (ulong)e->big_4mb_page.paddr << BIG_PAGE_SHIFT;
+
+         /* Same as below, but for the whole big page */
+         if (!(e->avail & PAGE_SHARED)) {
+
+            if (e->rw)
+               e->avail |= PAGE_COW_ORIG_RW;
+
+            e->rw = false;
+         }
+
+         for (ulong pa = paddr; pa < paddr + 4 * MB; pa += PAGE_SIZE)
+            pf_ref_count_inc(pa);
+
+         new_pdir->entries[i].raw = e->raw;
          continue;
+      }
 
       page_table_t *const orig_pt = pdir_get_page_table(pdir, i);
       page_table_t *const new_pt = pdir_get_page_table(new_pdir, i);
@@ -700,15 +1292,24 @@ pdir_deep_clone(pdir_t *pdir)
 
    for (u32 i = 0; i < BASE_VADDR_PD_IDX; i++) {
 
-      new_pdir->entries[i].raw = pdir->entries[i].raw;
+      const page_dir_entry_t e = pdir->entries[i];
+      page_table_t *orig_pt = NULL;
 
-      /* User-space cannot use 4-MB pages */
-      ASSERT(!pdir->entries[i].psize);
+      new_pdir->entries[i].raw = e.raw;
 
-      if (!pdir->entries[i].present)
+      if (!e.present)
          continue;
 
-      page_table_t *const orig_pt = pdir_get_page_table(pdir, i);
+      if (e.psize) {
+
+         /* The copy of a big page gets regular 4 KB pages */
+         new_pdir->entries[i].raw = 0;
+
+      } else {
+
+         orig_pt = pdir_get_page_table(pdir, i);
+      }
+
       page_table_t *const new_pt = kmalloc_accelerator_get_elem(&acc);
 
       if (UNLIKELY(!new_pt))
@@ -718,9 +1319,10 @@ pdir_deep_clone(pdir_t *pdir)
 
       for (u32 j = 0; j < 1024; j++) {
 
-         new_pt->pages[j].raw = orig_pt->pages[j].raw;
+         new_pt->pages[j].raw =
+            orig_pt ? orig_pt->pages[j].raw : big_page_pte_raw(e, j);
 
-         if (!orig_pt->pages[j].present)
+         if (!(new_pt->pages[j].raw & PG_PRESENT_BIT))
             continue;
 
          void *const new_page = kmalloc_accelerator_get_elem(&acc);
@@ -731,7 +1333,7 @@ pdir_deep_clone(pdir_t *pdir)
          ASSERT(IS_PAGE_ALIGNED(new_page));
 
          const ulong orig_page_paddr =
-            (ulong)orig_pt->pages[j].pageAddr << PAGE_SHIFT;
+            (ulong)new_pt->pages[j].pageAddr << PAGE_SHIFT;
 
          void *const orig_page = PA_TO_LIN_VA(orig_page_paddr);
 
@@ -739,10 +1341,13 @@ pdir_deep_clone(pdir_t *pdir)
          ASSERT(pf_ref_count_get(new_page_paddr) == 0);
          pf_ref_count_inc(new_page_paddr);
 
-         memcpy32(new_page, orig_page, PAGE_SIZE / 4);
+         memcpy_large(new_page, orig_page, PAGE_SIZE);
          new_pt->pages[j].pageAddr = SHR_BITS(new_page_paddr, PAGE_SHIFT, u32);
       }
 
+      if (e.psize)
+         new_pdir->entries[i].raw = PG_PRESENT_BIT | PG_RW_BIT | PG_US_BIT;
+
       new_pdir->entries[i].ptaddr =
          SHR_BITS(LIN_VA_TO_PA(new_pt), PAGE_SHIFT, u32);
    }
@@ -774,6 +1379,11 @@ void pdir_destroy(pdir_t *pdir)
       if (!pdir->entries[i].present)
          continue;
 
+      if (pdir->entries[i].psize) {
+         put_big_user_page_frames(pdir->entries[i], true);
+         continue;
+      }
+
       page_table_t *const pt = pdir_get_page_table(pdir, i);
 
       for (u32 j = 0; j < 1024; j++) {
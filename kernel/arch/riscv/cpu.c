@@ -170,3 +170,17 @@ void init_fpu_memcpy(void)
    /* STUB function: do nothing */
 }
 
+/*
+ * Opportunistic version of fpu_context_begin(), for callers having a non-FPU
+ * fallback (see memcpy_large()): instead of asserting, it fails when called
+ * from an IRQ handler or when an FPU context is already active.
+ */
+bool fpu_context_try_begin(void)
+{
+   if (in_irq() || in_fpu_context)
+      return false;
+
+   fpu_context_begin();
+   return true;
+}
+
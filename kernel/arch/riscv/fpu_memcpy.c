@@ -26,6 +26,8 @@
 
 #include <tilck/kernel/elf_utils.h>
 #include <tilck/kernel/cmdline.h>
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/paging.h>
 #include <tilck/kernel/arch/riscv/fpu_memcpy.h>
 
 void
@@ -40,3 +42,16 @@ memcpy_single_256_failsafe(void *dest, const void *src)
    memcpy32(dest, src, 8);
 }
 
+/*
+ * No vector or FPU-accelerated kernels on riscv yet: the page-sized copies
+ * just use the plain memcpy() and bzero().
+ */
+void memcpy_large(void *dest, const void *src, size_t n)
+{
+   memcpy(dest, src, n);
+}
+
+void bzero_page(void *page)
+{
+   bzero(page, PAGE_SIZE);
+}
@@ -70,6 +70,18 @@ pdir_get_page_table(pdir_t *pdir, ulong vaddr)
    return pt;
 }
 
+/* Per-process accounting (see mm_acct_user_pages()) of a user page */
+static ALWAYS_INLINE void
+acct_user_page(pdir_t *pdir, ulong vaddr, page_t e, long n)
+{
+   if (vaddr < BASE_VA) {
+      mm_acct_user_pages(pdir,
+                         (ulong)e.pfn << PAGE_SHIFT,
+                         !!(e.raw & PAGE_SHARED),
+                         n);
+   }
+}
+
 enum cow_result handle_potential_cow(void *context)
 {
    regs_t *r = context;
@@ -139,6 +151,10 @@ enum cow_result handle_potential_cow(void *context)
    pt->entries[PTE_INDEX(0, vaddr)].reserved = 0;
 
    invalidate_page_hw(vaddr);
+
+   if (orig_page_paddr == KERNEL_VA_TO_PA(zero_page))
+      mm_acct_user_pages(get_curr_pdir(), paddr, false, 1);
+
    return COW_RESOLVED;
 }
 
@@ -188,10 +204,10 @@ void handle_page_fault_int(regs_t *r)
     */
    if (um && um->h) {
       /*
-       * Call vfs_handle_fault() only if in first place the mapping allowed
-       * writing or if it didn't but the memory access type was a READ.
+       * Call vfs_handle_fault() only if the mapping allowed the type of the
+       * memory access in first place: not for mprotect()ed pages.
        */
-      if (!!(um->prot & PROT_WRITE) || rd) {
+      if ((wr && (um->prot & PROT_WRITE)) || (rd && (um->prot & PROT_READ))) {
 
          if (vfs_handle_fault(um, (void *)vaddr, p, wr))
             return;
@@ -270,7 +286,28 @@ bool is_rw_mapped(pdir_t *pdir, void *vaddrp)
    return e->present && e->wr;
 }
 
-void set_page_rw(pdir_t *pdir, void *vaddrp, bool rw)
+bool is_user_range_accessible(pdir_t *pdir, const void *vaddrp, size_t len)
+{
+   const ulong vend = (ulong)vaddrp + len;
+   page_table_t *pt;
+   page_t e;
+
+   /* User megapages are not supported on riscv: check just the 4 KB pages */
+   for (ulong va = (ulong)vaddrp & PAGE_MASK; va < vend; va += PAGE_SIZE) {
+
+      if (!(pt = pdir_get_page_table(pdir, va)))
+         continue;
+
+      e = pt->entries[PTE_INDEX(0, va)];
+
+      if (e.present && !e.usr)
+         return false;
+   }
+
+   return true;
+}
+
+int set_page_rw(pdir_t *pdir, void *vaddrp, bool rw)
 {
    page_table_t *pt;
    const ulong vaddr = (ulong) vaddrp;
@@ -280,6 +317,179 @@ void set_page_rw(pdir_t *pdir, void *vaddrp, bool rw)
 
    pt->entries[PTE_INDEX(0, vaddr)].wr = rw;
    invalidate_page_hw(vaddr);
+   return 0;
+}
+
+static page_t *
+get_private_user_pte(pdir_t *pdir, ulong vaddr)
+{
+   page_table_t *pt = pdir_get_page_table(pdir, vaddr);
+   page_t *e;
+
+   if (!pt)
+      return NULL;
+
+   e = &pt->entries[PTE_INDEX(0, vaddr)];
+
+   if (!e->present || !e->usr || (e->raw & PAGE_SHARED))
+      return NULL;
+
+   if (!pf_ref_count_get((ulong)e->pfn << PAGE_SHIFT))
+      return NULL; /* Not a regular RAM pageframe */
+
+   return e;
+}
+
+bool get_private_user_page(pdir_t *pdir, void *vaddrp, ulong *paddr)
+{
+   const page_t *e = get_private_user_pte(pdir, (ulong)vaddrp);
+
+   if (!e)
+      return false;
+
+   *paddr = (ulong)e->pfn << PAGE_SHIFT;
+   return true;
+}
+
+static page_t *
+get_user_pte(pdir_t *pdir, ulong vaddr)
+{
+   page_table_t *pt = pdir_get_page_table(pdir, vaddr);
+   page_t *e;
+
+   ASSERT(pt != NULL);
+   e = &pt->entries[PTE_INDEX(0, vaddr)];
+
+   ASSERT(e->present);
+   ASSERT(e->usr);
+   return e;
+}
+
+int swap_user_pages(pdir_t *pdir, void *va1, void *va2)
+{
+   page_t *e1 = get_user_pte(pdir, (ulong)va1);
+   page_t *e2 = get_user_pte(pdir, (ulong)va2);
+   const page_t tmp = *e1;
+
+   ASSERT(!is_preemption_enabled());
+
+   *e1 = *e2;
+   *e2 = tmp;
+   invalidate_page_hw((ulong)va1);
+   invalidate_page_hw((ulong)va2);
+   return 0;
+}
+
+int
+set_user_pages_prot(pdir_t *pdir, void *vaddrp, size_t count, u32 pg_flags)
+{
+   const ulong zero_paddr = KERNEL_VA_TO_PA(zero_page);
+   const bool us = !!(pg_flags & PAGING_FL_US);
+   const bool rw = us && (pg_flags & PAGING_FL_RW);
+   const ulong vbegin = (ulong)vaddrp;
+   const ulong vend = vbegin + count * PAGE_SIZE;
+   page_table_t *pt;
+   ulong paddr;
+   page_t *e;
+
+   ASSERT(!is_preemption_enabled());
+   ASSERT(IS_PAGE_ALIGNED(vbegin));
+
+   for (ulong vaddr = vbegin; vaddr < vend; vaddr += PAGE_SIZE) {
+
+      if (!(pt = pdir_get_page_table(pdir, vaddr)))
+         continue;
+
+      e = &pt->entries[PTE_INDEX(0, vaddr)];
+
+      if (!e->present)
+         continue;
+
+      /* PROT_NONE pages are just not accessible from user space */
+      e->usr = us;
+
+      if (!rw) {
+         e->wr = false;
+         e->raw &= ~PAGE_COW_ORIG_RW;
+         continue;
+      }
+
+      if (e->wr || (e->raw & PAGE_COW_ORIG_RW))
+         continue;
+
+      paddr = (ulong)e->pfn << PAGE_SHIFT;
+
+      if (e->raw & PAGE_SHARED) {
+
+         /* Never CoW, but a file hole on the zero page must stay read-only */
+         if (paddr != zero_paddr)
+            e->wr = true;
+
+         continue;
+      }
+
+      if (paddr == zero_paddr || pf_ref_count_get(paddr) > 1)
+         e->raw |= PAGE_COW_ORIG_RW;
+      else
+         e->wr = true;
+   }
+
+   if (count > USER_PAGES_PROT_INVLPG_MAX) {
+      invalidate_user_tlb_hw();
+   } else {
+      for (ulong vaddr = vbegin; vaddr < vend; vaddr += PAGE_SIZE)
+         invalidate_page_hw(vaddr);
+   }
+
+   return 0;
+}
+
+int split_user_big_pages(pdir_t *pdir, void *vaddr, size_t len)
+{
+   /* User megapages are not supported on riscv yet: nothing to split */
+   return 0;
+}
+
+void collapse_user_big_pages(pdir_t *pdir, void *vaddr, size_t len)
+{
+   /* User megapages are not supported on riscv yet: keep the 4 KB pages */
+}
+
+bool share_page_cow(pdir_t *pdir, void *vaddrp, ulong paddr)
+{
+   const ulong vaddr = (ulong)vaddrp;
+   page_t *e = get_private_user_pte(pdir, vaddr);
+   ulong old_paddr;
+
+   ASSERT(e != NULL);
+   ASSERT(IS_PAGE_ALIGNED(paddr));
+   ASSERT(!is_preemption_enabled());
+
+   old_paddr = (ulong)e->pfn << PAGE_SHIFT;
+
+   if (e->wr)
+      e->raw |= PAGE_COW_ORIG_RW;
+
+   e->wr = false;
+
+   if (paddr == old_paddr) {
+      invalidate_page_hw(vaddr);
+      return false;
+   }
+
+   pf_ref_count_inc(paddr);
+   e->pfn = PFN(paddr);
+   invalidate_page_hw(vaddr);
+
+   if (paddr == KERNEL_VA_TO_PA(zero_page))
+      mm_acct_user_pages(pdir, old_paddr, false, -1);
+
+   if (pf_ref_count_dec(old_paddr))
+      return false;
+
+   ASSERT(old_paddr != KERNEL_VA_TO_PA(zero_page));
+   kfree2(PA_TO_LIN_VA(old_paddr), PAGE_SIZE);
+   return true;
 }
 
 static inline int
@@ -307,6 +517,7 @@ __unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe, bool permissive)
    const ulong paddr = (ulong)
       pt->entries[PTE_INDEX(0, vaddr)].pfn << PAGE_SHIFT;
 
+   acct_user_page(pdir, vaddr, pt->entries[PTE_INDEX(0, vaddr)], -1);
    pt->entries[PTE_INDEX(0, vaddr)].raw = 0;
    invalidate_page_hw(vaddr);
 
@@ -319,10 +530,10 @@ __unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe, bool permissive)
    return 0;
 }
 
-void
+int
 unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe)
 {
-   __unmap_page(pdir, vaddrp, free_pageframe, false);
+   return __unmap_page(pdir, vaddrp, free_pageframe, false);
 }
 
 int
@@ -430,6 +641,7 @@ NODISCARD int
 map_page_int(pdir_t *pdir, void *vaddrp, ulong paddr, ulong hw_flags)
 {
    page_table_t *pt;
+   pdir_t *const root_pdir = pdir;
    const ulong vaddr = (ulong) vaddrp;
 
    ASSERT(IS_L0_PAGE_ALIGNED(vaddr)); // the vaddr must be page-aligned
@@ -455,6 +667,9 @@ map_page_int(pdir_t *pdir, void *vaddrp, ulong paddr, ulong hw_flags)
 
          pdir->entries[PTE_INDEX(level, vaddr)].raw =
             PAGE_TABLE | (PFN(LIN_VA_TO_PA(pt)) << _PAGE_PFN_SHIFT);
+
+         if (vaddr < BASE_VA)
+            mm_acct_page_tables(root_pdir, 1);
       }
 
       pdir = (pdir_t *)pt;
@@ -468,6 +683,7 @@ map_page_int(pdir_t *pdir, void *vaddrp, ulong paddr, ulong hw_flags)
 
    pf_ref_count_inc(paddr);
    invalidate_page_hw(vaddr);
+   acct_user_page(root_pdir, vaddr, pt->entries[PTE_INDEX(0, vaddr)], 1);
    return 0;
 }
 
@@ -67,7 +67,44 @@ bool is_rw_mapped(pdir_t *pdir, void *vaddrp)
    NOT_IMPLEMENTED();
 }
 
-void set_page_rw(pdir_t *pdir, void *vaddrp, bool rw)
+bool is_user_range_accessible(pdir_t *pdir, const void *vaddrp, size_t len)
+{
+   /* No mprotect() on x86-64 yet: there are no PROT_NONE pages */
+   return true;
+}
+
+int set_page_rw(pdir_t *pdir, void *vaddrp, bool rw)
+{
+   NOT_IMPLEMENTED();
+}
+
+bool get_private_user_page(pdir_t *pdir, void *vaddrp, ulong *paddr)
+{
+   NOT_IMPLEMENTED();
+}
+
+bool share_page_cow(pdir_t *pdir, void *vaddrp, ulong paddr)
+{
+   NOT_IMPLEMENTED();
+}
+
+int swap_user_pages(pdir_t *pdir, void *va1, void *va2)
+{
+   NOT_IMPLEMENTED();
+}
+
+int
+set_user_pages_prot(pdir_t *pdir, void *vaddr, size_t count, u32 pg_flags)
+{
+   NOT_IMPLEMENTED();
+}
+
+int split_user_big_pages(pdir_t *pdir, void *vaddr, size_t len)
+{
+   NOT_IMPLEMENTED();
+}
+
+void collapse_user_big_pages(pdir_t *pdir, void *vaddr, size_t len)
 {
    NOT_IMPLEMENTED();
 }
@@ -100,10 +137,10 @@ __unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe, bool permissive)
    NOT_IMPLEMENTED();
 }
 
-void
+int
 unmap_page(pdir_t *pdir, void *vaddrp, bool free_pageframe)
 {
-   __unmap_page(pdir, vaddrp, free_pageframe, false);
+   return __unmap_page(pdir, vaddrp, free_pageframe, false);
 }
 
 int
@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck_gen_headers/mod_sysfs.h>
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/printk.h>
+#include <tilck/common/boot.h>
+
+#include <tilck/kernel/boot_trace.h>
+#include <tilck/kernel/datetime.h>
+#include <tilck/kernel/errno.h>
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/kmalloc.h>
+
+#if MOD_sysfs
+   #include <tilck/mods/sysfs.h>
+   #include <tilck/mods/sysfs_utils.h>
+#endif
+
+/*
+ * The system time advances by whole timer ticks: measure the TSC frequency
+ * only over intervals long enough to make that error negligible.
+ */
+#define TSC_CALIB_MIN_MS                    1000
+
+static struct boot_trace_entry entries[BOOT_TRACE_MAX_ENTRIES];
+static u32 entries_count;
+
+static struct tilck_boot_trace bl_trace;
+
+static u64 calib_tsc;
+static u64 calib_sys_time;
+
+static void
+boot_trace_add(const char *name, enum boot_trace_src src)
+{
+   const u64 tsc = RDTSC();
+   ulong var;
+
+   disable_interrupts(&var);
+   {
+      if (entries_count < ARRAY_SIZE(entries)) {
+         entries[entries_count++] = (struct boot_trace_entry) {
+            .tsc = tsc,
+            .name = name,
+            .src = src,
+         };
+      }
+   }
+   enable_interrupts(&var);
+}
+
+void
+boot_trace(const char *name)
+{
+   boot_trace_add(name, BOOT_TRACE_KERNEL);
+}
+
+void
+boot_trace_module(const char *name)
+{
+   boot_trace_add(name, BOOT_TRACE_MODULE);
+}
+
+void
+boot_trace_import(const struct tilck_boot_trace *t)
+{
+   bl_trace = *t;
+   bl_trace.count = MIN(bl_trace.count, (u32)TILCK_BOOT_TRACE_MAX);
+
+   for (u32 i = 0; i < bl_trace.count; i++)
+      bl_trace.entries[i].name[TILCK_BOOT_TRACE_NAME_LEN - 1] = 0;
+}
+
+void
+boot_trace_timer_ready(void)
+{
+   calib_tsc = RDTSC();
+   calib_sys_time = get_sys_time();
+}
+
+u32
+boot_trace_tsc_khz(void)
+{
+   u64 tsc, sys_time, ms;
+   ulong var;
+
+   if (!calib_tsc)
+      return 0;
+
+   disable_interrupts(&var);
+   {
+      tsc = RDTSC();
+      sys_time = get_sys_time();
+   }
+   enable_interrupts(&var);
+
+   ms = (sys_time - calib_sys_time) / (TS_SCALE / 1000);
+
+   if (ms < TSC_CALIB_MIN_MS)
+      return 0;
+
+   return (u32)((tsc - calib_tsc) / ms);
+}
+
+u32
+boot_trace_get(struct boot_trace_entry *buf, u32 max)
+{
+   u32 n = 0, kcount;
+   ulong var;
+
+   for (u32 i = 0; i < bl_trace.count && n < max; i++, n++) {
+      buf[n] = (struct boot_trace_entry) {
+         .tsc = bl_trace.entries[i].tsc,
+         .name = bl_trace.entries[i].name,
+         .src = BOOT_TRACE_BOOTLOADER,
+      };
+   }
+
+   disable_interrupts(&var);
+   {
+      kcount = MIN(entries_count, max - n);
+   }
+   enable_interrupts(&var);
+
+   memcpy(buf + n, entries, kcount * sizeof(entries[0]));
+   return n + kcount;
+}
+
+#if MOD_sysfs
+
+static const char *const src_names[] = {
+   [BOOT_TRACE_BOOTLOADER] = "bootloader",
+   [BOOT_TRACE_KERNEL]     = "kernel",
+   [BOOT_TRACE_MODULE]     = "module",
+};
+
+#define BT_REPORT_LINE_MAX                    96
+#define BT_REPORT_ENTRIES                                               \
+   (BOOT_TRACE_MAX_ENTRIES + TILCK_BOOT_TRACE_MAX)
+
+static offt
+boot_trace_get_buf_sz(struct sysobj *obj, void *data)
+{
+   return (BT_REPORT_ENTRIES + 8) * BT_REPORT_LINE_MAX;
+}
+
+/*
+ * The whole trace, one stage per line, with the cycles spent in each stage
+ * (since the previous timestamp) and their conversion in microseconds, once
+ * the TSC frequency is known.
+ */
+static offt
+boot_trace_load(struct sysobj *obj, void *data, void *buf, offt sz, offt off)
+{
+   struct boot_trace_entry *e;
+   const u32 khz = boot_trace_tsc_khz();
+   size_t used = 0;
+   u64 total;
+   u32 n;
+
+   if (!(e = kalloc_array_obj(struct boot_trace_entry, BT_REPORT_ENTRIES)))
+      return -ENOMEM;
+
+   n = boot_trace_get(e, BT_REPORT_ENTRIES);
+
+#define WR(...)                                                      \
+   used += (size_t)snprintk((char *)buf + used,                      \
+                            (size_t)sz - used, __VA_ARGS__)
+
+   if (khz)
+      WR("tsc_khz: %u\n\n", khz);
+   else
+      WR("tsc_khz: unknown\n\n");
+
+   WR("%-10s %-28s %16s %12s %10s\n",
+      "source", "stage", "tsc", "cycles", "us");
+
+   for (u32 i = 0; i < n; i++) {
+
+      const u64 delta = i ? e[i].tsc - e[i-1].tsc : 0;
+
+      WR("%-10s %-28s %16llu %12llu %10llu\n",
+         src_names[e[i].src], e[i].name, e[i].tsc, delta,
+         khz ? delta * 1000 / khz : 0);
+   }
+
+   total = n ? e[n-1].tsc - e[0].tsc : 0;
+   WR("\ntotal: %llu cycles", total);
+
+   if (khz)
+      WR(", %llu us", total * 1000 / khz);
+
+   WR("\n");
+
+#undef WR
+
+   kfree_array_obj(e, struct boot_trace_entry, BT_REPORT_ENTRIES);
+   return (offt)used;
+}
+
+static const struct sysobj_prop_type boot_trace_prop_type = {
+   .buf_type   = SYSFS_BUF_BUFFERED,
+   .get_buf_sz = &boot_trace_get_buf_sz,
+   .load       = &boot_trace_load,
+};
+
+DEF_STATIC_SYSOBJ_PROP(trace, &boot_trace_prop_type);
+
+DEF_STATIC_SYSOBJ_TYPE(boot_sysobj_type,
+                       &prop_trace,
+                       NULL);
+
+void register_boot_trace_sysfs(void)
+{
+   struct sysobj *obj;
+
+   obj = sysfs_create_obj(&boot_sysobj_type,
+                          NULL,                   /* hooks */
+                          NULL);                  /* trace */
+
+   if (!obj)
+      return;
+
+   if (sysfs_register_obj(NULL, &sysfs_root_obj, "boot", obj) < 0)
+      sysfs_destroy_unregistered_obj(obj);
+}
+
+#else  /* !MOD_sysfs */
+
+void register_boot_trace_sysfs(void) { /* no-op */ }
+
+#endif /* MOD_sysfs */
@@ -456,7 +456,7 @@ load_elf_program(const char *filepath,
       goto out;
    }
 
-   if (!(pinfo->mi = alloc_mappings_info())) {
+   if (!(pinfo->mi = alloc_mappings_info(pinfo->pdir))) {
       rc = -ENOMEM;
       goto out;
    }
@@ -345,6 +345,9 @@ do_execve_int(struct execve_ctx *ctx, const char *path, const char *const *argv)
       return rc;
    }
 
+   /* The async I/O requests must not outlive the old address space */
+   destroy_process_aio_ctxs(get_curr_proc());
+
    disable_preemption();
    {
       rc = setup_process(&pinfo,
@@ -241,6 +241,9 @@ void terminate_process(int exit_code, int term_sig)
     */
    task_cancel_wakeup_timer(ti);
 
+   /* Release the RT reservation, if any (stops the period timer too) */
+   sched_rt_release(ti);
+
    /* Here we can either be RUNNABLE (if ti->wobj was set) or RUNNING */
    ASSERT(state == TASK_STATE_RUNNING || state == TASK_STATE_RUNNABLE);
 
@@ -249,10 +252,12 @@ void terminate_process(int exit_code, int term_sig)
    ti->nested_sig_handlers = -1;
 
    /*
-    * Close all the handles, keeping the preemption enabled while doing so.
+    * Wait for the async I/O requests still using our memory and close all the
+    * handles, keeping the preemption enabled while doing so.
     */
    enable_preemption();
    {
+      destroy_process_aio_ctxs(pi);
       close_all_handles();
    }
    disable_preemption();
@@ -321,8 +326,16 @@ void terminate_process(int exit_code, int term_sig)
 
    set_curr_pdir(get_kernel_pdir());
 
-   if (!vforked)
+   if (!vforked) {
+
       pdir_destroy(pi->pdir);
 
+      /* The address space is gone: nothing to account for it anymore */
+      if (pi->mi) {
+         pi->mi->pdir = NULL;
+         bzero(&pi->mi->usage, sizeof(pi->mi->usage));
+      }
+   }
+
    switch_stack_and_reschedule();
 }
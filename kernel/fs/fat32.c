@@ -32,8 +32,16 @@ fat_fs_walk_generic(struct fat_fs_device_data *d,
                      : fat_get_first_cluster(e));
 }
 
-STATIC ssize_t
-fat_read(fs_handle handle, char *buf, size_t bufsize, offt *pos)
+/*
+ * Read from the file to `buf`, which can be a user buffer (`to_user`): in that
+ * case, the data gets copied directly from the clusters to the user memory.
+ */
+static ssize_t
+fat_read_int(fs_handle handle,
+             char *buf,
+             size_t bufsize,
+             offt *pos,
+             bool to_user)
 {
    struct fatfs_handle *h = (struct fatfs_handle *) handle;
    struct fat_fs_device_data *d = h->fs->device_data;
@@ -74,7 +82,20 @@ fat_read(fs_handle handle, char *buf, size_t bufsize, offt *pos)
 
       ASSERT(to_read >= 0);
 
-      memcpy(buf + written_to_buf, data + cluster_off, (size_t)to_read);
+      if (to_user) {
+
+         int rc = copy_to_user(buf + written_to_buf,
+                               data + cluster_off,
+                               (size_t)to_read);
+
+         if (rc)
+            return written_to_buf ? (ssize_t)written_to_buf : rc;
+
+      } else {
+
+         memcpy(buf + written_to_buf, data + cluster_off, (size_t)to_read);
+      }
+
       written_to_buf += to_read;
       *pos += to_read;
 
@@ -106,6 +127,39 @@ fat_read(fs_handle handle, char *buf, size_t bufsize, offt *pos)
    return (ssize_t)written_to_buf;
 }
 
+STATIC ssize_t
+fat_read(fs_handle handle, char *buf, size_t bufsize, offt *pos)
+{
+   return fat_read_int(handle, buf, bufsize, pos, false);
+}
+
+static ssize_t
+fat_readv(fs_handle handle, const struct iovec *iov, int iovcnt)
+{
+   struct fatfs_handle *h = (struct fatfs_handle *) handle;
+   ssize_t ret = 0;
+   ssize_t rc;
+
+   for (int i = 0; i < iovcnt; i++) {
+
+      rc = fat_read_int(handle,
+                        iov[i].iov_base,
+                        iov[i].iov_len,
+                        &h->h_fpos,
+                        true);
+
+      if (rc < 0)
+         return ret ? ret : rc;
+
+      ret += rc;
+
+      if (rc < (ssize_t)iov[i].iov_len)
+         break; /* End of the file */
+   }
+
+   return ret;
+}
+
 
 STATIC int
 fat_rewind(fs_handle handle)
@@ -475,6 +529,7 @@ STATIC int fat_ioctl(fs_handle h, ulong request, void *arg)
 static const struct file_ops static_ops_fat =
 {
    .read = fat_read,
+   .readv = fat_readv,
    .seek = fat_seek,
    .write = fat_write,
    .ioctl = fat_ioctl,
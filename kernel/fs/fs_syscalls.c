@@ -350,21 +350,6 @@ int sys_ioctl(int fd, ulong request, void *argp)
    return vfs_ioctl(handle, request, argp);
 }
 
-static bool iov_len_overflow(const struct iovec *iov, int iovcnt)
-{
-   ssize_t tot_len = 0;
-
-   for (int i = 0; i < iovcnt; i++) {
-
-      tot_len += iov[i].iov_len;
-
-      if (tot_len < 0)
-         return true; /* overflow detected */
-   }
-
-   return false;
-}
-
 int sys_writev(int fd, const struct iovec *u_iov, int u_iovcnt)
 {
    fs_handle handle;
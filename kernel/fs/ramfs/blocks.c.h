@@ -22,11 +22,25 @@ static struct ramfs_block *ramfs_new_block(offt page)
    /* Init the block object */
    bintree_node_init(&b->node);
    b->offset = page;
+
+#if KRN_RAMFS_COMPRESSION
+   b->zblob = NULL;
+   b->atime = get_ticks();
+#endif
+
    return b;
 }
 
 static void ramfs_destroy_block(struct ramfs_block *b)
 {
+   if (!b->vaddr) {
+
+      /* The block is compressed: just free its compressed data */
+      ramfs_z_free_block_data(b);
+      kfree_obj(b, struct ramfs_block);
+      return;
+   }
+
    /* Release the pageframe used by this block */
    release_pageframes_mapped_at(get_kernel_pdir(), b->vaddr, PAGE_SIZE);
 
@@ -81,6 +81,7 @@ ramfs_create_inode_file(struct ramfs_data *d,
    i->parent_dir = parent;
    real_time_get_timespec(&i->ctime);
    i->mtime = i->ctime;
+   ramfs_z_add_file(i);
    return i;
 }
 
@@ -102,6 +103,7 @@ static int ramfs_destroy_inode(struct ramfs_data *d, struct ramfs_inode *i)
 
       case VFS_FILE:
          ASSERT(i->blocks_tree_root == NULL);
+         ramfs_z_remove_file(i);
          break;
 
       case VFS_DIR:
@@ -26,6 +26,13 @@ ramfs_mmap(struct user_mapping *um, pdir_t *pdir, int flags)
    if (i->type != VFS_FILE)
       return -EACCES;
 
+   /*
+    * Keep preemption disabled while walking the blocks and until the mapping
+    * is registered: that way, the blocks cannot get compressed in between
+    * (see zblocks.c.h).
+    */
+   disable_preemption();
+
    if (flags & VFS_MM_DONT_MMAP)
       goto register_mapping;
 
@@ -37,8 +44,8 @@ ramfs_mmap(struct user_mapping *um, pdir_t *pdir, int flags)
 
    pg_flags = PAGING_FL_US | PAGING_FL_SHARED;
 
-   if ((rh->fl_flags & O_RDWR) == O_RDWR)
-      pg_flags |= PAGING_FL_RW;
+   if (um->prot & PROT_WRITE)
+      pg_flags |= PAGING_FL_RW;   /* mmap() checked that the file is writable */
 
    while ((b = bintree_in_order_visit_next(&ctx))) {
 
@@ -48,10 +55,14 @@ ramfs_mmap(struct user_mapping *um, pdir_t *pdir, int flags)
       if ((size_t)b->offset >= off_end)
          break;
 
-      rc = map_page(pdir,
-                    (void *)vaddr,
-                    LIN_VA_TO_PA(b->vaddr),
-                    pg_flags);
+      vaddr = um->vaddr + ((size_t)b->offset - off_begin);
+
+      if (!(rc = ramfs_z_load_block(b, true))) {
+         rc = map_page(pdir,
+                       (void *)vaddr,
+                       LIN_VA_TO_PA(b->vaddr),
+                       pg_flags);
+      }
 
       if (rc) {
 
@@ -62,17 +73,20 @@ ramfs_mmap(struct user_mapping *um, pdir_t *pdir, int flags)
             unmap_page_permissive(pdir, (void *)vaddr, false);
          }
 
+         enable_preemption();
          return rc;
       }
-
-      vaddr += PAGE_SIZE;
    }
 
+   /* Files in physically contiguous blocks can use big pages */
+   collapse_user_big_pages(pdir, um->vaddrp, um->len);
+
 register_mapping:
    if (!(flags & VFS_MM_DONT_REGISTER)) {
       list_add_tail(&i->mappings_list, &um->inode_node);
    }
 
+   enable_preemption();
    return 0;
 }
 
@@ -85,7 +99,9 @@ ramfs_handle_fault_int(struct process *pi,
 {
    ulong abs_off;
    struct ramfs_block *block;
+   ulong paddr;
    int rc;
+   u32 pg_flags = PAGING_FL_US | PAGING_FL_SHARED;
    struct ramfs_handle *rh = um->h;
    ulong vaddr = (ulong) vaddrp;
 
@@ -95,12 +111,17 @@ ramfs_handle_fault_int(struct process *pi,
 
       /*
        * The page is present, just is read-only and the user code tried to
-       * write: there's nothing we can do.
+       * write. If the mapping is writable, that's a hole of the file mapped
+       * on the zero page by a read fault: drop it and allocate a block below.
+       * Otherwise, there's nothing we can do.
        */
 
       ASSERT(rw);
-      ASSERT((um->prot & PROT_WRITE) == 0);
-      return false;
+
+      if (!(um->prot & PROT_WRITE))
+         return false;
+
+      unmap_page(pi->pdir, (void *)(vaddr & PAGE_MASK), false);
    }
 
    /* The page is *not* present */
@@ -109,7 +130,20 @@ ramfs_handle_fault_int(struct process *pi,
    if (abs_off >= (ulong)rh->inode->fsize)
       return false; /* Read/write past EOF */
 
-   if (rw) {
+   block = bintree_find_ptr(rh->inode->blocks_tree_root,
+                            (offt)(abs_off & PAGE_MASK),
+                            struct ramfs_block,
+                            node,
+                            offset);
+
+   if (block) {
+
+      /* The block exists, but it's been compressed or written after mmap */
+      if (ramfs_z_load_block(block, true))
+         panic("Out-of-memory: unable to load a ramfs_block. No OOM killer");
+
+   } else if (rw) {
+
       /* Create and map on-the-fly a struct ramfs_block */
       if (!(block = ramfs_new_block((offt)(abs_off & PAGE_MASK))))
          panic("Out-of-memory: unable to alloc a ramfs_block. No OOM killer");
@@ -117,10 +151,20 @@ ramfs_handle_fault_int(struct process *pi,
       ramfs_append_new_block(rh->inode, block);
    }
 
-   rc = map_page(pi->pdir,
-                 (void *)(vaddr & PAGE_MASK),
-                 rw ? LIN_VA_TO_PA(block->vaddr) : KERNEL_VA_TO_PA(&zero_page),
-                 PAGING_FL_US | PAGING_FL_RW | PAGING_FL_SHARED);
+   if (block) {
+
+      paddr = LIN_VA_TO_PA(block->vaddr);
+
+      if (um->prot & PROT_WRITE)
+         pg_flags |= PAGING_FL_RW;
+
+   } else {
+
+      /* Read fault on a hole: the zero page must stay read-only */
+      paddr = KERNEL_VA_TO_PA(&zero_page);
+   }
+
+   rc = map_page(pi->pdir, (void *)(vaddr & PAGE_MASK), paddr, pg_flags);
 
    if (rc)
       panic("Out-of-memory: unable to map a ramfs_block. No OOM killer");
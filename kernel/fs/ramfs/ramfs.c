@@ -3,6 +3,7 @@
 #include "ramfs_int.h"
 #include "getdents.c.h"
 #include "locking.c.h"
+#include "zblocks.c.h"
 #include "dir_entries.c.h"
 #include "inodes.c.h"
 #include "stat.c.h"
@@ -353,6 +354,7 @@ struct mnt_fs *ramfs_create(void)
       return NULL;
    }
 
+   ramfs_z_init();
    return fs;
 }
 
@@ -1,6 +1,9 @@
 /* SPDX-License-Identifier: BSD-2-Clause */
 
 #pragma once
+#include <tilck_gen_headers/config_mm.h>
+#include <tilck_gen_headers/mod_sysfs.h>
+
 #include <stdbool.h>
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/string_util.h>
@@ -9,8 +12,10 @@
 
 #include <tilck/kernel/fs/vfs.h>
 #include <tilck/kernel/fs/flock.h>
+#include <tilck/kernel/fs/ramfs.h>
 #include <tilck/kernel/sched.h>
 #include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/hal.h>
 #include <tilck/kernel/errno.h>
 #include <tilck/kernel/list.h>
 #include <tilck/kernel/user.h>
@@ -28,12 +33,18 @@
 #include <dirent.h>        // system header
 
 struct ramfs_inode;
+struct ramfs_zblob;
 
 struct ramfs_block {
 
    struct bintree_node node;
    offt offset;                  /* MUST BE divisible by PAGE_SIZE */
-   void *vaddr;
+   void *vaddr;                  /* NULL when the block is compressed */
+
+#if KRN_RAMFS_COMPRESSION
+   struct ramfs_zblob *zblob;    /* compressed data, see zblocks.c.h */
+   u64 atime;                    /* ticks of the last read/write */
+#endif
 };
 
 /*
@@ -79,6 +90,10 @@ struct ramfs_inode {
    struct ramfs_inode *parent_dir;
    struct list mappings_list;          /* see ramfs_unmap_past_eof_mappings() */
 
+#if KRN_RAMFS_COMPRESSION
+   struct list_node z_node;            /* node in ramfs_z_files (VFS_FILE) */
+#endif
+
    union {
 
       /* valid when type == VFS_FILE */
@@ -193,4 +208,7 @@ ramfs_destroy_block(struct ramfs_block *b);
 static void
 ramfs_append_new_block(struct ramfs_inode *inode, struct ramfs_block *block);
 
+static int
+ramfs_block_get_data(struct ramfs_block *b);
+
 
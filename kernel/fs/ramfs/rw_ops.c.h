@@ -251,8 +251,9 @@ static int ramfs_truncate(struct mnt_fs *fs, vfs_inode_ptr_t i, offt len)
 }
 
 static ssize_t
-ramfs_read_nolock(struct ramfs_handle *rh, char *buf, size_t len, offt *pos)
+ramfs_read_nolock(fs_handle h, char *buf, size_t len, offt *pos)
 {
+   struct ramfs_handle *rh = h;
    struct ramfs_inode *inode = rh->inode;
    offt tot_read = 0;
    offt buf_rem = (offt) len;
@@ -286,8 +287,14 @@ ramfs_read_nolock(struct ramfs_handle *rh, char *buf, size_t len, offt *pos)
                                offset);
 
       if (block) {
+
+         /* The block might be compressed (KRN_RAMFS_COMPRESSION) */
+         if (ramfs_block_get_data(block))
+            break;
+
          /* reading a regular block */
-         memcpy(buf + tot_read, block->vaddr + page_off, (size_t)to_read);
+         memcpy_large(buf + tot_read, block->vaddr + page_off, (size_t)to_read);
+
       } else {
          /* reading a hole */
          memset(buf + tot_read, 0, (size_t)to_read);
@@ -298,6 +305,9 @@ ramfs_read_nolock(struct ramfs_handle *rh, char *buf, size_t len, offt *pos)
       buf_rem  -= to_read;
    }
 
+   if (len > 0 && !tot_read && *pos < inode->fsize)
+      return -ENOMEM;   /* Unable to decompress the first block */
+
    return (ssize_t) tot_read;
 }
 
@@ -315,8 +325,9 @@ static ssize_t ramfs_read(fs_handle h, char *buf, size_t len, offt *pos)
 }
 
 static ssize_t
-ramfs_write_nolock(struct ramfs_handle *rh, char *buf, size_t len, offt *pos)
+ramfs_write_nolock(fs_handle h, char *buf, size_t len, offt *pos)
 {
+   struct ramfs_handle *rh = h;
    struct ramfs_inode *inode = rh->inode;
    offt tot_written = 0;
    offt buf_rem = (offt)len;
@@ -352,9 +363,14 @@ ramfs_write_nolock(struct ramfs_handle *rh, char *buf, size_t len, offt *pos)
             break;
 
          ramfs_append_new_block(inode, block);
+
+      } else if (ramfs_block_get_data(block)) {
+         break;
       }
 
-      memcpy(block->vaddr + page_off, buf + tot_written, (size_t)to_write);
+      memcpy_large(block->vaddr + page_off,
+                   buf + tot_written,
+                   (size_t)to_write);
       tot_written += to_write;
       buf_rem     -= to_write;
       *pos     += to_write;
@@ -382,37 +398,6 @@ static ssize_t ramfs_write(fs_handle h, char *buf, size_t len, offt *pos)
    return ret;
 }
 
-static ssize_t
-ramfs_readv_nolock(struct ramfs_handle *rh, const struct iovec *iov, int iovcnt)
-{
-   struct task *curr = get_curr_task();
-   ssize_t ret = 0;
-   ssize_t rc;
-   int copy_rc;
-   size_t len;
-
-   for (int i = 0; i < iovcnt; i++) {
-
-      len = MIN(iov[i].iov_len, IO_COPYBUF_SIZE);
-      rc = ramfs_read_nolock(rh, curr->io_copybuf, len, &rh->h_fpos);
-
-      if (rc < 0) {
-         ret = rc;
-         break;
-      }
-
-      if ((copy_rc = copy_to_user(iov[i].iov_base, curr->io_copybuf, len)))
-         return copy_rc;
-
-      ret += rc;
-
-      if (rc < (ssize_t)iov[i].iov_len)
-         break; // Not enough data to fill all the user buffers.
-   }
-
-   return ret;
-}
-
 static ssize_t
 ramfs_readv(fs_handle h, const struct iovec *iov, int iovcnt)
 {
@@ -421,43 +406,12 @@ ramfs_readv(fs_handle h, const struct iovec *iov, int iovcnt)
 
    ramfs_file_shlock(h);
    {
-      ret = ramfs_readv_nolock(rh, iov, iovcnt);
+      ret = vfs_readv_copybuf(rh, iov, iovcnt, &ramfs_read_nolock, &rh->h_fpos);
    }
    ramfs_file_shunlock(h);
    return ret;
 }
 
-static ssize_t
-ramfs_writev_nolock(struct ramfs_handle *h, const struct iovec *iov, int iovcnt)
-{
-   struct task *curr = get_curr_task();
-   ssize_t ret = 0;
-   ssize_t rc;
-   size_t len;
-
-   for (int i = 0; i < iovcnt; i++) {
-
-      len = MIN(iov[i].iov_len, IO_COPYBUF_SIZE);
-
-      if (copy_from_user(curr->io_copybuf, iov[i].iov_base, len))
-         return -EFAULT;
-
-      rc = ramfs_write_nolock(h, curr->io_copybuf, len, &h->h_fpos);
-
-      if (rc < 0) {
-         ret = rc;
-         break;
-      }
-
-      ret += rc;
-
-      if (rc < (ssize_t)iov[i].iov_len)
-         break;
-   }
-
-   return ret;
-}
-
 static ssize_t
 ramfs_writev(fs_handle h, const struct iovec *iov, int iovcnt)
 {
@@ -466,7 +420,11 @@ ramfs_writev(fs_handle h, const struct iovec *iov, int iovcnt)
 
    ramfs_file_exlock(h);
    {
-      ret = ramfs_writev_nolock(rh, iov, iovcnt);
+      ret = vfs_writev_copybuf(rh,
+                               iov,
+                               iovcnt,
+                               &ramfs_write_nolock,
+                               &rh->h_fpos);
    }
    ramfs_file_exunlock(h);
    return ret;
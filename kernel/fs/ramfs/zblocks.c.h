@@ -0,0 +1,597 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include "ramfs_int.h"
+
+#if KRN_RAMFS_COMPRESSION
+
+#include <tilck/common/lz4.h>
+#include <tilck/kernel/timer.h>
+#include <tilck/kernel/cmdline.h>
+
+/*
+ * Compressed tier for the cold ramfs blocks
+ * -------------------------------------------
+ *
+ * Every RAMFS_Z_SCAN_INTERVAL_SECS, the `ramfs_z_thread` kthread visits all
+ * the ramfs files and LZ4-compresses their blocks not read or written in the
+ * last `-ramfs_zidle` seconds (0 disables the whole thing). The compressed
+ * data is stored in a packed arena and the block's page is freed: from then
+ * on, the block has vaddr == NULL and zblob != NULL. The next read, write or
+ * page fault touching the block decompresses it in a new page.
+ *
+ * The arena is made of RAMFS_Z_CHUNK_SIZE chunks, where the compressed blobs
+ * are allocated one after the other, each one with a small header pointing
+ * back to its block. Freed blobs are just marked as such: once more than half
+ * of a chunk is garbage, the thread moves its live blobs to the current chunk
+ * and frees it.
+ *
+ * Locking
+ * ---------
+ *
+ * Compressing a block requires its inode's exclusive lock, because readers
+ * and writers access block->vaddr with preemption enabled. The thread never
+ * waits for it: busy files are simply not hot enough to be compressed.
+ * The page fault handler and ramfs_mmap() don't take the inode lock: they run
+ * with preemption disabled, exactly like the actual compression of a block,
+ * the check for it being memory-mapped and all the arena operations. That's
+ * enough on Tilck, as it runs on a single CPU. Finally, the ramfs_z_files
+ * list is protected by `ramfs_z_files_lock`, held by the thread during the
+ * whole scan: an inode cannot be destroyed while the thread is using it.
+ *
+ * Memory-mapped blocks are never compressed, as user processes access them
+ * directly: they're pinned for as long as they're mapped.
+ */
+
+struct ramfs_zchunk {
+
+   struct list_node node;        /* node in ramfs_z_chunks */
+   u32 used;                     /* bytes allocated so far */
+   u32 live;                     /* bytes of the blobs still in use */
+   char data[];
+};
+
+struct ramfs_zblob {
+
+   struct ramfs_block *owner;    /* NULL once freed */
+   struct ramfs_zchunk *chunk;
+   u16 size;                     /* compressed data size */
+   u16 cap;                      /* space taken in the chunk, header included */
+   char data[];
+};
+
+#define RAMFS_Z_CHUNK_DATA_SIZE                                         \
+   (RAMFS_Z_CHUNK_SIZE - sizeof(struct ramfs_zchunk))
+
+#define RAMFS_Z_HASH_BITS                  12
+
+struct ramfs_z_stats {
+
+   u32 chunks;
+   u32 blocks;                   /* currently compressed blocks */
+   u64 zbytes;                   /* their compressed size */
+
+   u64 compressed;               /* total compressions */
+   u64 rejected;                 /* blocks not compressible enough */
+   u64 loads_rw;                 /* decompressions by read() or write() */
+   u64 loads_mm;                 /* decompressions by mmap or page faults */
+   u64 moved;                    /* blobs moved while compacting the arena */
+   u64 busy_skips;               /* files skipped because locked */
+   u64 oom;                      /* failed allocations */
+};
+
+static struct list ramfs_z_files = STATIC_LIST_INIT(ramfs_z_files);
+static struct list ramfs_z_chunks = STATIC_LIST_INIT(ramfs_z_chunks);
+static struct kmutex ramfs_z_files_lock =
+   STATIC_KMUTEX_INIT(ramfs_z_files_lock, 0);
+static struct ramfs_zchunk *ramfs_z_curr_chunk;
+static struct ramfs_z_stats ramfs_z_stats;
+static bool ramfs_z_thread_started;
+
+/* The thread's work buffers */
+static u32 *ramfs_z_ht;
+static void *ramfs_z_buf;
+
+/* ----------------------------- arena -------------------------------- */
+
+static struct ramfs_zchunk *ramfs_z_new_chunk(void)
+{
+   struct ramfs_zchunk *c;
+   ASSERT(!is_preemption_enabled());
+
+   if (!(c = kmalloc(RAMFS_Z_CHUNK_SIZE)))
+      return NULL;
+
+   list_node_init(&c->node);
+   c->used = 0;
+   c->live = 0;
+   list_add_tail(&ramfs_z_chunks, &c->node);
+   ramfs_z_stats.chunks++;
+   return c;
+}
+
+static void ramfs_z_destroy_chunk(struct ramfs_zchunk *c)
+{
+   ASSERT(!is_preemption_enabled());
+   ASSERT(c->live == 0);
+
+   if (c == ramfs_z_curr_chunk)
+      ramfs_z_curr_chunk = NULL;
+
+   list_remove(&c->node);
+   kfree2(c, RAMFS_Z_CHUNK_SIZE);
+   ramfs_z_stats.chunks--;
+}
+
+static struct ramfs_zblob *ramfs_z_alloc(struct ramfs_block *owner, u32 size)
+{
+   const u32 cap = pow2_round_up_at(sizeof(struct ramfs_zblob) + size,
+                                    sizeof(ulong));
+   struct ramfs_zchunk *c = ramfs_z_curr_chunk;
+   struct ramfs_zblob *zb;
+
+   ASSERT(!is_preemption_enabled());
+   ASSERT(cap <= RAMFS_Z_CHUNK_DATA_SIZE);
+
+   if (!c || c->used + cap > RAMFS_Z_CHUNK_DATA_SIZE) {
+
+      if (!(c = ramfs_z_new_chunk())) {
+         ramfs_z_stats.oom++;
+         return NULL;
+      }
+
+      /* The old current chunk is now just like all the others */
+      if (ramfs_z_curr_chunk && !ramfs_z_curr_chunk->live)
+         ramfs_z_destroy_chunk(ramfs_z_curr_chunk);
+
+      ramfs_z_curr_chunk = c;
+   }
+
+   zb = (void *)(c->data + c->used);
+   zb->owner = owner;
+   zb->chunk = c;
+   zb->size = (u16)size;
+   zb->cap = (u16)cap;
+
+   c->used += cap;
+   c->live += cap;
+   ramfs_z_stats.blocks++;
+   ramfs_z_stats.zbytes += size;
+   return zb;
+}
+
+static void ramfs_z_free(struct ramfs_zblob *zb)
+{
+   struct ramfs_zchunk *c = zb->chunk;
+   ASSERT(!is_preemption_enabled());
+   ASSERT(zb->owner != NULL);
+
+   zb->owner = NULL;
+   c->live -= zb->cap;
+   ramfs_z_stats.blocks--;
+   ramfs_z_stats.zbytes -= zb->size;
+
+   if (!c->live && c != ramfs_z_curr_chunk)
+      ramfs_z_destroy_chunk(c);
+}
+
+/*
+ * Move the live blobs of the emptiest chunk, if mostly made of garbage, to
+ * the current chunk, freeing it. Returns false if there was nothing to do.
+ */
+static bool ramfs_z_compact_one(void)
+{
+   struct ramfs_zchunk *c, *victim = NULL;
+   u32 off = 0;
+
+   ASSERT(!is_preemption_enabled());
+
+   list_for_each_ro(c, &ramfs_z_chunks, node) {
+
+      if (c == ramfs_z_curr_chunk || c->live * 2 >= c->used)
+         continue;
+
+      if (!victim || c->live < victim->live)
+         victim = c;
+   }
+
+   if (!victim)
+      return false;
+
+   while (off < victim->used) {
+
+      struct ramfs_zblob *zb = (void *)(victim->data + off);
+      struct ramfs_zblob *nzb;
+      bool last;
+
+      off += zb->cap;
+
+      if (!zb->owner)
+         continue;
+
+      /* NOTE: this might allocate a new chunk, but never touches `victim` */
+      if (!(nzb = ramfs_z_alloc(zb->owner, zb->size)))
+         return false;
+
+      memcpy(nzb->data, zb->data, zb->size);
+      zb->owner->zblob = nzb;
+      ramfs_z_stats.moved++;
+
+      last = victim->live == zb->cap;
+      ramfs_z_free(zb);
+
+      if (last)
+         break;               /* `victim` has been destroyed */
+   }
+
+   return true;
+}
+
+/*
+ * Compact a few chunks, each one with preemption disabled: moving a chunk's
+ * blobs means copying at most RAMFS_Z_CHUNK_SIZE bytes.
+ */
+static void ramfs_z_compact(void)
+{
+   for (int i = 0; i < 4; i++) {
+
+      bool done;
+
+      disable_preemption();
+      {
+         done = !ramfs_z_compact_one();
+      }
+      enable_preemption();
+
+      if (done)
+         break;
+   }
+}
+
+/* --------------------------- blocks ---------------------------------- */
+
+static bool
+ramfs_z_is_block_mapped(struct ramfs_inode *i, struct ramfs_block *b)
+{
+   struct user_mapping *um;
+   ASSERT(!is_preemption_enabled());
+
+   list_for_each_ro(um, &i->mappings_list, inode_node) {
+      if ((size_t)b->offset >= um->off && (size_t)b->offset < um->off + um->len)
+         return true;
+   }
+
+   return false;
+}
+
+/*
+ * Decompress the block `b`, if compressed, in a new page. Called with
+ * preemption disabled (see the comment at the top), no matter if the inode
+ * is locked or not.
+ */
+static int ramfs_z_load_block(struct ramfs_block *b, bool mm)
+{
+   struct ramfs_zblob *zb = b->zblob;
+   void *va;
+   int rc;
+
+   ASSERT(!is_preemption_enabled());
+
+   if (!zb)
+      return 0;         /* Already decompressed, maybe by another task */
+
+   if (!(va = kmalloc(PAGE_SIZE))) {
+      ramfs_z_stats.oom++;
+      return -ENOMEM;
+   }
+
+   rc = lz4_decompress(va, PAGE_SIZE, zb->data, zb->size);
+
+   if (rc != PAGE_SIZE)
+      panic("ramfs: corrupted compressed block at off %lld",
+            (long long)b->offset);
+
+   retain_pageframes_mapped_at(get_kernel_pdir(), va, PAGE_SIZE);
+   ramfs_z_free(zb);
+
+   b->zblob = NULL;
+   b->vaddr = va;
+   b->atime = get_ticks();
+
+   if (mm)
+      ramfs_z_stats.loads_mm++;
+   else
+      ramfs_z_stats.loads_rw++;
+
+   return 0;
+}
+
+static void ramfs_z_free_block_data(struct ramfs_block *b)
+{
+   disable_preemption();
+   {
+      ramfs_z_free(b->zblob);
+      b->zblob = NULL;
+   }
+   enable_preemption();
+}
+
+/*
+ * Make sure that the block's data is in memory, for a read or a write. The
+ * caller holds the inode lock, so the block cannot get compressed meanwhile.
+ */
+static int ramfs_block_get_data(struct ramfs_block *b)
+{
+   int rc = 0;
+
+   if (UNLIKELY(!b->vaddr)) {
+      disable_preemption();
+      {
+         rc = ramfs_z_load_block(b, false);
+      }
+      enable_preemption();
+   }
+
+   b->atime = get_ticks();
+   return rc;
+}
+
+/* Called with preemption disabled and the inode exclusively locked */
+static void
+ramfs_z_compress_block(struct ramfs_inode *i, struct ramfs_block *b, u64 now)
+{
+   struct ramfs_zblob *zb;
+   int rc;
+
+   ASSERT(!is_preemption_enabled());
+   ASSERT(b->vaddr && !b->zblob);
+
+   if (ramfs_z_is_block_mapped(i, b))
+      return;
+
+   rc = lz4_compress_ht(ramfs_z_buf, RAMFS_Z_MAX_BLOB_SIZE,
+                        b->vaddr, PAGE_SIZE, ramfs_z_ht, RAMFS_Z_HASH_BITS);
+
+   if (rc < 0) {
+
+      /* Not compressible enough: retry only after another idle period */
+      ramfs_z_stats.rejected++;
+      b->atime = now;
+      return;
+   }
+
+   if (!(zb = ramfs_z_alloc(b, (u32)rc)))
+      return;
+
+   memcpy(zb->data, ramfs_z_buf, (size_t)rc);
+
+   release_pageframes_mapped_at(get_kernel_pdir(), b->vaddr, PAGE_SIZE);
+   kfree2(b->vaddr, PAGE_SIZE);
+
+   b->vaddr = NULL;
+   b->zblob = zb;
+   ramfs_z_stats.compressed++;
+}
+
+static void ramfs_z_compress_inode(struct ramfs_inode *i, u64 now, u64 idle)
+{
+   struct bintree_walk_ctx ctx;
+   struct ramfs_block *b;
+
+   ASSERT(rwlock_wp_holding_exlock(&i->rwlock));
+
+   bintree_in_order_visit_start(&ctx,
+                                i->blocks_tree_root,
+                                struct ramfs_block,
+                                node,
+                                false);
+
+   while ((b = bintree_in_order_visit_next(&ctx))) {
+
+      if (!b->vaddr || now - b->atime < idle)
+         continue;
+
+      disable_preemption();
+      {
+         ramfs_z_compress_block(i, b, now);
+      }
+      enable_preemption();
+   }
+}
+
+/* ---------------------------- thread --------------------------------- */
+
+static void ramfs_z_scan(void)
+{
+   const u64 idle = (u64)kopt_ramfs_zidle * KRN_TIMER_HZ;
+   const u64 now = get_ticks();
+   struct ramfs_inode *i;
+
+   kmutex_lock(&ramfs_z_files_lock);
+   {
+      list_for_each_ro(i, &ramfs_z_files, z_node) {
+
+         if (!i->blocks_count)
+            continue;
+
+         if (!rwlock_wp_try_exlock(&i->rwlock)) {
+            ramfs_z_stats.busy_skips++;
+            continue;
+         }
+
+         ramfs_z_compress_inode(i, now, idle);
+         rwlock_wp_exunlock(&i->rwlock);
+      }
+   }
+   kmutex_unlock(&ramfs_z_files_lock);
+
+   ramfs_z_compact();
+}
+
+static void ramfs_z_thread(void *unused)
+{
+   while (true) {
+      kernel_sleep(RAMFS_Z_SCAN_INTERVAL_SECS * KRN_TIMER_HZ);
+      ramfs_z_scan();
+   }
+}
+
+static void ramfs_z_init(void)
+{
+   if (ramfs_z_thread_started || kopt_ramfs_zidle <= 0)
+      return;
+
+   ramfs_z_ht = kmalloc(sizeof(u32) << RAMFS_Z_HASH_BITS);
+   ramfs_z_buf = kmalloc(RAMFS_Z_MAX_BLOB_SIZE);
+
+   if (!ramfs_z_ht || !ramfs_z_buf)
+      goto oom;
+
+   if (kthread_create(&ramfs_z_thread, 0, NULL) < 0)
+      goto oom;
+
+   ramfs_z_thread_started = true;
+   return;
+
+oom:
+   printk("WARNING: ramfs: unable to start the compression thread\n");
+
+   if (ramfs_z_ht)
+      kfree2(ramfs_z_ht, sizeof(u32) << RAMFS_Z_HASH_BITS);
+
+   if (ramfs_z_buf)
+      kfree2(ramfs_z_buf, RAMFS_Z_MAX_BLOB_SIZE);
+
+   ramfs_z_ht = NULL;
+   ramfs_z_buf = NULL;
+}
+
+static void ramfs_z_add_file(struct ramfs_inode *i)
+{
+   kmutex_lock(&ramfs_z_files_lock);
+   {
+      list_add_tail(&ramfs_z_files, &i->z_node);
+   }
+   kmutex_unlock(&ramfs_z_files_lock);
+}
+
+static void ramfs_z_remove_file(struct ramfs_inode *i)
+{
+   kmutex_lock(&ramfs_z_files_lock);
+   {
+      list_remove(&i->z_node);
+   }
+   kmutex_unlock(&ramfs_z_files_lock);
+}
+
+/* ----------------------------- sysfs --------------------------------- */
+
+#if MOD_sysfs
+
+#include <tilck/mods/sysfs.h>
+#include <tilck/mods/sysfs_utils.h>
+
+static offt
+ramfs_z_get_buf_sz(struct sysobj *obj, void *data)
+{
+   return 1024;
+}
+
+/*
+ * The compression ratio is computed on the blocks currently compressed,
+ * while the arena usage shows how much memory they really take, including
+ * the garbage left by the freed blobs.
+ */
+static offt
+ramfs_z_load(struct sysobj *obj, void *data, void *buf, offt sz, offt off)
+{
+   struct ramfs_z_stats s;
+   size_t used = 0;
+   u64 orig, arena, ratio;
+
+   disable_preemption();
+   {
+      s = ramfs_z_stats;
+   }
+   enable_preemption();
+
+   orig = (u64)s.blocks * PAGE_SIZE;
+   arena = (u64)s.chunks * RAMFS_Z_CHUNK_SIZE;
+   ratio = s.zbytes ? orig * 100 / s.zbytes : 0;
+
+#define WR(...)                                                      \
+   used += (size_t)snprintk((char *)buf + used,                      \
+                            (size_t)sz - used, __VA_ARGS__)
+
+   WR("enabled:          %s\n", ramfs_z_thread_started ? "yes" : "no");
+   WR("idle_secs:        %ld\n", kopt_ramfs_zidle);
+   WR("blocks:           %u\n", s.blocks);
+   WR("orig_bytes:       %llu\n", orig);
+   WR("zbytes:           %llu\n", s.zbytes);
+   WR("ratio:            %llu.%02llu\n", ratio / 100, ratio % 100);
+   WR("arena_bytes:      %llu\n", arena);
+   WR("arena_chunks:     %u\n", s.chunks);
+   WR("compressed:       %llu\n", s.compressed);
+   WR("rejected:         %llu\n", s.rejected);
+   WR("loads_rw:         %llu\n", s.loads_rw);
+   WR("loads_mm:         %llu\n", s.loads_mm);
+   WR("moved:            %llu\n", s.moved);
+   WR("busy_skips:       %llu\n", s.busy_skips);
+   WR("oom:              %llu\n", s.oom);
+
+#undef WR
+
+   return (offt)used;
+}
+
+static const struct sysobj_prop_type ramfs_z_prop_type = {
+   .buf_type   = SYSFS_BUF_BUFFERED,
+   .get_buf_sz = &ramfs_z_get_buf_sz,
+   .load       = &ramfs_z_load,
+};
+
+DEF_STATIC_SYSOBJ_PROP(compression, &ramfs_z_prop_type);
+
+DEF_STATIC_SYSOBJ_TYPE(ramfs_sysobj_type,
+                       &prop_compression,
+                       NULL);
+
+void register_ramfs_sysfs(void)
+{
+   struct sysobj *obj;
+
+   obj = sysfs_create_obj(&ramfs_sysobj_type,
+                          NULL,                   /* hooks */
+                          NULL);                  /* compression */
+
+   if (!obj)
+      return;
+
+   if (sysfs_register_obj(NULL, &sysfs_root_obj, "ramfs", obj) < 0)
+      sysfs_destroy_unregistered_obj(obj);
+}
+
+#else  /* !MOD_sysfs */
+
+void register_ramfs_sysfs(void) { /* no-op */ }
+
+#endif /* MOD_sysfs */
+
+#else  /* !KRN_RAMFS_COMPRESSION */
+
+static inline void ramfs_z_init(void) { }
+static inline void ramfs_z_add_file(struct ramfs_inode *i) { }
+static inline void ramfs_z_remove_file(struct ramfs_inode *i) { }
+
+static inline int ramfs_z_load_block(struct ramfs_block *b, bool mm) {
+   return 0;
+}
+
+static inline void ramfs_z_free_block_data(struct ramfs_block *b) { }
+
+static inline int ramfs_block_get_data(struct ramfs_block *b) {
+   return 0;
+}
+
+void register_ramfs_sysfs(void) { /* no-op */ }
+
+#endif /* KRN_RAMFS_COMPRESSION */
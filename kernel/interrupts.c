@@ -38,6 +38,14 @@ static ALWAYS_INLINE void dec_irq_count(void)
    ASSERT(oldval > 0);
 }
 
+/* Registers of the context interrupted by the innermost IRQ */
+static regs_t *curr_irq_regs;
+
+regs_t *get_irq_regs(void)
+{
+   return curr_irq_regs;
+}
+
 #if KRN_TRACK_NESTED_INTERR
 
 static int nested_interrupts_count;
@@ -196,6 +204,9 @@ static void irq_resched(regs_t *r)
 
 void irq_entry(regs_t *r)
 {
+   /* The CPU disabled the interrupts: open an irqs-off section, if tracing */
+   const bool irqsoff_opened = IRQSOFF_TRACE_ENTRY();
+
    ASSERT(get_curr_task() != NULL);
    DEBUG_check_not_same_interrupt_nested(regs_intnum(r));
 
@@ -209,7 +220,12 @@ void irq_entry(regs_t *r)
    inc_irq_count();
 
    /* Call the arch-dependent IRQ handling logic */
-   arch_irq_handling(r);
+   {
+      regs_t *const prev_irq_regs = curr_irq_regs;
+      curr_irq_regs = r;
+      arch_irq_handling(r);
+      curr_irq_regs = prev_irq_regs;
+   }
 
    /* Decrease the always-enabled in_irq_count counter */
    dec_irq_count();
@@ -229,6 +245,7 @@ void irq_entry(regs_t *r)
     * re-enable the preemption and return.
     */
    enable_preemption_nosched();
+   IRQSOFF_TRACE_EXIT(irqsoff_opened);
 }
 
 void syscall_entry(regs_t *r)
@@ -238,6 +255,8 @@ void syscall_entry(regs_t *r)
     * the nested interrupts (debug feature). The preemption must always be
     * enabled here.
     */
+   const bool irqsoff_opened = IRQSOFF_TRACE_ENTRY();
+
    ASSERT(!are_interrupts_enabled());
    ASSERT(is_preemption_enabled());
 
@@ -252,6 +271,7 @@ void syscall_entry(regs_t *r)
    pop_nested_interrupt();
 
    ASSERT(is_preemption_enabled());
+   IRQSOFF_TRACE_EXIT(irqsoff_opened);
 }
 
 void fault_entry(regs_t *r)
@@ -260,7 +280,12 @@ void fault_entry(regs_t *r)
     * Here preemption could be either enabled or disabled. Typically is enabled,
     * but it's totally possible for example a page fault to occur in the kernel
     * while preemption is disabled.
+    *
+    * Same for the interrupts: a fault can happen inside an irqs-off section.
+    * In that case, IRQSOFF_TRACE_ENTRY() won't open a new section and the
+    * one already open will continue after the `iret`.
     */
+   const bool irqsoff_opened = IRQSOFF_TRACE_ENTRY();
    ASSERT(!are_interrupts_enabled());
 
    get_curr_task()->running_in_kernel++;
@@ -282,5 +307,6 @@ void fault_entry(regs_t *r)
    enable_preemption();
    disable_interrupts_forced();
    get_curr_task()->running_in_kernel--;
+   IRQSOFF_TRACE_EXIT(irqsoff_opened);
 }
 
@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck_gen_headers/mod_sysfs.h>
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/printk.h>
+
+#include <tilck/kernel/irq_poll.h>
+#include <tilck/kernel/worker_thread.h>
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/sched.h>
+#include <tilck/kernel/errno.h>
+
+#if MOD_sysfs
+   #include <tilck/mods/sysfs.h>
+   #include <tilck/mods/sysfs_utils.h>
+#endif
+
+#define IRQ_POLL_MAX_POLLERS                   16
+
+static struct list all_irq_polls = STATIC_LIST_INIT(all_irq_polls);
+static int irq_polls_count;
+
+void
+irq_poll_init(struct irq_poll *ip,
+              const char *name,
+              struct worker_thread *wth,
+              irq_poll_func poll,
+              irq_poll_set_irq_func set_irq,
+              void *ctx,
+              int budget)
+{
+   ASSERT(budget > 0);
+
+   *ip = (struct irq_poll) {
+      .name = name,
+      .wth = wth,
+      .poll = poll,
+      .set_irq = set_irq,
+      .ctx = ctx,
+      .budget = budget,
+   };
+
+   list_node_init(&ip->node);
+
+   disable_preemption();
+   {
+      if (irq_polls_count < IRQ_POLL_MAX_POLLERS) {
+         list_add_tail(&all_irq_polls, &ip->node);
+         irq_polls_count++;
+      }
+   }
+   enable_preemption();
+}
+
+/* Leave the polled mode. Must be called with interrupts disabled. */
+static void
+irq_poll_complete(struct irq_poll *ip)
+{
+   /*
+    * Clearing `scheduled` and enabling the IRQ must happen atomically for the
+    * IRQ handler: it must not see `scheduled` set once the IRQ is enabled,
+    * otherwise it would skip the schedule and the new work would be stranded.
+    */
+   ip->scheduled = false;
+   ip->set_irq(ip, true);
+}
+
+static void
+irq_poll_job(void *arg)
+{
+   struct irq_poll *ip = arg;
+   ulong var;
+   int done;
+
+   done = ip->poll(ip, ip->budget);
+
+   ip->polls++;
+   ip->work += (u64)MAX(done, 0);
+
+   if (done >= ip->budget) {
+
+      /*
+       * Used all the budget: there's likely more work to do. Stay in polled
+       * mode, but re-enqueue ourselves instead of looping here, in order to
+       * let the other jobs of this worker run.
+       */
+      ip->budget_exhausted++;
+
+      if (wth_requeue_self(ip->wth, &irq_poll_job, ip))
+         return;
+
+      ip->enqueue_failures++;
+   }
+
+   disable_interrupts(&var);
+   {
+      irq_poll_complete(ip);
+   }
+   enable_interrupts(&var);
+}
+
+bool
+irq_poll_schedule(struct irq_poll *ip)
+{
+   bool already_scheduled;
+   ulong var;
+
+   disable_interrupts(&var);
+   {
+      ip->irqs++;
+      already_scheduled = ip->scheduled;
+
+      if (!already_scheduled) {
+         ip->set_irq(ip, false);
+         ip->scheduled = true;
+      }
+   }
+   enable_interrupts(&var);
+
+   if (already_scheduled || wth_enqueue_on(ip->wth, &irq_poll_job, ip))
+      return true;
+
+   disable_interrupts(&var);
+   {
+      ip->enqueue_failures++;
+      irq_poll_complete(ip);
+   }
+   enable_interrupts(&var);
+   return false;
+}
+
+#if MOD_sysfs
+
+#define IRQ_POLL_REPORT_LINE_MAX                 128
+
+static offt
+irq_poll_report_get_buf_sz(struct sysobj *obj, void *data)
+{
+   return (IRQ_POLL_MAX_POLLERS + 2) * IRQ_POLL_REPORT_LINE_MAX;
+}
+
+/*
+ * One line per poller. `irqs` vs `polls` shows how many IRQs have been saved
+ * by the polled mode, `work/poll` the average batch size.
+ */
+static offt
+irq_poll_report_load(struct sysobj *obj, void *d, void *buf, offt sz, offt off)
+{
+   struct irq_poll *pos;
+   size_t used = 0;
+
+#define WR(...)                                                      \
+   used += (size_t)snprintk((char *)buf + used,                      \
+                            (size_t)sz - used, __VA_ARGS__)
+
+   WR("%-10s %6s %10s %10s %10s %8s %12s %9s\n",
+      "name", "budget", "irqs", "polls", "exhausted", "failures",
+      "work", "work/poll");
+
+   disable_preemption();
+   {
+      list_for_each_ro(pos, &all_irq_polls, node) {
+         WR("%-10s %6d %10u %10u %10u %8u %12llu %9llu\n",
+            pos->name, pos->budget, pos->irqs, pos->polls,
+            pos->budget_exhausted, pos->enqueue_failures, pos->work,
+            pos->polls ? pos->work / pos->polls : 0);
+      }
+   }
+   enable_preemption();
+
+#undef WR
+
+   return (offt)used;
+}
+
+static const struct sysobj_prop_type irq_poll_report_prop_type = {
+   .buf_type   = SYSFS_BUF_BUFFERED,
+   .get_buf_sz = &irq_poll_report_get_buf_sz,
+   .load       = &irq_poll_report_load,
+};
+
+DEF_STATIC_SYSOBJ_PROP(stats, &irq_poll_report_prop_type);
+
+DEF_STATIC_SYSOBJ_TYPE(irq_poll_sysobj_type,
+                       &prop_stats,
+                       NULL);
+
+void register_irq_poll_sysfs(void)
+{
+   struct sysobj *obj;
+
+   obj = sysfs_create_obj(&irq_poll_sysobj_type,
+                          NULL,                   /* hooks */
+                          NULL);                  /* stats */
+
+   if (!obj)
+      return;
+
+   if (sysfs_register_obj(NULL, &sysfs_root_obj, "irq_poll", obj) < 0)
+      sysfs_destroy_unregistered_obj(obj);
+}
+
+#else  /* !MOD_sysfs */
+
+void register_irq_poll_sysfs(void) { /* no-op */ }
+
+#endif /* MOD_sysfs */
@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+
+#include <tilck/kernel/irq_stats.h>
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/test/irq_stats.h>
+
+/*
+ * Everything here runs with interrupts disabled, except for the readers,
+ * which disable them on their own: on a single CPU, that's enough to keep
+ * the 64-bit counters consistent on i386 too.
+ *
+ * Each level of nesting has a start timestamp and the cycles spent by the
+ * IRQs nested into it: when a handler returns, its total time is added to
+ * its parent's nested time, while only its own time (total - nested) gets
+ * accounted to its IRQ.
+ */
+
+struct irq_stats_frame {
+   u64 start;
+   u64 nested_cycles;
+};
+
+static struct irq_line_stats all_stats[IRQ_STATS_MAX_IRQS];
+static struct irq_stats_frame frames[IRQ_STATS_MAX_NESTING];
+static u32 depth;
+static u32 max_depth;
+
+u32 irq_stats_hist_bucket(u64 cycles)
+{
+   const u32 hi = (u32)(cycles >> 32);
+   const u32 lo = (u32)cycles;
+   u32 b;
+
+   if (hi)
+      b = 32 + (31 - (u32)__builtin_clz(hi));
+   else if (lo)
+      b = 31 - (u32)__builtin_clz(lo);
+   else
+      b = 0;
+
+   return MIN(b, (u32)IRQ_STATS_HIST_BUCKETS - 1);
+}
+
+STATIC void irq_stats_push(u64 now)
+{
+   if (depth < IRQ_STATS_MAX_NESTING)
+      frames[depth] = (struct irq_stats_frame) { .start = now };
+
+   depth++;
+   max_depth = MAX(max_depth, depth);
+}
+
+STATIC void irq_stats_pop(int irq, u64 now)
+{
+   struct irq_stats_frame *f;
+   struct irq_line_stats *s;
+   u64 tot, self;
+
+   ASSERT(depth > 0);
+   depth--;
+
+   if (depth >= IRQ_STATS_MAX_NESTING)
+      return;           /* too deep: not tracked */
+
+   f = &frames[depth];
+   tot = now - f->start;
+   self = tot - MIN(f->nested_cycles, tot);
+
+   if (depth > 0)
+      frames[depth - 1].nested_cycles += tot;
+
+   if (irq < 0 || irq >= IRQ_STATS_MAX_IRQS)
+      return;
+
+   s = &all_stats[irq];
+   s->count++;
+   s->tot_cycles += self;
+   s->max_cycles = MAX(s->max_cycles, self);
+   s->hist[irq_stats_hist_bucket(self)]++;
+}
+
+void irq_stats_enter(void)
+{
+   ASSERT(!are_interrupts_enabled());
+   irq_stats_push(RDTSC());
+}
+
+void irq_stats_exit(int irq)
+{
+   ASSERT(!are_interrupts_enabled());
+   irq_stats_pop(irq, RDTSC());
+}
+
+void irq_stats_spurious(int irq)
+{
+   if (0 <= irq && irq < IRQ_STATS_MAX_IRQS)
+      all_stats[irq].spurious++;
+}
+
+void irq_stats_get(int irq, struct irq_line_stats *out)
+{
+   ulong var;
+   ASSERT(0 <= irq && irq < IRQ_STATS_MAX_IRQS);
+
+   disable_interrupts(&var);
+   {
+      *out = all_stats[irq];
+   }
+   enable_interrupts(&var);
+}
+
+u32 irq_stats_max_nesting(void)
+{
+   return max_depth;
+}
+
+void irq_stats_reset(void)
+{
+   ulong var;
+
+   disable_interrupts(&var);
+   {
+      bzero(all_stats, sizeof(all_stats));
+      max_depth = depth;
+   }
+   enable_interrupts(&var);
+}
@@ -0,0 +1,223 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Use the plain IRQ-state primitives in this file: the hooks below must never
+ * recurse into themselves. See <tilck/kernel/irqsoff.h>.
+ */
+#define __IRQSOFF_TRACER_IMPL__
+
+#include <tilck_gen_headers/config_debug.h>
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/printk.h>
+
+#include <tilck/kernel/irqsoff.h>
+#include <tilck/kernel/elf_utils.h>
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/test/irqsoff.h>
+
+/*
+ * Interrupts-off and preemption-off latency tracer.
+ *
+ * Each kind of section (irqs-off, preempt-off) has at most one section open
+ * at a time: the begin hooks are ignored while a section is already open and
+ * the end hooks are ignored when there's none. That's what makes the tracer
+ * robust against the transitions it cannot see: for example, the kernel
+ * starts with the interrupts disabled by the bootloader and with
+ * __disable_preempt == 1, so the first end events have no matching begin.
+ *
+ * Everything runs with the interrupts disabled, which on a single CPU is
+ * enough to keep the open sections and the stats consistent. The preemption
+ * hooks might be called with the interrupts enabled: they disable them on
+ * their own, with the plain (untraced) primitives.
+ */
+
+struct irqsoff_open_section {
+   bool open;
+   u64 begin_tsc;
+   ulong begin_ip;
+};
+
+static struct irqsoff_open_section open_sections[IRQSOFF_KINDS_COUNT];
+static struct irqsoff_stats all_stats[IRQSOFF_KINDS_COUNT];
+
+u32 irqsoff_hist_bucket(u64 cycles)
+{
+   const u32 hi = (u32)(cycles >> 32);
+   const u32 lo = (u32)cycles;
+   u32 b;
+
+   if (hi)
+      b = 32 + (31 - (u32)__builtin_clz(hi));
+   else if (lo)
+      b = 31 - (u32)__builtin_clz(lo);
+   else
+      b = 0;
+
+   return MIN(b, (u32)IRQSOFF_HIST_BUCKETS - 1);
+}
+
+static void
+irqsoff_top_insert(struct irqsoff_stats *s, const struct irqsoff_site *n)
+{
+   struct irqsoff_site *top = s->top;
+   int i, pos = IRQSOFF_TOP_N - 1;
+
+   /* Keep at most one entry per (begin, end) site pair */
+   for (i = 0; i < IRQSOFF_TOP_N && top[i].cycles; i++) {
+
+      if (top[i].begin_ip == n->begin_ip && top[i].end_ip == n->end_ip) {
+
+         if (top[i].cycles >= n->cycles)
+            return;
+
+         pos = i;
+         break;
+      }
+   }
+
+   if (top[pos].cycles >= n->cycles)
+      return; /* Not long enough to enter the table */
+
+   /* Shift down the shorter entries, overwriting the one at `pos` */
+   for (i = pos; i > 0 && top[i - 1].cycles < n->cycles; i--)
+      top[i] = top[i - 1];
+
+   top[i] = *n;
+}
+
+static void
+irqsoff_begin(enum irqsoff_kind k, ulong ip)
+{
+   struct irqsoff_open_section *os = &open_sections[k];
+
+   if (os->open)
+      return;
+
+   os->open = true;
+   os->begin_ip = ip;
+   os->begin_tsc = RDTSC();
+}
+
+STATIC void
+irqsoff_account(enum irqsoff_kind k, const struct irqsoff_site *site)
+{
+   struct irqsoff_stats *s = &all_stats[k];
+
+   s->count++;
+   s->tot_cycles += site->cycles;
+   s->max_cycles = MAX(s->max_cycles, site->cycles);
+   s->hist[irqsoff_hist_bucket(site->cycles)]++;
+   irqsoff_top_insert(s, site);
+}
+
+static void
+irqsoff_end(enum irqsoff_kind k, ulong ip)
+{
+   struct irqsoff_open_section *os = &open_sections[k];
+   const u64 now = RDTSC();
+
+   if (!os->open)
+      return;
+
+   os->open = false;
+
+   irqsoff_account(k, &(struct irqsoff_site) {
+      .cycles = now > os->begin_tsc ? now - os->begin_tsc : 0,
+      .begin_ip = os->begin_ip,
+      .end_ip = ip,
+   });
+}
+
+#define RET_IP()   ((ulong)__builtin_return_address(0))
+
+NO_INLINE void irqsoff_trace_irqs_off(void)
+{
+   irqsoff_begin(IRQSOFF_IRQS, RET_IP());
+}
+
+NO_INLINE void irqsoff_trace_irqs_on(void)
+{
+   irqsoff_end(IRQSOFF_IRQS, RET_IP());
+}
+
+NO_INLINE bool irqsoff_trace_entry(void)
+{
+   if (open_sections[IRQSOFF_IRQS].open)
+      return false;
+
+   irqsoff_begin(IRQSOFF_IRQS, RET_IP());
+   return true;
+}
+
+NO_INLINE void irqsoff_trace_exit(bool opened)
+{
+   if (opened)
+      irqsoff_end(IRQSOFF_IRQS, RET_IP());
+}
+
+NO_INLINE void irqsoff_trace_preempt_off(void)
+{
+   ulong var;
+   disable_interrupts(&var);
+   {
+      irqsoff_begin(IRQSOFF_PREEMPT, RET_IP());
+   }
+   enable_interrupts(&var);
+}
+
+void __irqsoff_trace_preempt_on(ulong ip)
+{
+   ulong var;
+   disable_interrupts(&var);
+   {
+      irqsoff_end(IRQSOFF_PREEMPT, ip);
+   }
+   enable_interrupts(&var);
+}
+
+NO_INLINE void irqsoff_trace_preempt_on(void)
+{
+   __irqsoff_trace_preempt_on(RET_IP());
+}
+
+void irqsoff_get_stats(enum irqsoff_kind k, struct irqsoff_stats *out)
+{
+   ulong var;
+   ASSERT(k < IRQSOFF_KINDS_COUNT);
+
+   disable_interrupts(&var);
+   {
+      *out = all_stats[k];
+   }
+   enable_interrupts(&var);
+}
+
+void irqsoff_reset_stats(enum irqsoff_kind k)
+{
+   ulong var;
+   ASSERT(k < IRQSOFF_KINDS_COUNT);
+
+   disable_interrupts(&var);
+   {
+      bzero(&all_stats[k], sizeof(all_stats[k]));
+   }
+   enable_interrupts(&var);
+}
+
+void irqsoff_ip_to_str(ulong ip, char *buf, size_t size)
+{
+   const char *sym;
+   long off = 0;
+
+   if (!ip) {
+      snprintk(buf, size, "-");
+      return;
+   }
+
+   if ((sym = find_sym_at_addr(ip, &off, NULL)))
+      snprintk(buf, size, "%s+%#lx", sym, (ulong)off);
+   else
+      snprintk(buf, size, "%p", TO_PTR(ip));
+}
@@ -214,3 +214,52 @@ void aligned_kfree2(void *ptr, size_t size)
 {
    general_kfree(ptr, &size, 0);
 }
+
+void *kmalloc_big_aligned_pages(size_t size)
+{
+   struct kmalloc_heap *h;
+   void *res = NULL;
+   ulong va;
+
+   ASSERT(kmalloc_initialized);
+   ASSERT(roundup_next_power_of_2(size) == size);
+   ASSERT(size > PAGE_SIZE);
+
+   /*
+    * The leak detector tracks whole chunks, while these are freed one page
+    * at a time: just don't support that case.
+    */
+   if (KRN_KMALLOC_SUPPORT_LEAK_DETECTOR && leak_detector_enabled)
+      return NULL;
+
+   disable_preemption();
+
+   for (int i = used_heaps - 1; i >= 0 && !res; i--) {
+
+      h = heaps[i];
+
+      if (h->dma || h->size < size || h->size - h->mem_allocated < size)
+         continue;
+
+      /*
+       * The heaps are not aligned at their size: try every `size`-aligned
+       * chunk in the heap. Because of the linear mapping, the physical
+       * address of the chunk is aligned as well.
+       */
+      for (va = pow2_round_up_at(h->vaddr, size);
+           va + size - 1 <= h->heap_last_byte;
+           va += size)
+      {
+         if (per_heap_kmalloc_at(h, (void *)va, size, PAGE_SIZE)) {
+            res = (void *)va;
+            break;
+         }
+      }
+   }
+
+   if (KRN_KMALLOC_HEAVY_STATS && res != NULL)
+      kmalloc_account_alloc(size);
+
+   enable_preemption();
+   return res;
+}
@@ -647,6 +647,171 @@ per_heap_kmalloc(struct kmalloc_heap *h, size_t *size, u32 flags)
    return res;
 }
 
+/*
+ * Size of the biggest block starting at `offset` (from the beginning of the
+ * heap) and fitting in `rem` bytes: blocks are always aligned at their size.
+ */
+static size_t
+max_aligned_block_size(ulong offset, size_t rem)
+{
+   size_t s = roundup_next_power_of_2(rem);
+
+   if (s > rem)
+      s >>= 1;
+
+   if (offset)
+      s = MIN(s, (size_t)(offset & (~offset + 1)));
+
+   return s;
+}
+
+static bool
+is_block_free_at(struct kmalloc_heap *h, ulong vaddr, size_t size)
+{
+   struct block_node *nodes = h->metadata_nodes;
+   ulong va = h->vaddr;
+   size_t s = h->size;
+   int n = 0;
+
+   while (s > size) {
+
+      if (!nodes[n].split)
+         return !nodes[n].full; /* the whole bigger block is free or not */
+
+      s >>= 1;
+
+      if (vaddr >= va + s) {
+         va += s;
+         n = NODE_RIGHT(n);
+      } else {
+         n = NODE_LEFT(n);
+      }
+   }
+
+   return is_block_node_free(nodes[n]);
+}
+
+static bool
+internal_kmalloc_at(struct kmalloc_heap *h,
+                    ulong vaddr,
+                    size_t size,
+                    bool do_actual_alloc)
+{
+   struct block_node *nodes = h->metadata_nodes;
+   ulong va = h->vaddr;
+   size_t s = h->size;
+   void *block;
+   int n = 0;
+
+   /* Split the nodes on the path from the root, like internal_kmalloc() */
+   while (s > size) {
+
+      nodes[n].split = true;
+      s >>= 1;
+
+      if (vaddr >= va + s) {
+         va += s;
+         n = NODE_RIGHT(n);
+      } else {
+         n = NODE_LEFT(n);
+      }
+   }
+
+   if (!actual_allocate_node(h, size, n, &block, do_actual_alloc)) {
+      size_t actual_size = size;
+      per_heap_kfree_unsafe(h, block, &actual_size, 0);
+      return false;
+   }
+
+   ASSERT((ulong)block == vaddr);
+
+   /* Mark the parent nodes as 'full', when necessary */
+   while (n > 0) {
+
+      n = NODE_PARENT(n);
+
+      if (!nodes[NODE_LEFT(n)].full || !nodes[NODE_RIGHT(n)].full)
+         break;
+
+      nodes[n].full = true;
+   }
+
+   if (do_actual_alloc)
+      h->mem_allocated += size;
+
+   return true;
+}
+
+static bool
+per_heap_kmalloc_at_unsafe(struct kmalloc_heap *h,
+                           ulong vaddr,
+                           size_t size,
+                           u32 flags)
+{
+   const bool do_actual_alloc = !(flags & KMALLOC_FL_NO_ACTUAL_ALLOC);
+   const u32 sub_blocks_min_size = flags & KMALLOC_FL_SUB_BLOCK_MIN_SIZE_MASK;
+   const ulong off = vaddr - h->vaddr;
+   size_t bs, tot;
+
+   ASSERT(!is_preemption_enabled());
+   ASSERT(size != 0);
+   ASSERT(pow2_round_up_at(size, h->min_block_size) == size);
+   ASSERT(!(vaddr & (h->min_block_size - 1)));
+
+   if (vaddr < h->vaddr || vaddr + size - 1 > h->heap_last_byte)
+      return false;
+
+   /* First, check that the whole range is free */
+   for (tot = 0; tot < size; tot += bs) {
+
+      bs = max_aligned_block_size(off + tot, size - tot);
+
+      if (!is_block_free_at(h, vaddr + tot, bs))
+         return false;
+   }
+
+   for (tot = 0; tot < size; tot += bs) {
+
+      bs = max_aligned_block_size(off + tot, size - tot);
+
+      if (!internal_kmalloc_at(h, vaddr + tot, bs, do_actual_alloc)) {
+
+         /* Roll-back: free the blocks allocated so far */
+         if (tot) {
+            per_heap_kfree_unsafe(h,
+                                  (void *)vaddr,
+                                  &tot,
+                                  KFREE_FL_MULTI_STEP | KFREE_FL_ALLOW_SPLIT);
+         }
+
+         return false;
+      }
+
+      if (sub_blocks_min_size && bs > sub_blocks_min_size) {
+         internal_kmalloc_split_block(h,
+                                      (void *)(vaddr + tot),
+                                      bs,
+                                      sub_blocks_min_size);
+      }
+   }
+
+   return true;
+}
+
+bool
+per_heap_kmalloc_at(struct kmalloc_heap *h, void *ptr, size_t size, u32 flags)
+{
+   bool res;
+   bool expected = false;
+
+   if (!atomic_cas_strong(&h->in_use, &expected, true))
+      return false; /* heap already in use (we're in IRQ context) */
+
+   res = per_heap_kmalloc_at_unsafe(h, (ulong)ptr, size, flags);
+   atomic_store(&h->in_use, false);
+   return res;
+}
+
 static void
 internal_kfree(struct kmalloc_heap *h,
                void *ptr,
@@ -821,14 +986,17 @@ per_heap_kfree_unsafe(struct kmalloc_heap *h,
    ASSERT(vaddr + size - 1 <= h->heap_last_byte);
    ASSERT(pow2_round_up_at(size, h->min_block_size) == size);
 
+   /*
+    * Free the biggest aligned blocks: for chunks returned by per_heap_kmalloc()
+    * they're the same sub-blocks it allocated, but that works also for chunks
+    * not aligned at their size, like the ones grown by per_heap_kmalloc_at().
+    */
+   const ulong off = vaddr - h->vaddr;
    size_t tot = 0;
 
-   for (int i = (int)h->heap_data_size_log2 - 1; i >= 0 && tot < size; i--) {
+   while (tot < size) {
 
-      const size_t sub_block_size = (1 << i);
-
-      if (!(size & sub_block_size))
-         continue;
+      const size_t sub_block_size = max_aligned_block_size(off + tot, size-tot);
 
       internal_kfree(h, ptr + tot, sub_block_size, allow_split, do_actual_free);
       tot += sub_block_size;
@@ -25,6 +25,7 @@
 #include <tilck/kernel/worker_thread.h>
 #include <tilck/kernel/fs/fat32.h>
 #include <tilck/kernel/fs/devfs.h>
+#include <tilck/kernel/fs/ramfs.h>
 #include <tilck/kernel/timer.h>
 #include <tilck/kernel/syscalls.h>
 #include <tilck/kernel/system_mmap.h>
@@ -36,6 +37,8 @@
 #include <tilck/kernel/fs/kernelfs.h>
 #include <tilck/kernel/fs/vfs.h>
 #include <tilck/kernel/uefi.h>
+#include <tilck/kernel/boot_trace.h>
+#include <tilck/kernel/ksm.h>
 
 #include <tilck/mods/console.h>
 #include <tilck/mods/fb_console.h>
@@ -50,6 +53,13 @@ static u32 saved_multiboot_magic;
 static multiboot_info_t *saved_multiboot_mbi;
 static void read_multiboot_info(void);
 
+/* Run an init stage and record its end in the boot trace */
+#define INIT_STAGE(func)                                              \
+   do {                                                               \
+      func();                                                         \
+      boot_trace(#func);                                              \
+   } while (0)
+
 static void
 save_multiboot_info(u32 magic, u32 mbi)
 {
@@ -211,16 +221,21 @@ read_multiboot_info(void)
    if (mbi->flags & MULTIBOOT_INFO_BOOT_LOADER_NAME) {
 
       const char *name = TO_PTR(mbi->boot_loader_name);
+      struct tilck_extra_boot_info *extra_boot_info = TO_PTR(mbi->apm_table);
 
       if (!strcmp(name, "TILCK_EFI")) {
 
-         struct tilck_extra_boot_info *extra_boot_info = TO_PTR(mbi->apm_table);
-
          printk("Multiboot: detected the TILCK_EFI bootloader\n");
          printk("Multiboot: ACPI RSDP: %p\n", TO_PTR(extra_boot_info->RSDP));
          printk("Multiboot: UEFI RT:   %p\n", TO_PTR(extra_boot_info->RT));
          acpi_set_root_pointer(extra_boot_info->RSDP);
          uefi_set_rt_pointer(extra_boot_info->RT);
+         boot_trace_import(&extra_boot_info->trace);
+
+      } else if (!strcmp(name, "TILCK_LEGACY")) {
+
+         printk("Multiboot: detected the TILCK_LEGACY bootloader\n");
+         boot_trace_import(&extra_boot_info->trace);
       }
    }
 
@@ -263,9 +278,6 @@ out:
 static void
 mount_initrd(void)
 {
-   /* declare the ramfs_create() function */
-   struct mnt_fs *ramfs_create(void);
-
    struct mnt_fs *initrd, *ramfs;
    void *ramdisk;
    size_t ramdisk_size;
@@ -335,6 +347,9 @@ run_init_or_selftest(void)
 
       if (rc != 0)
          panic("execve('%s') failed with %i\n", cmd_args[0], rc);
+
+      boot_trace("first_execve");
+      init_deferred_modules();
    }
 }
 
@@ -343,10 +358,11 @@ static void do_async_init(void *unused)
    /* declare the show_hello_message() function */
    void show_hello_message(void);
 
-   mount_initrd();
-   init_devfs();
-   init_modules();
-   init_extra_debug_features();
+   INIT_STAGE(mount_initrd);
+   INIT_STAGE(init_devfs);
+   INIT_STAGE(init_modules);
+   INIT_STAGE(init_extra_debug_features);
+   INIT_STAGE(init_ksm);
 
    show_hello_message();
    run_init_or_selftest();
@@ -362,35 +378,37 @@ async_init(void)
 void
 kmain(u32 multiboot_magic, u32 mbi_addr)
 {
+   boot_trace("kmain");
    call_kernel_global_ctors();
    save_multiboot_info(multiboot_magic, mbi_addr);
 
-   early_init_serial_ports();
-   init_cpu_exception_handling();
-   early_init_paging();
-   early_init_kmalloc();
-
-   read_multiboot_info();
-   enable_cpu_features();
-   kmain_early_checks();
-   init_segmentation();
-   init_fpu_memcpy();
-   init_kmalloc();
-   init_paging();
-
-   setup_uefi_runtime_services();
-   acpi_mod_init_tables();
-
-   init_console();
-   init_self_tests();
-   init_irq_handling();
-   init_sched();
-   init_syscall_interfaces();
-   init_worker_threads();
-   init_timer();
-   init_system_time();
-   init_kernelfs();
-
+   INIT_STAGE(early_init_serial_ports);
+   INIT_STAGE(init_cpu_exception_handling);
+   INIT_STAGE(early_init_paging);
+   INIT_STAGE(early_init_kmalloc);
+
+   INIT_STAGE(read_multiboot_info);
+   INIT_STAGE(enable_cpu_features);
+   INIT_STAGE(kmain_early_checks);
+   INIT_STAGE(init_segmentation);
+   INIT_STAGE(init_fpu_memcpy);
+   INIT_STAGE(init_kmalloc);
+   INIT_STAGE(init_paging);
+
+   INIT_STAGE(setup_uefi_runtime_services);
+   INIT_STAGE(acpi_mod_init_tables);
+
+   INIT_STAGE(init_console);
+   INIT_STAGE(init_self_tests);
+   INIT_STAGE(init_irq_handling);
+   INIT_STAGE(init_sched);
+   INIT_STAGE(init_syscall_interfaces);
+   INIT_STAGE(init_worker_threads);
+   INIT_STAGE(init_timer);
+   INIT_STAGE(init_system_time);
+   INIT_STAGE(init_kernelfs);
+
+   boot_trace_timer_ready();
    async_init();
    do_schedule();
 }
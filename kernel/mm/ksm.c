@@ -0,0 +1,397 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Same-page merging of the private user pages (-ksm boot option).
+ *
+ * Many processes end up with byte-identical private pages: zero-filled BSS,
+ * heap and stack pages, the same data segments in many instances of the
+ * same program (e.g. busybox) and so on. Every KSM_SCAN_INTERVAL_MS, a timer
+ * enqueues on a dedicated lowest-priority worker thread a job scanning the
+ * next KSM_PAGES_PER_BATCH private pages, going round-robin over all the
+ * processes. Each page is hashed and looked up in a table of the pages seen
+ * in the current pass: when an identical one is found, both become read-only
+ * COW mappings of the same pageframe and the other pageframe is freed, if
+ * that was its last mapping. Zero-filled pages are merged with the kernel's
+ * zero_page instead. A write to a merged page is just a regular COW fault.
+ *
+ * The table is cleared at the end of every pass and its entries are only
+ * hints: before merging, the recorded page is checked to be still mapped
+ * with the same content. The whole batch runs with preemption disabled, so
+ * no user code can touch the pages in the meanwhile.
+ */
+
+#include <tilck_gen_headers/config_mm.h>
+#include <tilck_gen_headers/mod_sysfs.h>
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/printk.h>
+
+#include <tilck/kernel/ksm.h>
+#include <tilck/kernel/paging.h>
+#include <tilck/kernel/process.h>
+#include <tilck/kernel/process_mm.h>
+#include <tilck/kernel/sched.h>
+#include <tilck/kernel/timer.h>
+#include <tilck/kernel/worker_thread.h>
+#include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/cmdline.h>
+
+#if MOD_sysfs
+   #include <tilck/mods/sysfs.h>
+   #include <tilck/mods/sysfs_utils.h>
+#endif
+
+STATIC_ASSERT((KSM_TABLE_SIZE & (KSM_TABLE_SIZE - 1)) == 0);
+
+struct ksm_entry {
+   int pid;                  /* 0: empty slot */
+   u32 hash;
+   ulong vaddr;
+};
+
+struct ksm_stats {
+   u64 full_scans;
+   u64 pages_scanned;
+   u64 pages_merged;
+   u64 zero_pages_merged;
+   u64 frames_freed;
+};
+
+static struct worker_thread *ksm_wth;
+static struct ktimer ksm_timer;
+static struct ksm_entry *ksm_table;
+static u32 ksm_table_used;
+static u32 ksm_zero_hash;
+static struct ksm_stats ksm_stats;
+static u32 ksm_enqueue_failures;           /* timer IRQ context */
+
+/* Scan cursor: the process being scanned and the next vaddr in it */
+static int ksm_pid;
+static ulong ksm_vaddr;
+
+static u32 ksm_hash_page(const void *page)
+{
+   const u32 *p = page;
+   u32 h = 2166136261u;
+
+   for (u32 i = 0; i < PAGE_SIZE / sizeof(u32); i++)
+      h = (h ^ p[i]) * 16777619u;
+
+   return h;
+}
+
+/*
+ * Processes are looked up through their main thread, skipping the zombies
+ * (their pdir is gone). Vforked children share their parent's pdir: scanning
+ * the parent is enough.
+ */
+static bool ksm_can_scan(struct task *ti)
+{
+   if (!is_main_thread(ti) || is_kernel_thread(ti))
+      return false;
+
+   if (atomic_load(&ti->state) == TASK_STATE_ZOMBIE)
+      return false;
+
+   return !ti->pi->vforked && ti->pi->mi != NULL;
+}
+
+static struct process *ksm_get_proc(int pid)
+{
+   struct task *ti = get_task(pid);
+   return ti && ksm_can_scan(ti) ? ti->pi : NULL;
+}
+
+static int ksm_next_proc_cb(void *obj, void *arg)
+{
+   struct task *ti = obj;
+   int *pid_ref = arg;
+
+   if (ti->tid <= *pid_ref || !ksm_can_scan(ti))
+      return 0;
+
+   /* The tasks are visited in tid order: that's the next process */
+   *pid_ref = ti->tid;
+   return 1;
+}
+
+/* The pid of the first scannable process after `pid`, or 0 if none */
+static int ksm_next_pid(int pid)
+{
+   return iterate_over_tasks(&ksm_next_proc_cb, &pid) ? pid : 0;
+}
+
+/*
+ * Find the lowest vaddr >= `vaddr` in the private anonymous mappings of `pi`
+ * (ELF segments, stack, brk heap and anonymous mmaps) and the end of its
+ * mapping. Returns 0 when there's nothing left to scan.
+ */
+static ulong
+ksm_next_vaddr(struct process *pi, ulong vaddr, ulong *end_ref)
+{
+   struct user_mapping *um;
+   ulong best = 0;
+
+   list_for_each_ro(um, &pi->mi->mappings, pi_node) {
+
+      if (um->h || um->type == USER_MAPPING_VDSO)
+         continue;
+
+      if (vaddr >= um->vaddr + um->len)
+         continue;
+
+      if (!best || MAX(vaddr, um->vaddr) < best) {
+         best = MAX(vaddr, um->vaddr);
+         *end_ref = um->vaddr + um->len;
+      }
+   }
+
+   return best;
+}
+
+static void ksm_merge(pdir_t *pdir, ulong vaddr, ulong paddr)
+{
+   if (share_page_cow(pdir, (void *)vaddr, paddr))
+      ksm_stats.frames_freed++;
+
+   ksm_stats.pages_merged++;
+}
+
+/* The slot with the given hash or the first empty one. NULL: table full */
+static struct ksm_entry *ksm_lookup(u32 hash)
+{
+   u32 idx = hash & (KSM_TABLE_SIZE - 1);
+
+   for (u32 i = 0; i < KSM_TABLE_SIZE; i++) {
+
+      struct ksm_entry *e = &ksm_table[idx];
+
+      if (!e->pid || e->hash == hash)
+         return e;
+
+      idx = (idx + 1) & (KSM_TABLE_SIZE - 1);
+   }
+
+   return NULL;
+}
+
+static void ksm_scan_page(struct process *pi, ulong vaddr)
+{
+   const ulong zero_pa = KERNEL_VA_TO_PA(zero_page);
+   struct process *other;
+   struct ksm_entry *e;
+   ulong paddr, other_pa;
+   void *page;
+   u32 hash;
+
+   if (!get_private_user_page(pi->pdir, (void *)vaddr, &paddr))
+      return;
+
+   ksm_stats.pages_scanned++;
+
+   if (paddr == zero_pa)
+      return;
+
+   page = PA_TO_LIN_VA(paddr);
+   hash = ksm_hash_page(page);
+
+   if (hash == ksm_zero_hash && !memcmp(page, zero_page, PAGE_SIZE)) {
+      ksm_merge(pi->pdir, vaddr, zero_pa);
+      ksm_stats.zero_pages_merged++;
+      return;
+   }
+
+   if (!(e = ksm_lookup(hash)))
+      return;
+
+   if (!e->pid) {
+
+      /* Keep the table sparse enough for the linear probing */
+      if (ksm_table_used < KSM_TABLE_SIZE * 3 / 4) {
+         *e = (struct ksm_entry) { pi->pid, hash, vaddr };
+         ksm_table_used++;
+      }
+
+      return;
+   }
+
+   other = ksm_get_proc(e->pid);
+
+   if (!other ||
+       !get_private_user_page(other->pdir, (void *)e->vaddr, &other_pa) ||
+       other_pa == zero_pa)
+   {
+      /* Stale entry: replace it with the current page */
+      e->pid = pi->pid;
+      e->vaddr = vaddr;
+      return;
+   }
+
+   if (other_pa == paddr)
+      return; /* Already the same pageframe */
+
+   if (memcmp(page, PA_TO_LIN_VA(other_pa), PAGE_SIZE))
+      return; /* Hash collision or the other page changed */
+
+   /* Make the recorded page COW too, then point the current one to it */
+   share_page_cow(other->pdir, (void *)e->vaddr, other_pa);
+   ksm_merge(pi->pdir, vaddr, other_pa);
+}
+
+static void ksm_end_pass(void)
+{
+   bzero(ksm_table, sizeof(struct ksm_entry) * KSM_TABLE_SIZE);
+   ksm_table_used = 0;
+   ksm_pid = 0;
+   ksm_vaddr = 0;
+   ksm_stats.full_scans++;
+}
+
+static void ksm_scan_batch(void *unused)
+{
+   int budget = KSM_PAGES_PER_BATCH;
+   struct process *pi;
+   ulong va, end = 0;
+
+   disable_preemption();
+
+   while (budget > 0) {
+
+      pi = ksm_pid ? ksm_get_proc(ksm_pid) : NULL;
+
+      if (!pi || !(va = ksm_next_vaddr(pi, ksm_vaddr, &end))) {
+
+         /* Done with this process (or it's gone): move to the next one */
+         if (!(ksm_pid = ksm_next_pid(ksm_pid))) {
+            ksm_end_pass();
+            break;
+         }
+
+         ksm_vaddr = 0;
+         continue;
+      }
+
+      for (; va < end && budget > 0; va += PAGE_SIZE, budget--)
+         ksm_scan_page(pi, va);
+
+      ksm_vaddr = va;
+   }
+
+   enable_preemption();
+}
+
+static void ksm_timer_fire(struct ktimer *t, void *ctx)
+{
+   /* If the previous batch is still pending, that's the one that will run */
+   if (!wth_enqueue_once_on(ksm_wth, &ksm_scan_batch, NULL))
+      ksm_enqueue_failures++;
+
+   ktimer_arm(t, MAX(ms_to_ticks(KSM_SCAN_INTERVAL_MS), 1u));
+}
+
+void init_ksm(void)
+{
+   if (!kopt_ksm)
+      return;
+
+   if (!(ksm_table = kzmalloc(sizeof(struct ksm_entry) * KSM_TABLE_SIZE))) {
+      printk("ksm: not enough memory for the table\n");
+      return;
+   }
+
+   disable_preemption();
+   {
+      ksm_wth = wth_create_thread("ksm", WTH_PRIO_LOWEST, 4);
+   }
+   enable_preemption();
+
+   if (!ksm_wth) {
+      printk("ksm: unable to create the worker thread\n");
+      kfree2(ksm_table, sizeof(struct ksm_entry) * KSM_TABLE_SIZE);
+      ksm_table = NULL;
+      return;
+   }
+
+   ksm_zero_hash = ksm_hash_page(zero_page);
+   ktimer_init(&ksm_timer, &ksm_timer_fire, NULL, KTIMER_MODE_IRQ);
+   ktimer_arm(&ksm_timer, MAX(ms_to_ticks(KSM_SCAN_INTERVAL_MS), 1u));
+}
+
+#if MOD_sysfs
+
+#define KSM_REPORT_BUF_SZ                                    512
+
+static offt
+ksm_report_get_buf_sz(struct sysobj *obj, void *data)
+{
+   return KSM_REPORT_BUF_SZ;
+}
+
+static offt
+ksm_report_load(struct sysobj *obj, void *d, void *buf, offt sz, offt off)
+{
+   struct ksm_stats s;
+   size_t used = 0;
+
+#define WR(...)                                                      \
+   used += (size_t)snprintk((char *)buf + used,                      \
+                            (size_t)sz - used, __VA_ARGS__)
+
+   disable_preemption();
+   {
+      s = ksm_stats;
+   }
+   enable_preemption();
+
+   WR("enabled:            %s\n", ksm_wth ? "yes" : "no");
+   WR("full_scans:         %llu\n", s.full_scans);
+   WR("pages_scanned:      %llu\n", s.pages_scanned);
+   WR("pages_merged:       %llu\n", s.pages_merged);
+   WR("zero_pages_merged:  %llu\n", s.zero_pages_merged);
+   WR("frames_freed:       %llu\n", s.frames_freed);
+   WR("enqueue_failures:   %u\n", ksm_enqueue_failures);
+
+   /*
+    * Memory released by the merges so far. Writes to merged pages trigger
+    * COW copies and take some of it back.
+    */
+   WR("saved_kb:           %llu\n", s.frames_freed * (PAGE_SIZE / KB));
+
+#undef WR
+
+   return (offt)used;
+}
+
+static const struct sysobj_prop_type ksm_report_prop_type = {
+   .buf_type   = SYSFS_BUF_BUFFERED,
+   .get_buf_sz = &ksm_report_get_buf_sz,
+   .load       = &ksm_report_load,
+};
+
+DEF_STATIC_SYSOBJ_PROP(stats, &ksm_report_prop_type);
+
+DEF_STATIC_SYSOBJ_TYPE(ksm_sysobj_type,
+                       &prop_stats,
+                       NULL);
+
+void register_ksm_sysfs(void)
+{
+   struct sysobj *obj;
+
+   obj = sysfs_create_obj(&ksm_sysobj_type,
+                          NULL,                   /* hooks */
+                          NULL);                  /* stats */
+
+   if (!obj)
+      return;
+
+   if (sysfs_register_obj(NULL, &sysfs_root_obj, "ksm", obj) < 0)
+      sysfs_destroy_unregistered_obj(obj);
+}
+
+#else  /* !MOD_sysfs */
+
+void register_ksm_sysfs(void) { /* no-op */ }
+
+#endif /* MOD_sysfs */
@@ -11,12 +11,43 @@
 #include <tilck/kernel/kmalloc.h>
 #include <tilck/kernel/errno.h>
 #include <tilck/kernel/fs/devfs.h>
+#include <tilck/kernel/fs/vfs.h>
 #include <tilck/kernel/syscalls.h>
+#include <tilck/kernel/user.h>
 
 #include <sys/mman.h>      // system header
 
+#ifndef MREMAP_MAYMOVE
+   #define MREMAP_MAYMOVE 1   /* Linux's value, GNU-only in libc headers */
+#endif
+
 char page_size_buf[PAGE_SIZE] ALIGNED_AT(PAGE_SIZE);
 
+/*
+ * Check RLIMIT_AS and, for new writable private memory (`data`), RLIMIT_DATA
+ * before growing the address space of `pi` by `len` bytes.
+ */
+static bool
+mm_rlimits_allow(struct process *pi, size_t len, bool data)
+{
+   const u64 as_lim = get_process_rlimit(pi, RLIMIT_AS);
+   const u64 data_lim = get_process_rlimit(pi, RLIMIT_DATA);
+
+   ASSERT(!is_preemption_enabled());
+
+   if (as_lim != K_RLIM64_INFINITY) {
+      if (mm_get_vm_size(pi->mi) + len > as_lim)
+         return false;
+   }
+
+   if (data && data_lim != K_RLIM64_INFINITY) {
+      if (mm_get_data_size(pi->mi) + len > data_lim)
+         return false;
+   }
+
+   return true;
+}
+
 static void
 brk_syscall_int(struct process *pi, void *new_brk)
 {
@@ -101,8 +132,15 @@ void *sys_brk(void *new_brk)
    disable_preemption();
    {
       struct user_mapping *br = pi->mi->brk_region;
+      const size_t growth = (ulong)new_brk - (ulong)pi->brk;
 
       ASSERT(br != NULL);
+
+      if (new_brk > pi->brk && !mm_rlimits_allow(pi, growth, true)) {
+         enable_preemption();
+         return pi->brk;
+      }
+
       brk_syscall_int(pi, new_brk);
 
       /* Keep the brk region mapping's length in sync with the new break */
@@ -166,6 +204,27 @@ mmap_err_case_free(struct process *pi, void *ptr, size_t actual_len)
                   KFREE_FL_NO_ACTUAL_FREE);
 }
 
+static bool
+expand_mmap_heap(struct process *pi)
+{
+   struct kmalloc_heap *new_heap;
+   struct kmalloc_heap *h = pi->mi->mmap_heap;
+   size_t heap_sz = pi->mi->mmap_heap_size;
+
+   if (heap_sz == USER_MMAP_MAX_SZ)
+      return false; /* cannot expand the heap more than that */
+
+   new_heap = kmalloc_heap_dup_expanded(h, heap_sz * 2);
+
+   if (!new_heap)
+      return false; /* no enough memory */
+
+   pi->mi->mmap_heap_size = heap_sz * 2;
+   pi->mi->mmap_heap = new_heap;
+   kmalloc_destroy_heap(h);
+   return true;
+}
+
 static struct user_mapping *
 mmap_on_user_heap(struct process *pi,
                   size_t *actual_len_ref,
@@ -179,28 +238,15 @@ mmap_on_user_heap(struct process *pi,
 
    while (true) {
 
-      struct kmalloc_heap *new_heap;
-      struct kmalloc_heap *h = pi->mi->mmap_heap;
-      size_t heap_sz = pi->mi->mmap_heap_size;
-
-      res = per_heap_kmalloc(h,
+      res = per_heap_kmalloc(pi->mi->mmap_heap,
                              actual_len_ref,
                              per_heap_kmalloc_flags);
 
       if (LIKELY(res != NULL))
          break;        /* great! */
 
-      if (heap_sz == USER_MMAP_MAX_SZ)
-         return NULL; /* cannot expand the heap more than that */
-
-      new_heap = kmalloc_heap_dup_expanded(h, heap_sz * 2);
-
-      if (!new_heap)
-         return NULL; /* no enough memory */
-
-      pi->mi->mmap_heap_size = heap_sz * 2;
-      pi->mi->mmap_heap = new_heap;
-      kmalloc_destroy_heap(h);
+      if (!expand_mmap_heap(pi))
+         return NULL;
    }
 
    /* NOTE: here `handle` might be NULL (zero-map case) and that's OK */
@@ -214,6 +260,153 @@ mmap_on_user_heap(struct process *pi,
    return um;
 }
 
+static u32
+prot_to_pg_flags(int prot)
+{
+   u32 pg_flags = 0;
+
+   if (prot & (PROT_READ | PROT_WRITE | PROT_EXEC))
+      pg_flags |= PAGING_FL_US;
+
+   if (prot & PROT_WRITE)
+      pg_flags |= PAGING_FL_RW;
+
+   return pg_flags;
+}
+
+static int
+set_pages_prot(struct process *pi, ulong vaddr, ulong vend, int prot)
+{
+   /* Sticky: the user copies will check the page tables from now on */
+   if (!(prot & (PROT_READ | PROT_WRITE | PROT_EXEC)))
+      pi->mi->prot_none = true;
+
+   return set_user_pages_prot(pi->pdir,
+                              (void *)vaddr,
+                              (vend - vaddr) >> PAGE_SHIFT,
+                              prot_to_pg_flags(prot));
+}
+
+/*
+ * The anonymous pages are always mapped RW (zero page or not): restrict the
+ * ones in [vaddr, vend) according to `um->prot`, when that's not writable.
+ */
+static void
+apply_anon_mapping_prot(struct process *pi,
+                        struct user_mapping *um,
+                        ulong vaddr,
+                        ulong vend)
+{
+   ASSERT(!is_preemption_enabled());
+
+   if (um->prot & PROT_WRITE)
+      return;
+
+   /* Anonymous big pages exist only in writable mappings: nothing to split */
+   VERIFY(set_pages_prot(pi, vaddr, vend, um->prot) == 0);
+}
+
+/*
+ * Prefault the pages of `um` in [vaddr, vend): the anonymous pages still on
+ * the zero page get their own zeroed pageframe, while the file pages not
+ * mapped yet are mapped by the filesystem's fault handler.
+ */
+static int
+populate_user_range(struct process *pi,
+                    struct user_mapping *um,
+                    ulong vaddr,
+                    ulong vend)
+{
+   const ulong zero_pa = KERNEL_VA_TO_PA(zero_page);
+   ulong pa;
+   int rc;
+
+   ASSERT(!is_preemption_enabled());
+
+   if (!(um->prot & PROT_WRITE)) {
+
+      if (!um->h || !(um->prot & PROT_READ))
+         return 0; /* Read-only (or no access) zero pages: nothing to do */
+   }
+
+   for (; vaddr < vend; vaddr += PAGE_SIZE) {
+
+      if (um->h) {
+
+         if (is_mapped(pi->pdir, (void *)vaddr))
+            continue;
+
+         if (!vfs_handle_fault(um, (void *)vaddr, false, false))
+            break; /* Past EOF, there's nothing more to map */
+
+         continue;
+      }
+
+      if (get_mapping2(pi->pdir, (void *)vaddr, &pa) < 0 || pa != zero_pa)
+         continue;
+
+      unmap_page(pi->pdir, (void *)vaddr, false);
+
+      rc = map_page(pi->pdir,
+                    (void *)vaddr,
+                    0,
+                    PAGING_FL_RWUS | PAGING_FL_DO_ALLOC | PAGING_FL_ZERO_PG);
+
+      if (rc) {
+         /* Out of memory: put back the zero page. Its page table is there. */
+         VERIFY(map_zero_page(pi->pdir, (void *)vaddr, PAGING_FL_RWUS) == 0);
+         return rc;
+      }
+   }
+
+   return 0;
+}
+
+/*
+ * Drop the pages of `um` in [vaddr, vend): the anonymous pages go back to
+ * the zero page and their pageframes are freed (unless still shared), while
+ * the file pages are just unmapped and will be faulted-in again on access.
+ */
+static int
+dontneed_user_range(struct process *pi,
+                    struct user_mapping *um,
+                    ulong vaddr,
+                    ulong vend)
+{
+   const ulong zero_pa = KERNEL_VA_TO_PA(zero_page);
+   ulong pa;
+   int rc;
+
+   ASSERT(!is_preemption_enabled());
+
+   /* Before changing anything: then, unmapping single pages cannot fail */
+   if ((rc = split_user_big_pages(pi->pdir, (void *)vaddr, vend - vaddr)))
+      return rc;
+
+   for (; vaddr < vend; vaddr += PAGE_SIZE) {
+
+      if (get_mapping2(pi->pdir, (void *)vaddr, &pa) < 0)
+         continue;
+
+      if (um->h) {
+         unmap_page(pi->pdir, (void *)vaddr, false);
+         continue;
+      }
+
+      if (pa == zero_pa)
+         continue;
+
+      unmap_page(pi->pdir, (void *)vaddr, true);
+
+      if ((rc = map_zero_page(pi->pdir, (void *)vaddr, PAGING_FL_RWUS)))
+         return rc;
+
+      apply_anon_mapping_prot(pi, um, vaddr, vaddr + PAGE_SIZE);
+   }
+
+   return 0;
+}
+
 long
 sys_mmap_pgoff(void *addr, size_t len, int prot,
                int flags, int fd, size_t pgoffset)
@@ -235,7 +428,7 @@ sys_mmap_pgoff(void *addr, size_t len, int prot,
    if (addr)
       return -EINVAL; /* addr != NULL not supported */
 
-   if (!(prot & PROT_READ))
+   if (prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC))
       return -EINVAL;
 
    actual_len = pow2_round_up_at(len, PAGE_SIZE);
@@ -251,9 +444,6 @@ sys_mmap_pgoff(void *addr, size_t len, int prot,
       if (!(flags & MAP_PRIVATE))
          return -EINVAL;
 
-      if ((prot & (PROT_READ | PROT_WRITE)) != (PROT_READ | PROT_WRITE))
-         return -EINVAL;
-
       if (pgoffset != 0)
          return -EINVAL; /* pgoffset != 0 does not make sense here */
 
@@ -290,12 +480,14 @@ sys_mmap_pgoff(void *addr, size_t len, int prot,
 
    disable_preemption();
    {
-      um = mmap_on_user_heap(pi,
-                             &actual_len,
-                             handle,
-                             per_heap_kmalloc_flags,
-                             pgoffset << PAGE_SHIFT,
-                             prot);
+      if (mm_rlimits_allow(pi, actual_len, !handle && (prot & PROT_WRITE))) {
+         um = mmap_on_user_heap(pi,
+                                &actual_len,
+                                handle,
+                                per_heap_kmalloc_flags,
+                                pgoffset << PAGE_SHIFT,
+                                prot);
+      }
    }
    enable_preemption();
 
@@ -328,6 +520,22 @@ sys_mmap_pgoff(void *addr, size_t len, int prot,
 
       if (MMAP_NO_COW)
          bzero(um->vaddrp, actual_len);
+
+      disable_preemption();
+      {
+         apply_anon_mapping_prot(pi, um, um->vaddr, um->vaddr + actual_len);
+      }
+      enable_preemption();
+   }
+
+   if (flags & MAP_POPULATE) {
+
+      /* Like on Linux, failing to prefault is not an error for mmap() */
+      disable_preemption();
+      {
+         populate_user_range(pi, um, um->vaddr, um->vaddr + actual_len);
+      }
+      enable_preemption();
    }
 
    return (long)um->vaddr;
@@ -369,12 +577,16 @@ static int munmap_int(struct process *pi, void *vaddrp, size_t len)
    }
 
    const ulong um_vend = um->vaddr + um->len;
+   const bool whole = actual_len == um->len;
 
-   if (actual_len == um->len) {
-
-      process_remove_user_mapping(um);
+   /*
+    * Before changing anything: then, unmapping the single pages cannot fail.
+    * Note: the mmap heap frees the anonymous pages one by one.
+    */
+   if ((rc = split_user_big_pages(pi->pdir, vaddrp, actual_len)))
+      return rc;
 
-   } else {
+   if (!whole) {
 
       /* partial un-map */
 
@@ -436,6 +648,9 @@ static int munmap_int(struct process *pi, void *vaddrp, size_t len)
          vfs_mmap(um2, pi->pdir, VFS_MM_DONT_MMAP);
    }
 
+   if (whole)
+      process_remove_user_mapping(um);
+
    per_heap_kfree(pi->mi->mmap_heap,
                   vaddrp,
                   &actual_len,
@@ -470,3 +685,496 @@ int sys_munmap(void *vaddrp, size_t len)
    return rc;
 }
 
+/*
+ * Grow the anonymous mapping `um` in-place, allocating on the mmap heap the
+ * range right after its end, if that's free.
+ */
+static bool
+mremap_grow_in_place(struct process *pi, struct user_mapping *um, size_t len)
+{
+   const ulong um_end = um->vaddr + um->len;
+   const size_t delta = len - um->len;
+
+   if (um_end + delta > USER_MMAP_BEGIN + USER_MMAP_MAX_SZ)
+      return false;
+
+   while (um_end + delta > USER_MMAP_BEGIN + pi->mi->mmap_heap_size) {
+      if (!expand_mmap_heap(pi))
+         return false;
+   }
+
+   if (!per_heap_kmalloc_at(pi->mi->mmap_heap,
+                            (void *)um_end,
+                            delta,
+                            PAGE_SIZE))       /* sub-block min size */
+   {
+      return false;
+   }
+
+   if (MMAP_NO_COW)
+      bzero((void *)um_end, delta);
+
+   apply_anon_mapping_prot(pi, um, um_end, um_end + delta);
+   um->len = len;
+   return true;
+}
+
+/*
+ * Move [vaddr, vaddr + old_len) to a new anonymous mapping of `len` bytes,
+ * moving the page table entries instead of copying the data.
+ */
+static long
+mremap_move(struct process *pi,
+            ulong vaddr,
+            size_t old_len,
+            size_t len,
+            int prot)
+{
+   struct user_mapping *um;
+   size_t actual_len = len;
+   ulong off;
+   int rc;
+
+   /* Before changing anything: then, swapping single pages cannot fail */
+   if ((rc = split_user_big_pages(pi->pdir, (void *)vaddr, old_len)))
+      return rc;
+
+   um = mmap_on_user_heap(pi,
+                          &actual_len,
+                          NULL,
+                          KMALLOC_FL_MULTI_STEP | PAGE_SIZE,
+                          0,
+                          prot);
+
+   if (!um)
+      return -ENOMEM;
+
+   if (MMAP_NO_COW)
+      bzero(um->vaddrp + old_len, len - old_len);
+
+   apply_anon_mapping_prot(pi, um, um->vaddr + old_len, um->vaddr + len);
+
+   /*
+    * The old range gets the new (zero) pages, freed by munmap_int(). The big
+    * pages of the old range have been split above, while the new range has
+    * just been mapped on the zero page.
+    */
+   for (off = 0; off < old_len; off += PAGE_SIZE) {
+      VERIFY(swap_user_pages(pi->pdir,
+                             (void *)(vaddr + off),
+                             um->vaddrp + off) == 0);
+   }
+
+   if ((rc = munmap_int(pi, (void *)vaddr, old_len))) {
+
+      /* Out of memory splitting the old mapping: move the pages back */
+      for (off = 0; off < old_len; off += PAGE_SIZE) {
+         VERIFY(swap_user_pages(pi->pdir,
+                                (void *)(vaddr + off),
+                                um->vaddrp + off) == 0);
+      }
+
+      munmap_int(pi, um->vaddrp, actual_len);
+      return rc;
+   }
+
+   return (long)um->vaddr;
+}
+
+long
+sys_mremap(void *old_addr, size_t old_len, size_t len, int flags, void *addr)
+{
+   struct process *pi = get_curr_proc();
+   const ulong vaddr = (ulong)old_addr;
+   struct user_mapping *um;
+   long rc;
+
+   if (!IS_PAGE_ALIGNED(vaddr) || flags & ~MREMAP_MAYMOVE)
+      return -EINVAL; /* MREMAP_FIXED and MREMAP_DONTUNMAP not supported */
+
+   if (!old_len || !len || !pi->mi->mmap_heap)
+      return -EINVAL;
+
+   old_len = pow2_round_up_at(old_len, PAGE_SIZE);
+   len = pow2_round_up_at(len, PAGE_SIZE);
+
+   disable_preemption();
+
+   um = process_get_user_mapping(old_addr);
+
+   if (!um || vaddr + old_len > um->vaddr + um->len) {
+      rc = -EFAULT; /* [old_addr, old_addr + old_len) is not mapped */
+      goto out;
+   }
+
+   if (um->type != USER_MAPPING_MMAP || um->h) {
+      rc = -EINVAL; /* Only anonymous mmap()ed regions are supported */
+      goto out;
+   }
+
+   rc = (long)vaddr;
+
+   if (len < old_len) {
+
+      if (munmap_int(pi, old_addr + len, old_len - len))
+         rc = -ENOMEM;
+
+   } else if (len > old_len) {
+
+      if (!mm_rlimits_allow(pi, len - old_len, um->prot & PROT_WRITE)) {
+         rc = -ENOMEM;
+         goto out;
+      }
+
+      if (vaddr + old_len == um->vaddr + um->len &&
+          mremap_grow_in_place(pi, um, um->len + len - old_len))
+      {
+         goto out;
+      }
+
+      if (flags & MREMAP_MAYMOVE)
+         rc = mremap_move(pi, vaddr, old_len, len, um->prot);
+      else
+         rc = -ENOMEM;
+   }
+
+out:
+   enable_preemption();
+   return rc;
+}
+
+/*
+ * Make [vaddr, vend) a user_mapping on its own, splitting `um` in up to three
+ * parts. Returns the mapping of [vaddr, vend) or NULL if out of memory, in
+ * which case `um` is left untouched.
+ */
+static struct user_mapping *
+split_user_mapping(struct process *pi,
+                   struct user_mapping *um,
+                   ulong vaddr,
+                   ulong vend)
+{
+   const ulong um_end = um->vaddr + um->len;
+   struct user_mapping *mid = um, *tail = NULL;
+
+   if (vend < um_end) {
+
+      tail = new_user_mapping(&pi->mi->mappings,
+                              um->type,
+                              pi,
+                              um->h,
+                              (void *)vend,
+                              um_end - vend,
+                              um->off + (vend - um->vaddr),
+                              um->prot);
+      if (!tail)
+         return NULL;
+   }
+
+   if (vaddr > um->vaddr) {
+
+      mid = new_user_mapping(&pi->mi->mappings,
+                             um->type,
+                             pi,
+                             um->h,
+                             (void *)vaddr,
+                             vend - vaddr,
+                             um->off + (vaddr - um->vaddr),
+                             um->prot);
+      if (!mid) {
+
+         if (tail)
+            process_remove_user_mapping(tail);
+
+         return NULL;
+      }
+   }
+
+   um->len = (mid != um ? vaddr : vend) - um->vaddr;
+
+   if (um->h) {
+
+      /* Register the new parts in the file's list of mappings */
+      if (tail)
+         vfs_mmap(tail, pi->pdir, VFS_MM_DONT_MMAP);
+
+      if (mid != um)
+         vfs_mmap(mid, pi->pdir, VFS_MM_DONT_MMAP);
+   }
+
+   return mid;
+}
+
+static bool
+can_merge_user_mappings(struct user_mapping *a, struct user_mapping *b)
+{
+   if (a->type != b->type || a->h != b->h || a->prot != b->prot)
+      return false;
+
+   if (a->type == USER_MAPPING_HEAP || a->type == USER_MAPPING_VDSO)
+      return false;
+
+   if (a->vaddr + a->len != b->vaddr)
+      return false;
+
+   return !a->h || a->off + a->len == b->off;
+}
+
+/* Merge `um` with its neighbours, when compatible. Returns the result */
+static struct user_mapping *
+merge_user_mapping(struct user_mapping *um)
+{
+   struct user_mapping *prev = process_get_user_mapping(um->vaddrp - 1);
+   struct user_mapping *next = process_get_user_mapping(um->vaddrp + um->len);
+
+   if (next && can_merge_user_mappings(um, next)) {
+      um->len += next->len;
+      process_remove_user_mapping(next);
+   }
+
+   if (prev && can_merge_user_mappings(prev, um)) {
+      prev->len += um->len;
+      process_remove_user_mapping(um);
+      um = prev;
+   }
+
+   return um;
+}
+
+static int
+mprotect_check(struct user_mapping *um, int prot)
+{
+   int fl;
+
+   if (um->type == USER_MAPPING_VDSO)
+      return -EACCES;
+
+   if (um->h && (prot & PROT_WRITE)) {
+
+      fl = ((struct fs_handle_base *)um->h)->fl_flags;
+
+      /* Same check as mmap(): the file must be open for writing */
+      if (!(fl & O_WRONLY) && (fl & O_RDWR) != O_RDWR)
+         return -EACCES;
+   }
+
+   return 0;
+}
+
+static int
+mprotect_mapping(struct process *pi,
+                 struct user_mapping *um,
+                 ulong vaddr,
+                 ulong vend,
+                 int prot)
+{
+   const int old_prot = um->prot;
+   int rc;
+
+   /*
+    * The brk heap is never split, because `brk_region` must keep covering
+    * the whole heap: just change the protection of its pages.
+    */
+   if (um->type != USER_MAPPING_HEAP) {
+
+      if (prot == um->prot)
+         return 0;
+
+      if (!(um = split_user_mapping(pi, um, vaddr, vend)))
+         return -ENOMEM;
+
+      um->prot = prot;
+   }
+
+   /*
+    * Anonymous pages getting PROT_WRITE become COW when shared (zero page,
+    * fork, same-page merging), while the shared (file) pages just become
+    * writable again, as they can never be COW.
+    */
+   rc = set_pages_prot(pi, vaddr, vend, prot);
+
+   if (um->type != USER_MAPPING_HEAP) {
+
+      /* Out-of-memory splitting a big page: the pages are unchanged */
+      if (rc)
+         um->prot = old_prot;
+
+      merge_user_mapping(um);
+   }
+
+   return rc;
+}
+
+int sys_mprotect(void *addrp, size_t len, int prot)
+{
+   struct process *pi = get_curr_proc();
+   const ulong vaddr = (ulong)addrp;
+   struct user_mapping *um;
+   ulong va, vend, um_end;
+   int rc = 0;
+
+   if (!IS_PAGE_ALIGNED(vaddr))
+      return -EINVAL;
+
+   if (prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC))
+      return -EINVAL; /* PROT_GROWSDOWN and PROT_GROWSUP not supported */
+
+   len = pow2_round_up_at(len, PAGE_SIZE);
+   vend = vaddr + len;
+
+   if (vend < vaddr || vend > USERMODE_VADDR_END)
+      return -ENOMEM;
+
+   disable_preemption();
+
+   /* Like Linux, check the whole range before changing anything */
+   for (va = vaddr; va < vend; va = um->vaddr + um->len) {
+
+      if (!(um = process_get_user_mapping((void *)va))) {
+         rc = -ENOMEM;
+         goto out;
+      }
+
+      if ((rc = mprotect_check(um, prot)))
+         goto out;
+   }
+
+   for (va = vaddr; va < vend && !rc; va = um_end) {
+      um = process_get_user_mapping((void *)va);
+      um_end = MIN(vend, um->vaddr + um->len);
+      rc = mprotect_mapping(pi, um, va, um_end, prot);
+   }
+
+out:
+   enable_preemption();
+   return rc;
+}
+
+static int
+madvise_mapping(struct process *pi,
+                struct user_mapping *um,
+                ulong vaddr,
+                ulong vend,
+                int advice)
+{
+   const struct fs_handle_base *hb = um->h;
+
+   if (hb) {
+
+      if (advice == MADV_FREE)
+         return -EINVAL; /* Only for private anonymous memory */
+
+      if (!hb->fops->handle_fault)
+         return 0; /* Unmapped pages could not be faulted-in again */
+
+   } else if (um->type == USER_MAPPING_PROG || um->type == USER_MAPPING_VDSO) {
+
+      /*
+       * Not anonymous memory: after MADV_DONTNEED, the pages of the ELF
+       * segments should be read again from the file. Just keep them.
+       */
+      return 0;
+   }
+
+   switch (advice) {
+
+      case MADV_DONTNEED:
+      case MADV_FREE:
+         /* Freeing the pages immediately is a valid MADV_FREE behavior */
+         return dontneed_user_range(pi, um, vaddr, vend);
+
+      case MADV_WILLNEED:
+         return populate_user_range(pi, um, vaddr, vend);
+
+      default:
+         /* Other hints (MADV_NORMAL, MADV_SEQUENTIAL, ...): ignore them */
+         return 0;
+   }
+}
+
+int sys_madvise(void *addrp, size_t len, int advice)
+{
+   struct process *pi = get_curr_proc();
+   const ulong vaddr = (ulong)addrp;
+   struct user_mapping *um;
+   ulong va, vend, um_end;
+   int rc = 0;
+
+   if (!IS_PAGE_ALIGNED(vaddr))
+      return -EINVAL;
+
+   len = pow2_round_up_at(len, PAGE_SIZE);
+   vend = vaddr + len;
+
+   if (vend < vaddr || vend > USERMODE_VADDR_END)
+      return -EINVAL;
+
+   disable_preemption();
+
+   for (va = vaddr; va < vend && !rc; va = um_end) {
+
+      if (!(um = process_get_user_mapping((void *)va))) {
+         rc = -ENOMEM; /* Linux behavior for unmapped addresses */
+         break;
+      }
+
+      um_end = MIN(vend, um->vaddr + um->len);
+      rc = madvise_mapping(pi, um, va, um_end, advice);
+   }
+
+   enable_preemption();
+   return rc;
+}
+
+int sys_mincore(void *addrp, size_t len, u8 *user_vec)
+{
+   const ulong zero_pa = KERNEL_VA_TO_PA(zero_page);
+   struct process *pi = get_curr_proc();
+   const ulong vaddr = (ulong)addrp;
+   u8 buf[64];
+   ulong va, vend, pa;
+   u32 n = 0;
+   int rc = 0;
+
+   if (!IS_PAGE_ALIGNED(vaddr))
+      return -EINVAL;
+
+   len = pow2_round_up_at(len, PAGE_SIZE);
+   vend = vaddr + len;
+
+   if (vend < vaddr || vend > USERMODE_VADDR_END)
+      return -ENOMEM;
+
+   for (va = vaddr; va < vend; va += PAGE_SIZE) {
+
+      disable_preemption();
+      {
+         if (!process_get_user_mapping((void *)va)) {
+            rc = -ENOMEM;
+         } else {
+
+            /*
+             * A page is resident when it's backed by its own pageframe:
+             * untouched anonymous pages, mapped on the zero page, are not.
+             */
+            buf[n++] = get_mapping2(pi->pdir, (void *)va, &pa) == 0 &&
+                       (pa & PAGE_MASK) != zero_pa;
+         }
+      }
+      enable_preemption();
+
+      if (rc)
+         return rc;
+
+      if (n == sizeof(buf) || va + PAGE_SIZE == vend) {
+
+         if (copy_to_user(user_vec, buf, n))
+            return -EFAULT;
+
+         user_vec += n;
+         n = 0;
+      }
+   }
+
+   return 0;
+}
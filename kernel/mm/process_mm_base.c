@@ -3,6 +3,83 @@
 #include <tilck/kernel/process_mm.h>
 #include <tilck/kernel/process.h>
 #include <tilck/kernel/paging_hw.h>
+#include <tilck/kernel/errno.h>
+
+#include <sys/mman.h>      // system header
+
+/* All the mappings_info objects, for finding the one of a given pdir */
+static struct list all_mi_list = STATIC_LIST_INIT(all_mi_list);
+
+static void register_mappings_info(struct mappings_info *mi, pdir_t *pdir)
+{
+   mi->pdir = pdir;
+   mi->prot_none = false;
+   bzero(&mi->usage, sizeof(mi->usage));
+   list_node_init(&mi->node);
+
+   disable_preemption();
+   {
+      list_add_tail(&all_mi_list, &mi->node);
+   }
+   enable_preemption();
+}
+
+static struct mappings_info *get_pdir_mi(pdir_t *pdir)
+{
+   struct process *pi = get_curr_proc();
+   struct mappings_info *mi;
+
+   ASSERT(!is_preemption_enabled());
+
+   if (LIKELY(pi->pdir == pdir && pi->mi))
+      return pi->mi;
+
+   /*
+    * Slow path: an address space being built (execve) or the one of another
+    * process (e.g. ramfs dropping a block mapped by many processes).
+    */
+   list_for_each_ro(mi, &all_mi_list, node) {
+      if (mi->pdir == pdir)
+         return mi;
+   }
+
+   return NULL;
+}
+
+void mm_acct_user_pages(pdir_t *pdir, ulong paddr, bool shared, long n)
+{
+   struct mappings_info *mi;
+
+   if (paddr == KERNEL_VA_TO_PA(zero_page) || pdir == get_kernel_pdir())
+      return;
+
+   disable_preemption();
+
+   if ((mi = get_pdir_mi(pdir))) {
+
+      mi->usage.rss_pages += n;
+
+      if (shared)
+         mi->usage.shared_pages += n;
+   }
+
+   enable_preemption();
+}
+
+void mm_acct_page_tables(pdir_t *pdir, long n)
+{
+   struct mappings_info *mi;
+
+   if (pdir == get_kernel_pdir())
+      return;
+
+   disable_preemption();
+
+   if ((mi = get_pdir_mi(pdir)))
+      mi->usage.pt_pages += n;
+
+   enable_preemption();
+}
 
 struct user_mapping *
 new_user_mapping(struct list *mappings,
@@ -86,6 +163,53 @@ struct user_mapping *process_get_user_mapping(void *vaddrp)
    return NULL;
 }
 
+size_t mm_get_vm_size(struct mappings_info *mi)
+{
+   struct user_mapping *um;
+   size_t tot = 0;
+
+   ASSERT(!is_preemption_enabled());
+
+   list_for_each_ro(um, &mi->mappings, pi_node)
+      tot += um->len;
+
+   return tot;
+}
+
+size_t mm_get_data_size(struct mappings_info *mi)
+{
+   struct user_mapping *um;
+   size_t tot = 0;
+
+   ASSERT(!is_preemption_enabled());
+
+   /* Like Linux: the writable, private and non-stack mappings (brk too) */
+   list_for_each_ro(um, &mi->mappings, pi_node) {
+
+      if (um->h || um->type == USER_MAPPING_STACK)
+         continue;
+
+      if (um->prot & PROT_WRITE)
+         tot += um->len;
+   }
+
+   return tot;
+}
+
+bool is_anon_big_page_allowed(void *vaddrp, size_t size)
+{
+   const ulong vaddr = (ulong)vaddrp;
+   struct user_mapping *um = process_get_user_mapping(vaddrp);
+
+   if (!um || um->h || um->type != USER_MAPPING_MMAP)
+      return false;
+
+   if (!(um->prot & PROT_WRITE))
+      return false;
+
+   return vaddr + size <= um->vaddr + um->len;
+}
+
 void remove_all_user_mappings(struct process *pi)
 {
    struct user_mapping *um, *tmp;
@@ -169,7 +293,7 @@ void remove_all_file_mappings(struct process *pi)
    }
 }
 
-struct mappings_info *alloc_mappings_info(void)
+struct mappings_info *alloc_mappings_info(pdir_t *pdir)
 {
    struct mappings_info *mi;
 
@@ -180,6 +304,7 @@ struct mappings_info *alloc_mappings_info(void)
    mi->mmap_heap = NULL;
    mi->mmap_heap_size = 0;
    mi->brk_region = NULL;
+   register_mappings_info(mi, pdir);
    return mi;
 }
 
@@ -187,6 +312,12 @@ void free_mappings_info(struct mappings_info *mi)
 {
    struct user_mapping *um, *tmp;
 
+   disable_preemption();
+   {
+      list_remove(&mi->node);
+   }
+   enable_preemption();
+
    if (mi->mmap_heap) {
       kmalloc_destroy_heap(mi->mmap_heap);
       kfree2(mi->mmap_heap, kmalloc_get_heap_struct_size());
@@ -214,6 +345,14 @@ duplicate_mappings_info(struct process *new_pi, struct mappings_info *mi)
    new_mi->mmap_heap = NULL;
    new_mi->mmap_heap_size = 0;
    new_mi->brk_region = NULL;
+   register_mappings_info(new_mi, new_pi->pdir);
+
+   /*
+    * pdir_clone() maps exactly the same pages. NOTE: with FORK_NO_COW, the
+    * zero pages get copied by pdir_deep_clone() and are not accounted.
+    */
+   new_mi->usage = mi->usage;
+   new_mi->prot_none = mi->prot_none;
 
    if (mi->mmap_heap) {
 
@@ -269,6 +408,12 @@ oom_case:
          kfree_obj(um, struct user_mapping);
       }
 
+      disable_preemption();
+      {
+         list_remove(&new_mi->node);
+      }
+      enable_preemption();
+
       kfree_obj(new_mi, struct mappings_info);
    }
 
@@ -381,7 +526,10 @@ int generic_fs_munmap(struct user_mapping *um, void *vaddrp, size_t len)
    ASSERT(IS_PAGE_ALIGNED(len));
 
    for (; vaddr < vend; vaddr += PAGE_SIZE) {
-      unmap_page_permissive(pi->pdir, (void *)vaddr, false);
+
+      /* Only splitting a big page can fail: the other pages are not there */
+      if (unmap_page_permissive(pi->pdir, (void *)vaddr, false) == -ENOMEM)
+         return -ENOMEM;
    }
 
    return 0;
@@ -1,13 +1,24 @@
 /* SPDX-License-Identifier: BSD-2-Clause */
 
 #include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
 #include <tilck/common/printk.h>
 
 #include <tilck/kernel/modules.h>
+#include <tilck/kernel/boot_trace.h>
+#include <tilck/kernel/cmdline.h>
+#include <tilck/kernel/sched.h>
 #include <tilck/kernel/sort.h>
 
+enum mod_state {
+   MOD_ST_PENDING,
+   MOD_ST_INITIALIZING,
+   MOD_ST_DONE,
+};
+
 static int mods_count;
 static struct module *modules[32];
+static enum mod_state mods_state[32];
 
 void register_module(struct module *m)
 {
@@ -22,13 +33,86 @@ static long mod_cmp_func(const void *a, const void *b)
    return (*ma)->priority - (*mb)->priority;
 }
 
+static int find_module(const char *name)
+{
+   for (int i = 0; i < mods_count; i++)
+      if (!strcmp(modules[i]->name, name))
+         return i;
+
+   return -1;
+}
+
+/*
+ * Initialize the module `i`, after its dependencies (recursively). Modules
+ * are initialized only by one thread at a time: first the async init thread,
+ * then, once it's done, the deferred init one.
+ */
+static void init_module_with_deps(int i)
+{
+   struct module *m = modules[i];
+
+   if (mods_state[i] == MOD_ST_DONE)
+      return;
+
+   if (mods_state[i] == MOD_ST_INITIALIZING)
+      panic("Dependency cycle involving the module '%s'", m->name);
+
+   mods_state[i] = MOD_ST_INITIALIZING;
+
+   for (const char *const *d = m->deps; d && *d; d++) {
+
+      const int dep = find_module(*d);
+
+      if (dep >= 0)
+         init_module_with_deps(dep);
+   }
+
+   printk("*** Init kernel module: %s\n", m->name);
+   m->init();
+   boot_trace_module(m->name);
+   mods_state[i] = MOD_ST_DONE;
+}
+
 void init_modules(void)
 {
+   bool defer_allowed;
+
    insertion_sort_ptr(modules, (u32)mods_count, &mod_cmp_func);
 
+   /*
+    * When a self-test runs instead of init, there's no userspace to start
+    * earlier: the test may need any module, so initialize them all now.
+    */
+   defer_allowed = !kopt_no_defer_mods && !self_test_to_run;
+
    for (int i = 0; i < mods_count; i++) {
-      struct module *m = modules[i];
-      printk("*** Init kernel module: %s\n", m->name);
-      m->init();
+
+      if (defer_allowed && (modules[i]->flags & MOD_FL_DEFERRED))
+         continue;
+
+      init_module_with_deps(i);
+   }
+}
+
+static void deferred_modules_thread(void *unused)
+{
+   for (int i = 0; i < mods_count; i++)
+      init_module_with_deps(i);
+}
+
+void init_deferred_modules(void)
+{
+   int i;
+
+   for (i = 0; i < mods_count; i++)
+      if (mods_state[i] != MOD_ST_DONE)
+         break;
+
+   if (i == mods_count)
+      return;           /* nothing deferred */
+
+   if (kthread_create(&deferred_modules_thread, 0, NULL) < 0) {
+      printk("WARNING: no kthread for the deferred modules: init them now\n");
+      deferred_modules_thread(NULL);
    }
 }
@@ -14,6 +14,7 @@
 #include <tilck/kernel/ringbuf.h>
 #include <tilck/kernel/sync.h>
 #include <tilck/kernel/sched.h>
+#include <tilck/kernel/user.h>
 
 #if KRN_HANG_DETECTION
    #include <tilck/kernel/list.h>
@@ -97,6 +98,42 @@ record_pipe_event(struct pipe *p, char op, bool is_write)
 }
 #endif /* KRN_HANG_DETECTION */
 
+static void pipe_wake_after_read(struct pipe *p)
+{
+   /*
+    * Wake up one blocked writer instead of all of them.
+    *
+    * Rationale: it is totally possible that just a single writer will fill up
+    * the whole buffer and, after that, the other writers will wake up just to
+    * discover they need to go back sleeping again. To spare those unnecessary
+    * context switches, we just wake up a single writer and, after it's done it
+    * will wake up writer if the buffer is still not full.
+    *
+    * The situation is perfectly symmetric for the readers as well, that's why
+    * here below we wake up another reader if the buffer is not empty.
+    */
+   kcond_signal_one(&p->not_full_cond);
+
+   if (!ringbuf_is_empty(&p->rb)) {
+      /* The buffer is not empty: wake up one more reader, if any */
+      kcond_signal_one(&p->not_empty_cond);
+   }
+}
+
+static void pipe_wake_after_write(struct pipe *p)
+{
+   /*
+    * Wake up one blocked reader, instead of all of them.
+    * See the comments in pipe_wake_after_read() above.
+    */
+   kcond_signal_one(&p->not_empty_cond);
+
+   if (!ringbuf_is_full(&p->rb)) {
+      /* The buffer is not full: wake up one more writer, if any */
+      kcond_signal_one(&p->not_full_cond);
+   }
+}
+
 static ssize_t pipe_read(fs_handle h, char *buf, size_t size, offt *pos)
 {
    struct kfs_handle *kh = h;
@@ -138,24 +175,7 @@ static ssize_t pipe_read(fs_handle h, char *buf, size_t size, offt *pos)
       }
    }
 
-   /*
-    * Wake up one blocked writer instead of all of them.
-    *
-    * Rationale: it is totally possible that just a single writer will fill up
-    * the whole buffer and, after that, the other writers will wake up just to
-    * discover they need to go back sleeping again. To spare those unnecessary
-    * context switches, we just wake up a single writer and, after it's done it
-    * will wake up writer if the buffer is still not full.
-    *
-    * The situation is perfectly symmetric for the readers as well, that's why
-    * here below we wake up another reader if the buffer is not empty.
-    */
-   kcond_signal_one(&p->not_full_cond);
-
-   if (!ringbuf_is_empty(&p->rb)) {
-      /* The buffer is not empty: wake up one more reader, if any */
-      kcond_signal_one(&p->not_empty_cond);
-   }
+   pipe_wake_after_read(p);
 
    /* Unlock the pipe's state lock and return */
    kmutex_unlock(&p->mutex);
@@ -206,18 +226,171 @@ static ssize_t pipe_write(fs_handle h, char *buf, size_t size, offt *pos)
       }
    }
 
-   /*
-    * Wake up one blocked reader, instead of all of them.
-    * See the comments in pipe_read() above.
-    */
-   kcond_signal_one(&p->not_empty_cond);
+   pipe_wake_after_write(p);
 
-   if (!ringbuf_is_full(&p->rb)) {
-      /* The buffer is not full: wake up one more writer, if any */
-      kcond_signal_one(&p->not_full_cond);
+   /* Unlock the pipe's state lock and return */
+   kmutex_unlock(&p->mutex);
+   return !sig_pending ? rc : -EINTR;
+}
+
+/*
+ * Copy the data in the ring buffer directly to the user iovecs. Returns the
+ * number of bytes copied or, if none, a copy_to_user() error.
+ */
+static ssize_t
+pipe_rb_to_iov(struct pipe *p, const struct iovec *iov, int iovcnt)
+{
+   ssize_t tot = 0;
+
+   for (int i = 0; i < iovcnt; i++) {
+
+      char *ubuf = iov[i].iov_base;
+      size_t rem = iov[i].iov_len;
+
+      while (rem > 0) {
+
+         u8 *ptr;
+         size_t n = MIN(rem, ringbuf_get_read_chunk(&p->rb, &ptr));
+         int rc;
+
+         if (!n)
+            return tot; /* the ring buffer is empty */
+
+         if ((rc = copy_to_user(ubuf, ptr, n)))
+            return tot ? tot : rc;
+
+         ringbuf_consume_bytes(&p->rb, n);
+         ubuf += n;
+         rem -= n;
+         tot += (ssize_t)n;
+      }
    }
 
-   /* Unlock the pipe's state lock and return */
+   return tot;
+}
+
+/*
+ * Copy the data in the user iovecs directly to the ring buffer, until it's
+ * full. Returns the number of bytes copied or, if none, -EFAULT.
+ */
+static ssize_t
+pipe_iov_to_rb(struct pipe *p, const struct iovec *iov, int iovcnt)
+{
+   ssize_t tot = 0;
+
+   for (int i = 0; i < iovcnt; i++) {
+
+      const char *ubuf = iov[i].iov_base;
+      size_t rem = iov[i].iov_len;
+
+      while (rem > 0) {
+
+         u8 *ptr;
+         size_t n = MIN(rem, ringbuf_get_write_chunk(&p->rb, &ptr));
+
+         if (!n)
+            return tot; /* the ring buffer is full */
+
+         if (copy_from_user(ptr, ubuf, n))
+            return tot ? tot : -EFAULT;
+
+         ringbuf_commit_bytes(&p->rb, n);
+         ubuf += n;
+         rem -= n;
+         tot += (ssize_t)n;
+      }
+   }
+
+   return tot;
+}
+
+/*
+ * Scatter-gather versions of pipe_read() and pipe_write(), copying the data
+ * directly between the ring buffer and the user iovecs with a single hold of
+ * the pipe's mutex. Like with write(), a writev() of up to PIPE_BUF_SIZE bytes
+ * is atomic: it waits until there's room for all of its data.
+ */
+static ssize_t pipe_readv(fs_handle h, const struct iovec *iov, int iovcnt)
+{
+   struct kfs_handle *kh = h;
+   struct pipe *p = (void *)kh->kobj;
+   bool sig_pending = false;
+   ssize_t rc = 0;
+
+   if (!iov_total_len(iov, iovcnt))
+      return 0;
+
+   kmutex_lock(&p->mutex);
+
+   while (true) {
+
+      if ((rc = pipe_rb_to_iov(p, iov, iovcnt)))
+         break; /* We read something or we got an error */
+
+      if (atomic_load(&p->write_handles) == 0)
+         break; /* No more writers, always return 0 */
+
+      if (kh->fl_flags & O_NONBLOCK) {
+         rc = -EAGAIN;
+         break;
+      }
+
+      kcond_wait(&p->not_empty_cond, &p->mutex, KCOND_WAIT_FOREVER);
+
+      if (pending_signals()) {
+         sig_pending = true;
+         break;
+      }
+   }
+
+   pipe_wake_after_read(p);
+   kmutex_unlock(&p->mutex);
+   return !sig_pending ? rc : -EINTR;
+}
+
+static ssize_t pipe_writev(fs_handle h, const struct iovec *iov, int iovcnt)
+{
+   struct kfs_handle *kh = h;
+   struct pipe *p = (void *)kh->kobj;
+   const size_t tot = iov_total_len(iov, iovcnt);
+   const size_t min_room = tot <= PIPE_BUF_SIZE ? tot : 1;
+   bool sig_pending = false;
+   ssize_t rc = 0;
+
+   if (!tot)
+      return 0;
+
+   kmutex_lock(&p->mutex);
+
+   while (true) {
+
+      if (atomic_load(&p->read_handles) == 0) {
+
+         /* Broken pipe */
+         send_signal(get_curr_pid(), SIGPIPE, true);
+         rc = -EPIPE;
+         break;
+      }
+
+      if (PIPE_BUF_SIZE - ringbuf_get_elems(&p->rb) >= min_room) {
+         rc = pipe_iov_to_rb(p, iov, iovcnt);
+         break;
+      }
+
+      if (kh->fl_flags & O_NONBLOCK) {
+         rc = -EAGAIN;
+         break;
+      }
+
+      kcond_wait(&p->not_full_cond, &p->mutex, KCOND_WAIT_FOREVER);
+
+      if (pending_signals()) {
+         sig_pending = true;
+         break;
+      }
+   }
+
+   pipe_wake_after_write(p);
    kmutex_unlock(&p->mutex);
    return !sig_pending ? rc : -EINTR;
 }
@@ -294,6 +467,7 @@ static struct kcond *pipe_get_except_cond(fs_handle h)
 static const struct file_ops static_ops_pipe_read_end =
 {
    .read = pipe_read,
+   .readv = pipe_readv,
    .read_ready = pipe_read_ready,
    .except_ready = pipe_except_ready,
    .get_rready_cond = pipe_get_rready_cond,
@@ -303,6 +477,7 @@ static const struct file_ops static_ops_pipe_read_end =
 static const struct file_ops static_ops_pipe_write_end =
 {
    .write = pipe_write,
+   .writev = pipe_writev,
    .except_ready = pipe_except_ready,
    .write_ready = pipe_write_ready,
    .get_wready_cond = pipe_get_wready_cond,
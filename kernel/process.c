@@ -19,6 +19,7 @@
 #include <tilck/kernel/fs/vfs.h>
 #include <tilck/kernel/paging_hw.h>
 #include <tilck/kernel/process_int.h>
+#include <tilck/kernel/cmdline.h>
 
 #include <sys/prctl.h>        // system header
 
@@ -28,6 +29,56 @@ STATIC_ASSERT(IS_PAGE_ALIGNED(ARGS_COPYBUF_SIZE));
 
 #define ISOLATED_STACK_HI_VMEM_SPACE   (KERNEL_STACK_SIZE + (2 * PAGE_SIZE))
 
+/*
+ * Pools of recycled kernel stacks (already mapped, with KRN_STACK_ISOLATION)
+ * and io/args copy buffers. Dying tasks put theirs here, up to `-task_pool`
+ * objects per pool, and new tasks take them back: in the common case, fork()
+ * and exit() don't touch the heap, hi_vmem or the page tables.
+ *
+ * The free objects are linked through their first word. They're NOT zeroed
+ * on reuse: the new task's code writes its stack and buffers before reading
+ * them. Only the fresh stacks come zeroed from kzmalloc().
+ */
+struct task_pool {
+   void *head;
+   long count;
+};
+
+static struct task_pool stacks_pool;
+static struct task_pool bufs_pool;
+
+static void *task_pool_get(struct task_pool *p)
+{
+   void *obj;
+
+   disable_preemption();
+   {
+      if ((obj = p->head)) {
+         p->head = *(void **)obj;
+         p->count--;
+      }
+   }
+   enable_preemption();
+   return obj;
+}
+
+static bool task_pool_put(struct task_pool *p, void *obj)
+{
+   bool ret = false;
+
+   disable_preemption();
+   {
+      if (p->count < kopt_task_pool) {
+         *(void **)obj = p->head;
+         p->head = obj;
+         p->count++;
+         ret = true;
+      }
+   }
+   enable_preemption();
+   return ret;
+}
+
 static void *alloc_kernel_isolated_stack(struct process *pi)
 {
    void *vaddr_in_block;
@@ -97,6 +148,9 @@ STATIC_ASSERT(
 
 static void alloc_kernel_stack(struct task *ti)
 {
+   if ((ti->kernel_stack = task_pool_get(&stacks_pool)))
+      return;
+
    if (KRN_STACK_ISOLATION) {
       ti->kernel_stack = alloc_kernel_isolated_stack(ti->pi);
    } else {
@@ -106,6 +160,12 @@ static void alloc_kernel_stack(struct task *ti)
 
 static void free_kernel_stack(struct task *ti)
 {
+   if (!ti->kernel_stack)
+      return;
+
+   if (task_pool_put(&stacks_pool, ti->kernel_stack))
+      return;
+
    if (KRN_STACK_ISOLATION) {
       free_kernel_isolated_stack(ti->pi, ti->kernel_stack);
    } else {
@@ -115,17 +175,31 @@ static void free_kernel_stack(struct task *ti)
 
 static bool do_common_task_allocs(struct task *ti, bool alloc_bufs)
 {
+   /* Not inherited: on fork, `ti` starts as a copy of its parent */
+   ti->lat = kzalloc_obj(struct sched_lat_stats);
+
+   if (!ti->lat)
+      return false;
+
    alloc_kernel_stack(ti);
 
-   if (!ti->kernel_stack)
+   if (!ti->kernel_stack) {
+      kfree_obj(ti->lat, struct sched_lat_stats);
+      ti->lat = NULL;
       return false;
+   }
 
    if (alloc_bufs) {
 
-      ti->io_copybuf = kmalloc(IO_COPYBUF_SIZE + ARGS_COPYBUF_SIZE);
+      ti->io_copybuf = task_pool_get(&bufs_pool);
+
+      if (!ti->io_copybuf)
+         ti->io_copybuf = kmalloc(IO_COPYBUF_SIZE + ARGS_COPYBUF_SIZE);
 
       if (!ti->io_copybuf) {
          free_kernel_stack(ti);
+         kfree_obj(ti->lat, struct sched_lat_stats);
+         ti->lat = NULL;
          return false;
       }
 
@@ -148,7 +222,14 @@ void free_common_task_allocs(struct task *ti)
    process_free_mappings_info(pi);
 
    free_kernel_stack(ti);
-   kfree2(ti->io_copybuf, IO_COPYBUF_SIZE + ARGS_COPYBUF_SIZE);
+
+   if (ti->io_copybuf && !task_pool_put(&bufs_pool, ti->io_copybuf))
+      kfree2(ti->io_copybuf, IO_COPYBUF_SIZE + ARGS_COPYBUF_SIZE);
+
+   if (ti->lat) {
+      kfree_obj(ti->lat, struct sched_lat_stats);
+      ti->lat = NULL;
+   }
 
    ti->io_copybuf = NULL;
    ti->args_copybuf = NULL;
@@ -192,6 +273,8 @@ void init_task_lists(struct task *ti)
                task_primary_timer_fire,
                NULL,
                KTIMER_MODE_IRQ);
+
+   sched_rt_init_task(ti);
 }
 
 void init_process_lists(struct process *pi)
@@ -220,6 +303,8 @@ allocate_new_process(struct task *parent, int pid, pdir_t *new_pdir)
 
    memcpy(ti, parent, sizeof(struct task));
    memcpy(pi, parent_pi, sizeof(struct process));
+   pi->rlimits = NULL;
+   pi->aio_ctxs = NULL;
 
    if (MOD_debugpanel) {
 
@@ -242,6 +327,9 @@ allocate_new_process(struct task *parent, int pid, pdir_t *new_pdir)
    pi->cwd.fs = NULL;
    pi->vforked = false;
 
+   if (UNLIKELY(!dup_process_rlimits(pi, parent_pi)))
+      goto oom_case;
+
    if (new_pdir != parent_pi->pdir) {
 
       if (parent_pi->mi) {
@@ -308,6 +396,7 @@ oom_case:
       }
 
       process_free_mappings_info(ti->pi);
+      free_process_rlimits(pi);
 
       if (MOD_debugpanel && pi->debug_cmdline)
          kfree2(pi->debug_cmdline, PROCESS_CMDLINE_BUF_SIZE);
@@ -367,6 +456,7 @@ static void free_process_int(struct process *pi)
       if (MOD_debugpanel)
          kfree2(pi->debug_cmdline, PROCESS_CMDLINE_BUF_SIZE);
 
+      free_process_rlimits(pi);
       arch_specific_free_proc(pi);
       kfree_obj((void *)get_process_task(pi), struct task_and_process);
    }
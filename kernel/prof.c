@@ -0,0 +1,337 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck_gen_headers/config_sched.h>
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/prof_abi.h>
+
+#include <tilck/kernel/prof.h>
+#include <tilck/kernel/interrupts.h>
+#include <tilck/kernel/elf_utils.h>
+#include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/sched.h>
+#include <tilck/kernel/sync.h>
+#include <tilck/kernel/user.h>
+#include <tilck/kernel/errno.h>
+#include <tilck/kernel/hal.h>
+
+/*
+ * Sampling CPU profiler.
+ *
+ * Once started, every `period` timer ticks, prof_tick() records the PC
+ * interrupted by the timer IRQ, the current tid and, optionally, the kernel
+ * callchain, walking the frame pointers without leaving the current kernel
+ * stack. The samples go in a buffer allocated at start: once it's full, the
+ * new samples are dropped and counted as lost. Nothing is symbolized in IRQ
+ * context: that happens only when the samples are read.
+ *
+ * The samples are append-only until the next start: once `samples_count`
+ * covers them, readers can copy them without disabling the interrupts. The
+ * control operations and the readers are serialized by `prof_mutex`, which
+ * protects the buffer from being freed while in use.
+ */
+
+#define PROF_COPY_BATCH                             32
+
+struct prof_ksample {
+   ulong ip;
+   int tid;
+   u8 user;
+   u8 depth;
+   ulong callchain[PROF_MAX_CALLCHAIN];
+};
+
+static struct kmutex prof_mutex = STATIC_KMUTEX_INIT(prof_mutex, 0);
+static struct prof_ksample *samples;
+static volatile bool running;
+static u32 samples_count;
+static u32 lost;
+static u32 period;
+static u32 ticks_left;
+static u32 flags;
+
+static u8
+prof_walk_stack(regs_t *r, ulong *chain)
+{
+   const ulong lo = (ulong)get_curr_task()->kernel_stack;
+   const ulong hi = lo + KERNEL_STACK_SIZE;
+   ulong fp = (ulong)regs_get_frame_ptr(r);
+   ulong ret, next;
+   u8 n = 0;
+
+   while (n < PROF_MAX_CALLCHAIN) {
+
+#if defined(__riscv)
+
+      /* The return address and the caller's fp are right below fp */
+      if (fp < lo + 2 * sizeof(ulong) || fp > hi)
+         break;
+
+      ret = ((ulong *)fp)[-1];
+      next = ((ulong *)fp)[-2];
+#else
+
+      /* The caller's ebp/rbp is at [fp], the return address right above */
+      if (fp < lo || fp + 2 * sizeof(ulong) > hi)
+         break;
+
+      ret = ((ulong *)fp)[1];
+      next = ((ulong *)fp)[0];
+#endif
+
+      if (ret < KERNEL_BASE_VA)
+         break;
+
+      chain[n++] = ret;
+
+      /* The stack grows down: the callers' frames must be above */
+      if (next <= fp)
+         break;
+
+      fp = next;
+   }
+
+   return n;
+}
+
+void prof_tick(void)
+{
+   struct prof_ksample *s;
+   regs_t *r;
+   ulong var;
+
+   if (LIKELY(!running))
+      return;
+
+   disable_interrupts(&var);
+
+   if (!running || --ticks_left)
+      goto out;
+
+   ticks_left = period;
+
+   if (!(r = get_irq_regs()))
+      goto out;
+
+   if (samples_count == PROF_BUF_SAMPLES) {
+      lost++;
+      goto out;
+   }
+
+   s = &samples[samples_count];
+   s->ip = (ulong)regs_get_ip(r);
+   s->user = s->ip < KERNEL_BASE_VA;
+   s->tid = get_curr_tid();
+   s->depth = 0;
+
+   if (!s->user && (flags & PROF_FL_CALLCHAIN))
+      s->depth = prof_walk_stack(r, s->callchain);
+
+   samples_count++;
+
+out:
+   enable_interrupts(&var);
+}
+
+/* Start of the function containing `addr`, or 0 if unknown */
+static u64
+prof_func_start(ulong addr)
+{
+   long off;
+
+   if (!find_sym_at_addr(addr, &off, NULL))
+      return 0;
+
+   return addr - (ulong)off;
+}
+
+static void
+prof_export_sample(const struct prof_ksample *ks, struct prof_sample *s)
+{
+   *s = (struct prof_sample) {
+      .ip = ks->user ? ks->ip : prof_func_start(ks->ip),
+      .tid = ks->tid,
+      .user = ks->user,
+      .depth = ks->depth,
+   };
+
+   /*
+    * These are return addresses: `ret - 1` is still inside the call
+    * instruction, which matters when the call is the last instruction of
+    * a function (e.g. calling a NORETURN one).
+    */
+   for (u8 i = 0; i < ks->depth; i++)
+      s->callchain[i] = prof_func_start(ks->callchain[i] - 1);
+}
+
+static void
+prof_fill_info(struct prof_info *info)
+{
+   ulong var;
+
+   *info = (struct prof_info) {
+      .flags = flags,
+      .period = period,
+      .timer_hz = KRN_TIMER_HZ,
+      .capacity = samples ? PROF_BUF_SAMPLES : 0,
+   };
+
+   disable_interrupts(&var);
+   {
+      info->running = running;
+      info->count = samples_count;
+      info->lost = lost;
+   }
+   enable_interrupts(&var);
+}
+
+static int
+prof_start(ulong new_period, ulong new_flags)
+{
+   ulong var;
+
+   if (running)
+      return -EBUSY;
+
+   if (!samples) {
+      if (!(samples = kalloc_array_obj(struct prof_ksample, PROF_BUF_SAMPLES)))
+         return -ENOMEM;
+   }
+
+   disable_interrupts(&var);
+   {
+      samples_count = 0;
+      lost = 0;
+      period = new_period ? (u32)new_period : 1;
+      ticks_left = period;
+      flags = (u32)new_flags;
+      running = true;
+   }
+   enable_interrupts(&var);
+   return 0;
+}
+
+static void
+prof_stop(void)
+{
+   ulong var;
+
+   disable_interrupts(&var);
+   {
+      running = false;
+   }
+   enable_interrupts(&var);
+}
+
+int tilck_sys_prof_ctl(ulong op, ulong new_period, ulong new_flags, ulong u_info)
+{
+   struct prof_info info;
+   int rc = 0;
+
+   if (u_info && user_out_of_range((void *)u_info, sizeof(info)))
+      return -EFAULT;
+
+   kmutex_lock(&prof_mutex);
+
+   switch (op) {
+
+      case PROF_CTL_INFO:
+         break;
+
+      case PROF_CTL_START:
+         rc = prof_start(new_period, new_flags);
+         break;
+
+      case PROF_CTL_STOP:
+         prof_stop();
+         break;
+
+      case PROF_CTL_FREE:
+         prof_stop();
+         kfree_array_obj(samples, struct prof_ksample, PROF_BUF_SAMPLES);
+         samples = NULL;
+         samples_count = 0;
+         break;
+
+      default:
+         rc = -EINVAL;
+   }
+
+   if (!rc && u_info) {
+      prof_fill_info(&info);
+      rc = copy_to_user((void *)u_info, &info, sizeof(info));
+   }
+
+   kmutex_unlock(&prof_mutex);
+   return rc;
+}
+
+int tilck_sys_prof_get_samples(ulong u_buf, ulong first, ulong max, ulong _4)
+{
+   struct prof_sample *batch;
+   u32 count, n = 0;
+   ulong var;
+   int rc = 0;
+
+   max = MIN(max, (ulong)PROF_BUF_SAMPLES);
+
+   if (user_out_of_range((void *)u_buf, max * sizeof(struct prof_sample)))
+      return -EFAULT;
+
+   if (!(batch = kalloc_array_obj(struct prof_sample, PROF_COPY_BATCH)))
+      return -ENOMEM;
+
+   kmutex_lock(&prof_mutex);
+
+   disable_interrupts(&var);
+   {
+      count = samples_count;
+   }
+   enable_interrupts(&var);
+
+   while (first + n < count && n < max) {
+
+      const u32 c = (u32)MIN3((ulong)(count - first - n),
+                              (ulong)(max - n),
+                              (ulong)PROF_COPY_BATCH);
+
+      for (u32 i = 0; i < c; i++)
+         prof_export_sample(&samples[first + n + i], &batch[i]);
+
+      rc = copy_to_user((struct prof_sample *)u_buf + n,
+                        batch, c * sizeof(struct prof_sample));
+
+      if (rc)
+         break;
+
+      n += c;
+   }
+
+   kmutex_unlock(&prof_mutex);
+   kfree_array_obj(batch, struct prof_sample, PROF_COPY_BATCH);
+   return rc ? rc : (int)n;
+}
+
+int tilck_sys_prof_get_sym(ulong addr, ulong u_buf, ulong buf_sz, ulong _4)
+{
+   const char *name;
+   size_t len;
+   long off;
+
+   if (!buf_sz || user_out_of_range((void *)u_buf, buf_sz))
+      return -EFAULT;
+
+   if (!(name = find_sym_at_addr(addr, &off, NULL)))
+      return -ENOENT;
+
+   len = MIN(strlen(name), buf_sz - 1);
+
+   if (copy_to_user((char *)u_buf, name, len))
+      return -EFAULT;
+
+   if (copy_to_user((char *)u_buf + len, "", 1))
+      return -EFAULT;
+
+   return (int)len;
+}
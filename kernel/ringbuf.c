@@ -5,6 +5,7 @@
 
 #include <tilck/kernel/ringbuf.h>
 #include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/hal.h>
 
 extern inline void ringbuf_reset(struct ringbuf *rb);
 extern inline bool ringbuf_write_elem1(struct ringbuf *rb, u8 val);
@@ -85,7 +86,7 @@ size_t ringbuf_write_bytes(struct ringbuf *rb, u8 *buf, size_t len)
    if (rb->write_pos < rb->read_pos) {
 
       actual_len = MIN(len, rb->read_pos - rb->write_pos);
-      memcpy(rb->buf + rb->write_pos, buf, actual_len);
+      memcpy_large(rb->buf + rb->write_pos, buf, actual_len);
       rb->write_pos += actual_len;
       rb->elems += actual_len;
       return actual_len;
@@ -93,7 +94,7 @@ size_t ringbuf_write_bytes(struct ringbuf *rb, u8 *buf, size_t len)
 
    /* Part one */
    actual_len = MIN(len, rb->max_elems - rb->write_pos);
-   memcpy(rb->buf + rb->write_pos, buf, actual_len);
+   memcpy_large(rb->buf + rb->write_pos, buf, actual_len);
    rb->write_pos = (rb->write_pos + actual_len) % rb->max_elems;
    rb->elems += actual_len;
 
@@ -106,7 +107,7 @@ size_t ringbuf_write_bytes(struct ringbuf *rb, u8 *buf, size_t len)
    /* Part two */
    ASSERT(rb->write_pos == 0);
    actual_len2 = MIN(len - actual_len, rb->read_pos);
-   memcpy(rb->buf, buf + actual_len, actual_len2);
+   memcpy_large(rb->buf, buf + actual_len, actual_len2);
    rb->write_pos += actual_len2;
    rb->elems += actual_len2;
 
@@ -152,7 +153,7 @@ size_t ringbuf_read_bytes(struct ringbuf *rb, u8 *buf, size_t len)
    if (rb->read_pos < rb->write_pos) {
 
       actual_len = MIN(len, rb->write_pos - rb->read_pos);
-      memcpy(buf, rb->buf + rb->read_pos, actual_len);
+      memcpy_large(buf, rb->buf + rb->read_pos, actual_len);
       rb->read_pos += actual_len;
       rb->elems -= actual_len;
       return actual_len;
@@ -160,7 +161,7 @@ size_t ringbuf_read_bytes(struct ringbuf *rb, u8 *buf, size_t len)
 
    /* Part one */
    actual_len = MIN(len, rb->max_elems - rb->read_pos);
-   memcpy(buf, rb->buf + rb->read_pos, actual_len);
+   memcpy_large(buf, rb->buf + rb->read_pos, actual_len);
    rb->read_pos = (rb->read_pos + actual_len) % rb->max_elems;
    rb->elems -= actual_len;
 
@@ -173,13 +174,53 @@ size_t ringbuf_read_bytes(struct ringbuf *rb, u8 *buf, size_t len)
    /* Part two */
    ASSERT(rb->read_pos == 0);
    actual_len2 = MIN(len - actual_len, rb->write_pos);
-   memcpy(buf + actual_len, rb->buf, actual_len2);
+   memcpy_large(buf + actual_len, rb->buf, actual_len2);
    rb->read_pos += actual_len2;
    rb->elems -= actual_len2;
 
    return actual_len + actual_len2;
 }
 
+size_t ringbuf_get_read_chunk(struct ringbuf *rb, u8 **ptr)
+{
+   ASSERT(rb->elem_size == 1);
+   *ptr = rb->buf + rb->read_pos;
+
+   if (ringbuf_is_empty(rb))
+      return 0;
+
+   return rb->read_pos < rb->write_pos
+      ? rb->write_pos - rb->read_pos
+      : rb->max_elems - rb->read_pos;
+}
+
+size_t ringbuf_get_write_chunk(struct ringbuf *rb, u8 **ptr)
+{
+   ASSERT(rb->elem_size == 1);
+   *ptr = rb->buf + rb->write_pos;
+
+   if (ringbuf_is_full(rb))
+      return 0;
+
+   return rb->write_pos < rb->read_pos
+      ? rb->read_pos - rb->write_pos
+      : rb->max_elems - rb->write_pos;
+}
+
+void ringbuf_consume_bytes(struct ringbuf *rb, size_t len)
+{
+   ASSERT(len <= rb->elems);
+   rb->read_pos = (rb->read_pos + (u32)len) % rb->max_elems;
+   rb->elems -= (u32)len;
+}
+
+void ringbuf_commit_bytes(struct ringbuf *rb, size_t len)
+{
+   ASSERT(len <= rb->max_elems - rb->elems);
+   rb->write_pos = (rb->write_pos + (u32)len) % rb->max_elems;
+   rb->elems += (u32)len;
+}
+
 bool ringbuf_read_elem(struct ringbuf *rb, void *elem_ptr /* out */)
 {
    if (ringbuf_is_empty(rb))
@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck_gen_headers/config_mm.h>
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+
+#include <tilck/kernel/process.h>
+#include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/syscalls.h>
+#include <tilck/kernel/user.h>
+#include <tilck/kernel/errno.h>
+
+/*
+ * Resource limits. All of them can be read and set (only the root user exists
+ * in Tilck), but only RLIMIT_AS and RLIMIT_DATA are enforced, by brk(),
+ * mmap() and mremap(). The ones of the resources fixed in Tilck just report
+ * the actual value and cannot be raised.
+ *
+ * The array of limits is allocated only when a process changes one of them:
+ * struct process has no room for it and almost no process needs it.
+ */
+
+static u64 get_fixed_rlimit(int resource)
+{
+   switch (resource) {
+
+      case RLIMIT_NOFILE:
+         return KRN_MAX_HANDLES;
+
+      case RLIMIT_STACK:
+         return KRN_USER_STACK_PAGES * PAGE_SIZE;
+
+      default:
+         return K_RLIM64_INFINITY;
+   }
+}
+
+u64 get_process_rlimit(struct process *pi, int resource)
+{
+   ASSERT(resource >= 0 && resource < RLIM_NLIMITS);
+
+   if (!pi->rlimits)
+      return get_fixed_rlimit(resource);
+
+   return pi->rlimits[resource].rlim_cur;
+}
+
+bool dup_process_rlimits(struct process *pi, struct process *parent)
+{
+   ASSERT(!pi->rlimits);
+
+   if (!parent->rlimits)
+      return true;
+
+   if (!(pi->rlimits = kalloc_array_obj(struct k_rlimit64, RLIM_NLIMITS)))
+      return false;
+
+   memcpy(pi->rlimits,
+          parent->rlimits,
+          sizeof(struct k_rlimit64) * RLIM_NLIMITS);
+
+   return true;
+}
+
+void free_process_rlimits(struct process *pi)
+{
+   if (pi->rlimits) {
+      kfree_array_obj(pi->rlimits, struct k_rlimit64, RLIM_NLIMITS);
+      pi->rlimits = NULL;
+   }
+}
+
+static struct k_rlimit64 *alloc_default_rlimits(void)
+{
+   struct k_rlimit64 *r;
+
+   if (!(r = kalloc_array_obj(struct k_rlimit64, RLIM_NLIMITS)))
+      return NULL;
+
+   for (int i = 0; i < RLIM_NLIMITS; i++) {
+      r[i].rlim_cur = get_fixed_rlimit(i);
+      r[i].rlim_max = get_fixed_rlimit(i);
+   }
+
+   return r;
+}
+
+static int
+do_prlimit(struct process *pi,
+           int resource,
+           const struct k_rlimit64 *new_rlim,
+           struct k_rlimit64 *old_rlim)
+{
+   if (resource < 0 || resource >= RLIM_NLIMITS)
+      return -EINVAL;
+
+   if (new_rlim) {
+
+      if (new_rlim->rlim_cur > new_rlim->rlim_max)
+         return -EINVAL;
+
+      if (new_rlim->rlim_max > get_fixed_rlimit(resource))
+         return -EPERM;
+   }
+
+   disable_preemption();
+   {
+      if (old_rlim) {
+
+         if (pi->rlimits) {
+            *old_rlim = pi->rlimits[resource];
+         } else {
+            old_rlim->rlim_cur = get_fixed_rlimit(resource);
+            old_rlim->rlim_max = get_fixed_rlimit(resource);
+         }
+      }
+
+      if (new_rlim) {
+
+         if (!pi->rlimits && !(pi->rlimits = alloc_default_rlimits())) {
+            enable_preemption();
+            return -ENOMEM;
+         }
+
+         pi->rlimits[resource] = *new_rlim;
+      }
+   }
+   enable_preemption();
+   return 0;
+}
+
+/* The 64-bit values get clamped to K_RLIM_INFINITY on 32-bit systems */
+static ulong rlim64_to_rlim(u64 val)
+{
+   return val >= K_RLIM_INFINITY ? K_RLIM_INFINITY : (ulong)val;
+}
+
+static u64 rlim_to_rlim64(ulong val)
+{
+   return val == K_RLIM_INFINITY ? K_RLIM64_INFINITY : val;
+}
+
+int sys_getrlimit(int resource, struct k_rlimit *user_rlim)
+{
+   struct k_rlimit64 r64;
+   struct k_rlimit r;
+   int rc;
+
+   if ((rc = do_prlimit(get_curr_proc(), resource, NULL, &r64)))
+      return rc;
+
+   r.rlim_cur = rlim64_to_rlim(r64.rlim_cur);
+   r.rlim_max = rlim64_to_rlim(r64.rlim_max);
+   return copy_to_user(user_rlim, &r, sizeof(r));
+}
+
+int sys_setrlimit(int resource, const struct k_rlimit *user_rlim)
+{
+   struct k_rlimit64 r64;
+   struct k_rlimit r;
+
+   if (copy_from_user(&r, user_rlim, sizeof(r)))
+      return -EFAULT;
+
+   r64.rlim_cur = rlim_to_rlim64(r.rlim_cur);
+   r64.rlim_max = rlim_to_rlim64(r.rlim_max);
+   return do_prlimit(get_curr_proc(), resource, &r64, NULL);
+}
+
+int sys_prlimit64(int pid,
+                  int resource,
+                  const struct k_rlimit64 *user_new_rlim,
+                  struct k_rlimit64 *user_old_rlim)
+{
+   struct k_rlimit64 new_rlim, old_rlim;
+   struct process *pi = get_curr_proc();
+   int rc;
+
+   if (user_new_rlim) {
+      if (copy_from_user(&new_rlim, user_new_rlim, sizeof(new_rlim)))
+         return -EFAULT;
+   }
+
+   disable_preemption();
+
+   if (pid && pid != pi->pid) {
+
+      if (!(pi = get_process(pid))) {
+         enable_preemption();
+         return -ESRCH;
+      }
+   }
+
+   rc = do_prlimit(pi,
+                   resource,
+                   user_new_rlim ? &new_rlim : NULL,
+                   user_old_rlim ? &old_rlim : NULL);
+
+   enable_preemption();
+
+   if (!rc && user_old_rlim)
+      rc = copy_to_user(user_old_rlim, &old_rlim, sizeof(old_rlim));
+
+   return rc;
+}
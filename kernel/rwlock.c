@@ -180,6 +180,35 @@ void rwlock_wp_exlock(struct rwlock_wp *rw)
    kmutex_unlock(&rw->m);
 }
 
+bool rwlock_wp_try_exlock(struct rwlock_wp *rw)
+{
+   bool success = false;
+
+   kmutex_lock(&rw->m);
+   {
+      if (rw->rec && rw->ex_owner == get_curr_task()) {
+
+         ASSERT(rw->rc >= 1);
+         rw->rc++;
+         success = true;
+
+      } else if (!rw->ex_owner && !rw->r && !rw->wq) {
+
+         rw->wq++;
+         rw->ex_owner = get_curr_task();
+
+         if (rw->rec) {
+            ASSERT(rw->rc == 0);
+            rw->rc = 1;
+         }
+
+         success = true;
+      }
+   }
+   kmutex_unlock(&rw->m);
+   return success;
+}
+
 static void rwlock_wp_exunlock_int(struct rwlock_wp *rw)
 {
    ASSERT(rw->ex_owner == get_curr_task());
@@ -95,6 +95,25 @@ void safe_ringbuf_destory(struct safe_ringbuf *rb)
    bzero(rb, sizeof(struct safe_ringbuf));
 }
 
+u16 safe_ringbuf_get_count(struct safe_ringbuf *rb)
+{
+   struct generic_safe_ringbuf_stat cs;
+   cs.__raw = atomic_load(&rb->s.raw);
+
+   if (cs.full)
+      return rb->max_elems;
+
+   return (u16)((cs.write_pos + rb->max_elems - cs.read_pos) % rb->max_elems);
+}
+
+void *safe_ringbuf_peek_elem(struct safe_ringbuf *rb, u16 i)
+{
+   struct generic_safe_ringbuf_stat cs;
+   cs.__raw = atomic_load(&rb->s.raw);
+
+   return rb->buf + ((cs.read_pos + i) % rb->max_elems) * rb->elem_size;
+}
+
 } // extern "C"
 
 template <int static_elem_size = 0>
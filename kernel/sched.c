@@ -13,6 +13,8 @@
 #include <tilck/kernel/errno.h>
 #include <tilck/kernel/test/sched.h>
 
+#include "sched_int.h"
+
 /* Shared global variables */
 struct task *__current;
 atomic_int_t __disable_preempt = { .v = 1 }; /* see docs/atomics.md */
@@ -155,6 +157,9 @@ void enable_preemption(void)
 
    ASSERT(oldval > 0);
 
+   if (oldval == 1)
+      IRQSOFF_TRACE_PREEMPT_ON_IP((ulong)__builtin_return_address(0));
+
    if (KRN_RESCHED_ENABLE_PREEMPT) {
       if (oldval == 1 && need_reschedule() && are_interrupts_enabled())
          schedule();
@@ -638,7 +643,7 @@ void set_current_task_in_kernel(void)
    get_curr_task()->running_in_kernel |= IN_SYSCALL_FLAG;
 }
 
-static void task_add_to_state_list(struct task *ti)
+void task_add_to_state_list(struct task *ti)
 {
    /*
     * Worker threads are a separate schedulable class for bottom-half
@@ -671,6 +676,12 @@ static void task_add_to_state_list(struct task *ti)
 
       case TASK_STATE_RUNNABLE: {
 
+         /* RT tasks go to the EDF ready set instead, see sched_rt.c */
+         if (is_rt_task(ti)) {
+            sched_rt_enqueue(ti);
+            break;
+         }
+
          /*
           * Re-initialize the node's left/right before each insert.
           * bintree_insert() places `ti` at a slot but does NOT clear
@@ -731,7 +742,7 @@ static void task_add_to_state_list(struct task *ti)
    }
 }
 
-static void task_remove_from_state_list(struct task *ti)
+void task_remove_from_state_list(struct task *ti)
 {
    /* Workers don't live in this tree — see task_add_to_state_list(). */
    if (is_worker_thread(ti))
@@ -755,6 +766,11 @@ static void task_remove_from_state_list(struct task *ti)
           */
          DEBUG_ONLY(int prev);
 
+         if (is_rt_task(ti)) {
+            sched_rt_dequeue(ti);
+            break;
+         }
+
          DEBUG_ONLY_UNSAFE(struct task *removed =)
             bintree_remove(&runnable_tree_root,
                            ti,
@@ -807,12 +823,22 @@ static void task_remove_from_state_list(struct task *ti)
  */
 void task_change_state_unsafe(struct task *ti, enum task_state new_state)
 {
+   const enum task_state old_state =
+      (enum task_state) atomic_load(&ti->state);
+
    ASSERT(!are_interrupts_enabled());
-   ASSERT(atomic_load(&ti->state) != (int) new_state);
-   ASSERT(atomic_load(&ti->state) != TASK_STATE_ZOMBIE);
+   ASSERT(old_state != new_state);
+   ASSERT(old_state != TASK_STATE_ZOMBIE);
 
    task_remove_from_state_list(ti);
    atomic_store(&ti->state, (int) new_state);
+
+   /* Before the insert: the depth seen at wakeup excludes `ti` itself */
+   sched_stats_on_state_change(ti,
+                               old_state,
+                               new_state,
+                               (u32) get_runnable_tasks_count());
+
    task_add_to_state_list(ti);
 }
 
@@ -1040,6 +1066,7 @@ void sched_account_ticks(void)
    const enum task_state state = get_curr_task_state();
    const bool is_running = (state == TASK_STATE_RUNNING);
    const bool is_worker = is_worker_thread(curr);
+   const bool is_rt = is_rt_task(curr);
    struct sched_ticks *t = &curr->ticks;
 
    ASSERT(curr != NULL);
@@ -1051,7 +1078,19 @@ void sched_account_ticks(void)
    if (curr->running_in_kernel)
       t->total_kernel++;
 
-   if (is_running && curr != idle_task) {
+   if (is_rt) {
+
+      /*
+       * RT tasks are accounted against their CBS budget instead of
+       * vruntime: they don't take part in the EEVDF fair share, and
+       * keeping them out of min_vruntime avoids pushing the floor
+       * for the woken EEVDF tasks. Same is_running gate as below:
+       * once RUNNABLE, curr is in the RT ready set.
+       */
+      if (is_running)
+         sched_rt_account_tick(curr);
+
+   } else if (is_running && curr != idle_task) {
 
       /*
        * vruntime is "CPU time consumed by this task", incremented
@@ -1112,9 +1151,11 @@ void sched_account_ticks(void)
     * start by sched_start_quantum() so a wake/sleep by another task
     * mid-quantum doesn't re-fair curr's quantum length. Workers
     * have unlimited slice -- they're preempted only by another
-    * worker, never by the timer-based timeout.
+    * worker, never by the timer-based timeout. So do RT tasks: they
+    * run until their budget is exhausted (see sched_rt_account_tick)
+    * or an earlier deadline shows up.
     */
-   const bool timeout = !is_worker && t->slice_used >= t->slice;
+   const bool timeout = !is_worker && !is_rt && t->slice_used >= t->slice;
 
    /*
     * !is_running covers all the cases where curr can't keep running
@@ -1222,14 +1263,19 @@ sched_do_select_runnable_task(enum task_state curr_state, bool resched)
    /*
     * Tree was empty. Keep running curr if it still wants to;
     * otherwise let do_schedule() fall back to idle.
+    *
+    * Not if curr is an RT task: a RUNNING RT curr reaching this point
+    * is throttled (sched_rt_pick_task() would have picked it
+    * otherwise) and must not keep the CPU until its replenishment.
+    * That applies to the vruntime comparison below as well.
     */
    if (!selected) {
 
-      if (curr_state == TASK_STATE_RUNNING)
+      if (curr_state == TASK_STATE_RUNNING && !is_rt_task(curr))
          selected = curr;
    }
 
-   if (!resched && selected && curr != idle_task) {
+   if (!resched && selected && curr != idle_task && !is_rt_task(curr)) {
 
       /*
        * If need_resched is not set, the caller didn't want necessarily to
@@ -1266,13 +1312,21 @@ void do_schedule(void)
    if (sched_should_return_immediately(curr, curr_state))
       return;
 
+   /*
+    * RT tasks first: the in-budget RT task with the earliest deadline
+    * wins against everything else. Returns NULL immediately while no
+    * RT task is admitted (dormant class), see sched_rt.c.
+    */
+   selected = sched_rt_pick_task(curr, curr_state);
+
    /*
     * Workers are picked here, BEFORE the regular runnable-list lookup
     * below. They're a separate schedulable class for bottom-half
     * processing (see wth.c), and a runnable worker always wins
     * against a runnable non-worker.
     */
-   selected = wth_get_runnable_thread();
+   if (!selected)
+      selected = wth_get_runnable_thread();
 
    /* Check for regular runnable tasks */
    if (!selected) {
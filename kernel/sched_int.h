@@ -0,0 +1,14 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#pragma once
+#include <tilck/kernel/sched.h>
+
+/* sched.c: ready-set maintenance, called with interrupts disabled */
+void task_add_to_state_list(struct task *ti);
+void task_remove_from_state_list(struct task *ti);
+
+/* sched_rt.c: hooks called by the core scheduler in sched.c */
+void sched_rt_enqueue(struct task *ti);
+void sched_rt_dequeue(struct task *ti);
+void sched_rt_account_tick(struct task *curr);
+struct task *sched_rt_pick_task(struct task *curr, enum task_state curr_state);
@@ -0,0 +1,462 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Real-time scheduling class: CBS budgets + EDF dispatch, admission
+ * controlled against KRN_RT_BANDWIDTH_PCT. See the design in
+ * docs/plans/realtime-roadmap.md.
+ *
+ * A task is promoted with a (C, T) reservation via sched_setattr()
+ * with SCHED_DEADLINE. While admitted:
+ *
+ *    - it gets the CPU ahead of worker threads and EEVDF tasks,
+ *      whenever it is RUNNABLE and has budget left (do_schedule());
+ *
+ *    - among RT tasks, the one with the earliest absolute deadline
+ *      wins (EDF). Deadlines are implicit: D == T;
+ *
+ *    - each tick it runs consumes one tick of budget. When the budget
+ *      reaches zero the task is throttled: it stays out of the RT
+ *      ready set until the next period (sched_rt_account_tick());
+ *
+ *    - at every period boundary its repl_timer replenishes the budget
+ *      and moves the deadline one period forward (sched_rt_replenish).
+ *
+ * Everything is tick-granular, because that's the granularity of the
+ * ktimer AVL: a period must be at least one tick (1 ms periods need
+ * KRN_TIMER_HZ >= 1000) and the runtime is rounded up to whole ticks.
+ *
+ * Dormancy: while no task is admitted, sched_rt_pick_task() is a single
+ * atomic load + return NULL and no other RT code runs at all.
+ */
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/utils.h>
+
+#include <tilck/kernel/sched.h>
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/timer.h>
+#include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/datetime.h>
+#include <tilck/kernel/user.h>
+#include <tilck/kernel/errno.h>
+#include <tilck/kernel/syscalls.h>
+#include <tilck/kernel/test/sched.h>
+
+#include <linux/sched.h> // system header
+
+#include "sched_int.h"
+
+#define RT_TICK_NS            ((u64)TS_SCALE / KRN_TIMER_HZ)
+#define RT_MAX_BANDWIDTH_X1K  (KRN_RT_BANDWIDTH_PCT * 10)
+
+/*
+ * RT ready set: AVL tree keyed by (deadline, tid), leftmost first. It
+ * contains the RUNNABLE, non-throttled RT tasks. Like the EEVDF tree,
+ * curr is never in it while RUNNING.
+ *
+ * Invariant: a task's rt->deadline and rt->throttled are never modified
+ * while the task sits in this tree. All the writers either run on
+ * curr while RUNNING (sched_rt_account_tick) or wrap the mutation in
+ * task_remove_from_state_list() / task_add_to_state_list() with
+ * interrupts disabled (admit, release, replenish).
+ */
+static struct task *rt_tree_root;
+
+/*
+ * Number of admitted RT tasks. Read without locks by do_schedule()
+ * for the dormancy check, so it's atomic. See docs/atomics.md.
+ */
+STATIC atomic_int_t rt_admitted_count;
+
+/*
+ * Sum of util_x1k over the admitted RT tasks. Written only with
+ * interrupts disabled, by sched_rt_admit() and sched_rt_release().
+ */
+STATIC u32 rt_sum_util_x1k;
+
+static void sched_rt_replenish(struct ktimer *t, void *ctx);
+
+static long sched_rt_cmp(const void *a, const void *b)
+{
+   const struct task *t1 = a;
+   const struct task *t2 = b;
+
+   if (t1->rt->deadline != t2->rt->deadline)
+      return t1->rt->deadline < t2->rt->deadline ? -1 : 1;
+
+   return (long)t1->tid - (long)t2->tid;
+}
+
+void sched_rt_init_task(struct task *ti)
+{
+   /*
+    * Called by init_task_lists(): after a fork, `ti` is a memcpy of
+    * the parent, including its `rt` pointer. Children are never RT:
+    * the parent's reservation is not inherited.
+    */
+   ti->sclass = SCHED_CLASS_NONRT;
+   ti->rt = NULL;
+}
+
+void sched_rt_enqueue(struct task *ti)
+{
+   ASSERT(!are_interrupts_enabled());
+   ASSERT(is_rt_task(ti));
+
+   /* Throttled tasks wait for sched_rt_replenish() out of the tree */
+   if (ti->rt->throttled)
+      return;
+
+   bintree_node_init(&ti->runnable_tree_node);
+
+   DEBUG_ONLY_UNSAFE(bool inserted =)
+      bintree_insert(&rt_tree_root,
+                     ti,
+                     sched_rt_cmp,
+                     struct task,
+                     runnable_tree_node);
+   ASSERT(inserted);
+
+   /*
+    * A newly-runnable RT task may preempt whatever is running. The
+    * only case where that can't be true is curr itself going back to
+    * the ready set inside do_schedule().
+    */
+   if (ti != get_curr_task())
+      sched_set_need_resched();
+}
+
+void sched_rt_dequeue(struct task *ti)
+{
+   ASSERT(!are_interrupts_enabled());
+   ASSERT(is_rt_task(ti));
+
+   if (ti->rt->throttled)
+      return;
+
+   DEBUG_ONLY_UNSAFE(struct task *removed =)
+      bintree_remove(&rt_tree_root,
+                     ti,
+                     sched_rt_cmp,
+                     struct task,
+                     runnable_tree_node);
+   ASSERT(removed == ti);
+}
+
+/*
+ * CBS budget enforcement, called by sched_account_ticks() on every tick
+ * an RT curr is RUNNING (therefore outside the ready set).
+ */
+void sched_rt_account_tick(struct task *curr)
+{
+   struct sched_rt *rt = curr->rt;
+
+   if (rt->budget > 0)
+      rt->budget--;
+
+   if (!rt->budget && !rt->throttled) {
+      rt->throttled = true;
+      rt->throttle_count++;
+      sched_set_need_resched();
+   }
+}
+
+/*
+ * EDF selection: the in-budget RT task with the earliest deadline,
+ * curr included. NULL means "no RT task wants the CPU" and the caller
+ * falls through to workers and EEVDF: that's how the slack left by the
+ * RT class flows down to the non-RT tasks.
+ */
+struct task *sched_rt_pick_task(struct task *curr, enum task_state curr_state)
+{
+   struct task *selected;
+   ulong var;
+
+   if (!atomic_load(&rt_admitted_count))
+      return NULL;
+
+   disable_interrupts(&var);
+   {
+      selected = bintree_get_first_obj(rt_tree_root,
+                                       struct task,
+                                       runnable_tree_node);
+
+      if (is_rt_task(curr)                &&
+          curr_state == TASK_STATE_RUNNING &&
+          !curr->rt->throttled)
+      {
+         if (!selected || curr->rt->deadline <= selected->rt->deadline)
+            selected = curr;
+      }
+   }
+   enable_interrupts(&var);
+   return selected;
+}
+
+/*
+ * Period boundary for `ti` (KTIMER_MODE_IRQ, interrupts disabled):
+ * refill the budget, move the deadline one period forward and, if the
+ * task had been throttled, put it back in the ready set.
+ */
+static void sched_rt_replenish(struct ktimer *t, void *ctx)
+{
+   struct task *ti = ctx;
+   struct sched_rt *rt = ti->rt;
+   const enum task_state state = (enum task_state)atomic_load(&ti->state);
+   const u64 now = get_ticks();
+
+   ASSERT(is_rt_task(ti));
+
+   /* The job for this period was still pending at its deadline */
+   if (!rt->throttled &&
+       (state == TASK_STATE_RUNNABLE || state == TASK_STATE_RUNNING))
+   {
+      rt->deadline_misses++;
+   }
+
+   task_remove_from_state_list(ti);
+   {
+      rt->budget = rt->runtime;
+      rt->throttled = false;
+      rt->deadline += rt->period;
+
+      /* Late timer (e.g. a skipped nested tick): don't try to catch up */
+      if (rt->deadline <= now)
+         rt->deadline = now + rt->period;
+   }
+   task_add_to_state_list(ti);
+
+   ktimer_arm(t, rt->deadline - now);
+   sched_set_need_resched();
+}
+
+/*
+ * Admit `ti` into the RT class with a (runtime, period) reservation,
+ * both in ticks, or change the reservation of an RT task. Returns
+ * -EBUSY when the new sum of the utilizations would exceed
+ * KRN_RT_BANDWIDTH_PCT.
+ */
+int sched_rt_admit(struct task *ti, u32 runtime, u32 period)
+{
+   struct sched_rt *new_rt = NULL;
+   struct sched_rt *rt;
+   u32 util, old_util;
+   ulong var;
+   int rc = 0;
+
+   if (!runtime || runtime > period)
+      return -EINVAL;
+
+   util = (u32)DIV_ROUND_UP((u64)runtime * 1000, period);
+
+   if (!is_rt_task(ti)) {
+
+      if (!(new_rt = kzalloc_obj(struct sched_rt)))
+         return -ENOMEM;
+
+      ktimer_init(&new_rt->repl_timer,
+                  sched_rt_replenish,
+                  ti,
+                  KTIMER_MODE_IRQ);
+   }
+
+   disable_interrupts(&var);
+   {
+      old_util = is_rt_task(ti) ? ti->rt->util_x1k : 0;
+
+      if (rt_sum_util_x1k - old_util + util > RT_MAX_BANDWIDTH_X1K) {
+         rc = -EBUSY;
+         goto out;
+      }
+
+      task_remove_from_state_list(ti);
+      {
+         if (new_rt) {
+            ti->sclass = SCHED_CLASS_RT;
+            ti->rt = new_rt;
+            atomic_fetch_add(&rt_admitted_count, 1);
+            new_rt = NULL;
+         }
+
+         rt_sum_util_x1k = rt_sum_util_x1k - old_util + util;
+
+         rt = ti->rt;
+         rt->runtime = runtime;
+         rt->period = period;
+         rt->util_x1k = util;
+         rt->budget = runtime;
+         rt->throttled = false;
+         rt->deadline = get_ticks() + period;
+      }
+      task_add_to_state_list(ti);
+
+      ktimer_arm(&rt->repl_timer, period);
+   }
+out:
+   enable_interrupts(&var);
+
+   if (new_rt)
+      kfree_obj(new_rt, struct sched_rt);
+
+   return rc;
+}
+
+/*
+ * Drop `ti` back to the non-RT class, releasing its reservation. The
+ * task re-joins EEVDF at the leading edge, like a new fork: the
+ * vruntime it had before the promotion is meaningless by now. No-op
+ * for non-RT tasks.
+ */
+void sched_rt_release(struct task *ti)
+{
+   struct sched_rt *rt = NULL;
+   ulong var;
+
+   disable_interrupts(&var);
+   {
+      if (!is_rt_task(ti))
+         goto out;
+
+      rt = ti->rt;
+
+      /*
+       * IRQ-mode timer + interrupts disabled: after the cancel, the
+       * callback can't be running nor fire anymore.
+       */
+      ktimer_cancel(&rt->repl_timer);
+
+      task_remove_from_state_list(ti);
+      {
+         rt_sum_util_x1k -= rt->util_x1k;
+         atomic_fetch_sub(&rt_admitted_count, 1);
+
+         ti->sclass = SCHED_CLASS_NONRT;
+         ti->rt = NULL;
+         fork_vruntime_handoff(ti);
+      }
+      task_add_to_state_list(ti);
+   }
+out:
+   enable_interrupts(&var);
+
+   if (rt)
+      kfree_obj(rt, struct sched_rt);
+}
+
+static int
+sched_setattr_deadline(struct task *ti, struct k_sched_attr *attr)
+{
+   u64 runtime, period;
+
+   if (attr->sched_flags)
+      return -EINVAL;
+
+   /* Implicit deadlines only: period == 0 means period == deadline */
+   if (!attr->sched_period)
+      attr->sched_period = attr->sched_deadline;
+
+   if (attr->sched_deadline != attr->sched_period)
+      return -EINVAL;
+
+   if (!attr->sched_runtime || attr->sched_runtime > attr->sched_period)
+      return -EINVAL;
+
+   /* Round the runtime up and the period down: never over-promise */
+   runtime = DIV_ROUND_UP(attr->sched_runtime, RT_TICK_NS);
+   period = attr->sched_period / RT_TICK_NS;
+
+   if (!period || period > UINT32_MAX)
+      return -EINVAL;
+
+   if (runtime > period)
+      return -EBUSY;
+
+   return sched_rt_admit(ti, (u32)runtime, (u32)period);
+}
+
+/*
+ * Linux's sched_setattr(), limited to:
+ *
+ *    - the calling task (pid == 0 or its own tid);
+ *    - SCHED_DEADLINE with deadline == period and no flags (promotion);
+ *    - SCHED_OTHER, to drop back to the non-RT class. sched_nice is
+ *      ignored: Tilck has no nice values.
+ */
+int sys_sched_setattr(int pid, struct k_sched_attr *u_attr, u32 flags)
+{
+   struct task *curr = get_curr_task();
+   struct k_sched_attr attr;
+   u32 size;
+
+   if (pid < 0 || flags)
+      return -EINVAL;
+
+   if (pid && pid != curr->tid)
+      return -EPERM;
+
+   if (copy_from_user(&size, &u_attr->size, sizeof(size)))
+      return -EFAULT;
+
+   if (!size)
+      size = sizeof(attr);
+
+   /* Sizes > VER0 are accepted: the extra fields are just ignored */
+   if (size < sizeof(attr))
+      return -E2BIG;
+
+   if (copy_from_user(&attr, u_attr, sizeof(attr)))
+      return -EFAULT;
+
+   switch (attr.sched_policy) {
+
+      case SCHED_DEADLINE:
+         return sched_setattr_deadline(curr, &attr);
+
+      case SCHED_NORMAL:
+         sched_rt_release(curr);
+         return 0;
+
+      default:
+         return -EINVAL;
+   }
+}
+
+int sys_sched_getattr(int pid, struct k_sched_attr *u_attr, u32 size, u32 fl)
+{
+   struct k_sched_attr attr = { .size = sizeof(attr) };
+   struct task *ti;
+   ulong var;
+
+   if (pid < 0 || fl || size < sizeof(attr))
+      return -EINVAL;
+
+   disable_preemption();
+   {
+      ti = pid ? get_task(pid) : get_curr_task();
+
+      if (!ti) {
+         enable_preemption();
+         return -ESRCH;
+      }
+
+      disable_interrupts(&var);
+      {
+         if (is_rt_task(ti)) {
+            attr.sched_policy = SCHED_DEADLINE;
+            attr.sched_runtime = ti->rt->runtime * RT_TICK_NS;
+            attr.sched_period = ti->rt->period * RT_TICK_NS;
+            attr.sched_deadline = attr.sched_period;
+         } else {
+            attr.sched_policy = SCHED_NORMAL;
+         }
+      }
+      enable_interrupts(&var);
+   }
+   enable_preemption();
+
+   if (copy_to_user(u_attr, &attr, sizeof(attr)))
+      return -EFAULT;
+
+   return 0;
+}
@@ -0,0 +1,190 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Scheduling-latency statistics: wakeup-to-run latency and runqueue depth
+ * histograms, plus voluntary/involuntary context-switch counters. Kept per
+ * task (ti->lat) and globally. See struct sched_lat_stats in sched.h.
+ *
+ * All the writers run with interrupts disabled: the state-change hook is
+ * called by task_change_state_unsafe() and the switch hook disables them on
+ * its own. That's enough for the 64-bit fields on i386 too, since readers
+ * copy the stats with interrupts disabled as well.
+ */
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/string_util.h>
+
+#include <tilck/kernel/sched.h>
+#include <tilck/kernel/hal.h>
+
+static struct sched_lat_stats global_lat;
+
+static u32 log2_u64(u64 val)
+{
+   const u32 hi = (u32)(val >> 32);
+   const u32 lo = (u32)val;
+
+   if (hi)
+      return 32 + (31 - (u32)__builtin_clz(hi));
+
+   return lo ? 31 - (u32)__builtin_clz(lo) : 0;
+}
+
+u32 sched_lat_hist_bucket(u64 cycles)
+{
+   return MIN(log2_u64(cycles), (u32)SCHED_LAT_HIST_BUCKETS - 1);
+}
+
+u32 sched_rq_hist_bucket(u32 depth)
+{
+   if (!depth)
+      return 0;
+
+   return MIN(1 + log2_u64(depth), (u32)SCHED_RQ_HIST_BUCKETS - 1);
+}
+
+static void
+sched_lat_account_wakeup(struct sched_lat_stats *s, u32 rq_depth)
+{
+   s->rq_hist[sched_rq_hist_bucket(rq_depth)]++;
+}
+
+static void
+sched_lat_account_run(struct sched_lat_stats *s, u64 cycles)
+{
+   s->wakeups++;
+   s->tot_cycles += cycles;
+   s->max_cycles = MAX(s->max_cycles, cycles);
+   s->lat_hist[sched_lat_hist_bucket(cycles)]++;
+}
+
+void sched_stats_on_state_change(struct task *ti,
+                                 enum task_state old_state,
+                                 enum task_state new_state,
+                                 u32 rq_depth)
+{
+   struct sched_lat_stats *s = ti->lat;
+   ASSERT(!are_interrupts_enabled());
+
+   if (!s)
+      return;
+
+   if (new_state == TASK_STATE_RUNNABLE) {
+
+      /* Preemption (RUNNING -> RUNNABLE) is not a wakeup */
+      if (old_state != TASK_STATE_SLEEPING && old_state != TASK_STATE_STOPPED)
+         return;
+
+      s->wakeup_pending = true;
+      s->wakeup_tsc = RDTSC();
+      sched_lat_account_wakeup(s, rq_depth);
+      sched_lat_account_wakeup(&global_lat, rq_depth);
+      return;
+   }
+
+   if (new_state == TASK_STATE_RUNNING && s->wakeup_pending) {
+
+      const u64 now = RDTSC();
+      const u64 cycles = now > s->wakeup_tsc ? now - s->wakeup_tsc : 0;
+
+      s->wakeup_pending = false;
+      sched_lat_account_run(s, cycles);
+      sched_lat_account_run(&global_lat, cycles);
+      return;
+   }
+
+   /* Woken up and then put back to sleep, stopped or killed before running */
+   if (new_state != TASK_STATE_RUNNING)
+      s->wakeup_pending = false;
+}
+
+/*
+ * Called by switch_to_task() on a real task switch, while `curr` is still
+ * the current task. Same semantics as Linux's nvcsw/nivcsw: a switch is
+ * involuntary when the outgoing task could have kept running.
+ */
+void sched_stats_on_switch(struct task *curr, struct task *next)
+{
+   const bool preempted =
+      atomic_load(&curr->state) == TASK_STATE_RUNNABLE;
+   ulong var;
+
+   if (curr == next || !curr->lat)
+      return;
+
+   disable_interrupts(&var);
+   {
+      if (preempted) {
+         curr->lat->nivcsw++;
+         global_lat.nivcsw++;
+      } else {
+         curr->lat->nvcsw++;
+         global_lat.nvcsw++;
+      }
+   }
+   enable_interrupts(&var);
+}
+
+/*
+ * Copy the stats of the task `tid`, or the global ones when tid == 0.
+ * Returns false if there's no such task or it has no stats (kernel_process,
+ * zombies).
+ */
+bool sched_stats_get(int tid, struct sched_lat_stats *out)
+{
+   struct sched_lat_stats *s = &global_lat;
+   bool found = true;
+   ulong var;
+
+   disable_preemption();
+   {
+      if (tid) {
+         struct task *ti = get_task(tid);
+         s = ti ? ti->lat : NULL;
+      }
+
+      disable_interrupts(&var);
+      {
+         if (s)
+            *out = *s;
+         else
+            found = false;
+      }
+      enable_interrupts(&var);
+   }
+   enable_preemption();
+   return found;
+}
+
+static int sched_stats_reset_cb(void *obj, void *arg)
+{
+   struct task *ti = obj;
+   struct sched_lat_stats *s = ti->lat;
+
+   if (s) {
+
+      const bool pending = s->wakeup_pending;
+      const u64 tsc = s->wakeup_tsc;
+
+      /* Keep the in-flight wakeup: it will be accounted as usual */
+      bzero(s, sizeof(*s));
+      s->wakeup_pending = pending;
+      s->wakeup_tsc = tsc;
+   }
+
+   return 0;
+}
+
+void sched_stats_reset(void)
+{
+   ulong var;
+
+   disable_preemption();
+   disable_interrupts(&var);
+   {
+      bzero(&global_lat, sizeof(global_lat));
+      iterate_over_tasks(sched_stats_reset_cb, NULL);
+   }
+   enable_interrupts(&var);
+   enable_preemption();
+}
@@ -360,6 +360,7 @@ switch_to_task(struct task *ti)
 
    ASSERT(!is_preemption_enabled());
    switch_to_task_safety_checks(curr, ti);
+   sched_stats_on_switch(curr, ti);
 
    /* Do as much as possible work before disabling the interrupts */
    task_change_state_idempotent(ti, TASK_STATE_RUNNING);
@@ -407,6 +408,9 @@ switch_to_task(struct task *ti)
    set_curr_task(ti);
    ti->timer_ready = false;
    set_kernel_stack((ulong)ti->state_regs);
+
+   /* context_switch() will re-enable the interrupts with its `iret` */
+   IRQSOFF_TRACE_IRQS_ON();
    context_switch(state);
 }
 
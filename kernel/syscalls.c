@@ -29,12 +29,6 @@
 #define LINUX_REBOOT_CMD_HALT       0xcdef0123
 #define LINUX_REBOOT_CMD_POWER_OFF  0x4321fedc
 
-int sys_madvise(void *addr, size_t len, int advice)
-{
-   // TODO (future): consider implementing at least part of sys_madvice().
-   return 0;
-}
-
 int
 do_nanosleep(const struct k_timespec64 *req, struct k_timespec64 *rem)
 {
@@ -10,6 +10,7 @@
 #include <tilck/kernel/user.h>
 #include <tilck/kernel/errno.h>
 #include <tilck/kernel/gcov.h>
+#include <tilck/kernel/prof.h>
 #include <tilck/kernel/debug_utils.h>
 
 typedef int (*tilck_cmd_func)(ulong, ulong, ulong, ulong);
@@ -45,6 +46,10 @@ static void *tilck_cmds[TILCK_CMD_COUNT] = {
    [TILCK_CMD_DP_TRACE_SET_FILTER] = NULL,
    [TILCK_CMD_DP_TRACE_GET_FILTER] = NULL,
    [TILCK_CMD_DP_TASK_SET_TRACED] = NULL,
+
+   [TILCK_CMD_PROF_CTL] = tilck_sys_prof_ctl,
+   [TILCK_CMD_PROF_GET_SAMPLES] = tilck_sys_prof_get_samples,
+   [TILCK_CMD_PROF_GET_SYM] = tilck_sys_prof_get_sym,
 };
 
 void register_tilck_cmd(int cmd_n, void *func)
@@ -13,6 +13,7 @@
 #include <tilck/kernel/elf_utils.h>
 #include <tilck/kernel/worker_thread.h>
 #include <tilck/kernel/datetime.h>
+#include <tilck/kernel/prof.h>
 
 FASTCALL void asm_nop_loop(u32 iters);
 
@@ -480,6 +481,7 @@ static enum irq_action timer_irq_handler(void *ctx)
    enable_interrupts_forced();
 
    sched_account_ticks();
+   prof_tick();
    tick_all_timers();
    return IRQ_HANDLED;
 }
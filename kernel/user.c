@@ -10,19 +10,28 @@
 #include <tilck/kernel/fault_resumable.h>
 #include <tilck/kernel/hal.h>
 #include <tilck/kernel/paging.h>
+#include <tilck/kernel/process.h>
+#include <tilck/kernel/process_mm.h>
 #include <tilck/kernel/signal.h>
+#include <tilck/kernel/timer.h>
 
 #include <linux/auxvec.h> // system header
 
 /* User-copy fixup landing pad, defined in kernel/arch/<arch>/user_copy.S */
 void asm_user_copy_fault(void);
 
+/* The PROT_NONE pages are still accessible by the kernel: reject them */
+static ALWAYS_INLINE bool user_range_prot_none(const void *user_ptr, size_t n)
+{
+   return !mm_user_range_accessible(get_curr_proc()->mi, user_ptr, n);
+}
+
 int copy_from_user(void *dest, const void *user_ptr, size_t n)
 {
    struct task *curr = get_curr_task();
    int rc;
 
-   if (user_out_of_range(user_ptr, n))
+   if (user_out_of_range(user_ptr, n) || user_range_prot_none(user_ptr, n))
       return -EFAULT;
 
    ASSERT(!curr->user_access_fixup);    /* user copies never nest */
@@ -39,7 +48,7 @@ int copy_to_user(void *user_ptr, const void *src, size_t n)
    struct task *curr = get_curr_task();
    int rc;
 
-   if (user_out_of_range(user_ptr, n))
+   if (user_out_of_range(user_ptr, n) || user_range_prot_none(user_ptr, n))
       return -EFAULT;
 
    ASSERT(!curr->user_access_fixup);    /* user copies never nest */
@@ -72,6 +81,73 @@ bool user_access_resume_on_fault(regs_t *r, bool out_of_mem)
    return true;
 }
 
+struct oom_victim_ctx {
+   int pid;
+   long pages;
+};
+
+static int oom_victim_cb(void *obj, void *arg)
+{
+   struct task *ti = obj;
+   struct oom_victim_ctx *ctx = arg;
+   struct mappings_info *mi = ti->pi->mi;
+   long pages;
+
+   if (!is_main_thread(ti) || is_kernel_thread(ti) || ti->tid == 1)
+      return 0;
+
+   if (!mi || ti->pi->vforked)
+      return 0; /* a vforked child uses its parent's address space */
+
+   pages = mi->usage.rss_pages + mi->usage.pt_pages;
+
+   /* The tasks are visited in tid order: on ties, the newest process wins */
+   if (pages > 0 && pages >= ctx->pages) {
+      ctx->pid = ti->tid;
+      ctx->pages = pages;
+   }
+
+   return 0;
+}
+
+/*
+ * Deterministic OOM policy: the victim is the user process (except init)
+ * with the most resident + page table pages. Returns true if the current
+ * task should just retry the faulting access, because another process has
+ * been killed in order to free memory.
+ */
+static bool oom_kill_other_process(void)
+{
+   static int last_victim;
+   static u64 last_victim_ticks;
+
+   struct oom_victim_ctx ctx = {0};
+   bool retry = false;
+
+   disable_preemption();
+   {
+      iterate_over_tasks(&oom_victim_cb, &ctx);
+
+      if (ctx.pid && ctx.pid != get_curr_pid()) {
+
+         if (ctx.pid != last_victim) {
+            printk("Out-of-memory: killing pid %d (%ld pages)\n",
+                   ctx.pid, ctx.pages);
+            last_victim = ctx.pid;
+            last_victim_ticks = get_ticks();
+         }
+
+         /* Give up on a victim that doesn't die within a second */
+         if (get_ticks() - last_victim_ticks < KRN_TIMER_HZ) {
+            send_signal(ctx.pid, SIGKILL, SIG_FL_PROCESS);
+            retry = true;
+         }
+      }
+   }
+   enable_preemption();
+   return retry;
+}
+
 void handle_cow_out_of_mem(regs_t *r)
 {
    struct task *curr = get_curr_task();
@@ -90,7 +166,13 @@ void handle_cow_out_of_mem(regs_t *r)
 
    if (!in_syscall(curr)) {
 
-      /* User-mode CoW fault under memory pressure: kill the process. */
+      /*
+       * User-mode CoW fault under memory pressure: kill the biggest process,
+       * which might be the current one.
+       */
+      if (oom_kill_other_process())
+         return;
+
       printk("Out-of-memory: killing pid %d\n", get_curr_pid());
       send_signal(get_curr_pid(), SIGKILL, SIG_FL_PROCESS | SIG_FL_FAULT);
       return;
@@ -160,7 +242,7 @@ internal_copy_user_str(char *dest,
       /* Cap the read so the over-read past the NUL stays cheap. */
       const size_t chunk = MIN(avail, USER_STR_COPY_CHUNK);
 
-      if (arch_user_copy(d, p, chunk))
+      if (user_range_prot_none(p, chunk) || arch_user_copy(d, p, chunk))
          return -1;                        /* unmapped user page */
 
       /* Scan the freshly-copied chunk for the string's NUL terminator. */
@@ -236,7 +318,9 @@ internal_copy_str_array_from_user(void *dest,
        * it is NULL, in order to compute 'argc'.
        */
 
-      if (arch_user_copy(&uptr, user_arr + argc, sizeof(uptr))) {
+      if (user_range_prot_none(user_arr + argc, sizeof(uptr)) ||
+          arch_user_copy(&uptr, user_arr + argc, sizeof(uptr)))
+      {
          rc = -1;
          goto out;
       }
@@ -815,69 +815,175 @@ int vfs_futimens(fs_handle h, const struct k_timespec64 times[2])
    return fsops->futimens(hb->fs, fsops->get_inode(h), times);
 }
 
-ssize_t vfs_readv(fs_handle h, const struct iovec *iov, int iovcnt)
+/*
+ * Copy `len` bytes between `buf` and the user iovecs, starting from the
+ * position (*i, *off) in the iovecs and advancing it.
+ */
+static int
+iov_copy(const struct iovec *iov,
+         int *i,
+         size_t *off,
+         char *buf,
+         size_t len,
+         bool to_user)
 {
-   ssize_t rc;
-   size_t len;
-   struct fs_handle_base *hb = h;
-   struct task *curr = get_curr_task();
+   while (len > 0) {
+
+      char *ubuf;
+      size_t n;
+      int rc;
+
+      if (*off == iov[*i].iov_len) {
+         (*i)++;
+         *off = 0;
+         continue;
+      }
+
+      ubuf = (char *)iov[*i].iov_base + *off;
+      n = MIN(len, iov[*i].iov_len - *off);
+
+      rc = to_user
+         ? copy_to_user(ubuf, buf, n)
+         : copy_from_user(buf, ubuf, n);
+
+      if (rc)
+         return rc;
+
+      buf += n;
+      len -= n;
+      *off += n;
+   }
+
+   return 0;
+}
+
+ssize_t
+vfs_readv_copybuf(fs_handle h,
+                  const struct iovec *iov,
+                  int iovcnt,
+                  func_read func,
+                  offt *pos)
+{
+   char *copybuf = get_curr_task()->io_copybuf;
+   size_t rem = iov_total_len(iov, iovcnt);
+   size_t off = 0;
    ssize_t ret = 0;
+   int i = 0;
 
-   if (hb->fops->readv)
-      return hb->fops->readv(h, iov, iovcnt);
+   while (rem > 0) {
 
-   /*
-    * readv() is not implemented in the file system: implement here it in a
-    * generic but non-atomic way. There's nothing more we can do. Also, the
-    * POSIX standard does not require readv() to be atomic:
-    *
-    *    https://pubs.opengroup.org/onlinepubs/9699919799/
-    *
-    * Note: Linux's man page claims that readv/writev must be atomic: that's
-    * possible now because all of the Linux file systems support internally the
-    * scatter/gather I/O. On Tilck, not all the file systems will support it.
-    */
+      const size_t len = MIN(rem, IO_COPYBUF_SIZE);
+      ssize_t rc = func(h, copybuf, len, pos);
+      int copy_rc;
 
-   for (int i = 0; i < iovcnt; i++) {
+      if (rc <= 0) {
+         ret = ret ? ret : rc;
+         break;
+      }
+
+      if ((copy_rc = iov_copy(iov, &i, &off, copybuf, (size_t)rc, true)))
+         return ret ? ret : copy_rc;
+
+      ret += rc;
+      rem -= (size_t)rc;
+
+      if ((size_t)rc < len)
+         break; /* Not enough data to fill all the user buffers */
+   }
 
+   return ret;
+}
+
+ssize_t
+vfs_writev_copybuf(fs_handle h,
+                   const struct iovec *iov,
+                   int iovcnt,
+                   func_write func,
+                   offt *pos)
+{
+   char *copybuf = get_curr_task()->io_copybuf;
+   size_t rem = iov_total_len(iov, iovcnt);
+   size_t off = 0;
+   ssize_t ret = 0;
+   int i = 0;
+
+   while (rem > 0) {
+
+      const size_t len = MIN(rem, IO_COPYBUF_SIZE);
+      ssize_t rc;
       int copy_rc;
-      len = MIN(iov[i].iov_len, IO_COPYBUF_SIZE);
 
-      rc = vfs_read(h, curr->io_copybuf, len);
+      if ((copy_rc = iov_copy(iov, &i, &off, copybuf, len, false)))
+         return ret ? ret : copy_rc;
 
-      if (rc < 0) {
-         ret = rc;
+      rc = func(h, copybuf, len, pos);
+
+      if (rc <= 0) {
+         ret = ret ? ret : rc;
          break;
       }
 
-      copy_rc = copy_to_user(iov[i].iov_base, curr->io_copybuf, len);
-      if (copy_rc < 0)
-         return copy_rc;
+      ret += rc;
+      rem -= (size_t)rc;
+
+      if ((size_t)rc < len)
+         break; /* The file (or device) couldn't take all the data */
+   }
+
+   return ret;
+}
+
+/*
+ * The handles with VFS_SPFL_NO_USER_COPY read and write directly the user
+ * buffers, so they're called once per iovec.
+ */
+static ssize_t
+vfs_rw_iov_no_user_copy(fs_handle h,
+                        const struct iovec *iov,
+                        int iovcnt,
+                        bool write)
+{
+   ssize_t ret = 0;
+   ssize_t rc;
+
+   for (int i = 0; i < iovcnt; i++) {
+
+      rc = write
+         ? vfs_write(h, iov[i].iov_base, iov[i].iov_len)
+         : vfs_read(h, iov[i].iov_base, iov[i].iov_len);
+
+      if (rc < 0)
+         return ret ? ret : rc;
 
       ret += rc;
 
       if (rc < (ssize_t)iov[i].iov_len)
-         break; // Not enough data to fill all the user buffers.
+         break;
    }
 
    return ret;
 }
 
-ssize_t vfs_writev(fs_handle h, const struct iovec *iov, int iovcnt)
+ssize_t vfs_readv(fs_handle h, const struct iovec *iov, int iovcnt)
 {
-   ssize_t rc;
-   size_t len;
    struct fs_handle_base *hb = h;
-   struct task *curr = get_curr_task();
-   ssize_t ret = 0;
 
-   if (hb->fops->writev)
-      return hb->fops->writev(h, iov, iovcnt);
+   NO_TEST_ASSERT(is_preemption_enabled());
+   ASSERT(h != NULL);
+
+   if ((hb->fl_flags & O_WRONLY) && !(hb->fl_flags & O_RDWR))
+      return -EBADF; /* file not opened for reading */
+
+   if (hb->fops->readv)
+      return hb->fops->readv(h, iov, iovcnt);
+
+   if (!hb->fops->read)
+      return -EBADF;
 
    /*
-    * writev() is not implemented in the file system: implement here it in a
-    * generic but non-atomic way. There's nothing more we can do. Also, the
-    * POSIX standard does not require writev() to be atomic:
+    * readv() is not implemented in the file system: emulate it here on top of
+    * read(), in a non-atomic way when the iovecs exceed IO_COPYBUF_SIZE bytes.
+    * The POSIX standard does not require readv() to be atomic:
     *
     *    https://pubs.opengroup.org/onlinepubs/9699919799/
     *
@@ -886,30 +992,34 @@ ssize_t vfs_writev(fs_handle h, const struct iovec *iov, int iovcnt)
     * scatter/gather I/O. On Tilck, not all the file systems will support it.
     */
 
-   for (int i = 0; i < iovcnt; i++) {
+   if (hb->spec_flags & VFS_SPFL_NO_USER_COPY)
+      return vfs_rw_iov_no_user_copy(h, iov, iovcnt, false);
 
-      len = MIN(iov[i].iov_len, IO_COPYBUF_SIZE);
+   return vfs_readv_copybuf(h, iov, iovcnt, hb->fops->read, &hb->h_fpos);
+}
 
-      if (copy_from_user(curr->io_copybuf, iov[i].iov_base, len))
-         return -EFAULT;
+ssize_t vfs_writev(fs_handle h, const struct iovec *iov, int iovcnt)
+{
+   struct fs_handle_base *hb = h;
 
-      rc = vfs_write(h, curr->io_copybuf, len);
+   NO_TEST_ASSERT(is_preemption_enabled());
+   ASSERT(h != NULL);
 
-      if (rc < 0) {
-         ret = rc;
-         break;
-      }
+   if (!(hb->fl_flags & (O_WRONLY | O_RDWR)))
+      return -EBADF; /* file not opened for writing */
 
-      ret += rc;
+   if (hb->fops->writev)
+      return hb->fops->writev(h, iov, iovcnt);
 
-      if (rc < (ssize_t)iov[i].iov_len) {
-         // For some reason (perfectly legit) we couldn't write the whole
-         // user data (i.e. network card's buffers are full).
-         break;
-      }
-   }
+   if (!hb->fops->write)
+      return -EBADF;
 
-   return ret;
+   /* See the comment in vfs_readv() */
+
+   if (hb->spec_flags & VFS_SPFL_NO_USER_COPY)
+      return vfs_rw_iov_no_user_copy(h, iov, iovcnt, true);
+
+   return vfs_writev_copybuf(h, iov, iovcnt, hb->fops->write, &hb->h_fpos);
 }
 
 u32 vfs_get_new_device_id(void)
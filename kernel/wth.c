@@ -32,6 +32,14 @@
  *     worker-blind by design. Workers are bottom halves, not tasks
  *     competing for fairness.
  *
+ * Job queues: each worker has a lock-free safe_ringbuf, sized at creation.
+ * When it's full, jobs go in a per-worker overflow list, with nodes taken
+ * from a pool shared by all the workers, and stay in FIFO order: as long as
+ * the overflow list is not empty, new jobs are appended there. Once the
+ * ring has been drained, the worker doubles its size (up to
+ * WTH_MAX_QUEUE_SIZE) and moves the overflowed jobs in it. Jobs are dropped
+ * only when both the ring and the overflow pool are full.
+ *
  * Convention: worker_threads[0] is the singleton "generic" worker
  * created at boot by init_worker_threads() at WTH_PRIO_HIGHEST.
  * Subsystems (acpi, e1000, serial, kb, ...) register their own
@@ -39,8 +47,12 @@
  * priority — see the assert in wth_create_thread().
  */
 
+#include <tilck_gen_headers/mod_sysfs.h>
+
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/atomics.h>
+#include <tilck/common/string_util.h>
+#include <tilck/common/printk.h>
 
 #include <tilck/kernel/worker_thread.h>
 #include <tilck/kernel/kmalloc.h>
@@ -53,11 +65,19 @@
 #include <tilck/kernel/debug_utils.h>
 #include <tilck/kernel/sort.h>
 
+#if MOD_sysfs
+   #include <tilck/mods/sysfs.h>
+   #include <tilck/mods/sysfs_utils.h>
+#endif
+
 #include "wth_int.h"
 
 int worker_threads_cnt;
 struct worker_thread *worker_threads[WTH_MAX_THREADS];
 
+static struct wth_ovf_node ovf_pool[WTH_OVF_POOL_SIZE];
+static struct list ovf_free_list;
+
 u32 wth_get_queue_size(struct worker_thread *wth)
 {
    return wth->rb.max_elems;
@@ -79,6 +99,47 @@ wth_get_name(struct worker_thread *wth)
    return wth->name;
 }
 
+int wth_get_exec_stats(struct wth_exec_stats *buf, int max)
+{
+   int n = 0;
+
+   disable_preemption();
+   {
+      for (; n < worker_threads_cnt && n < max; n++) {
+
+         struct worker_thread *t = worker_threads[n];
+
+         buf[n] = (struct wth_exec_stats) {
+            .name = t->name,
+            .priority = t->priority,
+            .run = t->stats.run,
+            .exec_tot = t->stats.exec_tot,
+            .exec_max = t->stats.exec_max,
+         };
+      }
+   }
+   enable_preemption();
+   return n;
+}
+
+void wth_reset_run_stats(void)
+{
+   disable_preemption();
+   {
+      for (int i = 0; i < worker_threads_cnt; i++) {
+
+         struct wth_stats *st = &worker_threads[i]->stats;
+
+         st->run = 0;
+         st->lat_tot = 0;
+         st->lat_max = 0;
+         st->exec_tot = 0;
+         st->exec_max = 0;
+      }
+   }
+   enable_preemption();
+}
+
 static long wth_cmp_func(const void *a, const void *b)
 {
    const struct worker_thread *const *wa = a;
@@ -86,14 +147,106 @@ static long wth_cmp_func(const void *a, const void *b)
    return (*wa)->priority - (*wb)->priority;
 }
 
-NODISCARD bool
-wth_enqueue_on(struct worker_thread *t, void (*func)(void *), void *arg)
+static u32 wth_get_depth(struct worker_thread *t)
+{
+   return safe_ringbuf_get_count(&t->rb) + t->ovf_count;
+}
+
+/*
+ * Append a job to the overflow list. Returns false when the pool is empty.
+ * Must be called with interrupts disabled.
+ */
+static bool
+wth_ovf_push(struct worker_thread *t, struct wjob *job, bool *was_empty)
+{
+   struct wth_ovf_node *n;
+
+   if (list_is_empty(&ovf_free_list)) {
+      t->stats.dropped++;
+      return false;
+   }
+
+   *was_empty = !t->ovf_count && safe_ringbuf_is_empty(&t->rb);
+
+   n = list_first_obj(&ovf_free_list, struct wth_ovf_node, node);
+   list_remove(&n->node);
+   n->job = *job;
+   list_add_tail(&t->ovf_list, &n->node);
+   t->ovf_count++;
+   t->stats.overflowed++;
+   return true;
+}
+
+/* Pop the oldest overflowed job. Must be called with interrupts disabled. */
+static bool
+wth_ovf_pop(struct worker_thread *t, struct wjob *job)
+{
+   struct wth_ovf_node *n;
+
+   if (!t->ovf_count)
+      return false;
+
+   n = list_first_obj(&t->ovf_list, struct wth_ovf_node, node);
+   list_remove(&n->node);
+   *job = n->job;
+   list_add_tail(&ovf_free_list, &n->node);
+   t->ovf_count--;
+   return true;
+}
+
+/*
+ * Look for a pending job identical to `job`. Scanning the ring is safe only
+ * if we didn't interrupt a write to it: the slot claimed by that write might
+ * not contain the new job yet. In that case, just don't coalesce.
+ */
+static bool
+wth_coalesce(struct worker_thread *t, struct wjob *job)
+{
+   struct wth_ovf_node *pos;
+   bool found = false;
+   ulong var;
+
+   disable_interrupts(&var);
+   {
+      if (!atomic_load(&t->rb_writers)) {
+
+         const u16 count = safe_ringbuf_get_count(&t->rb);
+
+         for (u16 i = 0; i < count && !found; i++) {
+            struct wjob *j = safe_ringbuf_peek_elem(&t->rb, i);
+            found = j->func == job->func && j->arg == job->arg;
+         }
+      }
+
+      list_for_each_ro(pos, &t->ovf_list, node) {
+
+         if (found)
+            break;
+
+         found = pos->job.func == job->func && pos->job.arg == job->arg;
+      }
+
+      if (found)
+         t->stats.coalesced++;
+   }
+   enable_interrupts(&var);
+   return found;
+}
+
+static bool
+wth_enqueue_int(struct worker_thread *t,
+                void (*func)(void *),
+                void *arg,
+                bool coalesce,
+                bool requeue)
 {
-   bool success, was_empty;
+   bool success = false, was_empty = false;
    struct wjob new_job = {
       .func = func,
       .arg = arg,
+      .tsc = RDTSC(),
    };
+   ulong var;
 
    ASSERT(t != NULL);
 
@@ -113,12 +266,36 @@ wth_enqueue_on(struct worker_thread *t, void (*func)(void *), void *arg)
     * there. We MUST allow that to happen.
     */
 
-   if (get_curr_task() == t->task)
+   if (requeue)
+      ASSERT(get_curr_task() == t->task);
+   else if (get_curr_task() == t->task)
       check_in_irq_handler();
 
 #endif
 
-   success = safe_ringbuf_write_elem(&t->rb, &new_job, &was_empty);
+   if (coalesce && wth_coalesce(t, &new_job)) {
+      enable_preemption();
+      return true;
+   }
+
+   /* Fast path: lock-free, unless older jobs are waiting in the overflow */
+   if (LIKELY(!t->ovf_count)) {
+      atomic_fetch_add(&t->rb_writers, 1);
+      success = safe_ringbuf_write_elem(&t->rb, &new_job, &was_empty);
+      atomic_fetch_sub(&t->rb_writers, 1);
+   }
+
+   disable_interrupts(&var);
+   {
+      if (!success)
+         success = wth_ovf_push(t, &new_job, &was_empty);
+
+      if (success) {
+         t->stats.enqueued++;
+         t->stats.max_depth = MAX(t->stats.max_depth, wth_get_depth(t));
+      }
+   }
+   enable_interrupts(&var);
 
    if (success && was_empty && t->waiting_for_jobs) {
       wth_wakeup(t);
@@ -128,6 +305,24 @@ wth_enqueue_on(struct worker_thread *t, void (*func)(void *), void *arg)
    return success;
 }
 
+NODISCARD bool
+wth_enqueue_on(struct worker_thread *t, void (*func)(void *), void *arg)
+{
+   return wth_enqueue_int(t, func, arg, false, false);
+}
+
+NODISCARD bool
+wth_enqueue_once_on(struct worker_thread *t, void (*func)(void *), void *arg)
+{
+   return wth_enqueue_int(t, func, arg, true, false);
+}
+
+NODISCARD bool
+wth_requeue_self(struct worker_thread *t, void (*func)(void *), void *arg)
+{
+   return wth_enqueue_int(t, func, arg, false, true);
+}
+
 NODISCARD bool
 wth_enqueue_anywhere(int lowest_prio, void (*func)(void *), void *arg)
 {
@@ -175,6 +370,51 @@ wth_find_worker(int lowest_prio)
    return worker_threads[0];
 }
 
+/*
+ * Called by the worker when its ring is empty but there are overflowed jobs:
+ * no producer is writing to the ring (they append to the overflow list), so
+ * we can replace it with a bigger one and move the overflowed jobs there.
+ */
+static void wth_grow_queue(struct worker_thread *t)
+{
+   const u16 old_size = t->rb.max_elems;
+   const u16 new_size = (u16)MIN(2u * old_size, (u32)t->max_queue_size);
+   struct wjob *new_jobs, *to_free;
+   u16 to_free_size;
+   struct wjob job;
+   bool was_empty;
+   ulong var;
+
+   if (new_size <= old_size)
+      return;
+
+   if (!(new_jobs = kalloc_array_obj(struct wjob, new_size)))
+      return;
+
+   to_free = new_jobs;
+   to_free_size = new_size;
+
+   disable_interrupts(&var);
+   {
+      if (safe_ringbuf_is_empty(&t->rb) && !atomic_load(&t->rb_writers)) {
+
+         to_free = t->jobs;
+         to_free_size = old_size;
+
+         t->jobs = new_jobs;
+         safe_ringbuf_init(&t->rb, new_size, sizeof(struct wjob), new_jobs);
+
+         while (!safe_ringbuf_is_full(&t->rb) && wth_ovf_pop(t, &job))
+            safe_ringbuf_write_elem(&t->rb, &job, &was_empty);
+
+         t->stats.grows++;
+      }
+   }
+   enable_interrupts(&var);
+
+   kfree_array_obj(to_free, struct wjob, to_free_size);
+}
+
 bool wth_process_single_job(struct worker_thread *t)
 {
    bool success;
@@ -193,9 +433,38 @@ bool wth_process_single_job(struct worker_thread *t)
 
    success = safe_ringbuf_read_elem(&t->rb, &job_to_run);
 
+   if (!success && t->ovf_count) {
+
+      ulong var;
+      wth_grow_queue(t);
+      success = safe_ringbuf_read_elem(&t->rb, &job_to_run);
+
+      if (!success) {
+         disable_interrupts(&var);
+         {
+            success = wth_ovf_pop(t, &job_to_run);
+         }
+         enable_interrupts(&var);
+      }
+   }
+
    if (success) {
+
+      const u64 start = RDTSC();
+      const u64 lat = start - job_to_run.tsc;
+      u64 exec;
+
+      t->stats.run++;
+      t->stats.lat_tot += lat;
+      t->stats.lat_max = MAX(t->stats.lat_max, lat);
+
       /* Run the job with preemption enabled */
       job_to_run.func(job_to_run.arg);
+
+      /* Wall-clock time: includes the time the job has been preempted */
+      exec = RDTSC() - start;
+      t->stats.exec_tot += exec;
+      t->stats.exec_max = MAX(t->stats.exec_max, exec);
    }
 
    return success;
@@ -233,7 +502,7 @@ void wth_run(void *arg)
           * unrelated wakeup.
           */
          const bool sleep_ok =
-            safe_ringbuf_is_empty(&t->rb) &&
+            safe_ringbuf_is_empty(&t->rb) && !t->ovf_count &&
             (t != worker_threads[0] || !ktimer_has_pending_deferred());
 
          if (sleep_ok) {
@@ -330,6 +599,8 @@ wth_create_thread(const char *name, int priority, u16 queue_size)
    idx = worker_threads_cnt;
    t->name = name;
    t->priority = priority;
+   t->max_queue_size = MAX(queue_size, (u16)WTH_MAX_QUEUE_SIZE);
+   list_init(&t->ovf_list);
    t->jobs = kzalloc_array_obj(struct wjob, queue_size);
 
    if (!t->jobs) {
@@ -377,6 +648,96 @@ init_wth_create_worker_or_die(int prio, u16 queue_size)
 
 void init_worker_threads(void)
 {
+   list_init(&ovf_free_list);
+
+   for (int i = 0; i < ARRAY_SIZE(ovf_pool); i++)
+      list_add_tail(&ovf_free_list, &ovf_pool[i].node);
+
    worker_threads_cnt = 0;
    init_wth_create_worker_or_die(WTH_PRIO_HIGHEST, WTH_MAX_PRIO_QUEUE_SIZE);
 }
+
+#if MOD_sysfs
+
+#define WTH_REPORT_LINE_MAX                  192
+
+static offt
+wth_report_get_buf_sz(struct sysobj *obj, void *data)
+{
+   return (WTH_MAX_THREADS + 2) * WTH_REPORT_LINE_MAX;
+}
+
+/*
+ * One line per worker: queue size and current/max depth, the job counters,
+ * the average and max latency between the enqueue and the start of a job
+ * and the average and max duration of the jobs, in TSC cycles.
+ */
+static offt
+wth_report_load(struct sysobj *obj, void *data, void *buf, offt sz, offt off)
+{
+   size_t used = 0;
+
+#define WR(...)                                                      \
+   used += (size_t)snprintk((char *)buf + used,                      \
+                            (size_t)sz - used, __VA_ARGS__)
+
+   WR("%-10s %4s %5s %5s %6s %9s %9s %9s %7s %5s %12s %12s %12s %12s\n",
+      "name", "prio", "qsize", "depth", "maxdep", "enqueued", "coalesced",
+      "overflow", "dropped", "grows", "avg_lat", "max_lat",
+      "avg_exec", "max_exec");
+
+   disable_preemption();
+   {
+      for (int i = 0; i < worker_threads_cnt; i++) {
+
+         struct worker_thread *t = worker_threads[i];
+         const struct wth_stats *st = &t->stats;
+
+         WR("%-10s %4d %5u %5u %6u %9u %9u %9u %7u %5u "
+            "%12llu %12llu %12llu %12llu\n",
+            t->name ? t->name : "generic", t->priority, t->rb.max_elems,
+            wth_get_depth(t), st->max_depth, st->enqueued, st->coalesced,
+            st->overflowed, st->dropped, st->grows,
+            st->run ? st->lat_tot / st->run : 0, st->lat_max,
+            st->run ? st->exec_tot / st->run : 0, st->exec_max);
+      }
+   }
+   enable_preemption();
+
+#undef WR
+
+   return (offt)used;
+}
+
+static const struct sysobj_prop_type wth_report_prop_type = {
+   .buf_type   = SYSFS_BUF_BUFFERED,
+   .get_buf_sz = &wth_report_get_buf_sz,
+   .load       = &wth_report_load,
+};
+
+DEF_STATIC_SYSOBJ_PROP(stats, &wth_report_prop_type);
+
+DEF_STATIC_SYSOBJ_TYPE(wth_sysobj_type,
+                       &prop_stats,
+                       NULL);
+
+void register_wth_sysfs(void)
+{
+   struct sysobj *obj;
+
+   obj = sysfs_create_obj(&wth_sysobj_type,
+                          NULL,                   /* hooks */
+                          NULL);                  /* stats */
+
+   if (!obj)
+      return;
+
+   if (sysfs_register_obj(NULL, &sysfs_root_obj, "wth", obj) < 0)
+      sysfs_destroy_unregistered_obj(obj);
+}
+
+#else  /* !MOD_sysfs */
+
+void register_wth_sysfs(void) { /* no-op */ }
+
+#endif /* MOD_sysfs */
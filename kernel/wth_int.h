@@ -3,10 +3,33 @@
 #pragma once
 #include <tilck/kernel/safe_ringbuf.h>
 #include <tilck/kernel/sync.h>
+#include <tilck/kernel/list.h>
 
 struct wjob {
    void (*func)(void *);
    void *arg;
+   u64 tsc;                   /* enqueue time, for the latency stats */
+};
+
+/* A job that didn't fit in the ring buffer, from the shared overflow pool */
+struct wth_ovf_node {
+   struct list_node node;
+   struct wjob job;
+};
+
+struct wth_stats {
+
+   u32 enqueued;              /* jobs accepted */
+   u32 coalesced;             /* jobs merged into an identical pending one */
+   u32 overflowed;            /* jobs that went in the overflow list */
+   u32 dropped;               /* jobs rejected: ring and overflow pool full */
+   u32 grows;                 /* times the ring buffer has been enlarged */
+   u32 max_depth;             /* max number of pending jobs */
+   u32 run;                   /* jobs run */
+   u64 lat_tot;               /* sum of the enqueue -> run latencies (cycles) */
+   u64 lat_max;               /* max enqueue -> run latency (cycles) */
+   u64 exec_tot;              /* time spent running jobs (cycles) */
+   u64 exec_max;              /* max duration of a single job (cycles) */
 };
 
 struct worker_thread {
@@ -14,8 +37,13 @@ struct worker_thread {
    const char *name;
    struct wjob *jobs;
    struct safe_ringbuf rb;
+   struct list ovf_list;      /* jobs not fitting in `rb`, newer than those */
+   u32 ovf_count;
+   u16 max_queue_size;        /* limit for growing `rb` */
+   atomic_int_t rb_writers;   /* on-going writes to `rb` (nested in IRQs) */
    struct task *task;
    struct kcond completion;
+   struct wth_stats stats;
    int priority;              /* 0 is the max priority */
    volatile bool waiting_for_jobs;
 };
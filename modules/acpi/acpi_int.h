@@ -18,6 +18,28 @@ struct basic_battery_info {
    bool has_BIX;
 };
 
+struct acpi_init_stage_stats {
+
+   bool done;
+   u64 cycles;          /* TSC cycles spent in the stage */
+   long heap_delta;     /* change of the kmalloc heaps usage, in bytes */
+};
+
+struct acpi_init_stats {
+
+   struct acpi_init_stage_stats tables;   /* static tables (FADT, MADT ..) */
+   struct acpi_init_stage_stats ns;       /* namespace load and evaluation */
+   const char *ns_trigger;                /* what caused the namespace load */
+};
+
+extern struct acpi_init_stats acpi_init_stats;
+
+const char *
+acpi_init_status_str(void);
+
+void
+register_acpi_init_sysfs(void);
+
 void
 print_acpi_failure(const char *func, const char *farg, ACPI_STATUS rc);
 
@@ -11,6 +11,9 @@
 #include <tilck/kernel/debug_utils.h>
 #include <tilck/kernel/cmdline.h>
 #include <tilck/kernel/uefi.h>
+#include <tilck/kernel/sync.h>
+#include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/kmalloc_debug.h>
 
 #include <tilck/mods/pci.h>
 #include <tilck/mods/acpi.h>
@@ -30,6 +33,14 @@ static u8 acpi_fadt_revision;
 static u16 acpi_iapc_boot_arch;
 static u32 acpi_fadt_flags;
 
+/* Memory and time spent in each init stage, see /syst/acpi_init */
+struct acpi_init_stats acpi_init_stats;
+
+/* -acpi_lazy: the namespace is loaded on first use */
+static bool acpi_ns_load_pending;
+static struct kmutex acpi_ns_load_mutex
+   = STATIC_KMUTEX_INIT(acpi_ns_load_mutex, 0);
+
 /* Callback lists */
 static struct list on_subsystem_enabled_cb_list
    = STATIC_LIST_INIT(on_subsystem_enabled_cb_list);
@@ -96,6 +107,61 @@ print_acpi_failure(const char *func, const char *farg, ACPI_STATUS rc)
    }
 }
 
+const char *
+acpi_init_status_str(void)
+{
+   static const char *const names[] = {
+      [ais_not_started]        = "not_started",
+      [ais_tables_initialized] = "tables_initialized",
+      [ais_tables_loaded]      = "tables_loaded",
+      [ais_subsystem_enabled]  = "subsystem_enabled",
+      [ais_fully_initialized]  = "fully_initialized",
+   };
+
+   if (acpi_init_status == ais_failed)
+      return "failed";
+
+   return names[acpi_init_status];
+}
+
+static size_t
+acpi_heaps_mem_allocated(void)
+{
+   struct debug_kmalloc_heap_info hi;
+   size_t tot = 0;
+
+   disable_preemption();
+   {
+      for (int i = 0; i < KMALLOC_HEAPS_COUNT; i++) {
+
+         if (!debug_kmalloc_get_heap_info(i, &hi))
+            break;
+
+         tot += hi.mem_allocated;
+      }
+   }
+   enable_preemption();
+   return tot;
+}
+
+static void
+acpi_stage_begin(struct acpi_init_stage_stats *st)
+{
+   st->heap_delta = -(long)acpi_heaps_mem_allocated();
+   st->cycles = RDTSC();
+}
+
+static void
+acpi_stage_end(struct acpi_init_stage_stats *st, const char *name)
+{
+   st->cycles = RDTSC() - st->cycles;
+   st->heap_delta += (long)acpi_heaps_mem_allocated();
+   st->done = true;
+
+   printk("ACPI: %s: %" PRIu64 " cycles, heap delta: %ld bytes\n",
+          name, st->cycles, st->heap_delta);
+}
+
 enum tristate
 acpi_is_8042_present(void)
 {
@@ -224,8 +290,8 @@ acpi_poweroff(void)
    print_acpi_failure("AcpiEnterSleepState", NULL, rc);
 }
 
-void
-acpi_mod_init_tables(void)
+static void
+acpi_init_tables(void)
 {
    ACPI_STATUS rc;
 
@@ -282,6 +348,14 @@ acpi_mod_init_tables(void)
    acpi_read_acpi_hw_flags();
 }
 
+void
+acpi_mod_init_tables(void)
+{
+   acpi_stage_begin(&acpi_init_stats.tables);
+   acpi_init_tables();
+   acpi_stage_end(&acpi_init_stats.tables, "static tables");
+}
+
 void
 acpi_mod_load_tables(void)
 {
@@ -562,16 +636,54 @@ acpi_has_method(ACPI_HANDLE obj, const char *name)
    return ACPI_SUCCESS(AcpiGetHandle(obj, (ACPI_STRING)name, &ret));
 }
 
+static void
+acpi_load_ns(void)
+{
+   acpi_stage_begin(&acpi_init_stats.ns);
+   acpi_mod_load_tables();
+   acpi_mod_enable_subsystem();
+   acpi_stage_end(&acpi_init_stats.ns, "namespace");
+}
+
+void
+acpi_ensure_ns_loaded(const char *trigger)
+{
+   if (!acpi_ns_load_pending || !is_preemption_enabled() || in_panic())
+      return;
+
+   kmutex_lock(&acpi_ns_load_mutex);
+   {
+      if (acpi_ns_load_pending) {
+         printk("ACPI: lazy namespace load, trigger: %s\n", trigger);
+         acpi_init_stats.ns_trigger = trigger;
+         acpi_load_ns();
+         acpi_ns_load_pending = false;
+      }
+   }
+   kmutex_unlock(&acpi_ns_load_mutex);
+}
+
 static void
 acpi_module_init(void)
 {
+   register_acpi_init_sysfs();
+
    if (kopt_noacpi) {
       printk("ACPI: don't load tables and switch to ACPI mode (-noacpi)\n");
       return;
    }
 
-   acpi_mod_load_tables();
-   acpi_mod_enable_subsystem();
+   if (acpi_init_status == ais_failed)
+      return;
+
+   if (kopt_acpi_lazy) {
+      printk("ACPI: defer the namespace load to first use (-acpi_lazy)\n");
+      acpi_ns_load_pending = true;
+      return;
+   }
+
+   acpi_init_stats.ns_trigger = "boot";
+   acpi_load_ns();
 }
 
 static struct module acpi_module = {
@@ -579,6 +691,7 @@ static struct module acpi_module = {
    .name = "acpi",
    .priority = MOD_acpi_prio,
    .init = &acpi_module_init,
+   .deps = MODULE_DEPS("pci"),
 };
 
 REGISTER_MODULE(&acpi_module);
@@ -9,6 +9,8 @@
 
 #include <tilck/kernel/kmalloc.h>
 #include <tilck/kernel/errno.h>
+#include <tilck/kernel/cmdline.h>
+#include <tilck/kernel/boot_trace.h>
 #include <tilck/mods/acpi.h>
 #include <tilck/mods/sysfs.h>
 #include <tilck/mods/sysfs_utils.h>
@@ -654,6 +656,98 @@ register_acpi_obj_in_sysfs(ACPI_HANDLE parent_obj,
    return AE_OK;
 }
 
+static void
+acpi_init_report_stage(char *buf, offt sz, size_t *used, u32 khz,
+                       const char *name, struct acpi_init_stage_stats *st)
+{
+   if (!st->done) {
+      *used += (size_t)snprintk(buf + *used, (size_t)sz - *used,
+                                "%-10s not done\n", name);
+      return;
+   }
+
+   *used += (size_t)snprintk(buf + *used, (size_t)sz - *used,
+                             "%-10s %12llu cycles %10llu us %10ld heap bytes\n",
+                             name, st->cycles,
+                             khz ? st->cycles * 1000 / khz : 0,
+                             st->heap_delta);
+}
+
+/*
+ * The init mode and status, plus the time and the heap memory spent on the
+ * static tables and on the namespace, to compare the eager and the lazy mode.
+ */
+static offt
+acpi_init_report_load(struct sysobj *obj, void *data,
+                      void *buf, offt sz, offt off)
+{
+   const u32 khz = boot_trace_tsc_khz();
+   const char *trigger = acpi_init_stats.ns_trigger;
+   size_t used = 0;
+
+   used += (size_t)snprintk((char *)buf + used, (size_t)sz - used,
+                            "mode:    %s\nstatus:  %s\ntrigger: %s\n\n",
+                            kopt_acpi_lazy ? "lazy" : "eager",
+                            acpi_init_status_str(),
+                            trigger ? trigger : "none");
+
+   acpi_init_report_stage(buf, sz, &used, khz, "tables",
+                          &acpi_init_stats.tables);
+   acpi_init_report_stage(buf, sz, &used, khz, "namespace",
+                          &acpi_init_stats.ns);
+   return (offt)used;
+}
+
+static offt
+acpi_init_load_load(struct sysobj *obj, void *data,
+                    void *buf, offt sz, offt off)
+{
+   return snprintk(buf, (size_t)sz, "%d\n",
+                   get_acpi_init_status() >= ais_tables_loaded);
+}
+
+/* Writing anything to /syst/acpi_init/load loads the namespace, if needed */
+static offt
+acpi_init_load_store(struct sysobj *obj, void *data, void *buf, offt sz)
+{
+   acpi_ensure_ns_loaded("sysfs");
+   return sz;
+}
+
+static const struct sysobj_prop_type acpi_init_report_prop_type = {
+   .load = &acpi_init_report_load,
+};
+
+static const struct sysobj_prop_type acpi_init_load_prop_type = {
+   .load = &acpi_init_load_load,
+   .store = &acpi_init_load_store,
+};
+
+DEF_STATIC_SYSOBJ_PROP(report, &acpi_init_report_prop_type);
+DEF_STATIC_SYSOBJ_PROP(load, &acpi_init_load_prop_type);
+
+DEF_STATIC_SYSOBJ_TYPE(acpi_init_sysobj_type,
+                       &prop_report,
+                       &prop_load,
+                       NULL);
+
+void
+register_acpi_init_sysfs(void)
+{
+   struct sysobj *obj;
+
+   obj = sysfs_create_obj(&acpi_init_sysobj_type,
+                          NULL,                   /* hooks */
+                          NULL,                   /* report */
+                          NULL);                  /* load */
+
+   if (!obj)
+      return;
+
+   if (sysfs_register_obj(NULL, &sysfs_root_obj, "acpi_init", obj) < 0)
+      sysfs_destroy_unregistered_obj(obj);
+}
+
 #else
 
 ACPI_STATUS
@@ -664,4 +758,7 @@ register_acpi_obj_in_sysfs(ACPI_HANDLE parent_obj,
    return AE_OK;
 }
 
+void
+register_acpi_init_sysfs(void) { /* no-op */ }
+
 #endif /* MOD_sysfs */
@@ -11,19 +11,23 @@
 
 #include <tilck_gen_headers/mod_tracing.h>
 #include <tilck_gen_headers/config_kmalloc.h>
+#include <tilck_gen_headers/config_debug.h>
 
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/string_util.h>
 #include <tilck/common/syscalls.h>
 #include <tilck/common/dp_abi.h>
+#include <tilck/common/boot.h>
 #include <tilck/common/utils.h>
 
 #include <tilck/kernel/errno.h>
+#include <tilck/kernel/hal.h>
 #include <tilck/kernel/user.h>
 #include <tilck/kernel/kmalloc.h>
 #include <tilck/kernel/kmalloc_debug.h>
 #include <tilck/kernel/sched.h>
 #include <tilck/kernel/process.h>
+#include <tilck/kernel/process_mm.h>
 #include <tilck/kernel/syscalls.h>
 #include <tilck/kernel/tty.h>
 #include <tilck/kernel/worker_thread.h>
@@ -33,6 +37,9 @@
 #include <tilck/kernel/cmdline.h>         /* kopt_ttys */
 #include <tilck/kernel/datetime.h>        /* clock_*resync* */
 #include <tilck/kernel/debug_utils.h>     /* register_tilck_cmd */
+#include <tilck/kernel/irqsoff.h>
+#include <tilck/kernel/irq_stats.h>
+#include <tilck/kernel/boot_trace.h>
 #include <tilck/kernel/modules.h>         /* REGISTER_MODULE */
 
 #include <tilck/mods/fb_console.h>        /* use_framebuffer + fb_* */
@@ -55,7 +62,6 @@ STATIC_ASSERT(sizeof(struct dp_printk_event_data) ==
 #endif
 
 #ifdef arch_x86_family
-   #include <tilck/kernel/hal.h>
    #include <tilck/common/arch/generic_x86/asm_consts.h>
    #include <tilck/common/arch/generic_x86/x86_utils.h>
 #endif
@@ -74,6 +80,25 @@ int dp_mini_debugger_tool(void);
 
 /* ---------------------------- TASKS --------------------------------- */
 
+static void
+dp_fill_task_sched_info(struct task *ti, struct dp_task_info *out)
+{
+   ulong var;
+
+   if (!ti->lat)
+      return;
+
+   disable_interrupts(&var);
+   {
+      out->nvcsw          = ti->lat->nvcsw;
+      out->nivcsw         = ti->lat->nivcsw;
+      out->wakeups        = ti->lat->wakeups;
+      out->wakeup_lat_tot = ti->lat->tot_cycles;
+      out->wakeup_lat_max = ti->lat->max_cycles;
+   }
+   enable_interrupts(&var);
+}
+
 static void dp_fill_task_info(struct task *ti, struct dp_task_info *out)
 {
    struct process *pi = ti->pi;
@@ -110,6 +135,14 @@ static void dp_fill_task_info(struct task *ti, struct dp_task_info *out)
          pi->debug_cmdline ? pi->debug_cmdline : "<n/a>";
       snprintk(out->name, sizeof(out->name), "%s", cmdline);
    }
+
+   dp_fill_task_sched_info(ti, out);
+
+   if (pi->mi) {
+      out->rss_pages = (u32) pi->mi->usage.rss_pages;
+      out->shared_pages = (u32) pi->mi->usage.shared_pages;
+      out->pt_pages = (u32) pi->mi->usage.pt_pages;
+   }
 }
 
 struct dp_get_tasks_ctx {
@@ -313,44 +346,94 @@ tilck_sys_dp_get_kmalloc_chunks(ulong u_buf, ulong max_count,
 
 /* ---------------------------- IRQ STATS ------------------------------ */
 
+STATIC_ASSERT(DP_IRQ_LINES == IRQ_STATS_MAX_IRQS);
+STATIC_ASSERT(DP_IRQ_HIST_BUCKETS == IRQ_STATS_HIST_BUCKETS);
+
+static void
+dp_fill_irq_bh_stats(struct dp_irq_stats *out)
+{
+   struct wth_exec_stats st[DP_IRQ_BH_MAX];
+   const int n = wth_get_exec_stats(st, ARRAY_SIZE(st));
+
+   for (int i = 0; i < n; i++) {
+
+      struct dp_irq_bh_stats *bh = &out->bh[i];
+
+      if (st[i].name)
+         snprintk(bh->name, sizeof(bh->name), "%s", st[i].name);
+
+      bh->priority = st[i].priority;
+      bh->run      = st[i].run;
+      bh->exec_tot = st[i].exec_tot;
+      bh->exec_max = st[i].exec_max;
+   }
+
+   out->bh_count = (u32)n;
+}
+
 static int
-tilck_sys_dp_get_irq_stats(ulong u_out, ulong _2, ulong _3, ulong _4)
+tilck_sys_dp_get_irq_stats(ulong u_out, ulong flags, ulong _3, ulong _4)
 {
    extern u32 spur_irq_count;
    extern u32 unhandled_irq_count[256];
 
-   struct dp_irq_stats out = {0};
+   struct dp_irq_stats *out;
+   struct irq_line_stats s;
    u32 mask = 0;
    int rc;
 
-   if (user_out_of_range((void *)u_out, sizeof(out)))
+   if (user_out_of_range((void *)u_out, sizeof(*out)))
       return -EFAULT;
 
+   if (!(out = kzalloc_obj(struct dp_irq_stats)))
+      return -ENOMEM;
+
    if (KRN_TRACK_NESTED_INTERR) {
       extern u32 slow_timer_irq_handler_count;
-      out.slow_timer_count = slow_timer_irq_handler_count;
+      out->slow_timer_count = slow_timer_irq_handler_count;
    }
 
-   out.spur_irq_count    = spur_irq_count;
-   out.ticks_at_snapshot = get_ticks();
+   out->spur_irq_count    = spur_irq_count;
+   out->ticks_at_snapshot = get_ticks();
+   out->tsc_at_snapshot   = RDTSC();
+   out->tsc_khz           = boot_trace_tsc_khz();
+   out->max_nesting       = irq_stats_max_nesting();
 
-   STATIC_ASSERT(ARRAY_SIZE(out.unhandled_count) ==
+   STATIC_ASSERT(ARRAY_SIZE(out->unhandled_count) ==
                  ARRAY_SIZE(unhandled_irq_count));
 
    for (u32 i = 0; i < ARRAY_SIZE(unhandled_irq_count); i++)
-      out.unhandled_count[i] = unhandled_irq_count[i];
+      out->unhandled_count[i] = unhandled_irq_count[i];
 
    for (int i = 0; i < 16; i++)
       if (!irq_is_masked(i))
          mask |= (1u << i);
 
-   out.unmasked_mask_lo16 = mask;
+   out->unmasked_mask_lo16 = mask;
 
-   rc = copy_to_user((void *)u_out, &out, sizeof(out));
-   if (rc)
-      return rc;
+   for (int i = 0; i < DP_IRQ_LINES; i++) {
 
-   return 0;
+      struct dp_irq_line_stats *l = &out->lines[i];
+      irq_stats_get(i, &s);
+
+      l->count      = s.count;
+      l->tot_cycles = s.tot_cycles;
+      l->max_cycles = s.max_cycles;
+      l->spurious   = s.spurious;
+      l->unhandled  = unhandled_irq_count[i];
+      memcpy(l->hist, s.hist, sizeof(l->hist));
+   }
+
+   dp_fill_irq_bh_stats(out);
+
+   if (flags & DP_IRQ_FL_RESET) {
+      irq_stats_reset();
+      wth_reset_run_stats();
+   }
+
+   rc = copy_to_user((void *)u_out, out, sizeof(*out));
+   kfree_obj(out, struct dp_irq_stats);
+   return rc;
 }
 
 /* ---------------------------- MEM MAP ------------------------------- */
@@ -607,6 +690,137 @@ tilck_sys_dp_get_runtime_info(ulong u_out, ulong _2, ulong _3, ulong _4)
    return 0;
 }
 
+/* ---------------------------- IRQSOFF TRACER ------------------------ */
+
+STATIC_ASSERT(DP_IRQSOFF_HIST_BUCKETS == IRQSOFF_HIST_BUCKETS);
+STATIC_ASSERT(DP_IRQSOFF_TOP_N == IRQSOFF_TOP_N);
+
+static void
+dp_fill_irqsoff_kind(enum irqsoff_kind k, struct dp_irqsoff_kind_stats *out)
+{
+   struct irqsoff_stats s;
+   irqsoff_get_stats(k, &s);
+
+   out->count      = s.count;
+   out->tot_cycles = s.tot_cycles;
+   out->max_cycles = s.max_cycles;
+   memcpy(out->hist, s.hist, sizeof(out->hist));
+
+   for (int i = 0; i < IRQSOFF_TOP_N && s.top[i].cycles; i++) {
+
+      struct dp_irqsoff_site *site = &out->top[i];
+
+      site->cycles = s.top[i].cycles;
+      irqsoff_ip_to_str(s.top[i].begin_ip, site->begin, sizeof(site->begin));
+      irqsoff_ip_to_str(s.top[i].end_ip, site->end, sizeof(site->end));
+   }
+}
+
+static int
+tilck_sys_dp_get_irqsoff_stats(ulong u_out, ulong flags, ulong _3, ulong _4)
+{
+   struct dp_irqsoff_stats *out;
+   int rc;
+
+   if (!KRN_IRQSOFF_TRACER)
+      return -EOPNOTSUPP;
+
+   if (user_out_of_range((void *)u_out, sizeof(*out)))
+      return -EFAULT;
+
+   if (!(out = kzalloc_obj(struct dp_irqsoff_stats)))
+      return -ENOMEM;
+
+   dp_fill_irqsoff_kind(IRQSOFF_IRQS, &out->irqs);
+   dp_fill_irqsoff_kind(IRQSOFF_PREEMPT, &out->preempt);
+
+   if (flags & DP_IRQSOFF_FL_RESET) {
+      irqsoff_reset_stats(IRQSOFF_IRQS);
+      irqsoff_reset_stats(IRQSOFF_PREEMPT);
+   }
+
+   rc = copy_to_user((void *)u_out, out, sizeof(*out));
+   kfree_obj(out, struct dp_irqsoff_stats);
+   return rc;
+}
+
+/* ---------------------------- SCHED STATS --------------------------- */
+
+STATIC_ASSERT(DP_SCHED_LAT_HIST_BUCKETS == SCHED_LAT_HIST_BUCKETS);
+STATIC_ASSERT(DP_SCHED_RQ_HIST_BUCKETS == SCHED_RQ_HIST_BUCKETS);
+
+static int
+tilck_sys_dp_get_sched_stats(ulong tid, ulong u_out, ulong flags, ulong _4)
+{
+   struct sched_lat_stats s;
+   struct dp_sched_stats out;
+
+   if (user_out_of_range((void *)u_out, sizeof(out)))
+      return -EFAULT;
+
+   if (!sched_stats_get((int)tid, &s))
+      return -ESRCH;
+
+   if (flags & DP_SCHED_FL_RESET)
+      sched_stats_reset();
+
+   out = (struct dp_sched_stats) {
+      .wakeups = s.wakeups,
+      .nvcsw   = s.nvcsw,
+      .nivcsw  = s.nivcsw,
+      .lat_tot = s.tot_cycles,
+      .lat_max = s.max_cycles,
+   };
+
+   memcpy(out.lat_hist, s.lat_hist, sizeof(out.lat_hist));
+   memcpy(out.rq_hist, s.rq_hist, sizeof(out.rq_hist));
+   return copy_to_user((void *)u_out, &out, sizeof(out));
+}
+
+/* ---------------------------- BOOT TRACE ---------------------------- */
+
+STATIC_ASSERT(DP_BOOT_TRACE_MAX >=
+              BOOT_TRACE_MAX_ENTRIES + TILCK_BOOT_TRACE_MAX);
+STATIC_ASSERT(DP_BOOT_TRACE_BOOTLOADER == (int)BOOT_TRACE_BOOTLOADER);
+STATIC_ASSERT(DP_BOOT_TRACE_KERNEL == (int)BOOT_TRACE_KERNEL);
+STATIC_ASSERT(DP_BOOT_TRACE_MODULE == (int)BOOT_TRACE_MODULE);
+
+static int
+tilck_sys_dp_get_boot_trace(ulong u_out, ulong _2, ulong _3, ulong _4)
+{
+   struct boot_trace_entry *e;
+   struct dp_boot_trace *out;
+   int rc = -ENOMEM;
+
+   if (user_out_of_range((void *)u_out, sizeof(*out)))
+      return -EFAULT;
+
+   if (!(e = kalloc_array_obj(struct boot_trace_entry, DP_BOOT_TRACE_MAX)))
+      return -ENOMEM;
+
+   if (!(out = kzalloc_obj(struct dp_boot_trace)))
+      goto out;
+
+   out->count = boot_trace_get(e, DP_BOOT_TRACE_MAX);
+   out->tsc_khz = boot_trace_tsc_khz();
+
+   for (u32 i = 0; i < out->count; i++) {
+
+      struct dp_boot_trace_entry *d = &out->entries[i];
+
+      d->tsc = e[i].tsc;
+      d->src = (u32)e[i].src;
+      strncpy(d->name, e[i].name, sizeof(d->name) - 1);
+   }
+
+   rc = copy_to_user((void *)u_out, out, sizeof(*out));
+   kfree_obj(out, struct dp_boot_trace);
+
+out:
+   kfree_array_obj(e, struct boot_trace_entry, DP_BOOT_TRACE_MAX);
+   return rc;
+}
+
 /* ---------------------------- TRACING ------------------------------- */
 
 /*
@@ -637,6 +851,12 @@ static void dp_data_register(void)
                       tilck_sys_dp_get_mtrrs);
    register_tilck_cmd(TILCK_CMD_DP_GET_RUNTIME_INFO,
                       tilck_sys_dp_get_runtime_info);
+   register_tilck_cmd(TILCK_CMD_DP_GET_IRQSOFF_STATS,
+                      tilck_sys_dp_get_irqsoff_stats);
+   register_tilck_cmd(TILCK_CMD_DP_GET_SCHED_STATS,
+                      tilck_sys_dp_get_sched_stats);
+   register_tilck_cmd(TILCK_CMD_DP_GET_BOOT_TRACE,
+                      tilck_sys_dp_get_boot_trace);
 
    /* The TILCK_CMD_DP_TRACE_* and DP_TASK_* sub-commands are
     * registered by MOD_tracing (modules/tracing/tracing_cmd.c) so
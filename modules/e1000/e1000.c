@@ -19,6 +19,7 @@
 #include <tilck/kernel/kmalloc.h>
 #include <tilck/kernel/modules.h>
 #include <tilck/kernel/worker_thread.h>
+#include <tilck/kernel/irq_poll.h>
 #include <tilck/kernel/irq.h>
 #include <tilck/mods/pci.h>
 #include <tilck/mods/tracing.h>
@@ -98,6 +99,7 @@
 #define REG_RAH   0x5404
 #define REG_ICS   0x00C8
 #define REG_IMC   0x00D8
+#define REG_ITR   0x00C4
 
 /*
  * PCI Configuration Register Bits
@@ -208,6 +210,7 @@ STATIC_ASSERT(sizeof(struct rx_desc) == 16); /* ... */
  */
 
 static struct worker_thread *wth;
+static struct irq_poll rx_poll;
 static int device_version;
 static struct mac_addr mac;
 static struct tx_desc *tx_ring;
@@ -322,16 +325,16 @@ static int e1000_send(char *src, u32 len)
    return 0;
 }
 
-static void process_incoming_desc(void *ctx)
+/*
+ * Receive up to `budget` packets. The RX interrupts stay masked (see
+ * e1000_rx_set_irq) while we're in polled mode.
+ */
+static int e1000_rx_poll(struct irq_poll *ip, int budget)
 {
-   /*
-    * Skip running the function entirely if this was a spurious
-    * call and there is nothing to do
-    */
-   if (!(rx_ring[rx_tail].status & BIT_RX_STATUS_DD))
-      return;
+   int done = 0;
+
+   while (done < budget && (rx_ring[rx_tail].status & BIT_RX_STATUS_DD)) {
 
-   do {
       if (rx_ring[rx_tail].status & BIT_RX_STATUS_EOP) {
 
          /*
@@ -351,9 +354,18 @@ static void process_incoming_desc(void *ctx)
 
       rx_ring[rx_tail].status = 0;
       rx_tail = (rx_tail + 1) % RX_RING_CAP;
-   } while (rx_ring[rx_tail].status & BIT_RX_STATUS_DD);
+      done++;
+   }
+
+   if (done)
+      write_reg(REG_RDT, (rx_tail + RX_RING_CAP - 1) % RX_RING_CAP);
 
-   write_reg(REG_RDT, (rx_tail + RX_RING_CAP - 1) % RX_RING_CAP);
+   return done;
+}
+
+static void e1000_rx_set_irq(struct irq_poll *ip, bool enabled)
+{
+   write_reg(enabled ? REG_IMS : REG_IMC, BIT_IMS_RXT0 | BIT_IMS_RXO);
 }
 
 static void
@@ -378,16 +390,16 @@ irq_handler_func(void *ctx)
 
    trace_printk(9, "e1000: Interrupt!\n");
 
-   if (icr & BIT_IMS_RXT0) {
+   if (icr & (BIT_IMS_RXT0 | BIT_IMS_RXO)) {
       // Packets received
-      if (!wth_enqueue_on(wth, process_incoming_desc, NULL))
+      if (!irq_poll_schedule(&rx_poll))
          printk("e1000: WARNING: hit job queue limit\n");
       ret = IRQ_HANDLED;
    }
 
    if (icr & BIT_IMS_LSC) {
       // Link status change
-      if (!wth_enqueue_on(wth, process_link_status_change, NULL))
+      if (!wth_enqueue_once_on(wth, process_link_status_change, NULL))
          printk("e1000: WARNING: hit job queue limit\n");
       ret = IRQ_HANDLED;
    }
@@ -504,6 +516,12 @@ static int setup_rx_ring(void)
 
 static void enable_nic_interrupts(void)
 {
+   /*
+    * Hardware interrupt moderation: the ITR register holds the minimum
+    * interval between interrupts, in units of 256 ns.
+    */
+   write_reg(REG_ITR, E1000_ITR_INTERVAL);
+
    read_reg(REG_ICR);
    write_reg(REG_IMS, BIT_IMS_RXT0 | BIT_IMS_RXO | BIT_IMS_LSC | BIT_IMS_TXDW);
 }
@@ -845,6 +863,14 @@ init_e1000(void)
       return;
    }
 
+   irq_poll_init(&rx_poll,
+                 "e1000",
+                 wth,
+                 &e1000_rx_poll,
+                 &e1000_rx_set_irq,
+                 NULL,
+                 E1000_RX_POLL_BUDGET);
+
    net_driver_funcs.get_mac_addr = e1000_get_mac_addr;
    net_driver_funcs.send_frame = e1000_send;
 
@@ -858,6 +884,8 @@ static struct module e1000_module = {
    .name = "e1000",
    .priority = MOD_e1000_prio,
    .init = &init_e1000,
+   .deps = MODULE_DEPS("pci"),
+   .flags = MOD_FL_DEFERRED,
 };
 
 REGISTER_MODULE(&e1000_module);
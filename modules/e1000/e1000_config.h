@@ -22,3 +22,15 @@
  */
 #define TX_BUF_SIZE   2048
 #define RX_BUF_SIZE   2048
+
+/*
+ * Max number of packets received per poll of the RX ring, before letting
+ * the other jobs of the worker thread run.
+ */
+#define E1000_RX_POLL_BUDGET    RX_RING_CAP
+
+/*
+ * Minimum interval between two interrupts, in units of 256 ns: 488 caps the
+ * interrupt rate at ~8000 per second. Zero disables the moderation.
+ */
+#define E1000_ITR_INTERVAL      488
@@ -305,7 +305,7 @@ static enum irq_action keyboard_irq_handler(void *ctx)
    }
 
    /* Everything is fine: we read at least one scancode */
-   if (!wth_enqueue_on(kb_worker_thread, &kb_irq_bottom_half, NULL)) {
+   if (!wth_enqueue_once_on(kb_worker_thread, &kb_irq_bottom_half, NULL)) {
 
       /*
        * While on real hardware this should NEVER happen, on some slow emulators
@@ -496,6 +496,7 @@ static struct module kb_ps2_module = {
    .name = "kb8042",
    .priority = MOD_kb_prio,
    .init = &init_kb,
+   .deps = MODULE_DEPS("acpi"),     /* is there an 8042 controller? */
 };
 
 REGISTER_MODULE(&kb_ps2_module);
@@ -8,6 +8,7 @@
 #include <tilck/kernel/modules.h>
 #include <tilck/kernel/hal.h>
 #include <tilck/kernel/irq.h>
+#include <tilck/kernel/irq_stats.h>
 #include <tilck/kernel/errno.h>
 #include <tilck/kernel/kmalloc.h>
 #include <tilck/kernel/sched.h>
@@ -68,6 +69,12 @@ enum irq_action generic_irq_handler(u8 irq)
 {
    struct irq_handler_node *pos;
    enum irq_action hret = IRQ_NOT_HANDLED;
+   ulong var;
+
+   /* Called with interrupts either enabled or not, depending on the chip */
+   disable_interrupts(&var);
+   irq_stats_enter();
+   enable_interrupts(&var);
 
    list_for_each_ro(pos, &irq_handlers_lists[irq], node) {
 
@@ -81,6 +88,9 @@ enum irq_action generic_irq_handler(u8 irq)
       unhandled_irq_count[irq]++;
    }
 
+   disable_interrupts(&var);
+   irq_stats_exit(irq);
+   enable_interrupts(&var);
    return hret;
 }
 
@@ -145,6 +145,11 @@ char serial_read(u16 port)
    return (char) inb(port);
 }
 
+void serial_set_rx_intr(u16 port, bool enabled)
+{
+   outb(port + UART_IER, enabled ? IER_RCV_AVAIL_INTR : IER_NO_INTR);
+}
+
 bool serial_write_ready(u16 port)
 {
    return !!(inb(port + UART_LSR) & LSR_EMPTY_TR_REG);
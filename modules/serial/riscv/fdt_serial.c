@@ -77,6 +77,14 @@ void serial_wait_for_read(u16 port)
    /* do nothing */
 }
 
+void serial_set_rx_intr(u16 port, bool enabled)
+{
+   /*
+    * Nothing to do: the UART drivers already disable the RX interrupt in
+    * their top half (clr_i) and enable it again on read.
+    */
+}
+
 bool serial_write_ready(u16 port)
 {
    /* do nothing */
@@ -8,6 +8,7 @@
 #include <tilck/kernel/hal.h>
 #include <tilck/kernel/irq.h>
 #include <tilck/kernel/worker_thread.h>
+#include <tilck/kernel/irq_poll.h>
 #include <tilck/kernel/cmdline.h>
 #include <tilck/kernel/tty.h>
 #include <tilck/kernel/sched.h>
@@ -16,13 +17,15 @@
 
 /* NOTE: hw-specific stuff in generic code. TODO: fix that. */
 
+/* Max bytes read by a single poll in the worker thread */
+#define SERIAL_POLL_BUDGET                      256
+
 struct serial_device {
 
    const char *name;
    u16 ioport;
    struct tty *tty;
-   atomic_int_t jobs_cnt;
-   struct worker_thread *wth;
+   struct irq_poll poll;
 };
 
 struct serial_device legacy_serial_ports[] =
@@ -45,20 +48,28 @@ struct serial_device legacy_serial_ports[] =
    },
 };
 
-static void ser_bh_handler(void *ctx)
+static int ser_poll(struct irq_poll *ip, int budget)
 {
-   struct serial_device *const dev = ctx;
+   struct serial_device *const dev = ip->ctx;
    struct tty *const t = dev->tty;
    const u16 p = dev->ioport;
+   int n = 0;
    char c;
 
-   while (serial_read_ready(p)) {
+   while (n < budget && serial_read_ready(p)) {
 
       c = serial_read(p);
       tty_send_keyevent(t, make_key_event(0, c, true), true);
+      n++;
    }
 
-   atomic_fetch_sub(&dev->jobs_cnt, 1);
+   return n;
+}
+
+static void ser_set_irq(struct irq_poll *ip, bool enabled)
+{
+   struct serial_device *const dev = ip->ctx;
+   serial_set_rx_intr(dev->ioport, enabled);
 }
 
 static enum irq_action serial_con_irq_handler(void *ctx)
@@ -68,28 +79,25 @@ static enum irq_action serial_con_irq_handler(void *ctx)
    if (!serial_read_ready(dev->ioport))
       return IRQ_NOT_HANDLED; /* Not an IRQ from this "device" [irq sharing] */
 
-   if (atomic_load(&dev->jobs_cnt) >= 2)
-      return IRQ_HANDLED;
-
    if (UNLIKELY(in_panic())) {
 
       /* Special panic-only trick: see the comment in keyboard_irq_handler() */
       ulong val;
       disable_interrupts(&val);
       {
-         atomic_fetch_add(&dev->jobs_cnt, 1);
-         ser_bh_handler(dev);
+         ser_poll(&dev->poll, SERIAL_POLL_BUDGET);
       }
       enable_interrupts(&val);
       return IRQ_HANDLED;
    }
 
-   if (!wth_enqueue_on(dev->wth, &ser_bh_handler, dev)) {
+   /*
+    * Disable the RX interrupt and read the data in the worker thread, until
+    * there's no more: during bursts, that's one IRQ per burst, not per byte.
+    */
+   if (!irq_poll_schedule(&dev->poll))
       printk("Serial: WARNING: hit job queue limit\n");
-      return IRQ_HANDLED;
-   }
 
-   atomic_fetch_add(&dev->jobs_cnt, 1);
    return IRQ_HANDLED;
 }
 
@@ -124,7 +132,14 @@ static void init_serial_comm(void)
       struct serial_device *dev = &legacy_serial_ports[i];
 
       dev->tty = get_serial_tty((int)i);
-      dev->wth = wth;
+
+      irq_poll_init(&dev->poll,
+                    dev->name,
+                    wth,
+                    &ser_poll,
+                    &ser_set_irq,
+                    dev,
+                    SERIAL_POLL_BUDGET);
    }
 
    irq_install_handler(X86_PC_COM1_COM3_IRQ, &com1);
@@ -16,6 +16,11 @@
 #include <tilck/kernel/modules.h>
 #include <tilck/kernel/sort.h>
 #include <tilck/kernel/cmdline.h>
+#include <tilck/kernel/boot_trace.h>
+#include <tilck/kernel/worker_thread.h>
+#include <tilck/kernel/irq_poll.h>
+#include <tilck/kernel/fs/ramfs.h>
+#include <tilck/kernel/ksm.h>
 
 #include "sysfs_int.h"
 #include "dents.c.h"
@@ -777,6 +782,11 @@ init_sysfs(void)
 
    sysfs_create_config_obj();
    register_kopts_sysfs();
+   register_boot_trace_sysfs();
+   register_wth_sysfs();
+   register_irq_poll_sysfs();
+   register_ramfs_sysfs();
+   register_ksm_sysfs();
 }
 
 static struct module sysfs_module = {
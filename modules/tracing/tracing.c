@@ -2,17 +2,19 @@
 
 #include <tilck_gen_headers/mod_sysfs.h>
 #include <tilck_gen_headers/config_kernel.h>
+#include <tilck_gen_headers/config_debug.h>
 
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/printk.h>
 #include <tilck/common/string_util.h>
+#include <tilck/common/utils.h>
 #include <tilck/common/tracing/wire.h>
+#include <tilck/common/tracing/ring.h>
 
 #include <tilck/kernel/modules.h>
 #include <tilck/kernel/sched.h>
 #include <tilck/kernel/kmalloc.h>
 #include <tilck/kernel/sync.h>
-#include <tilck/kernel/ringbuf.h>
 #include <tilck/kernel/datetime.h>
 #include <tilck/kernel/elf_utils.h>
 #include <tilck/kernel/bintree.h>
@@ -20,6 +22,10 @@
 #include <tilck/kernel/debug_utils.h>
 #include <tilck/kernel/interrupts.h>
 #include <tilck/kernel/errno.h>
+#include <tilck/kernel/irqsoff.h>
+#include <tilck/kernel/cmdline.h>
+#include <tilck/kernel/user.h>
+#include <tilck/kernel/paging.h>
 
 #include <tilck/mods/tracing.h>
 
@@ -32,7 +38,9 @@
  * DP_TASK_* sub-commands the userspace tracer uses. */
 void tracing_register_dp_cmd_handlers(void);
 
-#define TRACE_BUF_SIZE                       (128 * KB)
+/* Limits for the -trace_buf_kb boot option (ring data size, in KB) */
+#define TRACE_BUF_MIN_KB                     16
+#define TRACE_BUF_MAX_KB                     4096
 
 struct symbol_node {
 
@@ -43,9 +51,17 @@ struct symbol_node {
    const char *name;
 };
 
+/*
+ * The trace ring: a page with struct tr_ring_header, followed by the event
+ * slots (see <tilck/common/tracing/ring.h>). Producers run in any context
+ * with the interrupts disabled and only move `head`; consumers only move
+ * `tail` and are serialized by `tracing_consumer_lock`, so that a consumer
+ * can copy events out of the ring with the interrupts enabled.
+ */
 static struct kcond tracing_cond;
-static struct ringbuf tracing_rb;
-static void *tracing_buf;
+static struct kmutex tracing_consumer_lock;
+static struct tr_ring_header *tracing_ring;
+static size_t tracing_ring_size;
 
 static u32 syms_count;
 static struct symbol_node *syms_buf;
@@ -270,7 +286,15 @@ enqueue_trace_event(struct trace_event *e)
 
    disable_interrupts(&var);
    {
-      success = ringbuf_write_elem(&tracing_rb, e);
+      struct tr_ring_header *h = tracing_ring;
+
+      if ((success = tr_ring_count(h) < h->capacity)) {
+         memcpy((void *)tr_ring_slot(h, h->head), e, sizeof(*e));
+         COMPILER_BARRIER();
+         h->head++;
+      } else {
+         h->lost++;
+      }
    }
    enable_interrupts(&var);
 
@@ -487,18 +511,39 @@ trace_task_killed_int(int signum)
    enqueue_trace_event(&e);
 }
 
+/*
+ * Release `n` events, already copied by the caller. Consumers run with the
+ * interrupts enabled holding tracing_consumer_lock, while `head` can move
+ * at any time: that's fine, because producers never touch the slots past
+ * `head - capacity`, the oldest of which is at `tail`.
+ */
+static void
+tracing_ring_advance_tail(u32 n)
+{
+   struct tr_ring_header *h = tracing_ring;
+   ASSERT(kmutex_is_curr_task_holding_lock(&tracing_consumer_lock));
+
+   COMPILER_BARRIER();
+   h->tail += n;
+}
+
 bool read_trace_event_noblock(struct trace_event *e)
 {
+   struct tr_ring_header *h = tracing_ring;
    bool success;
 
    /* We must NOT consume trace events from IRQ handlers, of course */
    ASSERT(!in_irq());
    ASSERT(are_interrupts_enabled());
-   disable_interrupts_forced();
+
+   kmutex_lock(&tracing_consumer_lock);
    {
-      success = ringbuf_read_elem(&tracing_rb, e);
+      if ((success = tr_ring_count(h) > 0)) {
+         memcpy(e, tr_ring_slot(h, h->tail), sizeof(*e));
+         tracing_ring_advance_tail(1);
+      }
    }
-   enable_interrupts_forced();
+   kmutex_unlock(&tracing_consumer_lock);
    return success;
 }
 
@@ -517,6 +562,84 @@ bool read_trace_event(struct trace_event *e, u32 timeout_ticks)
    return success;
 }
 
+bool tracing_wait_for_events(u32 timeout_ticks)
+{
+   ASSERT(!in_irq());
+
+   if (tr_ring_count(tracing_ring) > 0)
+      return true;
+
+   /*
+    * Not all the events signal the condition (see enqueue_trace_event()):
+    * check the ring again after the wait, whatever the outcome.
+    */
+   kcond_wait(&tracing_cond, NULL, timeout_ticks);
+   return tr_ring_count(tracing_ring) > 0;
+}
+
+/*
+ * Copy up to `max` events to `user_buf` and consume them: at most two
+ * copy_to_user() calls, as the events might wrap around the end of the
+ * ring. Returns the number of events copied.
+ */
+int tracing_drain_events(void *user_buf, u32 max)
+{
+   struct tr_ring_header *h = tracing_ring;
+   const size_t es = sizeof(struct trace_event);
+   u32 n, first, idx;
+   int rc;
+
+   ASSERT(!in_irq());
+
+   if (user_out_of_range(user_buf, (size_t)max * es))
+      return -EFAULT;
+
+   kmutex_lock(&tracing_consumer_lock);
+   {
+      n = MIN(tr_ring_count(h), max);
+      idx = h->tail & (h->capacity - 1);
+      first = MIN(n, h->capacity - idx);
+
+      rc = copy_to_user(user_buf, tr_ring_slot(h, h->tail), first * es);
+
+      if (!rc && n > first)
+         rc = copy_to_user((char *)user_buf + first * es,
+                           tr_ring_slot(h, 0),
+                           (n - first) * es);
+
+      if (!rc)
+         tracing_ring_advance_tail(n);
+   }
+   kmutex_unlock(&tracing_consumer_lock);
+   return rc ? -EFAULT : (int)n;
+}
+
+int tracing_consume_events(u32 n)
+{
+   int rc = 0;
+   ASSERT(!in_irq());
+
+   kmutex_lock(&tracing_consumer_lock);
+   {
+      if (n <= tr_ring_count(tracing_ring))
+         tracing_ring_advance_tail(n);
+      else
+         rc = -EINVAL;
+   }
+   kmutex_unlock(&tracing_consumer_lock);
+   return rc;
+}
+
+u32 tracing_get_lost_events_count(void)
+{
+   return tracing_ring->lost;
+}
+
+u32 tracing_get_ring_capacity(void)
+{
+   return tracing_ring->capacity;
+}
+
 const struct syscall_info *
 tracing_get_syscall_info(u32 n)
 {
@@ -880,15 +1003,7 @@ set_traced_syscalls(const char *s)
 int
 tracing_get_in_buffer_events_count(void)
 {
-   ulong var;
-   int rc;
-
-   disable_interrupts(&var);
-   {
-      rc = (int)ringbuf_get_elems(&tracing_rb); // integer narrowing
-   }
-   enable_interrupts(&var);
-   return rc;
+   return (int)tr_ring_count(tracing_ring);
 }
 
 static void
@@ -1178,9 +1293,133 @@ static const struct sysobj_prop_type tracing_meta_prop_type = {
 
 DEF_STATIC_SYSOBJ_PROP(metadata, &tracing_meta_prop_type);
 
+/* ----------------- /syst/tracing/ring mmap-able event ring ------------ */
+
+/*
+ * The whole trace ring, header included. Its contents change all the time,
+ * but its size and location are fixed for the whole boot: that's all
+ * SYSFS_BUF_IMMUTABLE needs for read() and for the read-only mmap(). The
+ * consumers release the events read in place with TILCK_CMD_DP_TRACE_CONSUME.
+ */
+
+static offt
+tracing_ring_get_buf_sz(struct sysobj *obj, void *data)
+{
+   return (offt)tracing_ring_size;
+}
+
+static offt
+tracing_ring_load(struct sysobj *obj, void *data,
+                  void *buf, offt sz, offt off)
+{
+   if (off < 0 || (size_t)off > tracing_ring_size)
+      return -EINVAL;
+
+   const size_t remaining = tracing_ring_size - (size_t)off;
+   const size_t to_copy   = MIN((size_t)sz, remaining);
+
+   memcpy(buf, (char *)tracing_ring + off, to_copy);
+   return (offt)to_copy;
+}
+
+static void *
+tracing_ring_get_data_ptr(struct sysobj *obj, void *data)
+{
+   return tracing_ring;
+}
+
+static const struct sysobj_prop_type tracing_ring_prop_type = {
+   .buf_type     = SYSFS_BUF_IMMUTABLE,
+   .get_buf_sz   = &tracing_ring_get_buf_sz,
+   .load         = &tracing_ring_load,
+   .get_data_ptr = &tracing_ring_get_data_ptr,
+};
+
+DEF_STATIC_SYSOBJ_PROP(ring, &tracing_ring_prop_type);
+
+/* ------------- /syst/tracing/{irqsoff,preemptoff} reports ------------- */
+
+#if KRN_IRQSOFF_TRACER
+
+/*
+ * Human-readable reports of the irqs-off / preempt-off latency tracer (see
+ * kernel/irqsoff.c): summary, non-empty log2 histogram buckets and the
+ * longest sections with their call sites. All the values are in RDTSC
+ * cycles. Writing anything to the file resets the stats of that kind.
+ */
+
+static offt
+tracing_irqsoff_load(struct sysobj *obj, void *data,
+                     void *buf, offt sz, offt off)
+{
+   const enum irqsoff_kind k = (enum irqsoff_kind)(ulong)data;
+   char begin_str[64], end_str[64];
+   struct irqsoff_stats stats;
+   struct irqsoff_stats *s = &stats;
+   size_t used = 0;
+
+   irqsoff_get_stats(k, s);
+
+#define WR(...)                                                      \
+   used += (size_t)snprintk((char *)buf + used,                      \
+                            (size_t)sz - used, __VA_ARGS__)
+
+   WR("count: %llu\n", s->count);
+   WR("max_cycles: %llu\n", s->max_cycles);
+   WR("avg_cycles: %llu\n", s->count ? s->tot_cycles / s->count : 0);
+   WR("\nhistogram (cycles):\n");
+
+   for (u32 i = 0; i < IRQSOFF_HIST_BUCKETS; i++) {
+
+      if (!s->hist[i])
+         continue;
+
+      if (i < IRQSOFF_HIST_BUCKETS - 1)
+         WR("   [2^%-2u, 2^%-2u): %u\n", i, i + 1, s->hist[i]);
+      else
+         WR("   [2^%-2u,   inf): %u\n", i, s->hist[i]);
+   }
+
+   WR("\ntop sections:\n");
+
+   for (u32 i = 0; i < IRQSOFF_TOP_N && s->top[i].cycles; i++) {
+
+      irqsoff_ip_to_str(s->top[i].begin_ip, begin_str, sizeof(begin_str));
+      irqsoff_ip_to_str(s->top[i].end_ip, end_str, sizeof(end_str));
+
+      WR("   %12llu  %s -> %s\n", s->top[i].cycles, begin_str, end_str);
+   }
+
+#undef WR
+
+   return (offt)used;
+}
+
+static offt
+tracing_irqsoff_store(struct sysobj *obj, void *data, void *buf, offt sz)
+{
+   irqsoff_reset_stats((enum irqsoff_kind)(ulong)data);
+   return sz;
+}
+
+static const struct sysobj_prop_type tracing_irqsoff_prop_type = {
+   .load  = &tracing_irqsoff_load,
+   .store = &tracing_irqsoff_store,
+};
+
+DEF_STATIC_SYSOBJ_PROP(irqsoff, &tracing_irqsoff_prop_type);
+DEF_STATIC_SYSOBJ_PROP(preemptoff, &tracing_irqsoff_prop_type);
+
+#endif /* KRN_IRQSOFF_TRACER */
+
 DEF_STATIC_SYSOBJ_TYPE(tracing_sysobj_type,
                        &prop_events,
                        &prop_metadata,
+                       &prop_ring,
+#if KRN_IRQSOFF_TRACER
+                       &prop_irqsoff,
+                       &prop_preemptoff,
+#endif
                        NULL);
 
 static void
@@ -1189,12 +1428,24 @@ register_tracing_sysfs_obj(void)
    /*
     * The `tracing` object IS a directory (every sysobj is); each prop
     * registered on its type becomes a file under /syst/tracing/. We
-    * expose two:
-    *   /syst/tracing/events    -- streaming live trace events
-    *   /syst/tracing/metadata  -- immutable blob, syscall metadata
+    * expose three, plus two more with KRN_IRQSOFF_TRACER:
+    *   /syst/tracing/events     -- streaming live trace events
+    *   /syst/tracing/metadata   -- immutable blob, syscall metadata
+    *   /syst/tracing/ring       -- the trace ring itself, mmap-able
+    *   /syst/tracing/irqsoff    -- irqs-off latency report
+    *   /syst/tracing/preemptoff -- preempt-off latency report
     */
    struct sysobj *tracing_obj =
-      sysfs_create_obj(&tracing_sysobj_type, NULL, NULL);
+      sysfs_create_obj(&tracing_sysobj_type,
+                       NULL,                            /* hooks */
+                       NULL,                            /* events */
+                       NULL,                            /* metadata */
+                       NULL                             /* ring */
+#if KRN_IRQSOFF_TRACER
+                       , TO_PTR(IRQSOFF_IRQS)           /* irqsoff */
+                       , TO_PTR(IRQSOFF_PREEMPT)        /* preemptoff */
+#endif
+                       );
 
    if (!tracing_obj)
       return;
@@ -1223,15 +1474,33 @@ init_trace_printk(void)
    if (__trace_printk_initialized)
       return;
 
-   if (!(tracing_buf = kzmalloc(TRACE_BUF_SIZE)))
-      tracing_init_oom_panic("tracing_buf");
+   const long kb = CLAMP(kopt_trace_buf_kb, TRACE_BUF_MIN_KB, TRACE_BUF_MAX_KB);
+   const u32 n = (u32)(kb * KB / sizeof(struct trace_event));
+   const u32 cap = 1u << (31 - (u32)__builtin_clz(n));     /* pow2 <= n */
+
+   /*
+    * The header takes a whole page, so that the ring, page-aligned, can be
+    * mapped as-is in userspace through /syst/tracing/ring.
+    */
+   tracing_ring_size = pow2_round_up_at(
+      PAGE_SIZE + cap * sizeof(struct trace_event), PAGE_SIZE
+   );
 
-   ringbuf_init(&tracing_rb,
-                TRACE_BUF_SIZE / sizeof(struct trace_event),
-                sizeof(struct trace_event),
-                tracing_buf);
+   if (!(tracing_ring = aligned_kmalloc(tracing_ring_size, PAGE_SIZE)))
+      tracing_init_oom_panic("tracing_ring");
+
+   bzero(tracing_ring, tracing_ring_size);
+
+   *tracing_ring = (struct tr_ring_header) {
+      .magic = TR_RING_MAGIC,
+      .version = TR_RING_VERSION,
+      .elem_size = sizeof(struct trace_event),
+      .capacity = cap,
+      .data_off = PAGE_SIZE,
+   };
 
    kcond_init(&tracing_cond);
+   kmutex_init(&tracing_consumer_lock, 0);
    __trace_printk_initialized = true;
 }
 
@@ -1270,7 +1539,7 @@ init_tracing(void)
     * this point the metadata is read-only by construction. */
    tracing_init_meta_blob();
 
-   /* Expose /syst/tracing/{events,metadata} for the userspace `dp`
+   /* Expose /syst/tracing/{events,metadata,ring} for the userspace `dp`
     * tool. MOD_tracing has a hard dep on MOD_sysfs (declared in
     * modules/tracing/module_deps), so this is unconditional. */
    register_tracing_sysfs_obj();
@@ -1288,6 +1557,7 @@ static struct module dp_module = {
    .name = "tracing",
    .priority = MOD_tracing_prio,
    .init = &init_tracing,
+   .deps = MODULE_DEPS("sysfs"),
 };
 
 REGISTER_MODULE(&dp_module);
@@ -17,6 +17,8 @@
  * dp UI features, not tracer features.
  */
 
+#include <tilck_gen_headers/config_kernel.h>
+
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/string_util.h>
 #include <tilck/common/syscalls.h>
@@ -116,6 +118,8 @@ tilck_sys_dp_trace_get_stats(ulong u_out, ulong _2, ulong _3, ulong _4)
       .printk_lvl         = tracing_get_printk_lvl(),
       .sys_traced_count   = get_traced_syscalls_count(),
       .tasks_traced_count = get_traced_tasks_count(),
+      .lost_events        = tracing_get_lost_events_count(),
+      .ring_capacity      = tracing_get_ring_capacity(),
    };
    int rc;
 
@@ -243,6 +247,53 @@ tilck_sys_dp_trace_get_in_buf_count(ulong _1, ulong _2, ulong _3, ulong _4)
    return tracing_get_in_buffer_events_count();
 }
 
+/*
+ * With `wait` set, park for up to 100ms when the ring is empty, like the
+ * read() of /syst/tracing/events does: the callers poll stdin in between.
+ */
+static int
+tracing_cmd_wait_if_empty(ulong wait)
+{
+   if (!wait || tracing_get_in_buffer_events_count() > 0)
+      return 0;
+
+   if (!tracing_wait_for_events(KRN_TIMER_HZ / 10) && pending_signals())
+      return -EINTR;
+
+   return 0;
+}
+
+static int
+tilck_sys_dp_trace_drain(ulong u_buf, ulong max, ulong wait, ulong _4)
+{
+   int rc;
+
+   if (max > (ulong)tracing_get_ring_capacity())
+      max = tracing_get_ring_capacity();
+
+   if ((rc = tracing_cmd_wait_if_empty(wait)))
+      return rc;
+
+   return tracing_drain_events((void *)u_buf, (u32)max);
+}
+
+static int
+tilck_sys_dp_trace_consume(ulong count, ulong wait, ulong _3, ulong _4)
+{
+   int rc;
+
+   if (count > (ulong)tracing_get_ring_capacity())
+      return -EINVAL;
+
+   if ((rc = tracing_consume_events((u32)count)))
+      return rc;
+
+   if ((rc = tracing_cmd_wait_if_empty(wait)))
+      return rc;
+
+   return tracing_get_in_buffer_events_count();
+}
+
 /*
  * Walk every task and for each `task.traced == true`: write its tid
  * into the user buffer AND clear the traced flag in-kernel
@@ -393,4 +444,8 @@ void tracing_register_dp_cmd_handlers(void)
                       tilck_sys_dp_trace_set_test_mode);
    register_tilck_cmd(TILCK_CMD_DP_TRACE_INJECT_EVENT,
                       tilck_sys_dp_trace_inject_event);
+   register_tilck_cmd(TILCK_CMD_DP_TRACE_DRAIN,
+                      tilck_sys_dp_trace_drain);
+   register_tilck_cmd(TILCK_CMD_DP_TRACE_CONSUME,
+                      tilck_sys_dp_trace_consume);
 }
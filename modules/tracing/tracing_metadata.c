@@ -782,8 +782,8 @@ static const struct syscall_info __tracing_metadata[] =
    },
 
    /* ---------------- Layer 0c: memory-mgmt syscalls -------------------
-    * Tilck implements only munmap and madvise as real memory-mgmt
-    * calls — mprotect, mlock, mremap, msync, mincore etc. are all
+    * Tilck implements only munmap, mprotect, mremap, madvise and
+    * mincore as real memory-mgmt calls — mlock, msync etc. are all
     * stubs returning -ENOSYS, so they have nothing useful to
     * trace. brk and mmap_pgoff (the i386 mmap2 entry) were already
     * covered. */
@@ -798,6 +798,114 @@ static const struct syscall_info __tracing_metadata[] =
       },
    },
 
+   {
+      .sys_n = SYS_mprotect,
+      .n_params = 3,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("addr",   &ptype_voidp,     sys_param_in),
+         SIMPLE_PARAM("length", &ptype_int,       sys_param_in),
+         SIMPLE_PARAM("prot",   &ptype_mmap_prot, sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_mremap,
+      .n_params = 4,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_ptr,
+      .params = {
+         SIMPLE_PARAM("old_addr", &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("old_len",  &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("len",      &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("flags",    &ptype_int,   sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_setrlimit,
+      .n_params = 2,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("resource", &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("rlim",     &ptype_voidp, sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_prlimit64,
+      .n_params = 4,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("pid",      &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("resource", &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("new_rlim", &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("old_rlim", &ptype_voidp, sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_io_setup,
+      .n_params = 2,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("nr_events", &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("ctxp",      &ptype_voidp, sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_io_destroy,
+      .n_params = 1,
+      .exp_block = true,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("ctx_id", &ptype_voidp, sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_io_submit,
+      .n_params = 3,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("ctx_id", &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("nr",     &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("iocbpp", &ptype_voidp, sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_io_getevents,
+      .n_params = 5,
+      .exp_block = true,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("ctx_id",  &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("min_nr",  &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("nr",      &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("events",  &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("timeout", &ptype_voidp, sys_param_in),
+      },
+   },
+
+   {
+      .sys_n = SYS_io_cancel,
+      .n_params = 3,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("ctx_id", &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("iocb",   &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("result", &ptype_voidp, sys_param_in),
+      },
+   },
+
    /* madvise: advice is an enum (MADV_NORMAL / MADV_DONTNEED /
     * MADV_FREE / ...). Layer 1 will swap ptype_int for
     * ptype_madvise_advice for symbolic rendering. */
@@ -813,6 +921,18 @@ static const struct syscall_info __tracing_metadata[] =
       },
    },
 
+   {
+      .sys_n = SYS_mincore,
+      .n_params = 3,
+      .exp_block = false,
+      .ret_type = &ptype_errno_or_val,
+      .params = {
+         SIMPLE_PARAM("addr",   &ptype_voidp, sys_param_in),
+         SIMPLE_PARAM("length", &ptype_int,   sys_param_in),
+         SIMPLE_PARAM("vec",    &ptype_voidp, sys_param_in),
+      },
+   },
+
    /* ---------------- Layer 0d: signals + timers -----------------------
     * Legacy signal API + clock/timer/utime syscalls. The struct
     * args (struct sigaction, struct timespec, struct timeval, ...)
@@ -67,6 +67,18 @@ tilck_option(KRN_BIG_IO_BUF
    HELP     "Use a larger buffer for I/O"
 )
 
+tilck_option(KRN_RAMFS_COMPRESSION
+   TYPE     BOOL
+   CATEGORY "Kernel Memory"
+   DEFAULT  OFF
+   HELP     "Compress the cold ramfs file blocks in memory"
+            "A kernel thread periodically LZ4-compresses the ramfs"
+            "blocks not accessed for -ramfs_zidle seconds into a packed"
+            "arena, freeing their pages. They get decompressed on the"
+            "next read, write or page fault. Memory-mapped blocks are"
+            "never compressed. Stats in /syst/ramfs/compression."
+)
+
 tilck_option(KRN_KMALLOC_HEAVY_STATS
    TYPE     BOOL
    CATEGORY "Kernel Memory"
@@ -225,6 +237,19 @@ tilck_option(KRN_MIN_GRANULARITY_TICKS
             "-- still well above context-switch cost."
 )
 
+tilck_option(KRN_RT_BANDWIDTH_PCT
+   TYPE     UINT
+   CATEGORY "Kernel Misc"
+   DEFAULT  80
+   HELP     "CPU bandwidth cap for the RT (CBS/EDF) class, in %"
+            "Admission control for sched_setattr(SCHED_DEADLINE)"
+            "refuses any reservation that would push the sum of the"
+            "admitted utilizations (runtime / period) above this"
+            "percentage. The rest of the CPU is the floor left to"
+            "worker threads and EEVDF tasks. 0 disables the RT class."
+            "See docs/plans/realtime-roadmap.md."
+)
+
 tilck_option(KRN_HANG_DETECTION
    TYPE     BOOL
    CATEGORY "Kernel Misc"
@@ -241,6 +266,19 @@ tilck_option(KRN_HANG_DETECTION
             "but always-on per-pipe accounting cost."
 )
 
+tilck_option(KRN_IRQSOFF_TRACER
+   TYPE     BOOL
+   CATEGORY "Kernel Misc"
+   DEFAULT  OFF
+   HELP     "Compile in the irqs-off / preemption-off latency tracer"
+            "Timestamps (RDTSC) every transition of the interrupts-off"
+            "and the preemption-off state, keeping a log2 histogram of"
+            "the section lengths and the top-N longest sections with"
+            "their begin/end call sites. Results are exposed in"
+            "/syst/tracing/{irqsoff,preemptoff} and in the dp tool."
+            "Off by default because it adds a call on every cli/sti."
+)
+
 tilck_option(KRN_STACK_ISOLATION
    TYPE     BOOL
    CATEGORY "Kernel Misc"
@@ -2,6 +2,8 @@
 
 #include <tilck/common/basic_defs.h>
 #include <tilck/common/fat32_base.h>
+#include <tilck/common/lz4.h>
+#include <tilck/common/utils.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,6 +41,7 @@ struct action {
 
 static u32 used_bytes;
 static u32 ff_clu_off;
+static const char *out_file;
 
 /* --- */
 
@@ -163,6 +166,92 @@ static int action_do_align(struct action_ctx *ctx)
    return 0;
 }
 
+static int write_file(const char *path, const void *buf, size_t len)
+{
+   FILE *fh = fopen(path, "wb");
+
+   if (!fh) {
+      perror("fopen() failed");
+      return 1;
+   }
+
+   if (fwrite(buf, 1, len, fh) != len) {
+      perror("fwrite() failed");
+      fclose(fh);
+      return 1;
+   }
+
+   if (fclose(fh)) {
+      perror("fclose() failed");
+      return 1;
+   }
+
+   return 0;
+}
+
+/*
+ * Write into `out_file` the compressed initrd (see <tilck/common/lz4.h>) made
+ * from the whole fat part file, which should already be truncated and have
+ * its first data sector aligned.
+ */
+static int action_compress(struct action_ctx *ctx)
+{
+   const u32 raw_size = (u32)ctx->statbuf.st_size;
+   const u32 blocks = DIV_ROUND_UP(raw_size, LZ4_RD_BLOCK_SIZE);
+   struct lz4_rd_header *h;
+   u8 *buf, *p;
+   int rc;
+
+   if (!out_file) {
+      fprintf(stderr, "ERROR: missing output file\n");
+      return 1;
+   }
+
+   buf = malloc(sizeof(*h) + (size_t)blocks * LZ4_RD_MAX_BLK_DISK_SZ);
+
+   if (!buf) {
+      fprintf(stderr, "ERROR: out of memory\n");
+      return 1;
+   }
+
+   h = (void *)buf;
+   p = buf + sizeof(*h);
+
+   for (u32 off = 0; off < raw_size; off += LZ4_RD_BLOCK_SIZE) {
+
+      const u32 len = MIN(raw_size - off, (u32)LZ4_RD_BLOCK_SIZE);
+      const u8 *src = (u8 *)ctx->vaddr + off;
+      u32 word;
+
+      rc = lz4_compress(p + 4, len - 1, src, len);
+
+      if (rc > 0) {
+         word = (u32)rc;
+      } else {
+         memcpy(p + 4, src, len);
+         word = len | LZ4_RD_BLK_STORED;
+      }
+
+      memcpy(p, &word, 4);
+      p += 4 + (word & ~LZ4_RD_BLK_STORED);
+   }
+
+   *h = (struct lz4_rd_header) {
+      .magic = LZ4_RD_MAGIC,
+      .raw_size = raw_size,
+      .data_size = (u32)(p - buf - sizeof(*h)),
+      .block_size = LZ4_RD_BLOCK_SIZE,
+   };
+
+   printf("INFO: initrd compressed: %u -> %u bytes (%u%%)\n",
+          raw_size, (u32)(p - buf),
+          raw_size ? (u32)(100ull * (u32)(p - buf) / raw_size) : 0);
+
+   rc = write_file(out_file, buf, (size_t)(p - buf));
+   free(buf);
+   return rc;
+}
+
 struct action actions[] = {
 
    {
@@ -185,6 +274,13 @@ struct action actions[] = {
       ACTIONS_2(action_calc_used_bytes, action_do_align),
       NO_ACTIONS(),
    },
+
+   {
+      {"-z", "--compress"},
+      NO_ACTIONS(),
+      ACTIONS_1(action_compress),
+      NO_ACTIONS(),
+   },
 };
 
 void show_help_and_exit(int argc, char **argv)
@@ -193,6 +289,7 @@ void show_help_and_exit(int argc, char **argv)
    printf("    %s -t, --truncate <fat part file>\n", argv[0]);
    printf("    %s -c, --calc_used_bytes <fat part file>\n", argv[0]);
    printf("    %s -a, --align_first_data_sector <fat part file>\n", argv[0]);
+   printf("    %s -z, --compress <fat part file> <output file>\n", argv[0]);
    exit(1);
 }
 
@@ -215,6 +312,7 @@ parse_opts(int argc, char **argv, struct action **a_ref, const char **file_ref)
 
    *a_ref = a;
    *file_ref = argv[2];
+   out_file = argc > 3 ? argv[3] : NULL;
    return 0;
 }
 
@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <tilck/common/basic_defs.h>
+#include <tilck/common/printk.h>
+#include <tilck/common/string_util.h>
+
+#include <tilck/kernel/hal.h>
+#include <tilck/kernel/kmalloc.h>
+#include <tilck/kernel/paging.h>
+#include <tilck/kernel/user.h>
+#include <tilck/kernel/self_tests.h>
+
+/*
+ * Correctness and throughput of the kernel's memcpy(), memset(), memmove()
+ * and arch_user_copy(), plus the page-sized paths memcpy_large() and
+ * bzero_page(). The user-copy routine is called directly on kernel buffers,
+ * which never fault: that measures the same loop copy_to_user() and
+ * copy_from_user() run, minus the range checks.
+ */
+
+#define CP_BUF_SZ       (64 * KB)
+#define CP_GUARD        64
+#define CP_FILL         0xa5
+#define CP_PAGES        8
+
+static u8 *cp_src;
+static u8 *cp_dst;
+
+static const u32 cp_check_sizes[] = {
+   1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65,
+   255, 256, 257, 1000, 4095, 4096, 4097, 9001,
+};
+
+static void cp_check_guards(const char *fn, u32 off, u32 n)
+{
+   for (u32 i = 0; i < off + CP_GUARD; i++)
+      if (cp_dst[i] != CP_FILL)
+         panic("%s(off: %u, n: %u): wrote before dest[%u]", fn, off, n, i);
+
+   for (u32 i = off + CP_GUARD + n; i < off + 2 * CP_GUARD + n; i++)
+      if (cp_dst[i] != CP_FILL)
+         panic("%s(off: %u, n: %u): wrote after the end", fn, off, n);
+}
+
+static void cp_check_copy(const char *fn, u32 d_off, u32 s_off, u32 n)
+{
+   const u8 *d = cp_dst + CP_GUARD + d_off;
+   const u8 *s = cp_src + s_off;
+
+   for (u32 i = 0; i < n; i++)
+      if (d[i] != s[i])
+         panic("%s(d_off: %u, s_off: %u, n: %u): wrong byte at %u",
+               fn, d_off, s_off, n, i);
+
+   cp_check_guards(fn, d_off, n);
+}
+
+static void cp_check_correctness(void)
+{
+   for (u32 i = 0; i < CP_BUF_SZ; i++)
+      cp_src[i] = (u8)(i * 7 + (i >> 8));
+
+   for (u32 k = 0; k < ARRAY_SIZE(cp_check_sizes); k++) {
+
+      const u32 n = cp_check_sizes[k];
+
+      for (u32 d_off = 0; d_off < 8; d_off++) {
+         for (u32 s_off = 0; s_off < 8; s_off++) {
+
+            u8 *d = cp_dst + CP_GUARD + d_off;
+
+            memset(cp_dst, CP_FILL, n + 3 * CP_GUARD);
+            memcpy(d, cp_src + s_off, n);
+            cp_check_copy("memcpy", d_off, s_off, n);
+
+            memset(cp_dst, CP_FILL, n + 3 * CP_GUARD);
+
+            if (arch_user_copy(d, cp_src + s_off, n))
+               panic("arch_user_copy() failed on kernel buffers");
+
+            cp_check_copy("arch_user_copy", d_off, s_off, n);
+         }
+
+         memset(cp_dst, CP_FILL, n + 3 * CP_GUARD);
+         memset(cp_dst + CP_GUARD + d_off, 0x3c, n);
+
+         for (u32 i = 0; i < n; i++)
+            if (cp_dst[CP_GUARD + d_off + i] != 0x3c)
+               panic("memset(off: %u, n: %u): wrong byte at %u", d_off, n, i);
+
+         cp_check_guards("memset", d_off, n);
+      }
+
+      /* Overlapping moves, in both directions */
+      for (u32 i = 0; i < 2 * n + 16; i++)
+         cp_dst[i] = cp_src[i];
+
+      memmove(cp_dst + 3, cp_dst, n);
+
+      for (u32 i = 0; i < n; i++)
+         if (cp_dst[3 + i] != cp_src[i])
+            panic("memmove(up, n: %u): wrong byte at %u", n, i);
+
+      for (u32 i = 0; i < 2 * n + 16; i++)
+         cp_dst[i] = cp_src[i];
+
+      memmove(cp_dst, cp_dst + 9, n);
+
+      for (u32 i = 0; i < n; i++)
+         if (cp_dst[i] != cp_src[9 + i])
+            panic("memmove(down, n: %u): wrong byte at %u", n, i);
+   }
+
+   printk("memcpy, memset, memmove, arch_user_copy: OK\n");
+}
+
+static void cp_check_large_paths(void)
+{
+   static const u32 sizes[] = { 1000, 4095, 4096, 4129, 3 * 4096 + 5 };
+   static const u32 offs[][2] = { {0, 0}, {1, 1}, {16, 16}, {40, 8}, {3, 5} };
+   u8 *pg = cp_dst + (-(ulong)cp_dst & OFFSET_IN_PAGE_MASK);
+
+   for (u32 k = 0; k < ARRAY_SIZE(sizes); k++) {
+      for (u32 j = 0; j < ARRAY_SIZE(offs); j++) {
+
+         const u32 n = sizes[k];
+         const u32 d_off = offs[j][0], s_off = offs[j][1];
+
+         memset(cp_dst, CP_FILL, n + 3 * CP_GUARD);
+         memcpy_large(cp_dst + CP_GUARD + d_off, cp_src + s_off, n);
+         cp_check_copy("memcpy_large", d_off, s_off, n);
+      }
+   }
+
+   memset(pg, CP_FILL, 2 * PAGE_SIZE);
+   bzero_page(pg);
+
+   for (u32 i = 0; i < PAGE_SIZE; i++)
+      if (pg[i] || pg[PAGE_SIZE + i] != CP_FILL)
+         panic("bzero_page(): wrong byte at %u", i);
+
+   printk("memcpy_large, bzero_page: OK\n");
+}
+
+static void cp_perf_per_size(u32 size)
+{
+   const u32 iters = MAX(16u, (4 * MB) / size);
+   u64 start, t_cpy, t_cpy_mis, t_set, t_ucopy;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      memcpy(cp_dst, cp_src, size);
+   t_cpy = RDTSC() - start;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      memcpy(cp_dst + 1, cp_src + 2, size);
+   t_cpy_mis = RDTSC() - start;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      memset(cp_dst, 0, size);
+   t_set = RDTSC() - start;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      arch_user_copy(cp_dst, cp_src, size);
+   t_ucopy = RDTSC() - start;
+
+   printk("%6u: %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+          size,
+          t_cpy / iters,
+          t_cpy_mis / iters,
+          t_set / iters,
+          t_ucopy / iters);
+}
+
+static void cp_perf_pages(void)
+{
+   const u32 iters = 256;
+   u8 *dst = cp_dst + (-(ulong)cp_dst & OFFSET_IN_PAGE_MASK);
+   u8 *src = cp_src + (-(ulong)cp_src & OFFSET_IN_PAGE_MASK);
+   u64 start, t_cpy, t_large, t_zero, t_zero_pg;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      for (u32 p = 0; p < CP_PAGES; p++)
+         memcpy(dst + p * PAGE_SIZE, src + p * PAGE_SIZE, PAGE_SIZE);
+   t_cpy = RDTSC() - start;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      for (u32 p = 0; p < CP_PAGES; p++)
+         memcpy_large(dst + p * PAGE_SIZE, src + p * PAGE_SIZE, PAGE_SIZE);
+   t_large = RDTSC() - start;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      for (u32 p = 0; p < CP_PAGES; p++)
+         bzero(dst + p * PAGE_SIZE, PAGE_SIZE);
+   t_zero = RDTSC() - start;
+
+   start = RDTSC();
+   for (u32 i = 0; i < iters; i++)
+      for (u32 p = 0; p < CP_PAGES; p++)
+         bzero_page(dst + p * PAGE_SIZE);
+   t_zero_pg = RDTSC() - start;
+
+   printk("Cycles per page:\n");
+   printk("%12s %12s %12s %12s\n",
+          "memcpy", "memcpy_large", "bzero", "bzero_page");
+   printk("%12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+          t_cpy / (iters * CP_PAGES),
+          t_large / (iters * CP_PAGES),
+          t_zero / (iters * CP_PAGES),
+          t_zero_pg / (iters * CP_PAGES));
+}
+
+void selftest_copy_perf(void)
+{
+   printk("*** copy perf test ***\n");
+
+   cp_src = kmalloc(CP_BUF_SZ + 8);
+   cp_dst = kmalloc(CP_BUF_SZ + 8);
+
+   if (!cp_src || !cp_dst)
+      panic("No enough memory for the copy buffers");
+
+   cp_check_correctness();
+   cp_check_large_paths();
+
+   printk("Cycles per call:\n");
+   printk("%6s: %10s %10s %10s %10s\n",
+          "size", "memcpy", "unaligned", "memset", "user_copy");
+
+   for (u32 s = 64; s <= CP_BUF_SZ; s *= 4) {
+
+      if (se_is_stop_requested())
+         break;
+
+      cp_perf_per_size(s);
+   }
+
+   if (!se_is_stop_requested())
+      cp_perf_pages();
+
+   kfree2(cp_dst, CP_BUF_SZ + 8);
+   kfree2(cp_src, CP_BUF_SZ + 8);
+
+   if (se_is_stop_requested())
+      se_interrupted_end();
+   else
+      se_regular_end();
+}
+
+REGISTER_SELF_TEST(copy_perf, se_long, &selftest_copy_perf)
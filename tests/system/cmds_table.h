@@ -26,11 +26,16 @@ CMD_ENTRY(bad_read,     TT_SHORT,  true)
 CMD_ENTRY(bad_write,    TT_SHORT,  true)
 CMD_ENTRY(fork_perf,    TT_LONG,   true)
 CMD_ENTRY(vfork_perf,   TT_LONG,   true)
+CMD_ENTRY(fork_perf2,   TT_LONG,   true)
 CMD_ENTRY(syscall_perf, TT_MED,    true)
 CMD_ENTRY(fpu,          TT_SHORT,  true)
 CMD_ENTRY(brk,          TT_SHORT,  true)
 CMD_ENTRY(mmap,         TT_MED,    true)
 CMD_ENTRY(mmap2,        TT_SHORT,  true)
+CMD_ENTRY(madvise,      TT_SHORT,  true)
+CMD_ENTRY(mremap,       TT_SHORT,  true)
+CMD_ENTRY(mprotect,     TT_SHORT,  true)
+CMD_ENTRY(rlimit,       TT_SHORT,  true)
 CMD_ENTRY(kcow,         TT_SHORT,  true)
 CMD_ENTRY(wpid1,        TT_SHORT,  true)
 CMD_ENTRY(wpid2,        TT_SHORT,  true)
@@ -68,6 +73,9 @@ CMD_ENTRY(pipe2,        TT_SHORT,  true)
 CMD_ENTRY(pipe3,        TT_SHORT,  true)
 CMD_ENTRY(pipe4,        TT_SHORT,  true)
 CMD_ENTRY(pipe5,        TT_SHORT,  true)
+CMD_ENTRY(pipe6,        TT_SHORT,  true)
+CMD_ENTRY(aio1,         TT_SHORT,  true)
+CMD_ENTRY(aio2,         TT_SHORT,  true)
 CMD_ENTRY(pollerr,      TT_SHORT,  true)
 CMD_ENTRY(pollhup,      TT_SHORT,  true)
 CMD_ENTRY(poll1,        TT_SHORT,  true)
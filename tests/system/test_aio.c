@@ -0,0 +1,224 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/aio_abi.h>
+
+#include "devshell.h"
+#include "test_common.h"
+
+/* Header of the ring mapped by io_setup(): not exported by aio_abi.h */
+struct aio_ring {
+   unsigned id;
+   unsigned nr;
+   unsigned head;
+   unsigned tail;
+   unsigned magic;
+   unsigned compat_features;
+   unsigned incompat_features;
+   unsigned header_length;
+   struct io_event events[0];
+};
+
+/* The raw syscall takes the old timespec on 32-bit systems */
+struct aio_timespec {
+   long tv_sec;
+   long tv_nsec;
+};
+
+static long io_setup(unsigned nr, aio_context_t *ctx)
+{
+   return syscall(SYS_io_setup, nr, ctx);
+}
+
+static long io_destroy(aio_context_t ctx)
+{
+   return syscall(SYS_io_destroy, ctx);
+}
+
+static long io_submit(aio_context_t ctx, long nr, struct iocb **cbs)
+{
+   return syscall(SYS_io_submit, ctx, nr, cbs);
+}
+
+static long io_cancel(aio_context_t ctx, struct iocb *cb, struct io_event *ev)
+{
+   return syscall(SYS_io_cancel, ctx, cb, ev);
+}
+
+static long
+io_getevents(aio_context_t ctx, long min_nr, long nr,
+             struct io_event *evs, struct aio_timespec *ts)
+{
+   return syscall(SYS_io_getevents, ctx, min_nr, nr, evs, ts);
+}
+
+static void
+aio_prep(struct iocb *cb, int fd, int op, void *buf, size_t len, long off)
+{
+   memset(cb, 0, sizeof(*cb));
+   cb->aio_data = (unsigned long)cb;
+   cb->aio_lio_opcode = op;
+   cb->aio_fildes = fd;
+   cb->aio_buf = (unsigned long)buf;
+   cb->aio_nbytes = len;
+   cb->aio_offset = off;
+}
+
+/* Reap one event directly from the ring, without any syscall */
+static bool ring_reap_one(struct aio_ring *ring, struct io_event *ev)
+{
+   for (int i = 0; i < 1000; i++) {
+
+      if (ring->head != ring->tail) {
+         *ev = ring->events[ring->head];
+         ring->head = (ring->head + 1) % ring->nr;
+         return true;
+      }
+
+      sched_yield();
+   }
+
+   return false;
+}
+
+/* io_setup/io_submit/io_getevents on a ramfs file */
+int cmd_aio1(int argc, char **argv)
+{
+   static const char msg[] = "hello, aio!";
+   struct iocb cbs[3], *pcbs[3] = { &cbs[0], &cbs[1], &cbs[2] };
+   char r1[5], r2[16];
+   struct iovec rv[2] = {
+      { .iov_base = r1, .iov_len = sizeof(r1) },
+      { .iov_base = r2, .iov_len = sizeof(r2) },
+   };
+   struct io_event evs[3];
+   struct aio_ring *ring;
+   aio_context_t ctx = 0;
+   bool got_read = false, got_sync = false;
+   long rc;
+   int fd;
+
+   DEVSHELL_CMD_ASSERT(io_setup(8, &ctx) == 0);
+   DEVSHELL_CMD_ASSERT(ctx != 0);
+
+   ring = (void *)ctx;
+   DEVSHELL_CMD_ASSERT(ring->magic == 0xa10a10a1);
+   DEVSHELL_CMD_ASSERT(ring->nr > 8);
+   DEVSHELL_CMD_ASSERT(ring->head == ring->tail);
+
+   fd = open("/tmp/aio1", O_CREAT | O_RDWR, 0644);
+   DEVSHELL_CMD_ASSERT(fd > 0);
+
+   /* Write at an offset, then wait with io_getevents() */
+   aio_prep(&cbs[0], fd, IOCB_CMD_PWRITE, (void *)msg, strlen(msg), 100);
+   DEVSHELL_CMD_ASSERT(io_submit(ctx, 1, pcbs) == 1);
+
+   rc = io_getevents(ctx, 1, 3, evs, NULL);
+   DEVSHELL_CMD_ASSERT(rc == 1);
+   DEVSHELL_CMD_ASSERT(evs[0].data == (unsigned long)&cbs[0]);
+   DEVSHELL_CMD_ASSERT(evs[0].obj == (unsigned long)&cbs[0]);
+   DEVSHELL_CMD_ASSERT(evs[0].res == (long)strlen(msg));
+   DEVSHELL_CMD_ASSERT(lseek(fd, 0, SEEK_CUR) == 0);
+
+   /* A vectored read and an fsync in one batch, reaped from the ring */
+   memset(r2, 0, sizeof(r2));
+   aio_prep(&cbs[1], fd, IOCB_CMD_PREADV, rv, 2, 100);
+   aio_prep(&cbs[2], fd, IOCB_CMD_FSYNC, NULL, 0, 0);
+   DEVSHELL_CMD_ASSERT(io_submit(ctx, 2, &pcbs[1]) == 2);
+
+   for (int i = 0; i < 2; i++) {
+
+      DEVSHELL_CMD_ASSERT(ring_reap_one(ring, &evs[i]));
+
+      if (evs[i].obj == (unsigned long)&cbs[1]) {
+         DEVSHELL_CMD_ASSERT(evs[i].res == (long)strlen(msg));
+         got_read = true;
+      } else {
+         DEVSHELL_CMD_ASSERT(evs[i].obj == (unsigned long)&cbs[2]);
+         DEVSHELL_CMD_ASSERT(evs[i].res == 0);
+         got_sync = true;
+      }
+   }
+
+   DEVSHELL_CMD_ASSERT(got_read && got_sync);
+   DEVSHELL_CMD_ASSERT(!memcmp(r1, "hello", 5));
+   DEVSHELL_CMD_ASSERT(!strcmp(r2, ", aio!"));
+
+   /* Nothing left: a zero timeout returns immediately */
+   struct aio_timespec ts = { 0, 0 };
+   DEVSHELL_CMD_ASSERT(io_getevents(ctx, 1, 3, evs, &ts) == 0);
+
+   /* Invalid requests */
+   aio_prep(&cbs[0], fd, 1234, NULL, 0, 0);
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(io_submit(ctx, 1, pcbs) < 0 && errno == EINVAL);
+
+   aio_prep(&cbs[0], 1000, IOCB_CMD_PREAD, r2, sizeof(r2), 0);
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(io_submit(ctx, 1, pcbs) < 0 && errno == EBADF);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(io_getevents(ctx, 2, 1, evs, NULL) < 0);
+   DEVSHELL_CMD_ASSERT(errno == EINVAL);
+
+   DEVSHELL_CMD_ASSERT(io_destroy(ctx) == 0);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(io_destroy(ctx) < 0 && errno == EINVAL);
+
+   close(fd);
+   unlink("/tmp/aio1");
+   return 0;
+}
+
+/* Reads from a pipe completing only when data arrives; io_cancel() */
+int cmd_aio2(int argc, char **argv)
+{
+   struct iocb cb, *pcb = &cb;
+   struct aio_timespec ts = { 0, 50 * 1000 * 1000 };
+   struct io_event ev;
+   aio_context_t ctx = 0;
+   char buf[16];
+   int fds[2];
+
+   DEVSHELL_CMD_ASSERT(pipe(fds) == 0);
+   DEVSHELL_CMD_ASSERT(io_setup(4, &ctx) == 0);
+
+   memset(buf, 0, sizeof(buf));
+   aio_prep(&cb, fds[0], IOCB_CMD_PREAD, buf, sizeof(buf), 0);
+   DEVSHELL_CMD_ASSERT(io_submit(ctx, 1, &pcb) == 1);
+
+   /* The pipe is empty: the read stays in flight */
+   DEVSHELL_CMD_ASSERT(io_getevents(ctx, 1, 1, &ev, &ts) == 0);
+
+   DEVSHELL_CMD_ASSERT(write(fds[1], "data", 4) == 4);
+   DEVSHELL_CMD_ASSERT(io_getevents(ctx, 1, 1, &ev, NULL) == 1);
+   DEVSHELL_CMD_ASSERT(ev.obj == (unsigned long)&cb);
+   DEVSHELL_CMD_ASSERT(ev.res == 4);
+   DEVSHELL_CMD_ASSERT(!strcmp(buf, "data"));
+
+   /* Cancel a pending read: the result is posted in the ring */
+   DEVSHELL_CMD_ASSERT(io_submit(ctx, 1, &pcb) == 1);
+   DEVSHELL_CMD_ASSERT(io_getevents(ctx, 1, 1, &ev, &ts) == 0);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(io_cancel(ctx, &cb, &ev) < 0 && errno == EINPROGRESS);
+   DEVSHELL_CMD_ASSERT(io_getevents(ctx, 1, 1, &ev, NULL) == 1);
+   DEVSHELL_CMD_ASSERT(ev.res == -ECANCELED);
+
+   /* Destroying the context with a read still pending */
+   DEVSHELL_CMD_ASSERT(io_submit(ctx, 1, &pcb) == 1);
+   DEVSHELL_CMD_ASSERT(io_destroy(ctx) == 0);
+
+   close(fds[0]);
+   close(fds[1]);
+   return 0;
+}
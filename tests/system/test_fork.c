@@ -144,6 +144,59 @@ int cmd_vfork_perf(int argc, char **argv)
    return do_fork_perf(&vfork);
 }
 
+/*
+ * Fork rate with many children alive at the same time: each round forks a
+ * burst of children that exit immediately and then reaps them all. Bursts
+ * larger than the kernel's task pool (-task_pool) fall back to the heap.
+ */
+int cmd_fork_perf2(int argc, char **argv)
+{
+   const int rounds = 2000;
+   int burst = 16;
+   int rc, wstatus, child_pid;
+   ull_t start, duration;
+
+   if (argc > 0)
+      burst = atoi(argv[0]);
+
+   if (burst <= 0 || burst > 256) {
+      printf("Invalid burst size: %d\n", burst);
+      return 1;
+   }
+
+   start = RDTSC();
+
+   for (int r = 0; r < rounds; r++) {
+
+      for (int i = 0; i < burst; i++) {
+
+         child_pid = fork();
+
+         if (child_pid < 0) {
+            perror("fork() failed");
+            return 1;
+         }
+
+         if (!child_pid)
+            exit(0); // exit from the child
+      }
+
+      for (int i = 0; i < burst; i++) {
+
+         rc = waitpid(-1, &wstatus, 0);
+
+         if (rc < 0) {
+            perror("waitpid() failed");
+            return 1;
+         }
+      }
+   }
+
+   duration = RDTSC() - start;
+   printf("burst: %d, duration: %llu\n", burst, duration / (rounds * burst));
+   return 0;
+}
+
 int cmd_execve0(int argc, char **argv)
 {
    int rc, pid, wstatus;
@@ -15,6 +15,7 @@
 #include <sys/stat.h>
 #include <sys/syscall.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
 
 #include "devshell.h"
 #include "sysenter.h"
@@ -162,6 +163,355 @@ int cmd_mmap2(int argc, char **argv)
    return 0;
 }
 
+static bool all_resident(void *buf, size_t pages, unsigned char *vec, int val)
+{
+   if (mincore(buf, pages * getpagesize(), vec) != 0)
+      return false;
+
+   for (size_t i = 0; i < pages; i++)
+      if ((vec[i] & 1) != val)
+         return false;
+
+   return true;
+}
+
+/* madvise() and mincore() on anonymous memory, plus MAP_POPULATE */
+int cmd_madvise(int argc, char **argv)
+{
+   const size_t page_size = getpagesize();
+   const size_t pages = 8;
+   const size_t len = pages * page_size;
+   unsigned char vec[8];
+   char *buf;
+   int rc;
+
+   buf = mmap(NULL, len, PROT_READ | PROT_WRITE,
+              MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+   DEVSHELL_CMD_ASSERT(buf != (void *)-1);
+
+   if (!MMAP_NO_COW)
+      DEVSHELL_CMD_ASSERT(all_resident(buf, pages, vec, 0));
+
+   buf[0] = 'a';
+   buf[3 * page_size] = 'b';
+
+   DEVSHELL_CMD_ASSERT(mincore(buf, len, vec) == 0);
+   DEVSHELL_CMD_ASSERT(vec[0] & 1);
+   DEVSHELL_CMD_ASSERT(vec[3] & 1);
+
+   /* DONTNEED: the pages are dropped and read back as zeros */
+   rc = madvise(buf, len, MADV_DONTNEED);
+   DEVSHELL_CMD_ASSERT(rc == 0);
+   DEVSHELL_CMD_ASSERT(all_resident(buf, pages, vec, 0));
+   DEVSHELL_CMD_ASSERT(buf[0] == 0 && buf[3 * page_size] == 0);
+
+   /* WILLNEED: on Tilck, anonymous pages are prefaulted too */
+   rc = madvise(buf, len, MADV_WILLNEED);
+   DEVSHELL_CMD_ASSERT(rc == 0);
+
+   if (getenv("TILCK"))
+      DEVSHELL_CMD_ASSERT(all_resident(buf, pages, vec, 1));
+
+   rc = madvise(buf + 1, page_size, MADV_DONTNEED);
+   DEVSHELL_CMD_ASSERT(rc < 0 && errno == EINVAL);
+
+   DEVSHELL_CMD_ASSERT(munmap(buf, len) == 0);
+
+   /* The range is not mapped anymore */
+   rc = mincore(buf, len, vec);
+   DEVSHELL_CMD_ASSERT(rc < 0 && errno == ENOMEM);
+
+   buf = mmap(NULL, len, PROT_READ | PROT_WRITE,
+              MAP_ANONYMOUS | MAP_PRIVATE | MAP_POPULATE, -1, 0);
+
+   DEVSHELL_CMD_ASSERT(buf != (void *)-1);
+   DEVSHELL_CMD_ASSERT(all_resident(buf, pages, vec, 1));
+   DEVSHELL_CMD_ASSERT(munmap(buf, len) == 0);
+   return 0;
+}
+
+static void *
+do_mremap(void *old_addr, size_t old_len, size_t len, int flags)
+{
+   return (void *)syscall(SYS_mremap, old_addr, old_len, len, flags, NULL);
+}
+
+#ifndef MREMAP_MAYMOVE
+   #define MREMAP_MAYMOVE 1
+#endif
+
+/* mremap() of anonymous memory: growth in-place, moves and shrinking */
+int cmd_mremap(int argc, char **argv)
+{
+   const size_t page_size = getpagesize();
+   unsigned char vec[1];
+   char *buf, *buf2;
+
+   buf = mmap(NULL, 8 * page_size, PROT_READ | PROT_WRITE,
+              MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+   DEVSHELL_CMD_ASSERT(buf != (void *)-1);
+
+   for (int i = 0; i < 4; i++)
+      buf[i * page_size] = 'a' + i;
+
+   /* Make room after the first 4 pages, then grow back in-place */
+   DEVSHELL_CMD_ASSERT(munmap(buf + 4 * page_size, 4 * page_size) == 0);
+
+   buf2 = do_mremap(buf, 4 * page_size, 8 * page_size, 0);
+   DEVSHELL_CMD_ASSERT(buf2 == buf);
+
+   for (int i = 0; i < 4; i++) {
+      DEVSHELL_CMD_ASSERT(buf[i * page_size] == 'a' + i);
+      DEVSHELL_CMD_ASSERT(buf[(i + 4) * page_size] == 0);
+   }
+
+   buf[7 * page_size] = 'z';
+
+   /* Pages 2..7 follow the first two: they cannot grow without moving */
+   buf2 = do_mremap(buf, 2 * page_size, 4 * page_size, 0);
+   DEVSHELL_CMD_ASSERT(buf2 == (void *)-1 && errno == ENOMEM);
+
+   buf2 = do_mremap(buf, 2 * page_size, 16 * page_size, MREMAP_MAYMOVE);
+   DEVSHELL_CMD_ASSERT(buf2 != (void *)-1);
+   DEVSHELL_CMD_ASSERT(buf2 != buf);
+   DEVSHELL_CMD_ASSERT(buf2[0] == 'a' && buf2[page_size] == 'b');
+   DEVSHELL_CMD_ASSERT(buf2[15 * page_size] == 0);
+
+   /* The old range is gone, while the rest of the old mapping is still there */
+   DEVSHELL_CMD_ASSERT(mincore(buf, page_size, vec) < 0 && errno == ENOMEM);
+   DEVSHELL_CMD_ASSERT(buf[2 * page_size] == 'c');
+   DEVSHELL_CMD_ASSERT(buf[7 * page_size] == 'z');
+
+   /* Shrink */
+   DEVSHELL_CMD_ASSERT(do_mremap(buf2, 16 * page_size, page_size, 0) == buf2);
+   DEVSHELL_CMD_ASSERT(buf2[0] == 'a');
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(mincore(buf2 + page_size, page_size, vec) < 0);
+   DEVSHELL_CMD_ASSERT(errno == ENOMEM);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(
+      do_mremap(buf + 1, page_size, 2 * page_size, MREMAP_MAYMOVE) == (void *)-1
+   );
+   DEVSHELL_CMD_ASSERT(errno == EINVAL);
+
+   DEVSHELL_CMD_ASSERT(munmap(buf2, page_size) == 0);
+   DEVSHELL_CMD_ASSERT(munmap(buf + 2 * page_size, 6 * page_size) == 0);
+   return 0;
+}
+
+static void mprotect_write_child(void *ptr)
+{
+   *(volatile char *)ptr = 'x';
+}
+
+static void mprotect_read_child(void *ptr)
+{
+   (void)*(volatile char *)ptr;
+}
+
+static void mprotect_cow_child(void *ptr)
+{
+   if (mprotect(ptr, getpagesize(), PROT_READ | PROT_WRITE))
+      exit(1);
+
+   *(volatile char *)ptr = 'x';
+   exit(*(volatile char *)ptr == 'x' ? 0 : 2);
+}
+
+static int mprotect_file_mapping(void)
+{
+   static const char path[] = "/tmp/mprotect_test";
+   const size_t page_size = getpagesize();
+   char *buf, *fbuf;
+   int fd, rofd;
+
+   fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+   DEVSHELL_CMD_ASSERT(fd >= 0);
+
+   buf = malloc(page_size);
+   DEVSHELL_CMD_ASSERT(buf != NULL);
+   memset(buf, 'f', page_size);
+   DEVSHELL_CMD_ASSERT(write(fd, buf, page_size) == (ssize_t)page_size);
+
+   fbuf = mmap(NULL, page_size, PROT_READ, MAP_SHARED, fd, 0);
+   DEVSHELL_CMD_ASSERT(fbuf != (void *)-1);
+   DEVSHELL_CMD_ASSERT(fbuf[0] == 'f');
+   DEVSHELL_CMD_ASSERT(
+      test_sig(mprotect_write_child, fbuf, SIGSEGV, 0, 0) == 0
+   );
+
+   /* Writes to the shared mapping are visible through the file */
+   DEVSHELL_CMD_ASSERT(mprotect(fbuf, page_size, PROT_READ | PROT_WRITE) == 0);
+   fbuf[0] = 'g';
+   DEVSHELL_CMD_ASSERT(pread(fd, buf, 1, 0) == 1 && buf[0] == 'g');
+   DEVSHELL_CMD_ASSERT(munmap(fbuf, page_size) == 0);
+
+   /* No PROT_WRITE for files not open for writing */
+   rofd = open(path, O_RDONLY);
+   DEVSHELL_CMD_ASSERT(rofd >= 0);
+
+   fbuf = mmap(NULL, page_size, PROT_READ, MAP_SHARED, rofd, 0);
+   DEVSHELL_CMD_ASSERT(fbuf != (void *)-1);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(mprotect(fbuf, page_size, PROT_WRITE) < 0);
+   DEVSHELL_CMD_ASSERT(errno == EACCES);
+
+   DEVSHELL_CMD_ASSERT(munmap(fbuf, page_size) == 0);
+   close(rofd);
+   close(fd);
+   free(buf);
+   DEVSHELL_CMD_ASSERT(unlink(path) == 0);
+   return 0;
+}
+
+/* mprotect() of anonymous and file mappings, splitting them and with COW */
+int cmd_mprotect(int argc, char **argv)
+{
+   const size_t page_size = getpagesize();
+   const size_t len = 4 * page_size;
+   char *buf, *ro;
+   int fds[2];
+
+   buf = mmap(NULL, len, PROT_READ | PROT_WRITE,
+              MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+   DEVSHELL_CMD_ASSERT(buf != (void *)-1);
+   buf[0] = 'a';
+   buf[page_size] = 'b';
+
+   /* Read-only page in the middle: the mapping gets split in three parts */
+   DEVSHELL_CMD_ASSERT(mprotect(buf + page_size, page_size, PROT_READ) == 0);
+   DEVSHELL_CMD_ASSERT(buf[page_size] == 'b');
+   DEVSHELL_CMD_ASSERT(
+      test_sig(mprotect_write_child, buf + page_size, SIGSEGV, 0, 0) == 0
+   );
+
+   buf[0] = 'c';
+   buf[2 * page_size] = 'd';
+
+   /* Making the page writable in the child must not affect the parent */
+   DEVSHELL_CMD_ASSERT(
+      test_sig(mprotect_cow_child, buf + page_size, 0, 0, 0) == 0
+   );
+   DEVSHELL_CMD_ASSERT(buf[page_size] == 'b');
+
+   /* Back to a single writable mapping */
+   DEVSHELL_CMD_ASSERT(mprotect(buf, len, PROT_READ | PROT_WRITE) == 0);
+   buf[page_size] = 'e';
+   DEVSHELL_CMD_ASSERT(buf[0] == 'c' && buf[2 * page_size] == 'd');
+
+   /* PROT_NONE: any access is a SIGSEGV */
+   DEVSHELL_CMD_ASSERT(mprotect(buf, page_size, PROT_NONE) == 0);
+   DEVSHELL_CMD_ASSERT(test_sig(mprotect_read_child, buf, SIGSEGV, 0, 0) == 0);
+
+   /* Not even the kernel can read or write it on our behalf */
+   DEVSHELL_CMD_ASSERT(pipe(fds) == 0);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(write(fds[1], buf, 16) < 0 && errno == EFAULT);
+
+   DEVSHELL_CMD_ASSERT(write(fds[1], "xyz", 3) == 3);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(read(fds[0], buf, 16) < 0 && errno == EFAULT);
+
+   close(fds[0]);
+   close(fds[1]);
+
+   DEVSHELL_CMD_ASSERT(mprotect(buf, page_size, PROT_READ) == 0);
+   DEVSHELL_CMD_ASSERT(buf[0] == 'c');
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(mprotect(buf + 1, page_size, PROT_READ) < 0);
+   DEVSHELL_CMD_ASSERT(errno == EINVAL);
+
+   /* The range must be all mapped */
+   DEVSHELL_CMD_ASSERT(munmap(buf + 3 * page_size, page_size) == 0);
+
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(mprotect(buf, len, PROT_READ) < 0);
+   DEVSHELL_CMD_ASSERT(errno == ENOMEM);
+   DEVSHELL_CMD_ASSERT(munmap(buf, 3 * page_size) == 0);
+
+   /* Read-only anonymous mappings */
+   ro = mmap(NULL, page_size, PROT_READ, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+   DEVSHELL_CMD_ASSERT(ro != (void *)-1);
+   DEVSHELL_CMD_ASSERT(ro[0] == 0);
+   DEVSHELL_CMD_ASSERT(test_sig(mprotect_write_child, ro, SIGSEGV, 0, 0) == 0);
+   DEVSHELL_CMD_ASSERT(munmap(ro, page_size) == 0);
+
+   return mprotect_file_mapping();
+}
+
+static void rlimit_as_child(void *unused)
+{
+   const size_t page_size = getpagesize();
+   struct rlimit rl = { .rlim_cur = 0, .rlim_max = RLIM_INFINITY };
+   void *brk0 = (void *)syscall(SYS_brk, 0);
+   void *buf;
+
+   if (setrlimit(RLIMIT_AS, &rl))
+      exit(1);
+
+   /* No growth of the address space is allowed anymore */
+   errno = 0;
+   buf = mmap(NULL, page_size, PROT_READ | PROT_WRITE,
+              MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+   if (buf != (void *)-1 || errno != ENOMEM)
+      exit(2);
+
+   if ((void *)syscall(SYS_brk, brk0 + page_size) != brk0)
+      exit(3);
+
+   /* The soft limit can be raised up to the hard one */
+   rl.rlim_cur = RLIM_INFINITY;
+
+   if (setrlimit(RLIMIT_AS, &rl))
+      exit(4);
+
+   buf = mmap(NULL, page_size, PROT_READ | PROT_WRITE,
+              MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+
+   exit(buf != (void *)-1 ? 0 : 5);
+}
+
+/* getrlimit(), setrlimit() and the enforcement of RLIMIT_AS */
+int cmd_rlimit(int argc, char **argv)
+{
+   struct rlimit rl, rl2;
+
+   DEVSHELL_CMD_ASSERT(getrlimit(RLIMIT_AS, &rl) == 0);
+   DEVSHELL_CMD_ASSERT(rl.rlim_cur == RLIM_INFINITY);
+
+   /* The fixed limits can be lowered, but not raised */
+   DEVSHELL_CMD_ASSERT(getrlimit(RLIMIT_NOFILE, &rl) == 0);
+   DEVSHELL_CMD_ASSERT(rl.rlim_cur == rl.rlim_max);
+   DEVSHELL_CMD_ASSERT(rl.rlim_max != RLIM_INFINITY);
+
+   rl2 = (struct rlimit) { .rlim_cur = 1, .rlim_max = rl.rlim_max + 1 };
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(setrlimit(RLIMIT_NOFILE, &rl2) < 0);
+   DEVSHELL_CMD_ASSERT(errno == EPERM);
+
+   rl2 = (struct rlimit) { .rlim_cur = 2, .rlim_max = 1 };
+   errno = 0;
+   DEVSHELL_CMD_ASSERT(setrlimit(RLIMIT_DATA, &rl2) < 0);
+   DEVSHELL_CMD_ASSERT(errno == EINVAL);
+
+   DEVSHELL_CMD_ASSERT(test_sig(rlimit_as_child, NULL, 0, 0, 0) == 0);
+
+   /* The limits set by the child did not affect the parent */
+   DEVSHELL_CMD_ASSERT(getrlimit(RLIMIT_AS, &rl) == 0);
+   DEVSHELL_CMD_ASSERT(rl.rlim_cur == RLIM_INFINITY);
+   return 0;
+}
+
 static size_t fork_oom_alloc_size;
 
 static void fork_oom_child(void *buf)
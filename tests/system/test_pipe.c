@@ -10,6 +10,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/uio.h>
 
 #include "devshell.h"
 #include "test_common.h"
@@ -469,3 +470,62 @@ int cmd_pipe5(int argc, char **argv)
 
    return 0;
 }
+
+/* readv() and writev() on pipes, including the atomicity of small writev() */
+int cmd_pipe6(int argc, char **argv)
+{
+   char a[] = "hello", b[] = ", ", c[] = "world!";
+   char r1[3], r2[16], big[4096];
+   struct iovec wv[3] = {
+      { .iov_base = a, .iov_len = 5 },
+      { .iov_base = b, .iov_len = 2 },
+      { .iov_base = c, .iov_len = 6 },
+   };
+   struct iovec rv[2] = {
+      { .iov_base = r1, .iov_len = sizeof(r1) },
+      { .iov_base = r2, .iov_len = sizeof(r2) },
+   };
+   int fds[2];
+   ssize_t rc;
+
+   DEVSHELL_CMD_ASSERT(pipe(fds) == 0);
+
+   rc = writev(fds[1], wv, 3);
+   DEVSHELL_CMD_ASSERT(rc == 13);
+
+   memset(r2, 0, sizeof(r2));
+   rc = readv(fds[0], rv, 2);
+   DEVSHELL_CMD_ASSERT(rc == 13);
+   DEVSHELL_CMD_ASSERT(!memcmp(r1, "hel", 3));
+   DEVSHELL_CMD_ASSERT(!strcmp(r2, "lo, world!"));
+
+   /* Fill the pipe, leaving room for just 8 bytes */
+   DEVSHELL_CMD_ASSERT(fcntl(fds[1], F_SETFL, O_NONBLOCK) == 0);
+   memset(big, 'x', sizeof(big));
+   rc = write(fds[1], big, sizeof(big) - 8);
+   DEVSHELL_CMD_ASSERT(rc == (ssize_t)sizeof(big) - 8);
+
+   /* 13 bytes don't fit: nothing gets written */
+   errno = 0;
+   rc = writev(fds[1], wv, 3);
+   DEVSHELL_CMD_ASSERT(rc < 0 && errno == EAGAIN);
+
+   /* 7 bytes do fit */
+   rc = writev(fds[1], wv, 2);
+   DEVSHELL_CMD_ASSERT(rc == 7);
+
+   rc = read(fds[0], big, sizeof(big) - 8);
+   DEVSHELL_CMD_ASSERT(rc == (ssize_t)sizeof(big) - 8);
+
+   memset(r2, 0, sizeof(r2));
+   rc = read(fds[0], r2, sizeof(r2));
+   DEVSHELL_CMD_ASSERT(rc == 7);
+   DEVSHELL_CMD_ASSERT(!strcmp(r2, "hello, "));
+
+   /* No writers: readv() returns 0 */
+   close(fds[1]);
+   rc = readv(fds[0], rv, 2);
+   DEVSHELL_CMD_ASSERT(rc == 0);
+   close(fds[0]);
+   return 0;
+}
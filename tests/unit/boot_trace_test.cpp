@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <cstring>
+#include <gtest/gtest.h>
+
+extern "C" {
+   #include <tilck/common/basic_defs.h>
+   #include <tilck/common/boot.h>
+   #include <tilck/kernel/boot_trace.h>
+}
+
+TEST(boot_trace, merge_bootloader_and_kernel)
+{
+   static struct tilck_boot_trace bl;
+   struct boot_trace_entry buf[BOOT_TRACE_MAX_ENTRIES + TILCK_BOOT_TRACE_MAX];
+   u32 n;
+
+   /* A bogus count and names without the NUL terminator */
+   bl.count = TILCK_BOOT_TRACE_MAX + 5;
+
+   for (u32 i = 0; i < TILCK_BOOT_TRACE_MAX; i++) {
+      bl.entries[i].tsc = 1000 + i;
+      memset(bl.entries[i].name, 'a' + (char)i, TILCK_BOOT_TRACE_NAME_LEN);
+   }
+
+   boot_trace_import(&bl);
+   boot_trace("stage1");
+   boot_trace_module("mod1");
+
+   n = boot_trace_get(buf, ARRAY_SIZE(buf));
+   ASSERT_EQ(n, (u32)TILCK_BOOT_TRACE_MAX + 2);
+
+   for (u32 i = 0; i < TILCK_BOOT_TRACE_MAX; i++) {
+      ASSERT_EQ(buf[i].src, BOOT_TRACE_BOOTLOADER);
+      ASSERT_EQ(buf[i].tsc, 1000 + i);
+      ASSERT_EQ(strlen(buf[i].name), (size_t)TILCK_BOOT_TRACE_NAME_LEN - 1);
+   }
+
+   ASSERT_EQ(buf[TILCK_BOOT_TRACE_MAX].src, BOOT_TRACE_KERNEL);
+   ASSERT_STREQ(buf[TILCK_BOOT_TRACE_MAX].name, "stage1");
+   ASSERT_EQ(buf[TILCK_BOOT_TRACE_MAX + 1].src, BOOT_TRACE_MODULE);
+   ASSERT_STREQ(buf[TILCK_BOOT_TRACE_MAX + 1].name, "mod1");
+
+   /* A short buffer gets the first entries only */
+   n = boot_trace_get(buf, TILCK_BOOT_TRACE_MAX + 1);
+   ASSERT_EQ(n, (u32)TILCK_BOOT_TRACE_MAX + 1);
+   ASSERT_STREQ(buf[TILCK_BOOT_TRACE_MAX].name, "stage1");
+
+   n = boot_trace_get(buf, 3);
+   ASSERT_EQ(n, 3u);
+   ASSERT_EQ(buf[2].tsc, 1002u);
+
+   /* The TSC frequency is unknown until boot_trace_timer_ready() */
+   ASSERT_EQ(boot_trace_tsc_khz(), 0u);
+}
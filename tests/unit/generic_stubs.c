@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include <tilck/common/basic_defs.h>
+#include <tilck/common/page_size.h>
 #include <tilck/kernel/datetime.h>
 
 struct hw_timer_info;
@@ -49,6 +50,11 @@ void arch_specific_new_proc_setup(struct process *pi,
 void arch_specific_free_proc(struct process *pi) { NOT_REACHED(); }
 void fpu_context_begin(void) { }
 void fpu_context_end(void) { }
+void memcpy_large(void *dest, const void *src, size_t n)
+{
+   memcpy(dest, src, n);
+}
+void bzero_page(void *page) { memset(page, 0, PAGE_SIZE); }
 void map_zero_pages(void *pdir,
                     void *vaddrp,
                     size_t page_count,
@@ -56,13 +62,56 @@ void map_zero_pages(void *pdir,
 {
    NOT_REACHED();
 }
+int map_zero_page(void *pdir, void *vaddrp, u32 pg_flags)
+{
+   NOT_REACHED();
+   return -1;
+}
+int get_mapping2(void *pdir, void *vaddrp, ulong *pa_ref)
+{
+   NOT_REACHED();
+   return -1;
+}
+bool is_user_range_accessible(void *pdir, const void *vaddr, size_t len)
+{
+   return true;
+}
 void dump_var_mtrrs(void) { }
-void set_page_rw(void *pdir, void *vaddr, bool rw) { }
+int set_page_rw(void *pdir, void *vaddr, bool rw) { return 0; }
 void poweroff(void) { NOT_REACHED(); }
 int get_irq_num(void *ctx) { return -1; }
 int get_int_num(void *ctx) { return -1; }
 void retain_pageframes_mapped_at(void *pdir, void *vaddr, size_t len) { }
 void release_pageframes_mapped_at(void *pdir, void *vaddr, size_t len) { }
+bool get_private_user_page(void *pdir, void *vaddr, ulong *paddr)
+{
+   NOT_REACHED();
+   return false;
+}
+bool share_page_cow(void *pdir, void *vaddr, ulong paddr)
+{
+   NOT_REACHED();
+   return false;
+}
+int swap_user_pages(void *pdir, void *va1, void *va2)
+{
+   NOT_REACHED();
+   return -1;
+}
+int set_user_pages_prot(void *pdir, void *va, size_t n, u32 fl)
+{
+   NOT_REACHED();
+   return -1;
+}
+int split_user_big_pages(void *pdir, void *va, size_t len)
+{
+   NOT_REACHED();
+   return -1;
+}
+void collapse_user_big_pages(void *pdir, void *va, size_t len)
+{
+   NOT_REACHED();
+}
 bool irq_is_masked(int irq) { NOT_REACHED(); return false; }
 void dump_stacktrace(void *ebp, void *pdir) { NOT_REACHED(); }
 bool allocate_fpu_regs(void *arch_fields) { NOT_REACHED(); return false; }
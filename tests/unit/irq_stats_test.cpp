@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace testing;
+
+extern "C" {
+   #include <tilck/kernel/irq_stats.h>
+   #include <tilck/kernel/test/irq_stats.h>
+}
+
+class irq_stats_test : public Test {
+
+   void SetUp() override {
+      irq_stats_reset();
+   }
+
+   void TearDown() override {
+      irq_stats_reset();
+   }
+};
+
+TEST_F(irq_stats_test, summary_and_histogram)
+{
+   struct irq_line_stats s;
+
+   irq_stats_push(1000);
+   irq_stats_pop(3, 1100);
+   irq_stats_push(2000);
+   irq_stats_pop(3, 2120);
+   irq_stats_push(3000);
+   irq_stats_pop(3, 8000);
+   irq_stats_spurious(3);
+
+   irq_stats_get(3, &s);
+   EXPECT_EQ(s.count, 3u);
+   EXPECT_EQ(s.tot_cycles, 5220u);
+   EXPECT_EQ(s.max_cycles, 5000u);
+   EXPECT_EQ(s.spurious, 1u);
+   EXPECT_EQ(s.hist[6], 2u);        /* 100, 120 in [64, 128) */
+   EXPECT_EQ(s.hist[12], 1u);       /* 5000 in [4096, 8192) */
+   EXPECT_EQ(irq_stats_max_nesting(), 1u);
+
+   /* The other IRQs are accounted separately */
+   irq_stats_get(4, &s);
+   EXPECT_EQ(s.count, 0u);
+
+   irq_stats_reset();
+   irq_stats_get(3, &s);
+   EXPECT_EQ(s.count, 0u);
+   EXPECT_EQ(s.hist[6], 0u);
+   EXPECT_EQ(irq_stats_max_nesting(), 0u);
+}
+
+TEST_F(irq_stats_test, nested_time_not_charged_to_parent)
+{
+   struct irq_line_stats s;
+
+   irq_stats_push(1000);            /* IRQ 1 */
+   {
+      irq_stats_push(1100);         /* IRQ 0, nested */
+      {
+         irq_stats_push(1150);      /* IRQ 5, nested twice */
+         irq_stats_pop(5, 1250);
+      }
+      irq_stats_pop(0, 1400);
+   }
+   irq_stats_pop(1, 1500);
+
+   irq_stats_get(5, &s);
+   EXPECT_EQ(s.tot_cycles, 100u);
+
+   irq_stats_get(0, &s);
+   EXPECT_EQ(s.tot_cycles, 200u);   /* 300 - 100 spent in IRQ 5 */
+
+   irq_stats_get(1, &s);
+   EXPECT_EQ(s.tot_cycles, 200u);   /* 500 - 300 spent in IRQ 0 */
+
+   EXPECT_EQ(irq_stats_max_nesting(), 3u);
+}
+
+TEST_F(irq_stats_test, out_of_range_irqs_ignored)
+{
+   struct irq_line_stats s;
+
+   irq_stats_push(1000);
+   {
+      irq_stats_push(1100);
+      irq_stats_pop(IRQ_STATS_MAX_IRQS, 1200);
+   }
+   irq_stats_pop(2, 1300);
+
+   irq_stats_spurious(-1);
+   irq_stats_spurious(IRQ_STATS_MAX_IRQS);
+
+   /* The untracked nested IRQ's time is still not charged to IRQ 2 */
+   irq_stats_get(2, &s);
+   EXPECT_EQ(s.count, 1u);
+   EXPECT_EQ(s.tot_cycles, 200u);
+}
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace testing;
+
+extern "C" {
+   #include <tilck/kernel/irqsoff.h>
+   #include <tilck/kernel/test/irqsoff.h>
+}
+
+class irqsoff_test : public Test {
+
+   void SetUp() override {
+      irqsoff_reset_stats(IRQSOFF_IRQS);
+      irqsoff_reset_stats(IRQSOFF_PREEMPT);
+   }
+
+   void TearDown() override {
+      irqsoff_reset_stats(IRQSOFF_IRQS);
+      irqsoff_reset_stats(IRQSOFF_PREEMPT);
+   }
+
+protected:
+
+   static void account(enum irqsoff_kind k, u64 cycles, ulong b, ulong e) {
+      struct irqsoff_site site = { cycles, b, e };
+      irqsoff_account(k, &site);
+   }
+};
+
+TEST(irqsoff, hist_bucket)
+{
+   EXPECT_EQ(irqsoff_hist_bucket(0), 0u);
+   EXPECT_EQ(irqsoff_hist_bucket(1), 0u);
+   EXPECT_EQ(irqsoff_hist_bucket(2), 1u);
+   EXPECT_EQ(irqsoff_hist_bucket(3), 1u);
+   EXPECT_EQ(irqsoff_hist_bucket(1024), 10u);
+   EXPECT_EQ(irqsoff_hist_bucket(2047), 10u);
+   EXPECT_EQ(irqsoff_hist_bucket(1ull << 31), 31u);
+
+   /* Everything beyond the last bucket is clamped into it */
+   EXPECT_EQ(irqsoff_hist_bucket(1ull << 40), IRQSOFF_HIST_BUCKETS - 1u);
+   EXPECT_EQ(irqsoff_hist_bucket(~0ull), IRQSOFF_HIST_BUCKETS - 1u);
+}
+
+TEST_F(irqsoff_test, summary_and_histogram)
+{
+   struct irqsoff_stats s;
+
+   account(IRQSOFF_IRQS, 100, 0x10, 0x20);
+   account(IRQSOFF_IRQS, 120, 0x10, 0x20);
+   account(IRQSOFF_IRQS, 5000, 0x30, 0x40);
+
+   irqsoff_get_stats(IRQSOFF_IRQS, &s);
+   EXPECT_EQ(s.count, 3u);
+   EXPECT_EQ(s.tot_cycles, 5220u);
+   EXPECT_EQ(s.max_cycles, 5000u);
+   EXPECT_EQ(s.hist[6], 2u);        /* 100, 120 in [64, 128) */
+   EXPECT_EQ(s.hist[12], 1u);       /* 5000 in [4096, 8192) */
+
+   /* The other kind is accounted separately */
+   irqsoff_get_stats(IRQSOFF_PREEMPT, &s);
+   EXPECT_EQ(s.count, 0u);
+
+   irqsoff_reset_stats(IRQSOFF_IRQS);
+   irqsoff_get_stats(IRQSOFF_IRQS, &s);
+   EXPECT_EQ(s.count, 0u);
+   EXPECT_EQ(s.hist[6], 0u);
+   EXPECT_EQ(s.top[0].cycles, 0u);
+}
+
+TEST_F(irqsoff_test, top_sorted_and_bounded)
+{
+   struct irqsoff_stats s;
+
+   /* Distinct sites, inserted in a scrambled order */
+   for (u32 i = 0; i < 3 * IRQSOFF_TOP_N; i++) {
+      const u64 c = 1000 + ((i * 7) % (3 * IRQSOFF_TOP_N)) * 10;
+      account(IRQSOFF_PREEMPT, c, 0x100 + i, 0x200 + i);
+   }
+
+   irqsoff_get_stats(IRQSOFF_PREEMPT, &s);
+   EXPECT_EQ(s.top[0].cycles, s.max_cycles);
+
+   for (u32 i = 1; i < IRQSOFF_TOP_N; i++)
+      EXPECT_GT(s.top[i - 1].cycles, s.top[i].cycles);
+
+   /* Only the longest IRQSOFF_TOP_N survived */
+   EXPECT_EQ(s.top[IRQSOFF_TOP_N - 1].cycles,
+             1000u + (2 * IRQSOFF_TOP_N) * 10u);
+}
+
+TEST_F(irqsoff_test, top_one_entry_per_site)
+{
+   struct irqsoff_stats s;
+
+   account(IRQSOFF_IRQS, 300, 0xa, 0xb);
+   account(IRQSOFF_IRQS, 200, 0xc, 0xd);
+   account(IRQSOFF_IRQS, 100, 0xa, 0xb);   /* shorter: ignored */
+
+   irqsoff_get_stats(IRQSOFF_IRQS, &s);
+   EXPECT_EQ(s.top[0].cycles, 300u);
+   EXPECT_EQ(s.top[1].cycles, 200u);
+   EXPECT_EQ(s.top[2].cycles, 0u);
+
+   /* A longer section from a known site replaces its entry, moving it up */
+   account(IRQSOFF_IRQS, 400, 0xc, 0xd);
+
+   irqsoff_get_stats(IRQSOFF_IRQS, &s);
+   EXPECT_EQ(s.top[0].cycles, 400u);
+   EXPECT_EQ(s.top[0].begin_ip, 0xcul);
+   EXPECT_EQ(s.top[0].end_ip, 0xdul);
+   EXPECT_EQ(s.top[1].cycles, 300u);
+   EXPECT_EQ(s.top[1].begin_ip, 0xaul);
+   EXPECT_EQ(s.top[2].cycles, 0u);
+}
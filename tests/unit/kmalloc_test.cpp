@@ -781,6 +781,103 @@ TEST_F(kmalloc_test, multi_step_free)
 }
 
 
+TEST_F(kmalloc_test, kmalloc_at)
+{
+   void *ptr;
+   size_t s;
+
+   struct kmalloc_heap h;
+   kmalloc_create_heap(&h,
+                       MB,                           /* vaddr */
+                       KMALLOC_MIN_HEAP_SIZE,        /* heap size */
+                       KMALLOC_MIN_HEAP_SIZE / 16,   /* min block size */
+                       KMALLOC_MIN_HEAP_SIZE / 8,    /* alloc block size */
+                       false,                        /* linear mapping */
+                       NULL,                         /* metadata_nodes */
+                       fake_alloc_and_map_func,
+                       fake_free_and_map_func);
+
+   struct block_node *nodes = (struct block_node *)h.metadata_nodes;
+   const size_t mbs = h.min_block_size;
+
+   /* A chunk not aligned at its size */
+   ptr = (void *)(h.vaddr + 3 * mbs);
+   ASSERT_TRUE(per_heap_kmalloc_at(&h, ptr, 3 * mbs, mbs));
+   EXPECT_EQ(h.mem_allocated, 3 * mbs);
+
+   /* Overlapping and out-of-heap chunks */
+   ptr = (void *)(h.vaddr + 5 * mbs);
+   EXPECT_FALSE(per_heap_kmalloc_at(&h, ptr, 2 * mbs, mbs));
+   ptr = (void *)(h.vaddr + 15 * mbs);
+   EXPECT_FALSE(per_heap_kmalloc_at(&h, ptr, 2 * mbs, mbs));
+   EXPECT_EQ(h.mem_allocated, 3 * mbs);
+
+   ASSERT_TRUE(per_heap_kmalloc_at(&h, (void *)h.vaddr, 3 * mbs, mbs));
+
+   dump_heap_subtree(&h, 0, 5);
+
+   check_metadata(nodes, {
+      "+---------------------------------------------------------------+",
+      "|                              -S-                              |",
+      "+-------------------------------+-------------------------------+",
+      "|              -S-              |              ---              |",
+      "+---------------+---------------+---------------+---------------+",
+      "|      -SF      |      -S-      |      ---      |      ---      |",
+      "+-------+-------+-------+-------+-------+-------+-------+-------+",
+      "|  ASF  |  ASF  |  ASF  |  ---  |  ---  |  ---  |  ---  |  ---  |",
+      "+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+",
+      "|--F|--F|--F|--F|--F|--F|---|---|---|---|---|---|---|---|---|---|",
+      "+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+"
+   });
+
+   /* The regular allocations get the first free block after the chunks */
+   s = 2 * mbs;
+   ptr = per_heap_kmalloc(&h, &s, 0);
+   EXPECT_EQ(ptr, (void *)(h.vaddr + 6 * mbs));
+
+   /* The two chunks can be freed together, also in parts */
+   s = mbs;
+   per_heap_kfree(&h, (void *)(h.vaddr + 4 * mbs), &s,
+                  KFREE_FL_ALLOW_SPLIT | KFREE_FL_MULTI_STEP);
+   EXPECT_EQ(h.mem_allocated, 7 * mbs);
+
+   s = 4 * mbs;
+   per_heap_kfree(&h, (void *)h.vaddr, &s,
+                  KFREE_FL_ALLOW_SPLIT | KFREE_FL_MULTI_STEP);
+
+   s = mbs;
+   per_heap_kfree(&h, (void *)(h.vaddr + 5 * mbs), &s,
+                  KFREE_FL_ALLOW_SPLIT | KFREE_FL_MULTI_STEP);
+
+   s = 2 * mbs;
+   per_heap_kfree(&h, ptr, &s, 0);
+
+   EXPECT_EQ(h.mem_allocated, 0U);
+   EXPECT_EQ(nodes[0].raw, 0);
+   kmalloc_destroy_heap(&h);
+}
+
+TEST_F(kmalloc_test, big_aligned_pages)
+{
+   const size_t size = 4 * MB;
+   char *ptr, *ptr2;
+
+   ptr = (char *)kmalloc_big_aligned_pages(size);
+   ASSERT_TRUE(ptr != NULL);
+   EXPECT_EQ((ulong)ptr & (size - 1), 0U);
+
+   /* The pages can be freed one by one, in any order */
+   for (size_t off = size; off > 0; off -= PAGE_SIZE)
+      kfree2(ptr + off - PAGE_SIZE, PAGE_SIZE);
+
+   /* Now the whole chunk is free again */
+   ptr2 = (char *)kmalloc_big_aligned_pages(size);
+   EXPECT_EQ(ptr2, ptr);
+
+   for (size_t off = 0; off < size; off += PAGE_SIZE)
+      kfree2(ptr2 + off, PAGE_SIZE);
+}
+
 TEST_F(kmalloc_test, partial_free)
 {
    void *ptr;
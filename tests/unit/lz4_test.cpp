@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+#include <cstring>
+#include <vector>
+#include <random>
+#include <gtest/gtest.h>
+
+extern "C" {
+   #include <tilck/common/basic_defs.h>
+   #include <tilck/common/lz4.h>
+}
+
+using namespace std;
+
+static vector<u8> compress(const vector<u8> &in)
+{
+   vector<u8> out(lz4_compress_bound((u32)in.size()));
+   int rc = lz4_compress(out.data(), (u32)out.size(), in.data(), (u32)in.size());
+
+   EXPECT_GT(rc, 0);
+   out.resize((size_t)rc);
+   return out;
+}
+
+static void check_round_trip(const vector<u8> &in)
+{
+   vector<u8> c = compress(in);
+   vector<u8> out(in.size() + 16);
+   int rc = lz4_decompress(out.data(), (u32)out.size(), c.data(), (u32)c.size());
+
+   ASSERT_EQ(rc, (int)in.size());
+   out.resize((size_t)rc);
+   ASSERT_EQ(out, in);
+}
+
+static vector<u8> gen_text_like(size_t n, u32 seed)
+{
+   static const char *words[] = {
+      "busybox", "/usr/bin/", "tilck", "\x7f" "ELF", "\0\0\0\0", "init",
+   };
+
+   mt19937 e(seed);
+   vector<u8> v;
+
+   while (v.size() < n) {
+      const char *w = words[e() % ARRAY_SIZE(words)];
+      const size_t len = w[0] ? strlen(w) : 4;
+      v.insert(v.end(), w, w + len);
+      v.push_back((u8)(e() % 4 ? ' ' : e()));
+   }
+
+   v.resize(n);
+   return v;
+}
+
+TEST(lz4, small_sizes)
+{
+   for (size_t n = 0; n < 40; n++) {
+
+      vector<u8> zeros(n, 0), seq(n);
+
+      for (size_t i = 0; i < n; i++)
+         seq[i] = (u8)i;
+
+      check_round_trip(zeros);
+      check_round_trip(seq);
+   }
+}
+
+TEST(lz4, zeros_compress_well)
+{
+   vector<u8> in(LZ4_RD_BLOCK_SIZE, 0);
+   vector<u8> c = compress(in);
+
+   ASSERT_LT(c.size(), in.size() / 100);
+   check_round_trip(in);
+}
+
+TEST(lz4, random_data)
+{
+   mt19937 e(1234);
+   vector<u8> in(LZ4_RD_BLOCK_SIZE);
+
+   for (auto &b : in)
+      b = (u8)e();
+
+   check_round_trip(in);
+}
+
+TEST(lz4, text_like_data)
+{
+   for (u32 seed = 0; seed < 8; seed++)
+      check_round_trip(gen_text_like(LZ4_RD_BLOCK_SIZE - seed * 1001, seed));
+}
+
+TEST(lz4, overlapping_matches)
+{
+   vector<u8> in;
+
+   for (int i = 0; i < 5000; i++)
+      in.push_back((u8)"abc"[i % 3]);
+
+   check_round_trip(in);
+}
+
+/* Page-sized inputs with a small caller-provided hash table, as ramfs does */
+TEST(lz4, small_hash_table)
+{
+   vector<u32> ht(1u << 10, 0xdeadbeef);
+   vector<u8> in = gen_text_like(4096, 3);
+   vector<u8> c(lz4_compress_bound((u32)in.size()));
+   vector<u8> out(in.size());
+   int rc;
+
+   rc = lz4_compress_ht(c.data(), (u32)c.size(),
+                        in.data(), (u32)in.size(), ht.data(), 10);
+
+   ASSERT_GT(rc, 0);
+   ASSERT_LT(rc, (int)in.size());
+
+   rc = lz4_decompress(out.data(), (u32)out.size(), c.data(), (u32)rc);
+   ASSERT_EQ(rc, (int)in.size());
+   ASSERT_EQ(out, in);
+
+   /* Too small an output buffer: the compressor must give up, not overflow */
+   vector<u8> rnd(4096);
+   mt19937 e(5);
+
+   for (auto &b : rnd)
+      b = (u8)e();
+
+   ASSERT_EQ(lz4_compress_ht(c.data(), 2048,
+                             rnd.data(), (u32)rnd.size(), ht.data(), 10), -1);
+}
+
+TEST(lz4, corrupted_input)
+{
+   vector<u8> in = gen_text_like(4096, 42);
+   vector<u8> c = compress(in);
+   vector<u8> out(in.size());
+
+   /*
+    * Truncated input: it might still be a valid block if cut right after some
+    * literals, but never one producing the whole output.
+    */
+   ASSERT_LT(lz4_decompress(out.data(), (u32)out.size(),
+                            c.data(), (u32)c.size() / 2), (int)in.size());
+
+   /* Output buffer too small */
+   ASSERT_EQ(lz4_decompress(out.data(), (u32)out.size() - 1,
+                            c.data(), (u32)c.size()), -1);
+
+   /* An offset pointing before the beginning of the output */
+   const u8 bad[] = { 0x10, 'a', 0x10, 0x00, 0x00 };
+   ASSERT_EQ(lz4_decompress(out.data(), (u32)out.size(), bad, sizeof(bad)), -1);
+
+   /* Zero offset */
+   const u8 bad2[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+   ASSERT_EQ(lz4_decompress(out.data(), (u32)out.size(), bad2, sizeof(bad2)), -1);
+}
+
+/*
+ * Build a compressed initrd stream like `fathack --compress` does and feed it
+ * to lz4_rd_feed() in small, irregular pieces, as the bootloaders do.
+ */
+TEST(lz4, rd_feed_streaming)
+{
+   const u32 raw_size = 5 * LZ4_RD_BLOCK_SIZE + 777;
+   vector<u8> raw = gen_text_like(raw_size, 7);
+   vector<u8> stream;
+   mt19937 e(99);
+
+   /* One incompressible block, to have a stored one */
+   for (u32 i = LZ4_RD_BLOCK_SIZE; i < 2 * LZ4_RD_BLOCK_SIZE; i++)
+      raw[i] = (u8)e();
+
+   for (u32 off = 0; off < raw_size; off += LZ4_RD_BLOCK_SIZE) {
+
+      const u32 len = MIN(raw_size - off, (u32)LZ4_RD_BLOCK_SIZE);
+      vector<u8> blk(len);
+      int rc = lz4_compress(blk.data(), len - 1, raw.data() + off, len);
+      u32 word;
+
+      if (rc > 0) {
+         word = (u32)rc;
+         blk.resize((size_t)rc);
+      } else {
+         word = len | LZ4_RD_BLK_STORED;
+         memcpy(blk.data(), raw.data() + off, len);
+      }
+
+      stream.insert(stream.end(), (u8 *)&word, (u8 *)&word + 4);
+      stream.insert(stream.end(), blk.begin(), blk.end());
+   }
+
+   /* Sector padding, to be ignored */
+   stream.resize(stream.size() + 300, 0xcc);
+
+   vector<u8> out(raw_size);
+   struct lz4_rd_ctx ctx = { out.data(), raw_size, 0 };
+   vector<u8> pending;
+   size_t pos = 0;
+
+   while (pos < stream.size()) {
+
+      const size_t n = MIN(stream.size() - pos, (size_t)(1 + e() % 50000));
+      pending.insert(pending.end(), &stream[pos], &stream[pos] + n);
+      pos += n;
+
+      int rc = lz4_rd_feed(&ctx, pending.data(), (u32)pending.size());
+      ASSERT_GE(rc, 0);
+      ASSERT_LE(pending.size() - (size_t)rc, (size_t)LZ4_RD_MAX_BLK_DISK_SZ);
+      pending.erase(pending.begin(), pending.begin() + rc);
+   }
+
+   ASSERT_EQ(ctx.out_pos, raw_size);
+   ASSERT_EQ(out, raw);
+}
+
+TEST(lz4, rd_feed_corrupted)
+{
+   vector<u8> out(LZ4_RD_BLOCK_SIZE);
+   struct lz4_rd_ctx ctx = { out.data(), (u32)out.size(), 0 };
+
+   /* Block size bigger than LZ4_RD_BLOCK_SIZE */
+   const u32 w1 = LZ4_RD_BLOCK_SIZE + 1;
+   ASSERT_EQ(lz4_rd_feed(&ctx, &w1, sizeof(w1)), -1);
+
+   /* A stored block shorter than the expected output */
+   u8 buf[8] = { 4, 0, 0, 0x80, 1, 2, 3, 4 };
+   ASSERT_EQ(lz4_rd_feed(&ctx, buf, sizeof(buf)), -1);
+
+   /* Incomplete block: nothing consumed */
+   const u32 w2 = 100;
+   ASSERT_EQ(lz4_rd_feed(&ctx, &w2, sizeof(w2)), 0);
+}
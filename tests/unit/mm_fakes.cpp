@@ -95,9 +95,10 @@ map_pages(pdir_t *pdir,
    return page_count;
 }
 
-void unmap_page(pdir_t *, void *vaddrp, bool free_pageframe)
+int unmap_page(pdir_t *, void *vaddrp, bool free_pageframe)
 {
    mappings[(ulong)vaddrp] = INVALID_PADDR;
+   return 0;
 }
 
 int unmap_page_permissive(pdir_t *, void *vaddrp, bool free_pageframe)
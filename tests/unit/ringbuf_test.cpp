@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <vector>
 #include <gtest/gtest.h>
@@ -248,3 +249,58 @@ TEST(ringbuf, read_write_bytes)
    ASSERT_TRUE(ringbuf_is_empty(&rb));
    ringbuf_destory(&rb);
 }
+
+TEST(ringbuf, read_write_chunks)
+{
+   struct ringbuf rb;
+   char buffer[9] = "--------";
+   u8 *ptr;
+   size_t len;
+
+   ringbuf_init(&rb, 8, 1, buffer);
+
+   len = ringbuf_get_read_chunk(&rb, &ptr);
+   ASSERT_EQ(len, 0U);
+
+   len = ringbuf_get_write_chunk(&rb, &ptr);
+   ASSERT_EQ(len, 8U);
+   ASSERT_EQ((char *)ptr, buffer);
+
+   memcpy(ptr, "123456", 6);
+   ringbuf_commit_bytes(&rb, 6);
+   ASSERT_EQ(ringbuf_get_elems(&rb), 6U);
+
+   len = ringbuf_get_read_chunk(&rb, &ptr);
+   ASSERT_EQ(len, 6U);
+   ASSERT_EQ(memcmp(ptr, "1234", 4), 0);
+   ringbuf_consume_bytes(&rb, 4);
+
+   /* The free space wraps around: the write chunk ends at the buffer's end */
+   len = ringbuf_get_write_chunk(&rb, &ptr);
+   ASSERT_EQ(len, 2U);
+   memcpy(ptr, "78", 2);
+   ringbuf_commit_bytes(&rb, 2);
+
+   len = ringbuf_get_write_chunk(&rb, &ptr);
+   ASSERT_EQ(len, 4U);
+   ASSERT_EQ((char *)ptr, buffer);
+   memcpy(ptr, "9abc", 4);
+   ringbuf_commit_bytes(&rb, 4);
+
+   ASSERT_TRUE(ringbuf_is_full(&rb));
+   ASSERT_EQ(ringbuf_get_write_chunk(&rb, &ptr), 0U);
+   ASSERT_STREQ(buffer, "9abc5678");
+
+   len = ringbuf_get_read_chunk(&rb, &ptr);
+   ASSERT_EQ(len, 4U);
+   ASSERT_EQ(memcmp(ptr, "5678", 4), 0);
+   ringbuf_consume_bytes(&rb, 4);
+
+   len = ringbuf_get_read_chunk(&rb, &ptr);
+   ASSERT_EQ(len, 4U);
+   ASSERT_EQ(memcmp(ptr, "9abc", 4), 0);
+   ringbuf_consume_bytes(&rb, 4);
+
+   ASSERT_TRUE(ringbuf_is_empty(&rb));
+   ringbuf_destory(&rb);
+}
@@ -32,6 +32,7 @@ extern "C" {
    #include <tilck/kernel/sched.h>
    #include <tilck/kernel/process_int.h>
    #include <tilck/kernel/test/sched.h>
+   #include "kernel/sched_int.h" // private header
 }
 
 using namespace std;
@@ -108,6 +109,7 @@ protected:
       atomic_store(&idle_task->state, TASK_STATE_RUNNING);
 
       for (struct task *t : tasks) {
+         sched_rt_release(t);   /* no-op for non-RT tasks */
          enum task_state s = (enum task_state)atomic_load(&t->state);
          if (s != TASK_STATE_ZOMBIE)
             task_change_state(t, TASK_STATE_ZOMBIE);
@@ -1094,3 +1096,263 @@ TEST_F(scheduler_fairness_test, fresh_fork_does_not_leapfrog)
       << "fresh-fork workload had excessive ineligible picks "
          "(got " << r.ineligible_picks << ")";
 }
+
+
+/* =====================================================================
+ *                  Category 6: RT class (CBS + EDF)
+ * ===================================================================== */
+
+/*
+ * Fire `ti`'s replenishment timer by hand, as tick_all_timers() would
+ * at the period boundary (the test build never advances the ticks).
+ */
+static void fire_rt_replenish(struct task *ti)
+{
+   struct ktimer *t = &ti->rt->repl_timer;
+   ulong var;
+
+   disable_interrupts(&var);
+   t->fire(t, t->ctx);
+   enable_interrupts(&var);
+}
+
+TEST_F(scheduler_test, rt_class_dormant_when_nothing_admitted)
+{
+   make_task_at(0);
+
+   EXPECT_EQ(atomic_load(&rt_admitted_count), 0);
+   EXPECT_EQ(rt_sum_util_x1k, 0u);
+   EXPECT_EQ(sched_rt_pick_task(idle_task, TASK_STATE_RUNNING), nullptr);
+}
+
+TEST_F(scheduler_test, rt_admit_rejects_invalid_reservations)
+{
+   struct task *t = make_task_at(0);
+
+   EXPECT_EQ(sched_rt_admit(t, 0, 10), -EINVAL);
+   EXPECT_EQ(sched_rt_admit(t, 11, 10), -EINVAL);
+   EXPECT_FALSE(is_rt_task(t));
+   EXPECT_EQ(atomic_load(&rt_admitted_count), 0);
+}
+
+TEST_F(scheduler_test, rt_admission_enforces_bandwidth_cap)
+{
+   if (!KRN_RT_BANDWIDTH_PCT)
+      GTEST_SKIP() << "RT class disabled (KRN_RT_BANDWIDTH_PCT=0)";
+
+   struct task *a = make_task_at(0);
+   struct task *b = make_task_at(0);
+
+   /* `a` takes the whole RT bandwidth: nothing else fits */
+   ASSERT_EQ(sched_rt_admit(a, KRN_RT_BANDWIDTH_PCT, 100), 0);
+   EXPECT_EQ(rt_sum_util_x1k, (u32)KRN_RT_BANDWIDTH_PCT * 10);
+   EXPECT_EQ(sched_rt_admit(b, 1, 100), -EBUSY);
+   EXPECT_FALSE(is_rt_task(b));
+
+   /* Shrinking `a`'s own reservation is accounted as a replacement */
+   ASSERT_EQ(sched_rt_admit(a, 1, 100), 0);
+   EXPECT_EQ(rt_sum_util_x1k, 10u);
+   EXPECT_EQ(sched_rt_admit(b, 1, 100), 0);
+   EXPECT_EQ(atomic_load(&rt_admitted_count), 2);
+
+   sched_rt_release(a);
+   sched_rt_release(b);
+   EXPECT_EQ(rt_sum_util_x1k, 0u);
+   EXPECT_EQ(atomic_load(&rt_admitted_count), 0);
+}
+
+TEST_F(scheduler_test, rt_edf_picks_earliest_deadline_over_eevdf)
+{
+   struct task *eevdf = make_task_at(0);
+   struct task *slow = make_task_at(100);
+   struct task *fast = make_task_at(100);
+
+   ASSERT_EQ(sched_rt_admit(slow, 1, 20), 0);
+   ASSERT_EQ(sched_rt_admit(fast, 1, 10), 0);
+
+   /* RT tasks left the EEVDF tree: only `eevdf` is there now */
+   EXPECT_EQ(sched_do_select_runnable_task(TASK_STATE_RUNNING, true), eevdf);
+   EXPECT_EQ(sched_rt_pick_task(idle_task, TASK_STATE_RUNNING), fast);
+
+   /* An RT curr keeps the CPU against later deadlines only */
+   switch_curr_to(slow);
+   EXPECT_EQ(sched_rt_pick_task(slow, TASK_STATE_RUNNING), fast);
+   switch_curr_to(fast);
+   EXPECT_EQ(sched_rt_pick_task(fast, TASK_STATE_RUNNING), fast);
+}
+
+TEST_F(scheduler_test, rt_budget_exhaustion_throttles_until_replenish)
+{
+   struct task *t = make_task_at(0);
+
+   ASSERT_EQ(sched_rt_admit(t, 2, 10), 0);
+   switch_curr_to(t);
+
+   const u64 vruntime = atomic_load(&t->ticks.vruntime);
+   const u64 deadline = t->rt->deadline;
+
+   sched_account_ticks();
+   EXPECT_EQ(t->rt->budget, 1u);
+   EXPECT_FALSE(t->rt->throttled);
+   EXPECT_FALSE(need_reschedule());
+
+   sched_account_ticks();
+   EXPECT_EQ(t->rt->budget, 0u);
+   EXPECT_TRUE(t->rt->throttled);
+   EXPECT_EQ(t->rt->throttle_count, 1u);
+   EXPECT_TRUE(need_reschedule());
+
+   /* CBS time is not EEVDF time */
+   EXPECT_EQ(atomic_load(&t->ticks.vruntime), vruntime);
+
+   /* Throttled: neither the RT nor the EEVDF selector keep it */
+   EXPECT_EQ(sched_rt_pick_task(t, TASK_STATE_RUNNING), nullptr);
+   EXPECT_EQ(sched_do_select_runnable_task(TASK_STATE_RUNNING, false),
+             nullptr);
+
+   /* Preempted while throttled: RUNNABLE but out of the ready set */
+   switch_curr_to(idle_task);
+   EXPECT_EQ(sched_rt_pick_task(idle_task, TASK_STATE_RUNNING), nullptr);
+
+   fire_rt_replenish(t);
+   EXPECT_FALSE(t->rt->throttled);
+   EXPECT_EQ(t->rt->budget, 2u);
+   EXPECT_EQ(t->rt->deadline, deadline + 10);
+   EXPECT_EQ(t->rt->deadline_misses, 0u);
+   EXPECT_EQ(sched_rt_pick_task(idle_task, TASK_STATE_RUNNING), t);
+}
+
+TEST_F(scheduler_test, rt_replenish_counts_pending_job_as_deadline_miss)
+{
+   struct task *t = make_task_at(0);
+
+   ASSERT_EQ(sched_rt_admit(t, 5, 10), 0);
+
+   /* Still RUNNABLE, with budget left, at the period boundary */
+   fire_rt_replenish(t);
+   EXPECT_EQ(t->rt->deadline_misses, 1u);
+   EXPECT_EQ(sched_rt_pick_task(idle_task, TASK_STATE_RUNNING), t);
+}
+
+TEST_F(scheduler_test, rt_release_returns_task_to_eevdf)
+{
+   struct task *t = make_task_at(0);
+
+   ASSERT_EQ(sched_rt_admit(t, 1, 10), 0);
+   EXPECT_EQ(sched_do_select_runnable_task(TASK_STATE_SLEEPING, true),
+             nullptr);
+
+   sched_rt_release(t);
+   EXPECT_FALSE(is_rt_task(t));
+   EXPECT_EQ(t->rt, nullptr);
+   EXPECT_EQ(atomic_load(&t->ticks.vruntime), atomic_load(&min_vruntime));
+   EXPECT_EQ(sched_rt_pick_task(idle_task, TASK_STATE_RUNNING), nullptr);
+   EXPECT_EQ(sched_do_select_runnable_task(TASK_STATE_SLEEPING, true), t);
+}
+
+/* =====================================================================
+ *              Category 7: scheduling-latency statistics
+ * ===================================================================== */
+
+static struct sched_lat_stats get_lat_stats(int tid)
+{
+   struct sched_lat_stats s;
+   EXPECT_TRUE(sched_stats_get(tid, &s));
+   return s;
+}
+
+static u32 hist_sum(const u32 *hist, int n)
+{
+   u32 sum = 0;
+
+   for (int i = 0; i < n; i++)
+      sum += hist[i];
+
+   return sum;
+}
+
+TEST(sched_stats, hist_buckets)
+{
+   EXPECT_EQ(sched_lat_hist_bucket(0), 0u);
+   EXPECT_EQ(sched_lat_hist_bucket(1), 0u);
+   EXPECT_EQ(sched_lat_hist_bucket(1000), 9u);
+   EXPECT_EQ(sched_lat_hist_bucket(1ull << 31), 31u);
+   EXPECT_EQ(sched_lat_hist_bucket(1ull << 40),
+             SCHED_LAT_HIST_BUCKETS - 1u);
+
+   EXPECT_EQ(sched_rq_hist_bucket(0), 0u);
+   EXPECT_EQ(sched_rq_hist_bucket(1), 1u);
+   EXPECT_EQ(sched_rq_hist_bucket(2), 2u);
+   EXPECT_EQ(sched_rq_hist_bucket(3), 2u);
+   EXPECT_EQ(sched_rq_hist_bucket(4), 3u);
+   EXPECT_EQ(sched_rq_hist_bucket(1000), SCHED_RQ_HIST_BUCKETS - 1u);
+}
+
+TEST_F(scheduler_test, lat_stats_count_wakeups_not_preemptions)
+{
+   sched_stats_reset();
+
+   /* make_task_at() wakes each task: SLEEPING -> RUNNABLE */
+   struct task *a = make_task_at(0);
+   struct task *b = make_task_at(10);
+
+   EXPECT_EQ(get_lat_stats(a->tid).rq_hist[0], 1u);   /* empty runqueue */
+   EXPECT_EQ(get_lat_stats(b->tid).rq_hist[1], 1u);   /* `a` ahead */
+   EXPECT_EQ(get_lat_stats(0).wakeups, 0u);           /* none ran yet */
+
+   switch_curr_to(a);
+   EXPECT_EQ(get_lat_stats(a->tid).wakeups, 1u);
+
+   /* `a` is preempted: RUNNING -> RUNNABLE is not a wakeup */
+   switch_curr_to(b);
+   switch_curr_to(a);
+
+   struct sched_lat_stats sa = get_lat_stats(a->tid);
+   EXPECT_EQ(sa.wakeups, 1u);
+   EXPECT_EQ(hist_sum(sa.rq_hist, SCHED_RQ_HIST_BUCKETS), 1u);
+   EXPECT_EQ(hist_sum(sa.lat_hist, SCHED_LAT_HIST_BUCKETS), 1u);
+
+   struct sched_lat_stats g = get_lat_stats(0);
+   EXPECT_EQ(g.wakeups, 2u);
+   EXPECT_EQ(hist_sum(g.lat_hist, SCHED_LAT_HIST_BUCKETS), 2u);
+   EXPECT_GE(g.max_cycles, sa.max_cycles);
+
+   /* A wakeup followed by a sleep before running is not accounted */
+   task_change_state(b, TASK_STATE_SLEEPING);
+   task_change_state(b, TASK_STATE_RUNNABLE);
+   task_change_state(b, TASK_STATE_SLEEPING);
+   task_change_state(b, TASK_STATE_RUNNABLE);
+   switch_curr_to(b);
+   EXPECT_EQ(get_lat_stats(b->tid).wakeups, 2u);
+}
+
+TEST_F(scheduler_test, lat_stats_voluntary_vs_involuntary_switches)
+{
+   struct task *a = make_task_at(0);
+   struct task *b = make_task_at(10);
+
+   sched_stats_reset();
+   switch_curr_to(a);
+
+   /* Outgoing task still RUNNABLE: involuntary */
+   task_change_state(a, TASK_STATE_RUNNABLE);
+   sched_stats_on_switch(a, b);
+   switch_curr_to(b);
+
+   /* Outgoing task blocked: voluntary */
+   task_change_state(b, TASK_STATE_SLEEPING);
+   sched_stats_on_switch(b, a);
+
+   /* Not a switch at all */
+   sched_stats_on_switch(a, a);
+
+   EXPECT_EQ(get_lat_stats(a->tid).nivcsw, 1u);
+   EXPECT_EQ(get_lat_stats(a->tid).nvcsw, 0u);
+   EXPECT_EQ(get_lat_stats(b->tid).nvcsw, 1u);
+   EXPECT_EQ(get_lat_stats(0).nivcsw, 1u);
+   EXPECT_EQ(get_lat_stats(0).nvcsw, 1u);
+
+   sched_stats_reset();
+   EXPECT_EQ(get_lat_stats(a->tid).nivcsw, 0u);
+   EXPECT_EQ(get_lat_stats(0).nvcsw, 0u);
+}
@@ -11,6 +11,7 @@ extern "C" {
    #include <tilck/common/page_size.h>
    #include <tilck/kernel/user.h>
    #include <tilck/kernel/sched.h>
+   #include <tilck/kernel/process.h>
 
    /*
     * copy_str_from_user() is gmock-wrapped in this build, so call the real one
@@ -39,6 +40,7 @@ protected:
    void *saved_base_va;
    struct task *saved_current;
    struct task tsk;
+   struct process proc;
 
    /* Aligned scratch: a user argv in `ubuf`, the kernel output in `dbuf`. */
    alignas(void *) char ubuf[512];
@@ -50,6 +52,8 @@ protected:
 
       base_va = (void *)(1ul << 60);    /* every real address is "user" */
       memset(&tsk, 0, sizeof(tsk));     /* user_access_fixup == NULL */
+      memset(&proc, 0, sizeof(proc));   /* mi == NULL: no PROT_NONE pages */
+      tsk.pi = &proc;
       __current = &tsk;
       set_user_copy_fault(0, 0, -1);    /* no fault by default */
    }
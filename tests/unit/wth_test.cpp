@@ -72,7 +72,7 @@ TEST_F(worker_thread_test, essential)
 TEST_F(worker_thread_test, base)
 {
    struct worker_thread *wth = wth_find_worker(WTH_PRIO_HIGHEST);
-   const int max_jobs = wth_get_queue_size(wth);
+   const int max_jobs = wth_get_queue_size(wth) + WTH_OVF_POOL_SIZE;
    bool res;
 
    for (int i = 0; i < max_jobs; i++) {
@@ -82,8 +82,9 @@ TEST_F(worker_thread_test, base)
 
    res = wth_enqueue_on(wth, &simple_func1, TO_PTR(1234));
 
-   // There is no more space left, expecting the ADD failed.
+   // No more space left in the ring nor in the overflow pool: ADD failed.
    ASSERT_FALSE(res);
+   ASSERT_EQ(wth->stats.dropped, 1u);
 
    for (int i = 0; i < max_jobs; i++) {
       ASSERT_NO_FATAL_FAILURE({ res = wth_process_single_job(wth); });
@@ -150,7 +151,6 @@ TEST_F(worker_thread_test, advanced)
 TEST_F(worker_thread_test, chaos)
 {
    struct worker_thread *wth = wth_find_worker(WTH_PRIO_HIGHEST);
-   const int max_jobs = wth_get_queue_size(wth);
 
    random_device rdev;
    default_random_engine e(rdev());
@@ -167,13 +167,14 @@ TEST_F(worker_thread_test, chaos)
 
       for (int i = 0; i < c; i++) {
 
-         if (slots_used == max_jobs) {
-            ASSERT_FALSE(wth_enqueue_on(wth, &simple_func1, TO_PTR(1234)));
+         res = wth_enqueue_on(wth, &simple_func1, TO_PTR(1234));
+
+         if (!res) {
+            // Jobs are dropped only when the overflow pool is exhausted
+            ASSERT_EQ(wth->ovf_count, (u32)WTH_OVF_POOL_SIZE);
             break;
          }
 
-         res = wth_enqueue_on(wth, &simple_func1, TO_PTR(1234));
-         ASSERT_TRUE(res);
          slots_used++;
       }
 
@@ -193,3 +194,70 @@ TEST_F(worker_thread_test, chaos)
       }
    }
 }
+
+static vector<int> run_order;
+
+static void record_func(void *arg)
+{
+   run_order.push_back((int)(ulong)arg);
+}
+
+TEST_F(worker_thread_test, overflow_keeps_order_and_grows)
+{
+   struct worker_thread *wth = wth_find_worker(WTH_PRIO_HIGHEST);
+   const int queue_size = wth_get_queue_size(wth);
+   const int n = queue_size + 10;
+
+   run_order.clear();
+
+   for (int i = 0; i < n; i++)
+      ASSERT_TRUE(wth_enqueue_on(wth, &record_func, TO_PTR(i)));
+
+   ASSERT_EQ(wth->ovf_count, 10u);
+   ASSERT_EQ(wth->stats.overflowed, 10u);
+   ASSERT_EQ(wth->stats.max_depth, (u32)n);
+
+   // Consume a part of the ring: new jobs must still go after the overflow
+   for (int i = 0; i < 5; i++)
+      ASSERT_TRUE(wth_process_single_job(wth));
+
+   for (int i = n; i < n + 3; i++)
+      ASSERT_TRUE(wth_enqueue_on(wth, &record_func, TO_PTR(i)));
+
+   while (wth_process_single_job(wth)) { }
+
+   ASSERT_EQ(run_order.size(), (size_t)n + 3);
+
+   for (int i = 0; i < n + 3; i++)
+      ASSERT_EQ(run_order[i], i);
+
+   // Once the ring got empty, the worker enlarged it
+   ASSERT_EQ(wth->stats.grows, 1u);
+   ASSERT_EQ(wth_get_queue_size(wth), (u32)queue_size * 2);
+   ASSERT_EQ(wth->ovf_count, 0u);
+   ASSERT_EQ(wth->stats.run, (u32)n + 3);
+}
+
+TEST_F(worker_thread_test, coalesce)
+{
+   struct worker_thread *wth = wth_find_worker(WTH_PRIO_HIGHEST);
+
+   run_order.clear();
+
+   ASSERT_TRUE(wth_enqueue_once_on(wth, &record_func, TO_PTR(1)));
+   ASSERT_TRUE(wth_enqueue_once_on(wth, &record_func, TO_PTR(2)));
+   ASSERT_TRUE(wth_enqueue_once_on(wth, &record_func, TO_PTR(1)));
+   ASSERT_EQ(wth->stats.coalesced, 1u);
+
+   ASSERT_TRUE(wth_process_single_job(wth));
+
+   // The job with arg 1 already started: not pending anymore
+   ASSERT_TRUE(wth_enqueue_once_on(wth, &record_func, TO_PTR(1)));
+   ASSERT_TRUE(wth_enqueue_once_on(wth, &record_func, TO_PTR(2)));
+   ASSERT_EQ(wth->stats.coalesced, 2u);
+
+   while (wth_process_single_job(wth)) { }
+
+   ASSERT_EQ(run_order, vector<int>({1, 2, 1}));
+   ASSERT_EQ(wth->stats.enqueued, 3u);
+}
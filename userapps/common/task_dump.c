@@ -70,7 +70,8 @@ const char *task_dump_str(enum task_dump_str_t t)
    static char fmt[120];
    static char hfmt[120];
    static char header[120];
-   static char hline_sep[120] = "qqqqqqqnqqqqqqnqqqqqqnqqqqqqnqqqqqnqqqqqn";
+   static char hline_sep[120] =
+      "qqqqqqqnqqqqqqnqqqqqqnqqqqqqnqqqqqnqqqqqnqqqqqqqqn";
 
    if (!initialized) {
 
@@ -85,6 +86,7 @@ const char *task_dump_str(enum task_dump_str_t t)
                TERM_VLINE " %%-4d "
                TERM_VLINE " %%-3s "
                TERM_VLINE "  %%-2d "
+               TERM_VLINE " %%-6u "
                TERM_VLINE " %%-%ds",
                path_field_len);
 
@@ -95,11 +97,13 @@ const char *task_dump_str(enum task_dump_str_t t)
                TERM_VLINE " %%-4s "
                TERM_VLINE " %%-3s "
                TERM_VLINE " %%-3s "
+               TERM_VLINE " %%-6s "
                TERM_VLINE " %%-%ds",
                path_field_len);
 
       snprintf(header, sizeof(header), hfmt,
-               "pid", "pgid", "sid", "ppid", "S", "tty", "cmdline");
+               "pid", "pgid", "sid", "ppid", "S", "tty", "rss(K)",
+               "cmdline");
 
       p = hline_sep + strlen(hline_sep);
       end = hline_sep + sizeof(hline_sep);
@@ -155,7 +159,7 @@ render_task_row_plain(const struct dp_task_info *t, bool kernel_tasks)
    const int ttynum = t->is_kthread ? 0 : t->tty;
 
    term_write(fmt, t->tid, t->pgid, t->sid, t->parent_pid,
-                state_str, ttynum, path);
+                state_str, ttynum, t->rss_pages * 4, path);
    term_write("\r\n");
 }
 
@@ -24,7 +24,7 @@
 #include <tilck/common/dp_abi.h>
 
 #define MAX_DP_TASKS         512
-#define MAX_EXEC_PATH_LEN     34
+#define MAX_EXEC_PATH_LEN     25
 
 /*
  * Task state bytes stored in dp_task_info.state — values from
@@ -106,7 +106,7 @@ static void dp_exit(void)
 }
 
 static void
-dp_write_header(int i, const char *s, bool selected)
+dp_write_header(int i, const char *s, bool selected, bool compact)
 {
    if (selected) {
 
@@ -115,21 +115,42 @@ dp_write_header(int i, const char *s, bool selected)
          i, s
       );
 
+   } else if (compact) {
+
+      term_write("%d" RESET_ATTRS " ", i);
+
    } else {
 
       term_write("%d[%s]" RESET_ATTRS " ", i, s);
    }
 }
 
+/*
+ * Width of the tabs row, rendered as "N[Label] " for each screen. When that
+ * doesn't fit the panel's inner width, paint_chrome() falls back to showing
+ * the label of the selected tab only.
+ */
+static int tabs_row_width(void)
+{
+   struct dp_screen *p;
+   int w = 0;
+
+   for (p = dp_screens_head; p; p = p->next)
+      w += (int)strlen(p->label) + 4;
+
+   return w;
+}
+
 static void paint_chrome(void)
 {
    struct dp_screen *p;
+   const bool compact = tabs_row_width() > DP_W - 4;
 
    term_clear();
    term_move_cursor(tui_start_row + 1, tui_start_col + 2);
 
    for (p = dp_screens_head; p; p = p->next)
-      dp_write_header(p->index + 1, p->label, p == dp_ctx);
+      dp_write_header((p->index + 1) % 10, p->label, p == dp_ctx, compact);
 
    /*
     * No "q[Quit]" tab in the header: adding the Runtime screen pushed
@@ -228,7 +249,8 @@ dp_main_handle_keypress(struct key_event ke)
 
    if ('0' <= ke.print_char && ke.print_char <= '9') {
 
-      idx = ke.print_char - '0' - 1;
+      /* '1' .. '9' select the screens 0 .. 8, '0' the screen 9 */
+      idx = (ke.print_char - '0' + 9) % 10;
 
       for (p = dp_screens_head; p; p = p->next) {
 
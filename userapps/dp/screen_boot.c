@@ -0,0 +1,168 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Boot panel: the boot-time profile recorded by kernel/boot_trace.c, i.e.
+ * the time spent in each bootloader stage, kernel init stage and module
+ * init, computed as the difference between consecutive TSC timestamps.
+ * Driven by TILCK_CMD_DP_GET_BOOT_TRACE. The conversion to microseconds
+ * needs the TSC frequency, which the kernel measures against the system
+ * time during the first second after boot.
+ *
+ * Keys: 'r' refresh the snapshot.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <tilck/common/syscalls.h>
+#include <tilck/common/dp_abi.h>
+
+#include "term.h"
+#include "tui_layout.h"
+#include "dp_int.h"
+#include "dp_panel.h"
+
+static struct dp_boot_trace trace;
+static int got_data;
+static int load_errno;
+static int row;
+
+static const char *const src_names[] = {
+   [DP_BOOT_TRACE_BOOTLOADER] = "bl",
+   [DP_BOOT_TRACE_KERNEL]     = "krn",
+   [DP_BOOT_TRACE_MODULE]     = "mod",
+};
+
+static long dp_cmd_get_boot_trace(struct dp_boot_trace *out)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_GET_BOOT_TRACE,
+                  (long)out, 0L, 0L, 0L);
+}
+
+static void load_trace(void)
+{
+   if (dp_cmd_get_boot_trace(&trace) < 0) {
+      got_data = 0;
+      load_errno = errno;
+      return;
+   }
+
+   got_data = 1;
+}
+
+static void dp_boot_on_enter(void)
+{
+   load_trace();
+}
+
+static enum dp_kb_handler_action
+dp_boot_keypress(struct key_event ke)
+{
+   if (ke.print_char != 'r')
+      return dp_kb_handler_nak;
+
+   load_trace();
+   ui_need_update = true;
+   return dp_kb_handler_ok_and_continue;
+}
+
+static void fmt_us(char *buf, size_t sz, u64 cycles)
+{
+   if (trace.tsc_khz)
+      snprintf(buf, sz, "%llu",
+               (unsigned long long)(cycles * 1000 / trace.tsc_khz));
+   else
+      snprintf(buf, sz, "-");
+}
+
+static void show_summary(void)
+{
+   u64 tot[ARRAY_SIZE(src_names)] = {0};
+   char bl[24], krn[24], mod[24], all[24];
+
+   for (u32 i = 1; i < trace.count; i++) {
+
+      const struct dp_boot_trace_entry *e = &trace.entries[i];
+
+      if (e->src < ARRAY_SIZE(tot))
+         tot[e->src] += e->tsc - e[-1].tsc;
+   }
+
+   fmt_us(bl, sizeof(bl), tot[DP_BOOT_TRACE_BOOTLOADER]);
+   fmt_us(krn, sizeof(krn), tot[DP_BOOT_TRACE_KERNEL]);
+   fmt_us(mod, sizeof(mod), tot[DP_BOOT_TRACE_MODULE]);
+   fmt_us(all, sizeof(all),
+          tot[DP_BOOT_TRACE_BOOTLOADER] +
+          tot[DP_BOOT_TRACE_KERNEL] +
+          tot[DP_BOOT_TRACE_MODULE]);
+
+   if (trace.tsc_khz)
+      dp_writeln("TSC: %u kHz", trace.tsc_khz);
+   else
+      dp_writeln("TSC: frequency not measured yet (us not available)");
+
+   dp_writeln(" ");
+   dp_writeln("Bootloader: %s us   Kernel: %s us   Modules: %s us   "
+              "Total: %s us", bl, krn, mod, all);
+   dp_writeln(" ");
+}
+
+static void show_table(void)
+{
+   char us[24];
+
+   dp_writeln(" Src  Stage                               Cycles          us");
+   dp_writeln(
+      GFX_ON
+      "qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq"
+      GFX_OFF
+   );
+
+   for (u32 i = 0; i < trace.count; i++) {
+
+      const struct dp_boot_trace_entry *e = &trace.entries[i];
+      const u64 delta = i ? e->tsc - trace.entries[i-1].tsc : 0;
+
+      fmt_us(us, sizeof(us), delta);
+
+      dp_writeln(" %-4s %-28s %14llu %11s",
+                 e->src < ARRAY_SIZE(src_names) ? src_names[e->src] : "?",
+                 e->name, (unsigned long long)delta, us);
+   }
+}
+
+static void dp_show_boot(void)
+{
+   row = tui_screen_start_row;
+
+   dp_writeln(E_COLOR_BR_WHITE "r" RESET_ATTRS ": refresh");
+   dp_writeln(" ");
+
+   if (!got_data) {
+      dp_writeln(E_COLOR_BR_RED
+                 "TILCK_CMD_DP_GET_BOOT_TRACE failed (errno=%d)"
+                 RESET_ATTRS, load_errno);
+      return;
+   }
+
+   show_summary();
+   show_table();
+}
+
+static struct dp_screen dp_boot_screen = {
+   .index = 9,
+   .label = "Boot",
+   .draw_func = dp_show_boot,
+   .on_dp_enter = dp_boot_on_enter,
+   .on_keypress_func = dp_boot_keypress,
+};
+
+__attribute__((constructor))
+static void dp_boot_register(void)
+{
+   dp_register_screen(&dp_boot_screen);
+}
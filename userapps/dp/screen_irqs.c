@@ -6,8 +6,17 @@
  * IRQ count + rate, unhandled IRQ table, unmasked legacy IRQ list),
  * but driven by a TILCK_CMD_DP_GET_IRQ_STATS snapshot instead of
  * direct kernel-symbol access.
+ *
+ * On top of that, a top-like view of the time spent in the IRQ handlers
+ * (kernel/irq_stats.c) and in the bottom halves run by the worker threads,
+ * sorted by the CPU share in the last interval: rates and loads are the
+ * deltas between the last two snapshots (since boot, for the first one).
+ * Below, the handler duration histogram of the selected IRQ.
+ *
+ * Keys: UP/DOWN select the IRQ, 'r' refresh, 'c' clear the stats.
  */
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
@@ -18,12 +27,18 @@
 #include <tilck/common/dp_abi.h>
 
 #include "term.h"
+#include "tui_input.h"
 #include "tui_layout.h"
 #include "dp_int.h"
 #include "dp_panel.h"
 
+#define HIST_BAR_W   32
+
 static struct dp_irq_stats stats;
+static struct dp_irq_stats prev;        /* previous snapshot, for the rates */
 static int got_stats;
+static int load_errno;
+static int sel_irq = -1;
 static int row;
 
 /*
@@ -33,11 +48,11 @@ static int row;
  */
 static ulong timer_hz;
 
-static long dp_cmd_get_irqs(struct dp_irq_stats *out)
+static long dp_cmd_get_irqs(struct dp_irq_stats *out, ulong flags)
 {
    return syscall(TILCK_CMD_SYSCALL,
                   TILCK_CMD_DP_GET_IRQ_STATS,
-                  (long)out, 0L, 0L, 0L);
+                  (long)out, (long)flags, 0L, 0L);
 }
 
 static ulong read_ulong_from(const char *path, ulong fallback)
@@ -69,9 +84,270 @@ static void dp_irqs_first_setup(void)
    timer_hz = read_ulong_from("/syst/kernel/timer_hz", 250);
 }
 
+static void load_stats(ulong flags)
+{
+   prev = stats;
+
+   if (dp_cmd_get_irqs(&stats, flags) < 0) {
+      got_stats = 0;
+      load_errno = errno;
+      return;
+   }
+
+   if (!got_stats) {
+      /* No valid previous snapshot: the rates will be since boot */
+      memset(&prev, 0, sizeof(prev));
+   }
+
+   got_stats = 1;
+}
+
+/* Clear the kernel-side stats: the next rates will be since now */
+static void reset_stats(void)
+{
+   load_stats(DP_IRQ_FL_RESET);
+
+   if (!got_stats)
+      return;
+
+   /* Make the pre-reset snapshot look like the reset state */
+   for (u32 i = 0; i < stats.bh_count; i++) {
+      stats.bh[i].run = 0;
+      stats.bh[i].exec_tot = 0;
+   }
+
+   memset(stats.lines, 0, sizeof(stats.lines));
+   load_stats(0);
+}
+
+static void sel_step(int direction)
+{
+   int i = sel_irq;
+
+   do {
+      i += direction;
+   } while (0 <= i && i < DP_IRQ_LINES && !stats.lines[i].count);
+
+   if (0 <= i && i < DP_IRQ_LINES)
+      sel_irq = i;
+}
+
 static void dp_irqs_on_enter(void)
 {
-   got_stats = (dp_cmd_get_irqs(&stats) == 0);
+   load_stats(0);
+
+   if (sel_irq < 0 || !stats.lines[sel_irq].count) {
+      sel_irq = -1;
+      sel_step(+1);
+   }
+}
+
+static enum dp_kb_handler_action
+dp_irqs_keypress(struct key_event ke)
+{
+   if (!ke.print_char) {
+
+      if (!strcmp(ke.seq, TUI_KEY_UP))
+         sel_step(-1);
+      else if (!strcmp(ke.seq, TUI_KEY_DOWN))
+         sel_step(+1);
+      else
+         return dp_kb_handler_nak;
+
+      ui_need_update = true;
+      return dp_kb_handler_ok_and_continue;
+   }
+
+   switch (ke.print_char) {
+
+      case 'r':
+         load_stats(0);
+         break;
+
+      case 'c':
+         reset_stats();
+         break;
+
+      default:
+         return dp_kb_handler_nak;
+   }
+
+   ui_need_update = true;
+   return dp_kb_handler_ok_and_continue;
+}
+
+/* TSC cycles elapsed between the previous snapshot and the current one */
+static u64 interval_cycles(void)
+{
+   return stats.tsc_at_snapshot - prev.tsc_at_snapshot;
+}
+
+static void fmt_us(char *buf, size_t sz, u64 cycles)
+{
+   if (stats.tsc_khz)
+      snprintf(buf, sz, "%llu",
+               (unsigned long long)(cycles * 1000 / stats.tsc_khz));
+   else
+      snprintf(buf, sz, "-");
+}
+
+static void fmt_rate(char *buf, size_t sz, u64 delta)
+{
+   const u64 cycles = interval_cycles();
+
+   if (stats.tsc_khz && cycles)
+      snprintf(buf, sz, "%llu",
+               (unsigned long long)(delta * stats.tsc_khz * 1000 / cycles));
+   else
+      snprintf(buf, sz, "-");
+}
+
+/* CPU share in per-mille units, printed as a percentage */
+static void fmt_load(char *buf, size_t sz, u64 delta_cycles)
+{
+   const u64 cycles = interval_cycles();
+   const u64 pm = cycles ? delta_cycles * 1000 / cycles : 0;
+   snprintf(buf, sz, "%llu.%llu",
+            (unsigned long long)(pm / 10), (unsigned long long)(pm % 10));
+}
+
+static u64 irq_delta_cycles(int irq)
+{
+   return stats.lines[irq].tot_cycles - prev.lines[irq].tot_cycles;
+}
+
+static const struct dp_irq_bh_stats *
+find_prev_bh(const struct dp_irq_bh_stats *bh)
+{
+   for (u32 i = 0; i < prev.bh_count; i++) {
+
+      const struct dp_irq_bh_stats *p = &prev.bh[i];
+
+      if (p->priority == bh->priority && !strcmp(p->name, bh->name))
+         return p;
+   }
+
+   return NULL;
+}
+
+static u64 bh_delta_cycles(const struct dp_irq_bh_stats *bh)
+{
+   const struct dp_irq_bh_stats *p = find_prev_bh(bh);
+   return bh->exec_tot - (p ? p->exec_tot : 0);
+}
+
+static void show_irq_table(void)
+{
+   int order[DP_IRQ_LINES];
+   int n = 0;
+
+   for (int i = 0; i < DP_IRQ_LINES; i++)
+      if (stats.lines[i].count || stats.lines[i].spurious)
+         order[n++] = i;
+
+   /* Sort by CPU share in the last interval, desc (insertion sort) */
+   for (int i = 1; i < n; i++) {
+
+      const int v = order[i];
+      int j = i - 1;
+
+      for (; j >= 0 && irq_delta_cycles(order[j]) < irq_delta_cycles(v); j--)
+         order[j + 1] = order[j];
+
+      order[j + 1] = v;
+   }
+
+   dp_writeln(" IRQ        Count    Rate/s   Avg us   Max us   Load%%"
+              "   Spur   Unhandled");
+   dp_writeln(
+      GFX_ON
+      "qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq"
+      GFX_OFF
+   );
+
+   for (int k = 0; k < n; k++) {
+
+      const int i = order[k];
+      const struct dp_irq_line_stats *l = &stats.lines[i];
+      char rate[24], avg[24], max[24], load[16];
+
+      fmt_rate(rate, sizeof(rate), l->count - prev.lines[i].count);
+      fmt_us(avg, sizeof(avg), l->count ? l->tot_cycles / l->count : 0);
+      fmt_us(max, sizeof(max), l->max_cycles);
+      fmt_load(load, sizeof(load), irq_delta_cycles(i));
+
+      dp_writeln("%s #%-3d %11llu %9s %8s %8s %7s %6u %11u" RESET_ATTRS,
+                 i == sel_irq ? REVERSE_VIDEO : "",
+                 i, (unsigned long long)l->count, rate, avg, max, load,
+                 l->spurious, l->unhandled);
+   }
+}
+
+static void show_bh_table(void)
+{
+   dp_writeln(" Bottom halves (worker threads)");
+   dp_writeln(" Worker      Prio       Jobs    Rate/s   Avg us   Max us   Load%%");
+   dp_writeln(
+      GFX_ON
+      "qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq"
+      GFX_OFF
+   );
+
+   for (u32 i = 0; i < stats.bh_count; i++) {
+
+      const struct dp_irq_bh_stats *bh = &stats.bh[i];
+      const struct dp_irq_bh_stats *p = find_prev_bh(bh);
+      char rate[24], avg[24], max[24], load[16];
+
+      fmt_rate(rate, sizeof(rate), bh->run - (p ? p->run : 0));
+      fmt_us(avg, sizeof(avg), bh->run ? bh->exec_tot / bh->run : 0);
+      fmt_us(max, sizeof(max), bh->exec_max);
+      fmt_load(load, sizeof(load), bh_delta_cycles(bh));
+
+      dp_writeln(" %-10.10s %5d %10u %9s %8s %8s %7s",
+                 bh->name[0] ? bh->name : "generic", bh->priority,
+                 bh->run, rate, avg, max, load);
+   }
+}
+
+static void show_histogram(void)
+{
+   const struct dp_irq_line_stats *l;
+   char bar[HIST_BAR_W + 1];
+   u32 max = 0;
+
+   if (sel_irq < 0)
+      return;
+
+   l = &stats.lines[sel_irq];
+
+   for (int i = 0; i < DP_IRQ_HIST_BUCKETS; i++)
+      if (l->hist[i] > max)
+         max = l->hist[i];
+
+   dp_writeln("IRQ #%d handler duration (cycles):", sel_irq);
+
+   if (!max) {
+      dp_writeln("   (empty)");
+      return;
+   }
+
+   for (int i = 0; i < DP_IRQ_HIST_BUCKETS; i++) {
+
+      if (!l->hist[i])
+         continue;
+
+      int w = (int)((u64)l->hist[i] * HIST_BAR_W / max);
+      w = w ? w : 1;
+
+      memset(bar, '#', (size_t)w);
+      bar[w] = 0;
+
+      if (i < DP_IRQ_HIST_BUCKETS - 1)
+         dp_writeln("   [2^%-2d, 2^%-2d)   %10u %s", i, i + 1, l->hist[i], bar);
+      else
+         dp_writeln("   [2^%-2d,  inf)   %10u %s", i, l->hist[i], bar);
+   }
 }
 
 static void dp_show_irqs(void)
@@ -80,15 +356,22 @@ static void dp_show_irqs(void)
 
    row = tui_screen_start_row;
 
-   dp_writeln("Kernel IRQ-related counters");
+   dp_writeln(
+      E_COLOR_BR_WHITE "UP/DOWN" RESET_ATTRS ": select IRQ " TERM_VLINE " "
+      E_COLOR_BR_WHITE "r" RESET_ATTRS ": refresh " TERM_VLINE " "
+      E_COLOR_BR_WHITE "c" RESET_ATTRS ": clear"
+   );
+   dp_writeln(" ");
 
    if (!got_stats) {
       dp_writeln(E_COLOR_BR_RED
-                 "TILCK_CMD_DP_GET_IRQ_STATS failed (module not loaded?)"
-                 RESET_ATTRS);
+                 "TILCK_CMD_DP_GET_IRQ_STATS failed (errno=%d)"
+                 RESET_ATTRS, load_errno);
       return;
    }
 
+   dp_writeln("Kernel IRQ-related counters");
+
    /*
     * Always render this line; master gates it on KRN_TRACK_NESTED_INTERR
     * (compile-time), but the counter is set to 0 when that's off, so
@@ -149,6 +432,18 @@ static void dp_show_irqs(void)
       dp_writeln(" ");
       dp_writeln("%s", line);
    }
+
+   dp_writeln("Max IRQ nesting: %u", stats.max_nesting);
+   dp_writeln(" ");
+
+   if (!stats.tsc_khz)
+      dp_writeln("TSC frequency not measured yet: us and rates unavailable");
+
+   show_irq_table();
+   dp_writeln(" ");
+   show_bh_table();
+   dp_writeln(" ");
+   show_histogram();
 }
 
 static struct dp_screen dp_irqs_screen = {
@@ -157,6 +452,7 @@ static struct dp_screen dp_irqs_screen = {
    .draw_func = dp_show_irqs,
    .first_setup = dp_irqs_first_setup,
    .on_dp_enter = dp_irqs_on_enter,
+   .on_keypress_func = dp_irqs_keypress,
 };
 
 __attribute__((constructor))
@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * IRQsOff panel: shows the worst-case irqs-off and preempt-off sections
+ * measured by the kernel's latency tracer (kernel/irqsoff.c), as a log2
+ * histogram of the section lengths plus the longest sections with their
+ * begin/end call sites. Driven by TILCK_CMD_DP_GET_IRQSOFF_STATS, which
+ * returns -EOPNOTSUPP unless the kernel was built with KRN_IRQSOFF_TRACER=1.
+ *
+ * Keys: 'i' irqs-off view, 'p' preempt-off view, 'r' refresh the snapshot,
+ * 'c' clear the kernel-side stats (both kinds).
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <tilck/common/syscalls.h>
+#include <tilck/common/dp_abi.h>
+
+#include "term.h"
+#include "tui_layout.h"
+#include "dp_int.h"
+#include "dp_panel.h"
+
+#define HIST_BAR_W   32
+
+static struct dp_irqsoff_stats stats;
+static int got_data;
+static int load_errno;
+static char view = 'i';
+static int row;
+
+static long dp_cmd_get_irqsoff(struct dp_irqsoff_stats *out, ulong flags)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_GET_IRQSOFF_STATS,
+                  (long)out, (long)flags, 0L, 0L);
+}
+
+static void load_stats(ulong flags)
+{
+   if (dp_cmd_get_irqsoff(&stats, flags) < 0) {
+      got_data = 0;
+      load_errno = errno;
+      return;
+   }
+
+   got_data = 1;
+}
+
+static void dp_irqsoff_on_enter(void)
+{
+   load_stats(0);
+}
+
+static enum dp_kb_handler_action
+dp_irqsoff_keypress(struct key_event ke)
+{
+   if (!ke.print_char)
+      return dp_kb_handler_nak;
+
+   switch (ke.print_char) {
+
+      case 'i':
+      case 'p':
+         view = ke.print_char;
+         break;
+
+      case 'r':
+         load_stats(0);
+         break;
+
+      case 'c':
+         load_stats(DP_IRQSOFF_FL_RESET);
+         load_stats(0);
+         break;
+
+      default:
+         return dp_kb_handler_nak;
+   }
+
+   ui_need_update = true;
+   return dp_kb_handler_ok_and_continue;
+}
+
+static void show_histogram(const struct dp_irqsoff_kind_stats *s)
+{
+   char bar[HIST_BAR_W + 1];
+   u32 max = 0;
+
+   for (int i = 0; i < DP_IRQSOFF_HIST_BUCKETS; i++)
+      if (s->hist[i] > max)
+         max = s->hist[i];
+
+   dp_writeln("Histogram (cycles):");
+
+   for (int i = 0; i < DP_IRQSOFF_HIST_BUCKETS; i++) {
+
+      if (!s->hist[i])
+         continue;
+
+      int w = (int)((u64)s->hist[i] * HIST_BAR_W / max);
+      w = w ? w : 1;
+
+      memset(bar, '#', (size_t)w);
+      bar[w] = 0;
+
+      if (i < DP_IRQSOFF_HIST_BUCKETS - 1)
+         dp_writeln("   [2^%-2d, 2^%-2d) %10u %s",
+                    i, i + 1, s->hist[i], bar);
+      else
+         dp_writeln("   [2^%-2d,  inf) %10u %s",
+                    i, s->hist[i], bar);
+   }
+}
+
+static void show_top(const struct dp_irqsoff_kind_stats *s)
+{
+   dp_writeln("Longest sections:");
+
+   dp_writeln(
+      GFX_ON
+      "qqqqqqqqqqqqnqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq"
+      GFX_OFF
+   );
+
+   for (int i = 0; i < DP_IRQSOFF_TOP_N && s->top[i].cycles; i++) {
+
+      dp_writeln("%11llu " TERM_VLINE " begin: %s",
+                 (unsigned long long)s->top[i].cycles, s->top[i].begin);
+      dp_writeln("%11s " TERM_VLINE "   end: %s", "", s->top[i].end);
+   }
+}
+
+static void dp_show_irqsoff(void)
+{
+   const struct dp_irqsoff_kind_stats *s;
+
+   row = tui_screen_start_row;
+
+   if (!got_data) {
+
+      if (load_errno == EOPNOTSUPP || load_errno == ENOTSUP) {
+
+         dp_writeln("Not available: recompile with KRN_IRQSOFF_TRACER=1");
+
+      } else {
+
+         dp_writeln(E_COLOR_BR_RED
+                    "TILCK_CMD_DP_GET_IRQSOFF_STATS failed (errno=%d)"
+                    RESET_ATTRS, load_errno);
+      }
+
+      return;
+   }
+
+   s = view == 'i' ? &stats.irqs : &stats.preempt;
+
+   dp_writeln(
+      "View: "
+      "%s" "i" RESET_ATTRS "rqs-off, "
+      "%s" "p" RESET_ATTRS "reempt-off  "
+      E_COLOR_BR_WHITE "r" RESET_ATTRS "efresh, "
+      E_COLOR_BR_WHITE "c" RESET_ATTRS "lear",
+      view == 'i' ? E_COLOR_BR_WHITE REVERSE_VIDEO : E_COLOR_BR_WHITE,
+      view == 'p' ? E_COLOR_BR_WHITE REVERSE_VIDEO : E_COLOR_BR_WHITE);
+
+   dp_writeln(" ");
+   dp_writeln("Sections: %llu   Max: %llu cycles   Avg: %llu cycles",
+              (unsigned long long)s->count,
+              (unsigned long long)s->max_cycles,
+              (unsigned long long)(s->count ? s->tot_cycles / s->count : 0));
+   dp_writeln(" ");
+
+   if (!s->count)
+      return;
+
+   show_histogram(s);
+   dp_writeln(" ");
+   show_top(s);
+   dp_writeln(" ");
+}
+
+static struct dp_screen dp_irqsoff_screen = {
+   .index = 7,
+   .label = "IRQsOff",
+   .draw_func = dp_show_irqsoff,
+   .on_dp_enter = dp_irqsoff_on_enter,
+   .on_keypress_func = dp_irqsoff_keypress,
+};
+
+__attribute__((constructor))
+static void dp_irqsoff_register(void)
+{
+   dp_register_screen(&dp_irqsoff_screen);
+}
@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * Sched panel: wakeup-to-run latency and runqueue depth histograms, plus
+ * the voluntary/involuntary context-switch counters, measured by the
+ * kernel in kernel/sched_stats.c. The per-task summary comes from the
+ * regular task table (TILCK_CMD_DP_GET_TASKS), the histograms from
+ * TILCK_CMD_DP_GET_SCHED_STATS, either global or for the selected task.
+ *
+ * Keys: UP/DOWN select the task whose histograms are shown (the first
+ * entry is the global view), 'r' refresh, 'c' clear all the stats.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <tilck/common/syscalls.h>
+#include <tilck/common/dp_abi.h>
+
+#include "term.h"
+#include "tui_input.h"
+#include "tui_layout.h"
+#include "task_dump.h"
+#include "dp_int.h"
+#include "dp_panel.h"
+
+#define HIST_BAR_W   32
+
+static struct dp_sched_stats stats;
+static int got_data;
+static int load_errno;
+static int sel_tid;           /* 0: global view */
+static int row;
+
+static long
+dp_cmd_get_sched_stats(int tid, struct dp_sched_stats *out, ulong flags)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_GET_SCHED_STATS,
+                  (long)tid, (long)out, (long)flags, 0L);
+}
+
+static void load_stats(ulong flags)
+{
+   dp_tasks_refresh();
+
+   if (dp_cmd_get_sched_stats(sel_tid, &stats, flags) < 0) {
+
+      if (sel_tid && errno == ESRCH) {
+         /* The selected task is gone: fall back to the global view */
+         sel_tid = 0;
+         load_stats(flags);
+         return;
+      }
+
+      got_data = 0;
+      load_errno = errno;
+      return;
+   }
+
+   got_data = 1;
+}
+
+static int sel_task_index(void)
+{
+   for (int i = 0; i < dp_tasks_count; i++)
+      if (dp_tasks_buf[i].tid == sel_tid)
+         return i;
+
+   return -1;
+}
+
+static void sel_step(int direction)
+{
+   int i = sel_task_index() + direction;
+
+   if (i < -1)
+      i = -1;
+
+   if (i >= dp_tasks_count)
+      i = dp_tasks_count - 1;
+
+   sel_tid = i >= 0 ? dp_tasks_buf[i].tid : 0;
+   load_stats(0);
+}
+
+static void dp_sched_on_enter(void)
+{
+   sel_tid = 0;
+   load_stats(0);
+}
+
+static enum dp_kb_handler_action
+dp_sched_keypress(struct key_event ke)
+{
+   if (!ke.print_char) {
+
+      if (!strcmp(ke.seq, TUI_KEY_UP))
+         sel_step(-1);
+      else if (!strcmp(ke.seq, TUI_KEY_DOWN))
+         sel_step(+1);
+      else
+         return dp_kb_handler_nak;
+
+      ui_need_update = true;
+      return dp_kb_handler_ok_and_continue;
+   }
+
+   switch (ke.print_char) {
+
+      case 'r':
+         load_stats(0);
+         break;
+
+      case 'c':
+         load_stats(DP_SCHED_FL_RESET);
+         load_stats(0);
+         break;
+
+      default:
+         return dp_kb_handler_nak;
+   }
+
+   ui_need_update = true;
+   return dp_kb_handler_ok_and_continue;
+}
+
+static void
+show_histogram(const char *title, const u32 *hist, int n, bool rq)
+{
+   char bar[HIST_BAR_W + 1];
+   u32 max = 0;
+
+   for (int i = 0; i < n; i++)
+      if (hist[i] > max)
+         max = hist[i];
+
+   dp_writeln("%s", title);
+
+   if (!max) {
+      dp_writeln("   (empty)");
+      return;
+   }
+
+   for (int i = 0; i < n; i++) {
+
+      if (!hist[i])
+         continue;
+
+      int w = (int)((u64)hist[i] * HIST_BAR_W / max);
+      w = w ? w : 1;
+
+      memset(bar, '#', (size_t)w);
+      bar[w] = 0;
+
+      if (rq && i == 0)
+         dp_writeln("   %-16s %10u %s", "0", hist[i], bar);
+      else if (rq && i < n - 1)
+         dp_writeln("   [%4d, %4d)     %10u %s",
+                    1 << (i - 1), 1 << i, hist[i], bar);
+      else if (rq)
+         dp_writeln("   [%4d,  inf)     %10u %s", 1 << (i - 1), hist[i], bar);
+      else if (i < n - 1)
+         dp_writeln("   [2^%-2d, 2^%-2d)   %10u %s",
+                    i, i + 1, hist[i], bar);
+      else
+         dp_writeln("   [2^%-2d,  inf)   %10u %s", i, hist[i], bar);
+   }
+}
+
+static void show_task_table(void)
+{
+   dp_writeln(" TID  Wakeups   Avg lat   Max lat      Vol.    Invol.  Name");
+   dp_writeln(
+      GFX_ON
+      "qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq"
+      GFX_OFF
+   );
+
+   for (int i = 0; i < dp_tasks_count; i++) {
+
+      const struct dp_task_info *t = &dp_tasks_buf[i];
+      const u64 avg = t->wakeups ? t->wakeup_lat_tot / t->wakeups : 0;
+
+      dp_writeln("%s%5d %8u %9llu %9llu %9u %9u  %.20s" RESET_ATTRS,
+                 t->tid == sel_tid ? REVERSE_VIDEO : "",
+                 t->tid, t->wakeups,
+                 (unsigned long long)avg,
+                 (unsigned long long)t->wakeup_lat_max,
+                 t->nvcsw, t->nivcsw, t->name);
+   }
+}
+
+static void dp_show_sched(void)
+{
+   const u64 avg = stats.wakeups ? stats.lat_tot / stats.wakeups : 0;
+   row = tui_screen_start_row;
+
+   dp_writeln(
+      E_COLOR_BR_WHITE "UP/DOWN" RESET_ATTRS ": select task " TERM_VLINE " "
+      E_COLOR_BR_WHITE "r" RESET_ATTRS ": refresh " TERM_VLINE " "
+      E_COLOR_BR_WHITE "c" RESET_ATTRS ": clear"
+   );
+   dp_writeln(" ");
+
+   if (!got_data) {
+      dp_writeln(E_COLOR_BR_RED
+                 "TILCK_CMD_DP_GET_SCHED_STATS failed (errno=%d)"
+                 RESET_ATTRS, load_errno);
+      return;
+   }
+
+   if (sel_tid)
+      dp_writeln("Task %d   (latencies in RDTSC cycles)", sel_tid);
+   else
+      dp_writeln("All tasks   (latencies in RDTSC cycles)");
+
+   dp_writeln(" ");
+   dp_writeln("Wakeups: %u   Avg: %llu   Max: %llu   Vol: %u   Invol: %u",
+              stats.wakeups,
+              (unsigned long long)avg,
+              (unsigned long long)stats.lat_max,
+              stats.nvcsw, stats.nivcsw);
+   dp_writeln(" ");
+
+   show_histogram("Wakeup-to-run latency (cycles):",
+                  stats.lat_hist, DP_SCHED_LAT_HIST_BUCKETS, false);
+   dp_writeln(" ");
+   show_histogram("Runnable tasks ahead at wakeup:",
+                  stats.rq_hist, DP_SCHED_RQ_HIST_BUCKETS, true);
+   dp_writeln(" ");
+   show_task_table();
+}
+
+static struct dp_screen dp_sched_screen = {
+   .index = 8,
+   .label = "Sched",
+   .draw_func = dp_show_sched,
+   .on_dp_enter = dp_sched_on_enter,
+   .on_keypress_func = dp_sched_keypress,
+};
+
+__attribute__((constructor))
+static void dp_sched_register(void)
+{
+   dp_register_screen(&dp_sched_screen);
+}
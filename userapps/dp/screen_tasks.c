@@ -151,12 +151,12 @@ render_one_task(const struct dp_task_info *t, bool kernel_tasks)
       snprintf(rev_fmt, sizeof(rev_fmt),
                REVERSE_VIDEO "%s" RESET_ATTRS, fmt);
       dp_writeln(rev_fmt, t->tid, t->pgid, t->sid, t->parent_pid,
-                 state_str, ttynum, path);
+                 state_str, ttynum, t->rss_pages * 4, path);
 
    } else {
 
       dp_writeln(fmt, t->tid, t->pgid, t->sid, t->parent_pid,
-                 state_str, ttynum, path);
+                 state_str, ttynum, t->rss_pages * 4, path);
    }
 }
 
@@ -18,6 +18,12 @@
  *   tracer --test         — Tier 1 + Tier 2 self-tests
  *   tracer --test --stress
  *                         — ring-buffer overrun stress test
+ *   tracer --record FILE [SECONDS]
+ *                         — stream the raw events into FILE
+ *   tracer --replay FILE [--tid N] [--sys EXPR] [--stats]
+ *                         — render / analyze a recording offline
+ *   tracer --prof [SECONDS] [--period N] [-g] [--top N] [--folded FILE]
+ *                         — sampling CPU profiler (timer-driven)
  *   tracer -h, --help     — show usage and exit
  */
 
@@ -47,12 +53,86 @@ static void show_help_and_exit(void)
    printf("  tracer --test --stress  Inject 10000 events into the ring\n");
    printf("                          buffer and verify the surviving\n");
    printf("                          events round-trip correctly.\n");
+   printf("  tracer --record FILE [SECONDS]\n");
+   printf("                          Trace the traced tasks (see 't' in\n");
+   printf("                          the interactive tracer) and write\n");
+   printf("                          the raw events to FILE, until Ctrl+C\n");
+   printf("                          or SECONDS elapsed.\n");
+   printf("  tracer --replay FILE [--tid N] [--sys EXPR] [--stats]\n");
+   printf("                          Render the events of a recording,\n");
+   printf("                          optionally only for task N and for\n");
+   printf("                          the syscalls matching EXPR (shell\n");
+   printf("                          wildcards, e.g. 'read*'). --stats\n");
+   printf("                          prints per-syscall latency stats.\n");
+   printf("  tracer --prof [SECONDS] [--period N] [-g] [--top N]\n");
+   printf("                [--folded FILE]\n");
+   printf("                          Sample the CPU every N timer ticks\n");
+   printf("                          for SECONDS (default: 10) or until\n");
+   printf("                          Ctrl+C and show the top functions.\n");
+   printf("                          -g records kernel callchains; with\n");
+   printf("                          --folded, the collapsed stacks are\n");
+   printf("                          written to FILE (flame graphs).\n");
    printf("  tracer -h, --help       Show this help and exit.\n");
    exit(0);
 }
 
+static int run_replay(int argc, char **argv)
+{
+   struct tr_replay_opts opts = {0};
+
+   if (argc < 3)
+      show_help_and_exit();
+
+   for (int i = 3; i < argc; i++) {
+
+      if (!strcmp(argv[i], "--stats")) {
+         opts.stats = true;
+      } else if (!strcmp(argv[i], "--tid") && i + 1 < argc) {
+         opts.tid = atoi(argv[++i]);
+      } else if (!strcmp(argv[i], "--sys") && i + 1 < argc) {
+         opts.sys = argv[++i];
+      } else {
+         fprintf(stderr, "tracer: invalid option '%s'\n", argv[i]);
+         return 1;
+      }
+   }
+
+   return tr_run_replay(argv[2], &opts);
+}
+
+static int run_prof(int argc, char **argv)
+{
+   struct tr_prof_opts opts = {0};
+   int i = 2;
+
+   if (i < argc && argv[i][0] != '-')
+      opts.seconds = atoi(argv[i++]);
+
+   for (; i < argc; i++) {
+
+      if (!strcmp(argv[i], "-g")) {
+         opts.callchain = true;
+      } else if (!strcmp(argv[i], "--period") && i + 1 < argc) {
+         opts.period = atoi(argv[++i]);
+      } else if (!strcmp(argv[i], "--top") && i + 1 < argc) {
+         opts.top = atoi(argv[++i]);
+      } else if (!strcmp(argv[i], "--folded") && i + 1 < argc) {
+         opts.folded = argv[++i];
+      } else {
+         fprintf(stderr, "tracer: invalid option '%s'\n", argv[i]);
+         return 1;
+      }
+   }
+
+   return tr_run_prof(&opts);
+}
+
 int main(int argc, char **argv)
 {
+   /* Replaying a recording doesn't need the kernel: it works anywhere */
+   if (argc > 1 && !strcmp(argv[1], "--replay"))
+      return run_replay(argc, argv);
+
    if (!getenv("TILCK")) {
       printf("ERROR: the tracer exists only on Tilck!\n");
       return 1;
@@ -73,5 +153,16 @@ int main(int argc, char **argv)
       return rc1 == 0 && rc2 == 0 ? 0 : 1;
    }
 
+   if (argc > 1 && !strcmp(argv[1], "--record")) {
+
+      if (argc < 3)
+         show_help_and_exit();
+
+      return tr_run_record(argv[2], argc > 3 ? atoi(argv[3]) : 0);
+   }
+
+   if (argc > 1 && !strcmp(argv[1], "--prof"))
+      return run_prof(argc, argv);
+
    return dp_run_tracer();
 }
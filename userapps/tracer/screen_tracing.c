@@ -8,8 +8,9 @@
  * Master implemented this entirely in the kernel (modules/debugpanel/
  * dp_tracing.c + dp_tracing_sys.c). After the userspace move the
  * rendering lives in tr_render.c / tr_dump*.c and is driven by
- * metadata fetched from /syst/tracing/metadata; events are streamed
- * via /syst/tracing/events.
+ * metadata fetched from /syst/tracing/metadata; events are rendered
+ * in place from the read-only mapping of /syst/tracing/ring, or copied
+ * out in batches with TILCK_CMD_DP_TRACE_DRAIN when mmap() fails.
  *
  * Everything else — banner, help, key dispatch, filter prompts,
  * traced-PID list editor, "discard remaining events?" prompt — is
@@ -35,10 +36,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/syscall.h>
 
 #include <tilck/common/syscalls.h>
 #include <tilck/common/dp_abi.h>
+#include <tilck/common/tracing/ring.h>
 
 #include "term.h"
 #include "tui_input.h"
@@ -46,8 +50,9 @@
 #include "task_dump.h"
 #include "tr.h"
 
-#define EVENTS_PATH       "/syst/tracing/events"
+#define RING_PATH         "/syst/tracing/ring"
 #define RENDER_BUF_SZ     1024
+#define EVENTS_BATCH      32     /* max events rendered between stdin polls */
 #define MAX_SYSCALLS      512
 
 /* ----------------------- TILCK_CMD wrappers -------------------------- */
@@ -124,6 +129,22 @@ dp_cmd_get_in_buf_count(void)
                   0L, 0L, 0L, 0L);
 }
 
+static long
+dp_cmd_trace_drain(struct dp_trace_event *buf, ulong max, int wait)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_DRAIN,
+                  (long)buf, (long)max, (long)wait, 0L);
+}
+
+static long
+dp_cmd_trace_consume(ulong count, int wait)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_CONSUME,
+                  (long)count, (long)wait, 0L, 0L);
+}
+
 static long
 dp_cmd_get_traced_tids_and_clear(int *buf, ulong max)
 {
@@ -199,7 +220,9 @@ static void show_banner(void)
       TERM_VLINE " #Sys traced: " E_COLOR_BR_BLUE "%d" RESET_ATTRS " "
       TERM_VLINE " #Tasks traced: " E_COLOR_BR_BLUE "%d" RESET_ATTRS " "
       TERM_VLINE "\r\n"
-      TERM_VLINE " Printk lvl: " E_COLOR_BR_BLUE "%d" RESET_ATTRS
+      TERM_VLINE " Printk lvl: " E_COLOR_BR_BLUE "%d" RESET_ATTRS " "
+      TERM_VLINE " Buf: " E_COLOR_BR_BLUE "%u" RESET_ATTRS " events "
+      TERM_VLINE " Lost: %s%u" RESET_ATTRS
       "\r\n",
       st.force_exp_block ? E_COLOR_GREEN "ON" RESET_ATTRS
                          : E_COLOR_RED "OFF" RESET_ATTRS,
@@ -207,7 +230,10 @@ static void show_banner(void)
                          : E_COLOR_RED "OFF" RESET_ATTRS,
       st.sys_traced_count,
       st.tasks_traced_count,
-      st.printk_lvl);
+      st.printk_lvl,
+      st.ring_capacity,
+      st.lost_events ? E_COLOR_BR_RED : E_COLOR_BR_BLUE,
+      st.lost_events);
 
    term_write(TERM_VLINE " Trace expr: " E_COLOR_YELLOW "%s" RESET_ATTRS,
                 filter_buf);
@@ -441,28 +467,127 @@ static void edit_traced_pids(void)
       term_write("Tracing %d tasks\r\n", set);
 }
 
+/* ------------------------ trace ring access -------------------------- */
+
+/*
+ * The kernel's trace ring, mapped read-only (see <tilck/common/tracing/
+ * ring.h>). Events are rendered in place and then released in batches with
+ * TILCK_CMD_DP_TRACE_CONSUME. If the mapping is not available, the events
+ * are copied out in batches with TILCK_CMD_DP_TRACE_DRAIN instead.
+ */
+static const struct tr_ring_header *ring;
+static size_t ring_map_sz;
+
+static void ring_map(void)
+{
+   const struct tr_ring_header *h;
+   struct stat st;
+   int fd;
+
+   if ((fd = open(RING_PATH, O_RDONLY)) < 0)
+      return;
+
+   if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*h)) {
+      close(fd);
+      return;
+   }
+
+   h = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+
+   if (h == MAP_FAILED)
+      return;
+
+   if (h->magic != TR_RING_MAGIC ||
+       h->version != TR_RING_VERSION ||
+       h->elem_size != sizeof(struct dp_trace_event))
+   {
+      munmap((void *)h, (size_t)st.st_size);
+      return;
+   }
+
+   ring = h;
+   ring_map_sz = (size_t)st.st_size;
+}
+
+static void ring_unmap(void)
+{
+   if (ring) {
+      munmap((void *)ring, ring_map_sz);
+      ring = NULL;
+   }
+}
+
+/*
+ * Consume up to `max` events, rendering them when `render` is true. With
+ * `wait` set, park in the kernel for up to 100 ms when the ring is empty.
+ * Returns the number of events consumed, or -1 on error (errno is set).
+ */
+static long
+consume_events(u32 max, bool render, bool wait, struct dp_render_ctx *ctx)
+{
+   struct dp_trace_event evs[EVENTS_BATCH];
+   const struct dp_trace_event *ev;
+   char rbuf[RENDER_BUF_SZ];
+   u32 n, tail;
+   long rc;
+
+   max = MIN(max, (u32)EVENTS_BATCH);
+
+   if (ring) {
+
+      tail = ring->tail;
+      n = MIN(tr_ring_count(ring), max);
+      COMPILER_BARRIER();     /* read the events only after `head` */
+
+      for (u32 i = 0; render && i < n; i++) {
+
+         ev = tr_ring_slot(ring, tail + i);
+
+         if ((rc = tr_render_event(ev, rbuf, sizeof(rbuf), ctx)) > 0)
+            term_write_n(rbuf, (int)rc);
+      }
+
+      if (dp_cmd_trace_consume(n, !n && wait) < 0)
+         return -1;
+
+      return n;
+   }
+
+   if ((rc = dp_cmd_trace_drain(evs, max, wait)) < 0)
+      return -1;
+
+   for (long i = 0; render && i < rc; i++) {
+
+      long len = tr_render_event(&evs[i], rbuf, sizeof(rbuf), ctx);
+
+      if (len > 0)
+         term_write_n(rbuf, (int)len);
+   }
+
+   return rc;
+}
+
 /* ------------------------ live tracing loop -------------------------- */
 
 /*
- * Drive the live tracing loop: read events from /syst/tracing/events
- * and render each one via the kernel renderer. Stops on:
+ * Drive the live tracing loop: consume the events from the trace ring in
+ * batches and render each one locally. Stops on:
  *
  *   - Ctrl+C — exit the tracer entirely. Returns false. The TTY is
  *     in raw mode (ISIG cleared) so this arrives as byte 0x03 on
  *     stdin, not as a SIGINT signal.
  *   - 'q' typed   — exit. Returns false.
  *   - Enter typed — back to the banner. Returns true.
- *   - I/O error on either fd — exit. Returns false.
+ *   - I/O error on stdin or on the ring — exit. Returns false.
  *
- * The kernel-side /syst/tracing/events read is bounded to ~100 ms
- * (KRN_TIMER_HZ / 10) per call so even with no events flowing the
+ * When the ring is empty, the kernel waits for events up to ~100 ms
+ * (KRN_TIMER_HZ / 10) per call, so even with no events flowing the
  * stdin probe gets a chance to drain typed commands.
  */
 static bool
-trace_live_loop(int events_fd)
+trace_live_loop(void)
 {
-   struct dp_trace_event ev;
-   char rbuf[RENDER_BUF_SZ];
    char c;
    ssize_t n;
    struct dp_render_ctx ctx = {0};
@@ -486,28 +611,8 @@ trace_live_loop(int events_fd)
       if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
          break;
 
-      n = read(events_fd, &ev, sizeof(ev));
-
-      if (n == (ssize_t)sizeof(ev)) {
-
-         long rc = tr_render_event(&ev, rbuf, sizeof(rbuf), &ctx);
-
-         if (rc > 0)
-            term_write_n(rbuf, (int)rc);
-
-         continue;
-      }
-
-      if (n < 0 && (errno == EINTR || errno == EAGAIN ||
-                    errno == EWOULDBLOCK))
-      {
-         continue;
-      }
-
-      if (n < 0)
+      if (consume_events(EVENTS_BATCH, true, true, &ctx) < 0 && errno != EINTR)
          break;
-
-      break;     /* n == 0: treat as EOF */
    }
 
    if (ctx.last_tp_incomplete_line)
@@ -522,11 +627,10 @@ trace_live_loop(int events_fd)
  * "Discard remaining N events in the buf? [Y/n]"; default Y means
  * read-and-drop, n means render them too.
  */
-static int dump_remaining_events(int events_fd)
+static int dump_remaining_events(void)
 {
-   struct dp_trace_event ev;
-   char rbuf[RENDER_BUF_SZ];
    char c;
+   long rc;
    struct dp_render_ctx ctx = {0};
    const long rem = dp_cmd_get_in_buf_count();
 
@@ -556,33 +660,21 @@ static int dump_remaining_events(int events_fd)
    term_write_n(&c, 1);
    term_write("\r\n");
 
-   /* Drain. The events fd's kernel-side read is non-blocking-friendly
-    * (returns -EAGAIN when empty), so loop until we hit that or EOF. */
-
-   while (true) {
-
-      ssize_t n = read(events_fd, &ev, sizeof(ev));
-
-      if (n == (ssize_t)sizeof(ev)) {
-
-         if (c == 'n' || c == 'N') {
-
-            long rc = tr_render_event(&ev, rbuf, sizeof(rbuf), &ctx);
+   /*
+    * Consume only the events that were there when we asked: tracing is
+    * off, but trace_printk() might still be producing a few more.
+    */
+   for (long left = rem; left > 0; left -= rc) {
 
-            if (rc > 0)
-               term_write_n(rbuf, (int)rc);
-         }
+      rc = consume_events((u32)left, c == 'n' || c == 'N', false, &ctx);
 
+      if (rc < 0 && errno == EINTR) {
+         rc = 0;
          continue;
       }
 
-      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      if (rc <= 0)
          break;
-
-      if (n < 0 && errno == EINTR)
-         continue;
-
-      break;     /* EOF or unexpected error */
    }
 
    if (ctx.last_tp_incomplete_line)
@@ -669,37 +761,23 @@ static bool tracer_handle_one_key(int unused)
 
       case TUI_KEY_ENTER: {
 
-         int events_fd = open(EVENTS_PATH, O_RDONLY | O_NONBLOCK);
-
-         if (events_fd < 0) {
-            term_write(E_COLOR_BR_RED
-                         "open(%s) failed: errno=%d\r\n"
-                         RESET_ATTRS, EVENTS_PATH, errno);
-            break;
-         }
-
          term_write("\r\n");
          term_write(E_COLOR_GREEN "-- Tracing active --"
                       RESET_ATTRS "\r\n\r\n");
 
          dp_cmd_set_enabled(1);
-         bool keep_banner = trace_live_loop(events_fd);
+         bool keep_banner = trace_live_loop();
          dp_cmd_set_enabled(0);
 
-         if (!keep_banner) {
-            close(events_fd);
+         if (!keep_banner)
             return false;     /* clean exit (q or Ctrl+C) */
-         }
 
          term_write(E_COLOR_RED "-- Tracing stopped --"
                       RESET_ATTRS "\r\n");
 
-         if (dump_remaining_events(events_fd) < 0) {
-            close(events_fd);
+         if (dump_remaining_events() < 0)
             return false;
-         }
 
-         close(events_fd);
          break;
       }
 
@@ -725,6 +803,7 @@ static bool tracer_handle_one_key(int unused)
 int dp_run_tracer(void)
 {
    tr_meta_init();
+   ring_map();
    tui_init_layout();
    tui_term_setup();
 
@@ -746,6 +825,7 @@ int dp_run_tracer(void)
    while (tracer_handle_one_key(-1)) { }
 
    dp_cmd_set_enabled(0);
+   ring_unmap();
    tui_term_restore();
    return 0;
 }
@@ -28,6 +28,11 @@
  *     ptype_wstatus int in fmt0 slot 0, ioctl_argp / fcntl_arg
  *     context-dispatched cases)
  *   - Edge cases: "<fault>" marker, unknown sys_n fallback
+ *   - Bulk consumers: TILCK_CMD_DP_TRACE_DRAIN and the read-only
+ *     mapping of /syst/tracing/ring + TILCK_CMD_DP_TRACE_CONSUME
+ *   - Recording file round-trip + offline latency stats (tr_record.c,
+ *     tr_replay.c). Runs last: replaying switches the renderer to the
+ *     syscall names stored in the file.
  *
  * Wire-sanity prelude: read /syst/tracing/metadata, validate magic +
  * version. tr_meta_init does the validation already; we just check
@@ -57,10 +62,12 @@
 
 #include <tilck/common/syscalls.h>
 #include <tilck/common/dp_abi.h>
+#include <tilck/common/tracing/ring.h>
 
 #include "tr.h"
 
 #define EVENTS_PATH       "/syst/tracing/events"
+#define RING_PATH         "/syst/tracing/ring"
 #define RENDER_BUF_SZ     1024
 #define STRESS_NEVENTS    10000
 
@@ -88,6 +95,22 @@ cmd_inject_event(const struct dp_trace_event *ev)
                   (long)ev, 0L, 0L, 0L);
 }
 
+static long
+cmd_trace_drain(struct dp_trace_event *buf, ulong max, int wait)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_DRAIN,
+                  (long)buf, (long)max, (long)wait, 0L);
+}
+
+static long
+cmd_trace_consume(ulong count, int wait)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_CONSUME,
+                  (long)count, (long)wait, 0L, 0L);
+}
+
 /* ------------------------------ harness ------------------------------ */
 
 static int events_fd = -1;
@@ -864,6 +887,189 @@ test_inj_gate(void)
    test_pass(name);
 }
 
+/*
+ * 21: TILCK_CMD_DP_TRACE_DRAIN copies out a batch of events, in order,
+ * and consumes them. Stray printk events may be interleaved: skip them.
+ */
+static void
+test_inj_drain_batch(void)
+{
+   const char *name = "inj_drain_batch";
+   struct dp_trace_event ev, back[16];
+   int next = 0;
+   long n;
+
+   drain_ring();
+
+   for (int i = 0; i < 3; i++) {
+
+      mkev(&ev, dp_te_sys_enter, INJ_TID);
+      ev.sys_ev.sys = SYS_getpid;
+      ev.sys_ev.args[0] = (ulong)i;
+
+      if (cmd_inject_event(&ev) < 0) {
+         test_fail(name, "inject failed");
+         return;
+      }
+   }
+
+   if ((n = cmd_trace_drain(back, 16, 0)) < 3) {
+      test_fail(name, "drain returned less than 3 events");
+      return;
+   }
+
+   for (long i = 0; i < n; i++)
+      if (back[i].tid == INJ_TID && back[i].sys_ev.args[0] == (ulong)next)
+         next++;
+
+   if (next != 3) {
+      test_fail(name, "injected events missing or out of order");
+      return;
+   }
+
+   if (cmd_trace_drain(back, 16, 0) != 0 && back[0].tid == INJ_TID) {
+      test_fail(name, "drained events were not consumed");
+      return;
+   }
+
+   test_pass(name);
+}
+
+/*
+ * 22: map /syst/tracing/ring read-only, find an injected event in place
+ * and release it with TILCK_CMD_DP_TRACE_CONSUME.
+ */
+static void
+test_inj_ring_mmap(void)
+{
+   const char *name = "inj_ring_mmap";
+   const struct tr_ring_header *h;
+   const struct dp_trace_event *e;
+   struct dp_trace_event ev;
+   u32 n, tail;
+   bool found = false;
+   off_t sz;
+   int fd;
+
+   if ((fd = open(RING_PATH, O_RDONLY)) < 0) {
+      test_fail(name, "open failed");
+      return;
+   }
+
+   sz = lseek(fd, 0, SEEK_END);
+   h = mmap(NULL, (size_t)sz, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+
+   if (sz <= 0 || h == MAP_FAILED) {
+      test_fail(name, "mmap failed");
+      return;
+   }
+
+   if (h->magic != TR_RING_MAGIC || h->version != TR_RING_VERSION ||
+       h->elem_size != sizeof(ev) || (h->capacity & (h->capacity - 1)))
+   {
+      test_fail(name, "bad ring header");
+      goto out;
+   }
+
+   drain_ring();
+   mkev(&ev, dp_te_sys_enter, INJ_TID);
+   ev.sys_ev.sys = SYS_getpid;
+   ev.sys_ev.args[0] = 0xc0ffee;
+
+   if (cmd_inject_event(&ev) < 0) {
+      test_fail(name, "inject failed");
+      goto out;
+   }
+
+   tail = h->tail;
+   n = tr_ring_count(h);
+
+   for (u32 i = 0; i < n; i++) {
+      e = tr_ring_slot(h, tail + i);
+      found |= e->tid == INJ_TID && e->sys_ev.args[0] == 0xc0ffee;
+   }
+
+   if (!found) {
+      test_fail(name, "injected event not found in the mapping");
+      goto out;
+   }
+
+   if (cmd_trace_consume(n, 0) < 0 || h->tail != tail + n) {
+      test_fail(name, "consume did not advance the tail");
+      goto out;
+   }
+
+   if (cmd_trace_consume(h->capacity + 1, 0) >= 0 || errno != EINVAL) {
+      test_fail(name, "consume past head not rejected");
+      goto out;
+   }
+
+   test_pass(name);
+
+out:
+   munmap((void *)h, (size_t)sz);
+}
+
+/*
+ * 23: write a recording with a few synthetic events, replay it with
+ * --stats and check the per-syscall latency aggregation.
+ */
+static void
+test_inj_record_replay(void)
+{
+   const char *name = "inj_record_replay";
+   const char *path = "/tmp/tracer_test.trc";
+   const struct tr_replay_opts opts = { .tid = INJ_TID, .stats = true };
+   const struct tr_sys_stats *st;
+   struct tr_file_writer w;
+   struct dp_trace_event evs[4];
+
+   /* getpid(): 3 us, then 1 us; then an exit-only (CALL) error */
+   for (int i = 0; i < 4; i++) {
+      mkev(&evs[i], i % 2 ? dp_te_sys_exit : dp_te_sys_enter, INJ_TID);
+      evs[i].sys_ev.sys = SYS_getpid;
+   }
+
+   evs[0].sys_time = 1000;
+   evs[1].sys_time = 4000;
+   evs[2].sys_time = 10000;
+   evs[3].sys_time = 11000;
+
+   if (tr_file_create(&w, path) ||
+       tr_file_write_chunk(&w, evs, 2, 0) ||
+       tr_file_write_chunk(&w, evs + 2, 2, 7))
+   {
+      test_fail(name, "cannot write the recording");
+      return;
+   }
+
+   evs[0].sys_ev.retval = -ENOSYS;
+   evs[0].type = dp_te_sys_exit;
+
+   if (tr_file_write_chunk(&w, evs, 1, 0) || tr_file_close(&w)) {
+      test_fail(name, "cannot write the recording");
+      return;
+   }
+
+   if (tr_run_replay(path, &opts) != 0) {
+      test_fail(name, "replay failed");
+      return;
+   }
+
+   unlink(path);
+   st = tr_stats_get(SYS_getpid);
+
+   if (st->calls != 3 || st->errors != 1 || st->timed != 2 ||
+       st->tot_ns != 4000 || st->min_ns != 1000 || st->max_ns != 3000)
+   {
+      test_fail(name, "unexpected latency stats");
+      return;
+   }
+
+   test_pass(name);
+}
+
 /* ----------------------------- drivers -------------------------------- */
 
 int
@@ -913,6 +1119,9 @@ tr_run_tier2_tests(void)
    test_inj_unknown_sys_n();
    test_inj_tid_roundtrip();
    test_inj_gate();
+   test_inj_drain_batch();
+   test_inj_ring_mmap();
+   test_inj_record_replay();
 
    cmd_set_test_mode(0);
    close(events_fd);
@@ -931,7 +1140,7 @@ tr_run_tier2_tests(void)
  * arg array.
  *
  * What this proves:
- *   - ringbuf_write_elem under back-pressure doesn't corrupt the
+ *   - the ring producer under back-pressure doesn't corrupt the
  *     event payload.
  *   - drain after stress yields events with valid (sys_n, tid)
  *     pairs from the injection sequence.
@@ -47,6 +47,16 @@ const struct tr_wire_syscall *tr_get_sys_info(unsigned sys_n);
  */
 const struct tr_wire_ptype_info *tr_get_ptype_info(unsigned type_id);
 
+/*
+ * Load the metadata from a blob instead of /syst/tracing/metadata: used
+ * when replaying a recording. Same return values as tr_meta_init(), plus
+ * -EBUSY if a different metadata blob has been already loaded.
+ */
+int tr_meta_init_from_blob(const void *blob, size_t size);
+
+/* The raw metadata blob loaded by tr_meta_init(), NULL if none. */
+const void *tr_meta_get_blob(size_t *size);
+
 /* --------------------------- runtime knobs --------------------------- */
 
 /*
@@ -111,6 +121,99 @@ int tr_render_event(const struct dp_trace_event *e,
                     size_t out_sz,
                     struct dp_render_ctx *ctx);
 
+/*
+ * Syscall names, without the "sys_" prefix. Fetched lazily from the
+ * kernel, unless tr_set_sys_names_offline() has been called: then only
+ * the names preloaded with tr_set_sys_name() are known and all the
+ * others render as "syscall_<n>".
+ */
+const char *tr_get_sys_name(unsigned sys_n);
+void tr_set_sys_name(unsigned sys_n, const char *name);
+void tr_set_sys_names_offline(void);
+
+/* -------------------------- record / replay -------------------------- */
+
+/*
+ * Per-syscall latency statistics, aggregated offline from the events of
+ * a recording (or of any event stream). Latencies come from matching
+ * ENTER/EXIT pairs of the same task: syscalls traced only at exit (CALL)
+ * are counted, but have no latency. Implementation in tr_replay.c.
+ */
+struct tr_sys_stats {
+
+   u32 calls;           /* EXIT events */
+   u32 errors;          /* EXIT events with retval < 0 */
+   u32 timed;           /* EXIT events with a matching ENTER */
+   u64 tot_ns;
+   u64 min_ns;
+   u64 max_ns;
+};
+
+void tr_stats_reset(void);
+void tr_stats_add_event(const struct dp_trace_event *e);
+const struct tr_sys_stats *tr_stats_get(unsigned sys_n);
+void tr_stats_print(void);
+
+/*
+ * `tracer --record FILE [SECONDS]` — enable tracing and stream the raw
+ * events plus the metadata into FILE (format: struct tr_file_header in
+ * <tilck/common/tracing/wire.h>) until Ctrl+C or SECONDS elapsed.
+ * Implementation in tr_record.c.
+ */
+int tr_run_record(const char *path, int seconds);
+
+/*
+ * Recording writer used by tr_run_record(): tr_file_create() writes the
+ * header, the metadata and the syscall names; tr_file_write_chunk() one
+ * batch of events. Both return 0 on success, -errno on failure.
+ */
+struct tr_file_writer {
+   void *f;             /* FILE * */
+   u64 events;
+   u64 lost;
+};
+
+int tr_file_create(struct tr_file_writer *w, const char *path);
+int tr_file_write_chunk(struct tr_file_writer *w,
+                        const struct dp_trace_event *evs,
+                        u32 count,
+                        u32 lost);
+int tr_file_close(struct tr_file_writer *w);
+
+/*
+ * `tracer --replay FILE [--tid N] [--sys EXPR] [--stats]` — render the
+ * events of a recording, optionally filtered by task and by syscall name
+ * (fnmatch() pattern, without "sys_"), or print the per-syscall latency
+ * stats instead. Needs no kernel support. Implementation in tr_replay.c.
+ */
+struct tr_replay_opts {
+   int tid;             /* 0: all tasks */
+   const char *sys;     /* NULL: all syscalls */
+   bool stats;
+};
+
+int tr_run_replay(const char *path, const struct tr_replay_opts *opts);
+
+/* ------------------------------ profiler ----------------------------- */
+
+/*
+ * `tracer --prof [SECONDS] [--period N] [-g] [--top N] [--folded FILE]` —
+ * run the kernel's sampling profiler (TILCK_CMD_PROF_*), showing the top
+ * functions live, then the final profile. With -g, kernel callchains are
+ * recorded too: they give the inclusive ("total") counts and, with
+ * --folded, the collapsed stacks written to FILE for flame graph tools.
+ * Implementation in tr_prof.c.
+ */
+struct tr_prof_opts {
+   int seconds;         /* 0: default (10 s) */
+   int period;          /* 0: sample at every timer tick */
+   int top;             /* 0: default (20) */
+   bool callchain;
+   const char *folded;  /* NULL: no collapsed stacks output */
+};
+
+int tr_run_prof(const struct tr_prof_opts *opts);
+
 /* ----------------------------- entry -------------------------------- */
 
 /*
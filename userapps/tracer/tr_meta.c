@@ -154,6 +154,16 @@ static int validate_and_index(void)
    return 0;
 }
 
+static void reset_meta(void)
+{
+   free(meta_blob);
+   meta_blob = NULL;
+   meta_blob_size = 0;
+   meta_hdr = NULL;
+   meta_ptypes = NULL;
+   meta_syscalls = NULL;
+}
+
 int tr_meta_init(void)
 {
    int rc;
@@ -180,11 +190,7 @@ int tr_meta_init(void)
               "fall back to name-only events)\r\n",
               META_PATH, rc);
 
-      free(meta_blob);
-      meta_blob = NULL;
-      meta_hdr = NULL;
-      meta_ptypes = NULL;
-      meta_syscalls = NULL;
+      reset_meta();
       inited = true;
       return rc;
    }
@@ -193,6 +199,41 @@ int tr_meta_init(void)
    return 0;
 }
 
+int tr_meta_init_from_blob(const void *blob, size_t size)
+{
+   int rc;
+
+   if (inited) {
+
+      /* Replaying a recording made by this very kernel: nothing to do */
+      if (meta_blob && size == meta_blob_size && !memcmp(blob, meta_blob, size))
+         return 0;
+
+      return -EBUSY;
+   }
+
+   if (size < sizeof(struct tr_wire_header))
+      return -EINVAL;
+
+   if (!(meta_blob = malloc(size)))
+      return -ENOMEM;
+
+   memcpy(meta_blob, blob, size);
+   meta_blob_size = size;
+
+   if ((rc = validate_and_index()) < 0)
+      reset_meta();
+
+   inited = true;
+   return rc;
+}
+
+const void *tr_meta_get_blob(size_t *size)
+{
+   *size = meta_blob_size;
+   return meta_blob;
+}
+
 const struct tr_wire_syscall *tr_get_sys_info(unsigned sys_n)
 {
    if (sys_n >= MAX_SYS_N)
@@ -0,0 +1,390 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * `tracer --prof` — front-end for the kernel's sampling CPU profiler
+ * (kernel/prof.c, ABI in <tilck/common/prof_abi.h>).
+ *
+ * The kernel records one sample every N timer ticks: the interrupted PC,
+ * the tid and, with -g, the kernel callchain. Kernel addresses come back
+ * already resolved to the start of their function: here we aggregate them
+ * into a flat profile (self samples, plus the inclusive ones when there
+ * are callchains) and resolve only the names of the functions we print.
+ * User samples can't be symbolized by the kernel: they are aggregated per
+ * task, as "[user:TID]".
+ *
+ * While profiling, the top functions are shown live, refreshed every
+ * second. At the end, the final profile is printed and, with --folded,
+ * written as "collapsed stacks" (one "outer;...;leaf COUNT" line per
+ * distinct stack), the input format of the common flame graph tools.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <tilck/common/syscalls.h>
+#include <tilck/common/prof_abi.h>
+
+#include "tr.h"
+
+#define FUNCS_HT_SIZE      2048        /* power of 2 */
+#define FUNC_NAME_MAX        48
+#define FETCH_BATCH         256
+#define DEFAULT_TOP          20
+#define DEFAULT_SECONDS      10
+
+struct prof_func {
+   u64 addr;                 /* 0: empty slot */
+   int tid;                  /* user samples only */
+   u32 self;
+   u32 total;
+   char name[FUNC_NAME_MAX];
+};
+
+static struct prof_func funcs[FUNCS_HT_SIZE];
+static u32 funcs_count;
+static struct prof_sample *all_samples;
+static u32 samples_count;
+static u32 samples_cap;
+static volatile sig_atomic_t stop_profiling;
+
+/* ----------------------- TILCK_CMD wrappers -------------------------- */
+
+static long
+cmd_prof_ctl(enum prof_ctl_op op, u32 period, u32 flags, struct prof_info *i)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_PROF_CTL,
+                  (long)op, (long)period, (long)flags, (long)i);
+}
+
+static long
+cmd_prof_get_samples(struct prof_sample *buf, u32 first, u32 max)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_PROF_GET_SAMPLES,
+                  (long)buf, (long)first, (long)max, 0L);
+}
+
+static long
+cmd_prof_get_sym(u64 addr, char *buf, size_t buf_sz)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_PROF_GET_SYM,
+                  (long)addr, (long)buf, (long)buf_sz, 0L);
+}
+
+/* --------------------------- aggregation ----------------------------- */
+
+/*
+ * Find or add the entry for a kernel function (tid = 0) or for the user
+ * samples of a task (addr = 0). Returns NULL when the table is full.
+ */
+static struct prof_func *
+get_func(u64 addr, int tid)
+{
+   const u64 key = addr ? addr : (u64)tid;
+   u32 h = (u32)((key * 0x9E3779B97F4A7C15ull) >> 40) & (FUNCS_HT_SIZE - 1);
+
+   for (u32 i = 0; i < FUNCS_HT_SIZE; i++, h = (h + 1) & (FUNCS_HT_SIZE - 1)) {
+
+      struct prof_func *f = &funcs[h];
+
+      if (!f->addr && !f->tid) {
+
+         if (funcs_count == FUNCS_HT_SIZE - 1)
+            return NULL;
+
+         funcs_count++;
+         f->addr = addr;
+         f->tid = addr ? 0 : tid;
+
+         if (!addr)
+            snprintf(f->name, sizeof(f->name), "[user:%d]", tid);
+         else if (cmd_prof_get_sym(addr, f->name, sizeof(f->name)) < 0)
+            snprintf(f->name, sizeof(f->name), "%#llx",
+                     (unsigned long long)addr);
+
+         return f;
+      }
+
+      if (f->addr == addr && f->tid == (addr ? 0 : tid))
+         return f;
+   }
+
+   return NULL;
+}
+
+static void
+account_sample(const struct prof_sample *s)
+{
+   struct prof_func *seen[PROF_MAX_CALLCHAIN + 1];
+   struct prof_func *f;
+   int n = 0;
+
+   /* Unknown kernel addresses (0) all go in the "[unknown]" bucket */
+   if (!(f = get_func(s->user ? 0 : (s->ip ? s->ip : 1), s->tid)))
+      return;
+
+   if (!s->user && !s->ip)
+      snprintf(f->name, sizeof(f->name), "[unknown]");
+
+   f->self++;
+   f->total++;
+   seen[n++] = f;
+
+   /* Inclusive counts: each function once per sample, recursion or not */
+   for (u8 i = 0; i < s->depth && i < PROF_MAX_CALLCHAIN; i++) {
+
+      bool dup = false;
+
+      if (!s->callchain[i] || !(f = get_func(s->callchain[i], 0)))
+         continue;
+
+      for (int j = 0; j < n && !dup; j++)
+         dup = seen[j] == f;
+
+      if (!dup) {
+         f->total++;
+         seen[n++] = f;
+      }
+   }
+}
+
+/* Fetch the samples recorded since the last call. Returns 0 or -errno. */
+static int
+fetch_samples(void)
+{
+   long n;
+
+   do {
+
+      if (samples_count + FETCH_BATCH > samples_cap) {
+
+         const u32 new_cap = samples_cap ? samples_cap * 2 : 1024;
+         void *p = realloc(all_samples, new_cap * sizeof(*all_samples));
+
+         if (!p)
+            return -ENOMEM;
+
+         all_samples = p;
+         samples_cap = new_cap;
+      }
+
+      n = cmd_prof_get_samples(all_samples + samples_count,
+                               samples_count, FETCH_BATCH);
+
+      if (n < 0)
+         return -errno;
+
+      for (long i = 0; i < n; i++)
+         account_sample(&all_samples[samples_count + i]);
+
+      samples_count += (u32)n;
+
+   } while (n == FETCH_BATCH);
+
+   return 0;
+}
+
+static int cmp_funcs_by_self(const void *a, const void *b)
+{
+   const struct prof_func *fa = *(const struct prof_func *const *)a;
+   const struct prof_func *fb = *(const struct prof_func *const *)b;
+
+   if (fa->self != fb->self)
+      return fa->self < fb->self ? 1 : -1;
+
+   return fa->total < fb->total ? 1 : (fa->total > fb->total ? -1 : 0);
+}
+
+static void
+print_top(int top, const struct prof_info *info)
+{
+   struct prof_func **sorted;
+   u32 n = 0;
+
+   printf("Samples: %u (lost: %u), every %u tick(s) at %u Hz%s\n\n",
+          samples_count, info->lost, info->period, info->timer_hz,
+          (info->flags & PROF_FL_CALLCHAIN) ? ", with callchains" : "");
+
+   if (!samples_count || !(sorted = malloc(funcs_count * sizeof(*sorted))))
+      return;
+
+   for (u32 i = 0; i < FUNCS_HT_SIZE; i++)
+      if ((funcs[i].addr || funcs[i].tid) && (funcs[i].self || funcs[i].total))
+         sorted[n++] = &funcs[i];
+
+   qsort(sorted, n, sizeof(*sorted), cmp_funcs_by_self);
+
+   printf("   Self%%   Total%%    Samples  Function\n");
+
+   for (u32 i = 0; i < n && (int)i < top; i++) {
+
+      const struct prof_func *f = sorted[i];
+
+      printf("  %5.1f%%   %5.1f%%  %9u  %s\n",
+             100.0 * f->self / samples_count,
+             100.0 * f->total / samples_count,
+             f->self, f->name);
+   }
+
+   free(sorted);
+}
+
+/* -------------------------- folded export ---------------------------- */
+
+static const char *
+func_name(u64 addr, int tid)
+{
+   const struct prof_func *f = get_func(addr, tid);
+   return f ? f->name : "[unknown]";
+}
+
+static int cmp_strings(const void *a, const void *b)
+{
+   return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* Build the "outer;...;leaf" string of a sample; returns a malloc'd string */
+static char *
+sample_stack_str(const struct prof_sample *s)
+{
+   char buf[(PROF_MAX_CALLCHAIN + 1) * (FUNC_NAME_MAX + 1)];
+   size_t used = 0;
+
+   buf[0] = 0;
+
+   for (int i = (int)s->depth - 1; i >= 0; i--) {
+
+      if (!s->callchain[i])
+         continue;
+
+      used += (size_t)snprintf(buf + used, sizeof(buf) - used, "%s;",
+                               func_name(s->callchain[i], 0));
+   }
+
+   if (s->user)
+      snprintf(buf + used, sizeof(buf) - used, "%s", func_name(0, s->tid));
+   else
+      snprintf(buf + used, sizeof(buf) - used, "%s",
+               s->ip ? func_name(s->ip, 0) : "[unknown]");
+
+   return strdup(buf);
+}
+
+static int
+write_folded(const char *path)
+{
+   char **stacks;
+   FILE *f;
+   u32 i, j;
+   int rc = 0;
+
+   if (!(stacks = calloc(samples_count ? samples_count : 1, sizeof(char *))))
+      return -ENOMEM;
+
+   for (i = 0; i < samples_count; i++) {
+      if (!(stacks[i] = sample_stack_str(&all_samples[i]))) {
+         rc = -ENOMEM;
+         goto out;
+      }
+   }
+
+   if (!(f = fopen(path, "w"))) {
+      rc = -errno;
+      goto out;
+   }
+
+   /* Identical stacks become adjacent: merge them, summing their counts */
+   qsort(stacks, samples_count, sizeof(char *), cmp_strings);
+
+   for (i = 0; i < samples_count; i = j) {
+
+      for (j = i + 1; j < samples_count && !strcmp(stacks[i], stacks[j]); j++)
+         { }
+
+      fprintf(f, "%s %u\n", stacks[i], j - i);
+   }
+
+   if (fclose(f))
+      rc = -errno;
+
+out:
+   for (i = 0; i < samples_count; i++)
+      free(stacks[i]);
+
+   free(stacks);
+   return rc;
+}
+
+/* ---------------------------- profiling ------------------------------ */
+
+static void on_sigint(int signum)
+{
+   stop_profiling = 1;
+}
+
+int tr_run_prof(const struct tr_prof_opts *opts)
+{
+   struct sigaction sa = { .sa_handler = on_sigint };
+   const int seconds = opts->seconds > 0 ? opts->seconds : DEFAULT_SECONDS;
+   const int top = opts->top > 0 ? opts->top : DEFAULT_TOP;
+   const time_t start = time(NULL);
+   struct prof_info info;
+   int rc;
+
+   if (cmd_prof_ctl(PROF_CTL_START,
+                    (u32)opts->period,
+                    opts->callchain ? PROF_FL_CALLCHAIN : 0,
+                    &info) < 0)
+   {
+      fprintf(stderr, "tracer: cannot start the profiler: %s\n",
+              strerror(errno));
+      return 1;
+   }
+
+   sigaction(SIGINT, &sa, NULL);
+   sigaction(SIGTERM, &sa, NULL);
+
+   while (!stop_profiling && time(NULL) - start < seconds) {
+
+      sleep(1);
+
+      if ((rc = fetch_samples()) < 0)
+         break;
+
+      cmd_prof_ctl(PROF_CTL_INFO, 0, 0, &info);
+
+      /* Clear the screen and show the live top-N */
+      printf("\033[H\033[2J");
+      printf("Profiling for %d seconds, Ctrl+C to stop... (%ld s)\n\n",
+             seconds, (long)(time(NULL) - start));
+      print_top(top, &info);
+      fflush(stdout);
+   }
+
+   cmd_prof_ctl(PROF_CTL_STOP, 0, 0, &info);
+   rc = fetch_samples();
+
+   printf("\033[H\033[2J");
+   print_top(top, &info);
+
+   if (!rc && opts->folded) {
+
+      if ((rc = write_folded(opts->folded)) < 0)
+         fprintf(stderr, "tracer: cannot write %s: %s\n",
+                 opts->folded, strerror(-rc));
+      else
+         printf("\nCollapsed stacks written to %s\n", opts->folded);
+   }
+
+   cmd_prof_ctl(PROF_CTL_FREE, 0, 0, NULL);
+   free(all_samples);
+   return rc < 0 ? 1 : 0;
+}
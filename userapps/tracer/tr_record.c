@@ -0,0 +1,281 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * `tracer --record FILE [SECONDS]` — stream the raw trace events into a
+ * file, for offline analysis with `tracer --replay`.
+ *
+ * Nothing is rendered while recording: the events are drained from the
+ * kernel's trace ring in batches (TILCK_CMD_DP_TRACE_DRAIN) and written
+ * as-is, framed by struct tr_file_chunk. The file starts with a copy of
+ * /syst/tracing/metadata and of the syscall names, so that it can be
+ * rendered later without the kernel that produced it.
+ *
+ * What gets traced is what the interactive tracer would show: the tasks
+ * marked as traced and the syscall filter expression currently set.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <tilck/common/syscalls.h>
+#include <tilck/common/dp_abi.h>
+#include <tilck/common/tracing/wire.h>
+
+#include "tr.h"
+
+#define MAX_SYSCALLS      512
+#define DRAIN_BATCH       64
+
+/* ----------------------- TILCK_CMD wrappers -------------------------- */
+
+static long
+cmd_get_stats(struct dp_trace_stats *out)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_GET_STATS,
+                  (long)out, 0L, 0L, 0L);
+}
+
+static long
+cmd_set_enabled(int enabled)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_SET_ENABLED,
+                  (long)enabled, 0L, 0L, 0L);
+}
+
+static long
+cmd_get_sys_name(unsigned sys_n, char *buf, ulong buf_sz)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_GET_SYS_NAME,
+                  (long)sys_n, (long)buf, (long)buf_sz, 0L);
+}
+
+static long
+cmd_trace_drain(struct dp_trace_event *buf, ulong max, int wait)
+{
+   return syscall(TILCK_CMD_SYSCALL,
+                  TILCK_CMD_DP_TRACE_DRAIN,
+                  (long)buf, (long)max, (long)wait, 0L);
+}
+
+/* --------------------------- file writer ----------------------------- */
+
+static int
+write_all(struct tr_file_writer *w, const void *buf, size_t size)
+{
+   errno = 0;
+
+   if (size && fwrite(buf, size, 1, w->f) != 1)
+      return errno ? -errno : -EIO;
+
+   return 0;
+}
+
+int tr_file_create(struct tr_file_writer *w, const char *path)
+{
+   struct tr_file_sys_name *names;
+   struct tr_file_header h;
+   char buf[DP_SYS_NAME_MAX];
+   const void *meta;
+   size_t meta_size;
+   u32 n = 0;
+   int rc;
+
+   if (!(meta = tr_meta_get_blob(&meta_size)))
+      return -ENOENT;
+
+   if (!(names = calloc(MAX_SYSCALLS, sizeof(*names))))
+      return -ENOMEM;
+
+   for (u32 i = 0; i < MAX_SYSCALLS; i++) {
+
+      const char *p = buf;
+
+      if (cmd_get_sys_name(i, buf, sizeof(buf)) < 0)
+         continue;
+
+      if (!strncmp(p, "sys_", 4))
+         p += 4;
+
+      names[n].sys_n = i;
+      snprintf(names[n].name, sizeof(names[n].name), "%s", p);
+      n++;
+   }
+
+   h = (struct tr_file_header) {
+      .magic = TR_FILE_MAGIC,
+      .version = TR_FILE_VERSION,
+      .event_size = sizeof(struct dp_trace_event),
+      .meta_size = (u32)meta_size,
+      .names_count = n,
+   };
+
+   *w = (struct tr_file_writer) { 0 };
+
+   if (!(w->f = fopen(path, "wb"))) {
+      rc = -errno;
+      free(names);
+      return rc;
+   }
+
+   if (!(rc = write_all(w, &h, sizeof(h))))
+      if (!(rc = write_all(w, meta, meta_size)))
+         rc = write_all(w, names, n * sizeof(*names));
+
+   free(names);
+
+   if (rc) {
+      fclose(w->f);
+      w->f = NULL;
+   }
+
+   return rc;
+}
+
+int tr_file_write_chunk(struct tr_file_writer *w,
+                        const struct dp_trace_event *evs,
+                        u32 count,
+                        u32 lost)
+{
+   const struct tr_file_chunk c = {
+      .magic = TR_CHUNK_MAGIC,
+      .count = count,
+      .lost = lost,
+   };
+   int rc;
+
+   if (!count && !lost)
+      return 0;
+
+   if ((rc = write_all(w, &c, sizeof(c))))
+      return rc;
+
+   if ((rc = write_all(w, evs, count * sizeof(*evs))))
+      return rc;
+
+   w->events += count;
+   w->lost += lost;
+   return 0;
+}
+
+int tr_file_close(struct tr_file_writer *w)
+{
+   int rc = fclose(w->f) ? -errno : 0;
+   w->f = NULL;
+   return rc;
+}
+
+/* ---------------------------- recording ------------------------------ */
+
+static volatile sig_atomic_t stop_recording;
+
+static void on_sigint(int signum)
+{
+   stop_recording = 1;
+}
+
+static u32 get_lost_events(void)
+{
+   struct dp_trace_stats st = {0};
+   cmd_get_stats(&st);
+   return st.lost_events;
+}
+
+/*
+ * Drain one batch (waiting up to 100ms in the kernel if `wait` is set)
+ * and append it to the file. Returns the number of events written, or
+ * -errno.
+ */
+static long
+record_batch(struct tr_file_writer *w,
+             struct dp_trace_event *buf,
+             u32 *last_lost,
+             bool wait)
+{
+   const u32 lost = get_lost_events();
+   long n;
+   int rc;
+
+   if ((n = cmd_trace_drain(buf, DRAIN_BATCH, wait)) < 0)
+      return errno == EINTR ? 0 : -errno;
+
+   if ((rc = tr_file_write_chunk(w, buf, (u32)n, lost - *last_lost)))
+      return rc;
+
+   *last_lost = lost;
+   return n;
+}
+
+int tr_run_record(const char *path, int seconds)
+{
+   struct dp_trace_event *buf;
+   struct tr_file_writer w;
+   struct sigaction sa = { .sa_handler = on_sigint };
+   const time_t start = time(NULL);
+   u32 last_lost;
+   long n = 0;
+   int rc;
+
+   if (tr_meta_init() < 0)
+      return 2;
+
+   if (!(buf = malloc(DRAIN_BATCH * sizeof(*buf)))) {
+      fprintf(stderr, "tracer: out of memory\n");
+      return 1;
+   }
+
+   if ((rc = tr_file_create(&w, path))) {
+      fprintf(stderr, "tracer: cannot create %s: %s\n", path, strerror(-rc));
+      free(buf);
+      return 1;
+   }
+
+   sigaction(SIGINT, &sa, NULL);
+   sigaction(SIGTERM, &sa, NULL);
+
+   if (seconds > 0)
+      printf("Recording for %d seconds to %s...\n", seconds, path);
+   else
+      printf("Recording to %s, Ctrl+C to stop...\n", path);
+
+   last_lost = get_lost_events();
+   cmd_set_enabled(1);
+
+   while (!stop_recording) {
+
+      if (seconds > 0 && time(NULL) - start >= seconds)
+         break;
+
+      if ((n = record_batch(&w, buf, &last_lost, true)) < 0)
+         break;
+   }
+
+   cmd_set_enabled(0);
+
+   /* Collect what was produced before tracing got disabled */
+   while (n >= 0 && (n = record_batch(&w, buf, &last_lost, false)) > 0) { }
+
+   if (n < 0)
+      fprintf(stderr, "tracer: recording failed: %s\n", strerror((int)-n));
+
+   if ((rc = tr_file_close(&w)) && n >= 0) {
+      fprintf(stderr, "tracer: cannot write %s: %s\n", path, strerror(-rc));
+      n = rc;
+   }
+
+   printf("Recorded %llu events (%llu lost) in %ld seconds\n",
+          (unsigned long long)w.events,
+          (unsigned long long)w.lost,
+          (long)(time(NULL) - start));
+
+   free(buf);
+   return n < 0 ? 1 : 0;
+}
@@ -366,6 +366,21 @@ dump_ret_val(struct sbuf *sb,
 #define MAX_SYS_NAMES   512
 
 static char *sys_name_cache[MAX_SYS_NAMES];
+static bool sys_names_offline;   /* replaying a recording: no kernel */
+
+void tr_set_sys_name(unsigned sys_n, const char *name)
+{
+   if (sys_n >= MAX_SYS_NAMES)
+      return;
+
+   free(sys_name_cache[sys_n]);
+   sys_name_cache[sys_n] = strdup(name);
+}
+
+void tr_set_sys_names_offline(void)
+{
+   sys_names_offline = true;
+}
 
 static const char *get_syscall_name_cached(unsigned sys_n)
 {
@@ -381,9 +396,12 @@ static const char *get_syscall_name_cached(unsigned sys_n)
    if (sys_name_cache[sys_n])
       return sys_name_cache[sys_n];
 
-   rc = syscall(TILCK_CMD_SYSCALL,
-                TILCK_CMD_DP_TRACE_GET_SYS_NAME,
-                (long)sys_n, (long)buf, (long)sizeof(buf), 0L);
+   if (sys_names_offline)
+      rc = -1;
+   else
+      rc = syscall(TILCK_CMD_SYSCALL,
+                   TILCK_CMD_DP_TRACE_GET_SYS_NAME,
+                   (long)sys_n, (long)buf, (long)sizeof(buf), 0L);
 
    const char *src;
 
@@ -402,6 +420,11 @@ static const char *get_syscall_name_cached(unsigned sys_n)
    return sys_name_cache[sys_n] ? sys_name_cache[sys_n] : "?";
 }
 
+const char *tr_get_sys_name(unsigned sys_n)
+{
+   return get_syscall_name_cached(sys_n);
+}
+
 static void
 dump_syscall_event(struct sbuf *sb,
                    const struct dp_trace_event *e,
@@ -0,0 +1,306 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+
+/*
+ * `tracer --replay FILE` — offline rendering and analysis of a recording
+ * made with `tracer --record` (format: struct tr_file_header in
+ * <tilck/common/tracing/wire.h>).
+ *
+ * The metadata and the syscall names come from the file itself, so no
+ * kernel support is needed: the renderer is switched to offline mode
+ * before the first event. Besides rendering, the events can be filtered
+ * by task and by syscall name, or aggregated into per-syscall latency
+ * statistics (--stats).
+ */
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <tilck/common/dp_abi.h>
+#include <tilck/common/tracing/wire.h>
+
+#include "tr.h"
+
+#define RENDER_BUF_SZ     1024
+#define MAX_SYSCALLS      512
+#define MAX_PENDING       64      /* tasks with an ENTER waiting for EXIT */
+
+/* ----------------------------- latency stats ----------------------------- */
+
+struct pending_enter {
+   int tid;                /* 0: free slot */
+   u32 sys;
+   u64 sys_time;
+};
+
+static struct tr_sys_stats sys_stats[MAX_SYSCALLS];
+static struct pending_enter pending[MAX_PENDING];
+
+void tr_stats_reset(void)
+{
+   memset(sys_stats, 0, sizeof(sys_stats));
+   memset(pending, 0, sizeof(pending));
+}
+
+static struct pending_enter *find_pending(int tid)
+{
+   for (int i = 0; i < MAX_PENDING; i++)
+      if (pending[i].tid == tid)
+         return &pending[i];
+
+   return NULL;
+}
+
+void tr_stats_add_event(const struct dp_trace_event *e)
+{
+   const struct dp_syscall_event_data *se = &e->sys_ev;
+   struct pending_enter *p = find_pending(e->tid);
+   struct tr_sys_stats *s;
+   u64 ns;
+
+   if (e->type == dp_te_sys_enter) {
+
+      /* A task has at most one syscall in flight: replace any stale one */
+      if (p || (p = find_pending(0)))
+         *p = (struct pending_enter) { e->tid, se->sys, e->sys_time };
+
+      return;
+   }
+
+   if (e->type != dp_te_sys_exit || se->sys >= MAX_SYSCALLS)
+      return;
+
+   s = &sys_stats[se->sys];
+   s->calls++;
+
+   if (se->retval < 0)
+      s->errors++;
+
+   if (!p || p->sys != se->sys || p->sys_time > e->sys_time) {
+
+      /* Traced only at exit, or the ENTER was lost */
+      if (p)
+         p->tid = 0;
+
+      return;
+   }
+
+   ns = e->sys_time - p->sys_time;
+   p->tid = 0;
+
+   s->min_ns = s->timed ? MIN(s->min_ns, ns) : ns;
+   s->max_ns = MAX(s->max_ns, ns);
+   s->tot_ns += ns;
+   s->timed++;
+}
+
+const struct tr_sys_stats *tr_stats_get(unsigned sys_n)
+{
+   return sys_n < MAX_SYSCALLS ? &sys_stats[sys_n] : NULL;
+}
+
+static int cmp_by_tot_ns(const void *a, const void *b)
+{
+   const struct tr_sys_stats *sa = &sys_stats[*(const u16 *)a];
+   const struct tr_sys_stats *sb = &sys_stats[*(const u16 *)b];
+
+   if (sa->tot_ns != sb->tot_ns)
+      return sa->tot_ns < sb->tot_ns ? 1 : -1;
+
+   return sa->calls < sb->calls ? 1 : (sa->calls > sb->calls ? -1 : 0);
+}
+
+void tr_stats_print(void)
+{
+   u16 order[MAX_SYSCALLS];
+   int n = 0;
+
+   for (u16 i = 0; i < MAX_SYSCALLS; i++)
+      if (sys_stats[i].calls)
+         order[n++] = i;
+
+   qsort(order, (size_t)n, sizeof(order[0]), cmp_by_tot_ns);
+
+   printf("%-20s %8s %7s %8s %12s %10s %10s %10s\n",
+          "syscall", "calls", "errors", "timed",
+          "total us", "avg us", "min us", "max us");
+
+   for (int i = 0; i < n; i++) {
+
+      const struct tr_sys_stats *s = &sys_stats[order[i]];
+
+      printf("%-20.20s %8u %7u %8u", tr_get_sys_name(order[i]),
+             s->calls, s->errors, s->timed);
+
+      if (s->timed)
+         printf(" %12llu %10llu %10llu %10llu\n",
+                (unsigned long long)(s->tot_ns / 1000),
+                (unsigned long long)(s->tot_ns / s->timed / 1000),
+                (unsigned long long)(s->min_ns / 1000),
+                (unsigned long long)(s->max_ns / 1000));
+      else
+         printf(" %12s %10s %10s %10s\n", "-", "-", "-", "-");
+   }
+}
+
+/* ------------------------------ file reader ------------------------------ */
+
+static int
+read_exact(FILE *f, void *buf, size_t size)
+{
+   if (size && fread(buf, size, 1, f) != 1)
+      return ferror(f) ? -EIO : -ENODATA;
+
+   return 0;
+}
+
+/*
+ * Read the header, load the embedded metadata and the syscall names. On
+ * success, `f` is left at the first chunk.
+ */
+static int
+read_file_prelude(FILE *f)
+{
+   struct tr_file_header h;
+   struct tr_file_sys_name name;
+   void *meta;
+   int rc;
+
+   if ((rc = read_exact(f, &h, sizeof(h))))
+      return rc;
+
+   if (h.magic != TR_FILE_MAGIC)
+      return -EINVAL;
+
+   if (h.version != TR_FILE_VERSION ||
+       h.event_size != sizeof(struct dp_trace_event))
+   {
+      return -ENOTSUP;
+   }
+
+   if (!(meta = malloc(h.meta_size ? h.meta_size : 1)))
+      return -ENOMEM;
+
+   if (!(rc = read_exact(f, meta, h.meta_size)))
+      rc = tr_meta_init_from_blob(meta, h.meta_size);
+
+   free(meta);
+
+   if (rc)
+      return rc;
+
+   tr_set_sys_names_offline();
+
+   for (u32 i = 0; i < h.names_count; i++) {
+
+      if ((rc = read_exact(f, &name, sizeof(name))))
+         return rc;
+
+      name.name[sizeof(name.name) - 1] = 0;
+      tr_set_sys_name(name.sys_n, name.name);
+   }
+
+   return 0;
+}
+
+/* -------------------------------- replay --------------------------------- */
+
+static bool
+event_matches(const struct dp_trace_event *e, const struct tr_replay_opts *o)
+{
+   if (o->tid && e->tid != o->tid)
+      return false;
+
+   if (!o->sys)
+      return true;
+
+   if (e->type != dp_te_sys_enter && e->type != dp_te_sys_exit)
+      return false;
+
+   return !fnmatch(o->sys, tr_get_sys_name(e->sys_ev.sys), 0);
+}
+
+int tr_run_replay(const char *path, const struct tr_replay_opts *opts)
+{
+   struct tr_file_chunk c;
+   struct dp_trace_event ev;
+   struct dp_render_ctx ctx = {0};
+   char rbuf[RENDER_BUF_SZ];
+   u64 events = 0, matched = 0, lost = 0;
+   FILE *f;
+   int rc;
+
+   if (!(f = fopen(path, "rb"))) {
+      fprintf(stderr, "tracer: cannot open %s: %s\n", path, strerror(errno));
+      return 1;
+   }
+
+   if ((rc = read_file_prelude(f))) {
+      fprintf(stderr, "tracer: %s: bad or unsupported recording: %s\n",
+              path, strerror(-rc));
+      fclose(f);
+      return 1;
+   }
+
+   tr_stats_reset();
+
+   while (!(rc = read_exact(f, &c, sizeof(c)))) {
+
+      if (c.magic != TR_CHUNK_MAGIC) {
+         rc = -EINVAL;
+         break;
+      }
+
+      lost += c.lost;
+
+      if (c.lost && !opts->stats)
+         printf("<%u events lost>\n", c.lost);
+
+      for (u32 i = 0; i < c.count; i++) {
+
+         if (read_exact(f, &ev, sizeof(ev))) {
+            rc = -EINVAL;     /* truncated chunk */
+            break;
+         }
+
+         events++;
+
+         if (!event_matches(&ev, opts))
+            continue;
+
+         matched++;
+
+         if (opts->stats) {
+            tr_stats_add_event(&ev);
+            continue;
+         }
+
+         if ((rc = tr_render_event(&ev, rbuf, sizeof(rbuf), &ctx)) > 0)
+            fwrite(rbuf, (size_t)rc, 1, stdout);
+
+         rc = 0;
+      }
+
+      if (rc)
+         break;
+   }
+
+   fclose(f);
+
+   if (rc != -ENODATA) {
+      fprintf(stderr, "tracer: %s: truncated or corrupted recording\n", path);
+      return 1;
+   }
+
+   if (opts->stats)
+      tr_stats_print();
+
+   printf("\n%llu events, %llu matched, %llu lost\n",
+          (unsigned long long)events,
+          (unsigned long long)matched,
+          (unsigned long long)lost);
+
+   return 0;
+}